@@ -0,0 +1,1102 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <sort.hpp>
+#include <containeralgorithms.hpp>
+#include <setalgorithms.hpp>
+#include <iterator.hpp>
+
+namespace Designar
+{
+  /** B+ tree of keys with rank operations. It can replace RankedTreap as
+   *  the TreeType of TreeSet and TreeMap.
+   *
+   *  Every node takes about BTreeNodeSize bytes of keys. Leaves keep their
+   *  keys sorted and contiguous and are linked in order, so a scan reads
+   *  whole cache lines. Inner nodes keep the separators of their children
+   *  and how many keys are below each one, which gives select and
+   *  position in O(log n). Searches inside a node are the branchless
+   *  lower_bound and upper_bound of sort.hpp.
+   *
+   *  Keys move between nodes when these split or merge, so the pointers
+   *  returned by insert and search, as well as the iterators, are only
+   *  valid until the next insertion or removal.
+   */
+  template <typename Key, class Cmp = std::less<Key>>
+  class BPlusTree : public ContainerAlgorithms<BPlusTree<Key, Cmp>, Key>,
+		    public SetAlgorithms<BPlusTree<Key, Cmp>, Key>
+  {
+    // Keys of a leaf and children of an inner node.
+    static constexpr nat_t MAX_FILL =
+      BTreeNodeSize / sizeof(Key) < 8 ? 8 : BTreeNodeSize / sizeof(Key);
+
+    static constexpr nat_t MIN_FILL = MAX_FILL / 2;
+
+    struct Node
+    {
+      nat_t num;
+      bool  leaf;
+
+      Node(bool l)
+	: num(0), leaf(l)
+      {
+	// empty
+      }
+    };
+
+    // Nodes have room for one more item, which is moved out by a split.
+    struct Leaf : public Node
+    {
+      Key    keys[MAX_FILL + 1];
+      Leaf * prev;
+      Leaf * next;
+
+      Leaf()
+	: Node(true), prev(nullptr), next(nullptr)
+      {
+	// empty
+      }
+    };
+
+    // keys[i] is not less than the keys of child i, nor greater than those
+    // of child i + 1; counts[i] is the number of keys below child i.
+    struct Inner : public Node
+    {
+      Key    keys[MAX_FILL];
+      nat_t  counts[MAX_FILL + 1];
+      Node * child[MAX_FILL + 1];
+
+      Inner()
+	: Node(false)
+      {
+	// empty
+      }
+    };
+
+    Node * root;
+    Leaf * head;
+    Leaf * tail;
+    nat_t  num_items;
+    Cmp  & cmp;
+
+    static Leaf * LEAF(Node * p)
+    {
+      return static_cast<Leaf *>(p);
+    }
+
+    static Inner * INNER(Node * p)
+    {
+      return static_cast<Inner *>(p);
+    }
+
+    template <typename T>
+    static void open_gap(T * a, nat_t n, nat_t i)
+    {
+      for (nat_t j = n; j > i; --j)
+	a[j] = std::move(a[j - 1]);
+    }
+
+    template <typename T>
+    static void close_gap(T * a, nat_t n, nat_t i)
+    {
+      for (nat_t j = i + 1; j < n; ++j)
+	a[j - 1] = std::move(a[j]);
+    }
+
+    static nat_t size_of(Node * p)
+    {
+      if (p->leaf)
+	return p->num;
+
+      nat_t ret_val = 0;
+
+      for (nat_t i = 0; i < p->num; ++i)
+	ret_val += INNER(p)->counts[i];
+
+      return ret_val;
+    }
+
+    // First child of p whose keys may be equal to k.
+    nat_t lower_child(Node * p, const Key & k) const
+    {
+      return Designar::lower_bound(INNER(p)->keys, 0, p->num - 1, k, cmp);
+    }
+
+    // Child of p where k goes after the keys equal to it.
+    nat_t upper_child(Node * p, const Key & k) const
+    {
+      return Designar::upper_bound(INNER(p)->keys, 0, p->num - 1, k, cmp);
+    }
+
+    static void destroy(Node *);
+
+    Node * copy(Node *, Leaf *&);
+
+    void copy(const BPlusTree & t)
+    {
+      Leaf * last = nullptr;
+
+      if (t.root != nullptr)
+	root = copy(t.root, last);
+
+      tail = last;
+      num_items = t.num_items;
+    }
+
+    bool verify(Node *, const Key *, const Key *, bool) const;
+
+    Leaf * split_leaf(Leaf *);
+
+    static Inner * split_inner(Inner *, Key &);
+
+    template <class K>
+    Key * insert(Node *, K &&, bool, Key *&, Node *&, Key &);
+
+    template <class K>
+    Key * insert_key(K &&, bool, Key *&);
+
+    void borrow_from_left(Inner *, nat_t);
+
+    void borrow_from_right(Inner *, nat_t);
+
+    void merge(Inner *, nat_t);
+
+    Key remove_pos(Node *, nat_t);
+
+    nat_t locate(const Key &, Leaf *&, nat_t &) const;
+
+    Leaf * seek(nat_t, nat_t &) const;
+
+    nat_t bytes(Node *) const;
+
+  public:
+    using ItemType  = Key;
+    using KeyType   = Key;
+    using DataType  = Key;
+    using ValueType = Key;
+    using SizeType  = nat_t;
+    using CmpType   = Cmp;
+
+    BPlusTree(Cmp & _cmp)
+      : root(nullptr), head(nullptr), tail(nullptr), num_items(0), cmp(_cmp)
+    {
+      // empty
+    }
+
+    BPlusTree(Cmp && _cmp = Cmp())
+      : BPlusTree(_cmp)
+    {
+      // empty
+    }
+
+    BPlusTree(const BPlusTree & t)
+      : BPlusTree(t.cmp)
+    {
+      copy(t);
+    }
+
+    BPlusTree(BPlusTree && t)
+      : BPlusTree()
+    {
+      swap(t);
+    }
+
+    BPlusTree(const std::initializer_list<Key> &);
+
+    ~BPlusTree()
+    {
+      clear();
+    }
+
+    BPlusTree & operator = (const BPlusTree & t)
+    {
+      if (this == &t)
+	return *this;
+
+      clear();
+      copy(t);
+      cmp = t.cmp;
+      return *this;
+    }
+
+    BPlusTree & operator = (BPlusTree && t)
+    {
+      swap(t);
+      return *this;
+    }
+
+    void swap(BPlusTree & t)
+    {
+      std::swap(root, t.root);
+      std::swap(head, t.head);
+      std::swap(tail, t.tail);
+      std::swap(num_items, t.num_items);
+      std::swap(cmp, t.cmp);
+    }
+
+    bool verify() const
+    {
+      return root == nullptr ? num_items == 0 :
+	verify(root, nullptr, nullptr, false);
+    }
+
+    bool verify_dup() const
+    {
+      return root == nullptr ? num_items == 0 :
+	verify(root, nullptr, nullptr, true);
+    }
+
+    bool is_empty() const
+    {
+      return num_items == 0;
+    }
+
+    bool is_sorted() const
+    {
+      return true;
+    }
+
+    nat_t size() const
+    {
+      return num_items;
+    }
+
+    /// Bytes taken by the nodes.
+    nat_t node_bytes() const
+    {
+      return root == nullptr ? 0 : bytes(root);
+    }
+
+    void clear()
+    {
+      if (root != nullptr)
+	destroy(root);
+
+      root = nullptr;
+      head = tail = nullptr;
+      num_items = 0;
+    }
+
+    Cmp & get_cmp()
+    {
+      return cmp;
+    }
+
+    const Cmp & get_cmp() const
+    {
+      return cmp;
+    }
+
+    Key * insert(const Key & k)
+    {
+      Key * found;
+      return insert_key(k, false, found);
+    }
+
+    Key * insert(Key && k)
+    {
+      Key * found;
+      return insert_key(std::forward<Key>(k), false, found);
+    }
+
+    Key * insert_dup(const Key & k)
+    {
+      Key * found;
+      return insert_key(k, true, found);
+    }
+
+    Key * insert_dup(Key && k)
+    {
+      Key * found;
+      return insert_key(std::forward<Key>(k), true, found);
+    }
+
+    Key * append(const Key & k)
+    {
+      return insert(k);
+    }
+
+    Key * append(Key && k)
+    {
+      return insert(std::forward<Key>(k));
+    }
+
+    Key * append_dup(const Key & k)
+    {
+      return insert_dup(k);
+    }
+
+    Key * append_dup(Key && k)
+    {
+      return insert_dup(std::forward<Key>(k));
+    }
+
+    Key * search(const Key & k)
+    {
+      Leaf * leaf;
+      nat_t i;
+
+      locate(k, leaf, i);
+
+      if (leaf == nullptr or cmp(k, leaf->keys[i]))
+	return nullptr;
+
+      return &leaf->keys[i];
+    }
+
+    const Key * search(const Key & k) const
+    {
+      return const_cast<BPlusTree *>(this)->search(k);
+    }
+
+    Key * search_or_insert(const Key & k)
+    {
+      Key * found;
+      Key * result = insert_key(k, false, found);
+      return result == nullptr ? found : result;
+    }
+
+    Key * search_or_insert(Key && k)
+    {
+      Key * found;
+      Key * result = insert_key(std::forward<Key>(k), false, found);
+      return result == nullptr ? found : result;
+    }
+
+    Key & find(const Key & k)
+    {
+      Key * result = search(k);
+
+      if (result == nullptr)
+	throw std::domain_error("Key not found");
+
+      return *result;
+    }
+
+    const Key & find(const Key & k) const
+    {
+      const Key * result = search(k);
+
+      if (result == nullptr)
+	throw std::domain_error("Key not found");
+
+      return *result;
+    }
+
+    bool remove(const Key & k)
+    {
+      Leaf * leaf;
+      nat_t i;
+      nat_t r = locate(k, leaf, i);
+
+      if (leaf == nullptr or cmp(k, leaf->keys[i]))
+	return false;
+
+      remove_pos(r);
+      return true;
+    }
+
+    Key remove_pos(nat_t i)
+    {
+      if (i >= size())
+	throw std::out_of_range("Infix position is out of range");
+
+      Key ret_val = remove_pos(root, i);
+      --num_items;
+
+      if (not root->leaf and root->num == 1)
+	{
+	  Inner * old_root = INNER(root);
+	  root = old_root->child[0];
+	  delete old_root;
+	}
+      else if (root->leaf and root->num == 0)
+	clear();
+
+      return ret_val;
+    }
+
+    const Key & min() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Tree is empty");
+
+      return head->keys[0];
+    }
+
+    const Key & max() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Tree is empty");
+
+      return tail->keys[tail->num - 1];
+    }
+
+    Key & select(nat_t i)
+    {
+      if (i >= size())
+	throw std::out_of_range("Infix position is out of range");
+
+      nat_t j;
+      Leaf * leaf = seek(i, j);
+      return leaf->keys[j];
+    }
+
+    const Key & select(nat_t i) const
+    {
+      return const_cast<BPlusTree *>(this)->select(i);
+    }
+
+    int_t position(const Key & k) const
+    {
+      Leaf * leaf;
+      nat_t i;
+      nat_t r = locate(k, leaf, i);
+
+      if (leaf == nullptr or cmp(k, leaf->keys[i]))
+	return -1;
+
+      return r;
+    }
+
+    Key & operator [] (nat_t i)
+    {
+      return select(i);
+    }
+
+    const Key & operator [] (nat_t i) const
+    {
+      return select(i);
+    }
+
+    class Iterator : public ForwardIterator<Iterator, Key>
+    {
+      friend class BPlusTree;
+      friend class BasicIterator<Iterator, Key>;
+
+      BPlusTree * tree_ptr = nullptr;
+      Leaf * leaf = nullptr;
+      nat_t  i = 0;
+      nat_t  rank = 0;
+
+    protected:
+      Key * get_location() const
+      {
+	return leaf == nullptr ? nullptr : &leaf->keys[i];
+      }
+
+    public:
+      Iterator()
+      {
+	// empty
+      }
+
+      Iterator(const BPlusTree & t)
+	: tree_ptr(const_cast<BPlusTree *>(&t)), leaf(t.head)
+      {
+	// empty
+      }
+
+      Iterator(const BPlusTree & t, int)
+	: tree_ptr(const_cast<BPlusTree *>(&t)), rank(t.size())
+      {
+	// empty
+      }
+
+      void reset_first()
+      {
+	leaf = tree_ptr->head;
+	i = rank = 0;
+      }
+
+      bool has_current() const
+      {
+	return leaf != nullptr;
+      }
+
+      Key & get_current()
+      {
+	if (not has_current())
+	  throw std::overflow_error("There is not current element");
+
+	return leaf->keys[i];
+      }
+
+      const Key & get_current() const
+      {
+	if (not has_current())
+	  throw std::overflow_error("There is not current element");
+
+	return leaf->keys[i];
+      }
+
+      void next()
+      {
+	if (not has_current())
+	  throw std::overflow_error("There is not current element");
+
+	++rank;
+
+	if (++i < leaf->num)
+	  return;
+
+	leaf = leaf->next;
+	i = 0;
+      }
+
+      // The keys move on removal, so the next one is found by its rank.
+      Key del()
+      {
+	if (not has_current())
+	  throw std::logic_error("There is not current element");
+
+	Key ret_val = tree_ptr->remove_pos(rank);
+
+	if (rank < tree_ptr->size())
+	  leaf = tree_ptr->seek(rank, i);
+	else
+	  leaf = nullptr;
+
+	return ret_val;
+      }
+    };
+
+    Iterator begin()
+    {
+      return Iterator(*this);
+    }
+
+    Iterator begin() const
+    {
+      return Iterator(*this);
+    }
+
+    Iterator end()
+    {
+      return Iterator(*this, 0);
+    }
+
+    Iterator end() const
+    {
+      return Iterator(*this, 0);
+    }
+  };
+
+  template <typename Key, class Cmp>
+  BPlusTree<Key, Cmp>::BPlusTree(const std::initializer_list<Key> & l)
+    : BPlusTree()
+  {
+    for (const auto & item : l)
+      append(item);
+  }
+
+  template <typename Key, class Cmp>
+  void BPlusTree<Key, Cmp>::destroy(Node * p)
+  {
+    if (p->leaf)
+      {
+	delete LEAF(p);
+	return;
+      }
+
+    for (nat_t i = 0; i < p->num; ++i)
+      destroy(INNER(p)->child[i]);
+
+    delete INNER(p);
+  }
+
+  template <typename Key, class Cmp>
+  typename BPlusTree<Key, Cmp>::Node *
+  BPlusTree<Key, Cmp>::copy(Node * p, Leaf *& last)
+  {
+    if (p->leaf)
+      {
+	Leaf * q = new Leaf(*LEAF(p));
+	q->prev = last;
+	q->next = nullptr;
+
+	if (last == nullptr)
+	  head = q;
+	else
+	  last->next = q;
+
+	last = q;
+	return q;
+      }
+
+    Inner * q = new Inner(*INNER(p));
+
+    for (nat_t i = 0; i < p->num; ++i)
+      q->child[i] = copy(INNER(p)->child[i], last);
+
+    return q;
+  }
+
+  // Checks order, counts and fill of the subtree of p within [lo, hi].
+  template <typename Key, class Cmp>
+  bool BPlusTree<Key, Cmp>::verify(Node * p, const Key * lo, const Key * hi,
+				   bool dup) const
+  {
+    if (p != root and (p->num < MIN_FILL or p->num > MAX_FILL))
+      return false;
+
+    if (p->leaf)
+      {
+	Leaf * l = LEAF(p);
+
+	if (l->num == 0)
+	  return false;
+
+	for (nat_t i = 0; i < l->num; ++i)
+	  {
+	    if (i > 0 and (dup ? cmp(l->keys[i], l->keys[i - 1]) :
+			   not cmp(l->keys[i - 1], l->keys[i])))
+	      return false;
+
+	    if ((lo != nullptr and cmp(l->keys[i], *lo)) or
+		(hi != nullptr and cmp(*hi, l->keys[i])))
+	      return false;
+	  }
+
+	return (l->next == nullptr) == (l == tail) and
+	  (l->prev == nullptr) == (l == head) and
+	  (l->next == nullptr or l->next->prev == l);
+      }
+
+    Inner * q = INNER(p);
+
+    if (q->num < 2)
+      return false;
+
+    for (nat_t i = 0; i < q->num; ++i)
+      {
+	const Key * l = i == 0 ? lo : &q->keys[i - 1];
+	const Key * h = i == q->num - 1 ? hi : &q->keys[i];
+
+	if (q->counts[i] != size_of(q->child[i]) or
+	    not verify(q->child[i], l, h, dup))
+	  return false;
+      }
+
+    return p != root or size_of(p) == num_items;
+  }
+
+  template <typename Key, class Cmp>
+  typename BPlusTree<Key, Cmp>::Leaf *
+  BPlusTree<Key, Cmp>::split_leaf(Leaf * l)
+  {
+    Leaf * r = new Leaf;
+    nat_t h = l->num / 2;
+
+    for (nat_t i = h; i < l->num; ++i)
+      r->keys[i - h] = std::move(l->keys[i]);
+
+    r->num = l->num - h;
+    l->num = h;
+
+    r->prev = l;
+    r->next = l->next;
+
+    if (l->next == nullptr)
+      tail = r;
+    else
+      l->next->prev = r;
+
+    l->next = r;
+
+    return r;
+  }
+
+  // Moves the upper half of the children of q to a new node; sep is left
+  // with the separator of both.
+  template <typename Key, class Cmp>
+  typename BPlusTree<Key, Cmp>::Inner *
+  BPlusTree<Key, Cmp>::split_inner(Inner * q, Key & sep)
+  {
+    Inner * r = new Inner;
+    nat_t h = q->num / 2;
+
+    sep = std::move(q->keys[h - 1]);
+
+    for (nat_t i = h; i < q->num; ++i)
+      {
+	r->child[i - h] = q->child[i];
+	r->counts[i - h] = q->counts[i];
+      }
+
+    for (nat_t i = h; i + 1 < q->num; ++i)
+      r->keys[i - h] = std::move(q->keys[i]);
+
+    r->num = q->num - h;
+    q->num = h;
+
+    return r;
+  }
+
+  /* Inserts k under p. Returns the key inserted, or nullptr if k was
+   * already there and dup is false, then found points to it. When p
+   * overflows, its upper half goes to a new sibling left in right, with
+   * the separator in sep; otherwise right is nullptr.
+   */
+  template <typename Key, class Cmp>
+  template <class K>
+  Key * BPlusTree<Key, Cmp>::insert(Node * p, K && k, bool dup, Key *& found,
+				    Node *& right, Key & sep)
+  {
+    right = nullptr;
+
+    if (p->leaf)
+      {
+	Leaf * l = LEAF(p);
+	nat_t i;
+
+	if (dup)
+	  i = Designar::upper_bound(l->keys, 0, l->num, k, cmp);
+	else
+	  {
+	    i = Designar::lower_bound(l->keys, 0, l->num, k, cmp);
+
+	    // The first key not less than k may start the next leaf.
+	    Key * q = i < l->num ? &l->keys[i] :
+	      l->next == nullptr ? nullptr : &l->next->keys[0];
+
+	    if (q != nullptr and not cmp(k, *q))
+	      {
+		found = q;
+		return nullptr;
+	      }
+	  }
+
+	open_gap(l->keys, l->num, i);
+	l->keys[i] = std::forward<K>(k);
+
+	if (++l->num <= MAX_FILL)
+	  return &l->keys[i];
+
+	Leaf * r = split_leaf(l);
+	right = r;
+	sep = r->keys[0];
+
+	return i < l->num ? &l->keys[i] : &r->keys[i - l->num];
+      }
+
+    Inner * q = INNER(p);
+    nat_t c = dup ? upper_child(q, k) : lower_child(q, k);
+
+    Node * child_right;
+    Key child_sep;
+
+    Key * ret_val = insert(q->child[c], std::forward<K>(k), dup, found,
+			   child_right, child_sep);
+
+    if (ret_val == nullptr)
+      return nullptr;
+
+    ++q->counts[c];
+
+    if (child_right == nullptr)
+      return ret_val;
+
+    nat_t moved = size_of(child_right);
+    q->counts[c] -= moved;
+
+    open_gap(q->keys, q->num - 1, c);
+    q->keys[c] = std::move(child_sep);
+
+    open_gap(q->child, q->num, c + 1);
+    q->child[c + 1] = child_right;
+
+    open_gap(q->counts, q->num, c + 1);
+    q->counts[c + 1] = moved;
+
+    if (++q->num > MAX_FILL)
+      right = split_inner(q, sep);
+
+    return ret_val;
+  }
+
+  template <typename Key, class Cmp>
+  template <class K>
+  Key * BPlusTree<Key, Cmp>::insert_key(K && k, bool dup, Key *& found)
+  {
+    if (root == nullptr)
+      root = head = tail = new Leaf;
+
+    Node * right;
+    Key sep;
+
+    Key * ret_val = insert(root, std::forward<K>(k), dup, found, right, sep);
+
+    if (ret_val == nullptr)
+      return nullptr;
+
+    ++num_items;
+
+    if (right != nullptr)
+      {
+	Inner * new_root = new Inner;
+
+	new_root->num = 2;
+	new_root->keys[0] = std::move(sep);
+	new_root->child[0] = root;
+	new_root->child[1] = right;
+	new_root->counts[1] = size_of(right);
+	new_root->counts[0] = num_items - new_root->counts[1];
+
+	root = new_root;
+      }
+
+    return ret_val;
+  }
+
+  // Moves the last item of child c - 1 of q to the front of child c.
+  template <typename Key, class Cmp>
+  void BPlusTree<Key, Cmp>::borrow_from_left(Inner * q, nat_t c)
+  {
+    Node * a = q->child[c - 1];
+    Node * b = q->child[c];
+    nat_t moved = 1;
+
+    if (b->leaf)
+      {
+	Leaf * la = LEAF(a);
+	Leaf * lb = LEAF(b);
+
+	open_gap(lb->keys, lb->num, 0);
+	lb->keys[0] = std::move(la->keys[la->num - 1]);
+	q->keys[c - 1] = lb->keys[0];
+      }
+    else
+      {
+	Inner * ia = INNER(a);
+	Inner * ib = INNER(b);
+
+	open_gap(ib->keys, ib->num - 1, 0);
+	ib->keys[0] = std::move(q->keys[c - 1]);
+
+	open_gap(ib->child, ib->num, 0);
+	ib->child[0] = ia->child[ia->num - 1];
+
+	open_gap(ib->counts, ib->num, 0);
+	ib->counts[0] = moved = ia->counts[ia->num - 1];
+
+	q->keys[c - 1] = std::move(ia->keys[ia->num - 2]);
+      }
+
+    --a->num;
+    ++b->num;
+
+    q->counts[c - 1] -= moved;
+    q->counts[c] += moved;
+  }
+
+  // Moves the first item of child c + 1 of q to the back of child c.
+  template <typename Key, class Cmp>
+  void BPlusTree<Key, Cmp>::borrow_from_right(Inner * q, nat_t c)
+  {
+    Node * a = q->child[c];
+    Node * b = q->child[c + 1];
+    nat_t moved = 1;
+
+    if (a->leaf)
+      {
+	Leaf * la = LEAF(a);
+	Leaf * lb = LEAF(b);
+
+	la->keys[la->num] = std::move(lb->keys[0]);
+	close_gap(lb->keys, lb->num, 0);
+	q->keys[c] = lb->keys[0];
+      }
+    else
+      {
+	Inner * ia = INNER(a);
+	Inner * ib = INNER(b);
+
+	ia->keys[ia->num - 1] = std::move(q->keys[c]);
+	ia->child[ia->num] = ib->child[0];
+	ia->counts[ia->num] = moved = ib->counts[0];
+
+	q->keys[c] = std::move(ib->keys[0]);
+
+	close_gap(ib->keys, ib->num - 1, 0);
+	close_gap(ib->child, ib->num, 0);
+	close_gap(ib->counts, ib->num, 0);
+      }
+
+    ++a->num;
+    --b->num;
+
+    q->counts[c] += moved;
+    q->counts[c + 1] -= moved;
+  }
+
+  // Appends child c + 1 of q to child c and deletes it.
+  template <typename Key, class Cmp>
+  void BPlusTree<Key, Cmp>::merge(Inner * q, nat_t c)
+  {
+    Node * a = q->child[c];
+    Node * b = q->child[c + 1];
+
+    if (a->leaf)
+      {
+	Leaf * la = LEAF(a);
+	Leaf * lb = LEAF(b);
+
+	for (nat_t i = 0; i < lb->num; ++i)
+	  la->keys[la->num + i] = std::move(lb->keys[i]);
+
+	la->next = lb->next;
+
+	if (lb->next == nullptr)
+	  tail = la;
+	else
+	  lb->next->prev = la;
+
+	la->num += lb->num;
+	delete lb;
+      }
+    else
+      {
+	Inner * ia = INNER(a);
+	Inner * ib = INNER(b);
+
+	ia->keys[ia->num - 1] = std::move(q->keys[c]);
+
+	for (nat_t i = 0; i + 1 < ib->num; ++i)
+	  ia->keys[ia->num + i] = std::move(ib->keys[i]);
+
+	for (nat_t i = 0; i < ib->num; ++i)
+	  {
+	    ia->child[ia->num + i] = ib->child[i];
+	    ia->counts[ia->num + i] = ib->counts[i];
+	  }
+
+	ia->num += ib->num;
+	delete ib;
+      }
+
+    q->counts[c] += q->counts[c + 1];
+
+    close_gap(q->keys, q->num - 1, c);
+    close_gap(q->child, q->num, c + 1);
+    close_gap(q->counts, q->num, c + 1);
+    --q->num;
+  }
+
+  // Removes the key of rank i under p; a child left under MIN_FILL takes
+  // an item from a sibling or is merged with it.
+  template <typename Key, class Cmp>
+  Key BPlusTree<Key, Cmp>::remove_pos(Node * p, nat_t i)
+  {
+    if (p->leaf)
+      {
+	Leaf * l = LEAF(p);
+	Key ret_val = std::move(l->keys[i]);
+	close_gap(l->keys, l->num, i);
+	--l->num;
+	return ret_val;
+      }
+
+    Inner * q = INNER(p);
+    nat_t c = 0;
+
+    while (i >= q->counts[c])
+      i -= q->counts[c++];
+
+    Key ret_val = remove_pos(q->child[c], i);
+    --q->counts[c];
+
+    if (q->child[c]->num >= MIN_FILL)
+      return ret_val;
+
+    if (c > 0 and q->child[c - 1]->num > MIN_FILL)
+      borrow_from_left(q, c);
+    else if (c + 1 < q->num and q->child[c + 1]->num > MIN_FILL)
+      borrow_from_right(q, c);
+    else if (c > 0)
+      merge(q, c - 1);
+    else
+      merge(q, c);
+
+    return ret_val;
+  }
+
+  /* Finds the first key which is not less than k and returns its rank.
+   * leaf and i are left on it, or leaf is nullptr if there is none.
+   */
+  template <typename Key, class Cmp>
+  nat_t BPlusTree<Key, Cmp>::locate(const Key & k, Leaf *& leaf,
+				    nat_t & i) const
+  {
+    leaf = nullptr;
+
+    if (root == nullptr)
+      return 0;
+
+    Node * p = root;
+    nat_t r = 0;
+
+    while (not p->leaf)
+      {
+	nat_t c = lower_child(p, k);
+
+	for (nat_t j = 0; j < c; ++j)
+	  r += INNER(p)->counts[j];
+
+	p = INNER(p)->child[c];
+      }
+
+    leaf = LEAF(p);
+    i = Designar::lower_bound(leaf->keys, 0, leaf->num, k, cmp);
+    r += i;
+
+    if (i == leaf->num)
+      {
+	leaf = leaf->next;
+	i = 0;
+      }
+
+    return r;
+  }
+
+  // Leaf holding the key of rank r < size(); i is left on its index.
+  template <typename Key, class Cmp>
+  typename BPlusTree<Key, Cmp>::Leaf *
+  BPlusTree<Key, Cmp>::seek(nat_t r, nat_t & i) const
+  {
+    Node * p = root;
+
+    while (not p->leaf)
+      {
+	nat_t c = 0;
+
+	while (r >= INNER(p)->counts[c])
+	  r -= INNER(p)->counts[c++];
+
+	p = INNER(p)->child[c];
+      }
+
+    i = r;
+    return LEAF(p);
+  }
+
+  template <typename Key, class Cmp>
+  nat_t BPlusTree<Key, Cmp>::bytes(Node * p) const
+  {
+    if (p->leaf)
+      return sizeof(Leaf);
+
+    nat_t ret_val = sizeof(Inner);
+
+    for (nat_t i = 0; i < p->num; ++i)
+      ret_val += bytes(INNER(p)->child[i]);
+
+    return ret_val;
+  }
+
+} // end namespace Designar
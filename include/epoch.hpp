@@ -0,0 +1,191 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include <types.hpp>
+#include <array.hpp>
+
+namespace Designar
+{
+  /** Epoch based memory reclamation.
+   *
+   *  Lock-free linked structures cannot delete a node as soon as it is
+   *  unlinked because another thread may still be reading it. A thread
+   *  which is going to read shared nodes enters a critical region through
+   *  an EpochGuard; unlinked nodes are handed to retire() and they are
+   *  freed only when every thread inside a critical region has observed a
+   *  newer epoch, that is, when nobody can hold a reference to them.
+   *
+   *  Retired objects are kept in per-thread lists (one per epoch modulo 3)
+   *  and freed in batches, so the cost of a retire() is amortized O(1).
+   *
+   *  Usage example:
+   *  \code{.cpp}
+   *  {
+   *    EpochGuard guard;
+   *    Node * p = head.load();
+   *    // ... unlink p ...
+   *    Epoch::retire(p);
+   *  }
+   *  \endcode
+   *
+   *  @ingroup utils
+   */
+  class Epoch
+  {
+  public:
+    using Deleter = void (*)(void *);
+
+    /// Number of retired objects after which a thread tries to advance.
+    static constexpr nat_t RETIRE_THRESHOLD = 64;
+
+  private:
+    static constexpr nat_t NUM_BUCKETS = 3;
+    static constexpr nat_t ACTIVE      = 1;
+
+    struct Retired
+    {
+      void  * ptr;
+      Deleter deleter;
+    };
+
+    struct Bucket
+    {
+      DynArray<Retired> items;
+      nat_t             epoch = 0;
+
+      void free_all();
+    };
+
+    struct Record
+    {
+      std::atomic<nat_t> local_epoch; // epoch << 1 | ACTIVE
+      std::atomic<bool>  in_use;
+      Record           * next;
+      nat_t              nesting;
+      nat_t              num_retired;
+      Bucket             buckets[NUM_BUCKETS];
+
+      Record()
+	: local_epoch(0), in_use(true), next(nullptr),
+	  nesting(0), num_retired(0)
+      {
+	// empty
+      }
+    };
+
+    class RecordOwner
+    {
+      Record * rec = nullptr;
+
+    public:
+      ~RecordOwner();
+
+      Record * get();
+    };
+
+    std::atomic<nat_t>    global_epoch;
+    std::atomic<Record *> records;
+    std::mutex            orphans_mtx;
+    DynArray<Bucket *>    orphans;
+
+    static thread_local RecordOwner owner;
+
+    Epoch()
+      : global_epoch(0), records(nullptr)
+    {
+      // empty
+    }
+
+    static Epoch & domain()
+    {
+      static Epoch instance;
+      return instance;
+    }
+
+    Record * acquire_record();
+
+    void release_record(Record *);
+
+    bool try_advance();
+
+    void reclaim(Record *, nat_t);
+
+    void reclaim_orphans(nat_t);
+
+  public:
+    Epoch(const Epoch &) = delete;
+
+    Epoch & operator = (const Epoch &) = delete;
+
+    ~Epoch();
+
+    /// Enters a critical region of the calling thread (reentrant).
+    static void enter();
+
+    /// Leaves a critical region of the calling thread.
+    static void exit();
+
+    /// Returns true if the calling thread is inside a critical region.
+    static bool is_in_critical_region();
+
+    /// Current value of the global epoch.
+    static nat_t current();
+
+    /** Defers the destruction of an unlinked object.
+     *
+     *  The object will be destroyed with deleter once no thread can hold
+     *  a reference obtained before the call.
+     */
+    static void retire(void *, Deleter);
+
+    template <typename T>
+    static void retire(T * ptr)
+    {
+      retire(ptr, [] (void * p) { delete static_cast<T *>(p); });
+    }
+
+    template <typename T>
+    static void retire_array(T * ptr)
+    {
+      retire(ptr, [] (void * p) { delete [] static_cast<T *>(p); });
+    }
+
+    /// Number of objects retired by the calling thread not freed yet.
+    static nat_t num_pending();
+
+    /** Tries to free every object retired by the calling thread.
+     *
+     *  It must be called outside of a critical region. It gives up after a
+     *  bounded number of attempts if other threads keep old epochs alive.
+     */
+    static void synchronize();
+  };
+
+  /// RAII wrapper over Epoch::enter() and Epoch::exit().
+  class EpochGuard
+  {
+  public:
+    EpochGuard()
+    {
+      Epoch::enter();
+    }
+
+    EpochGuard(const EpochGuard &) = delete;
+
+    EpochGuard & operator = (const EpochGuard &) = delete;
+
+    ~EpochGuard()
+    {
+      Epoch::exit();
+    }
+  };
+
+} // end namespace Designar
@@ -0,0 +1,535 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <sort.hpp>
+#include <now.hpp>
+
+namespace Designar
+{
+  constexpr nat_t ExternalSortMemoryBudget = nat_t(256) << 20;
+
+  constexpr nat_t ExternalSortBufferSize = nat_t(1) << 20;
+
+  /// $TMPDIR if it is set, /tmp otherwise.
+  std::string default_temp_dir();
+
+  /** Names of temporary files in a directory. Files are removed when they
+   *  are released or when the set is destroyed, so an exception does not
+   *  leave them behind.
+   */
+  class TempFileSet
+  {
+    std::string dir;
+    DynArray<std::string> paths;
+
+  public:
+    TempFileSet(const std::string &);
+
+    TempFileSet(const TempFileSet &) = delete;
+
+    TempFileSet & operator = (const TempFileSet &) = delete;
+
+    ~TempFileSet();
+
+    /// Path for a new file with a name unique to this process run.
+    std::string create();
+
+    /// Removes the file at path.
+    void release(const std::string & path);
+
+    nat_t size() const
+    {
+      return paths.size();
+    }
+  };
+
+  struct ExternalSortStats
+  {
+    nat_t num_items        = 0;
+    nat_t num_bytes        = 0;
+    nat_t num_runs         = 0;
+    nat_t num_merge_passes = 0;
+
+    /// Milliseconds spent reading, sorting and spilling runs.
+    double run_time = 0;
+
+    /// Milliseconds spent merging runs into the output.
+    double merge_time = 0;
+
+    double total_time() const
+    {
+      return run_time + merge_time;
+    }
+
+    /// Megabytes (10^6 bytes) of input sorted per second.
+    real_t throughput() const;
+  };
+
+  /** How ExternalSort reads and writes records of type T.
+   *
+   *  This version handles fixed-size records stored as raw bytes, so T
+   *  must be trivially copyable. Runs are read in bulk into a FixedArray
+   *  sized after the memory budget.
+   */
+  template <typename T>
+  struct ExternalRecord
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+		  "Fixed-size records must be trivially copyable");
+
+    using RunType = FixedArray<T>;
+
+    static RunType make_run(nat_t budget)
+    {
+      return RunType(std::max(budget / sizeof(T), nat_t(1)));
+    }
+
+    // Reads up to run.size() records, adds the bytes read to bytes.
+    static nat_t read_run(std::istream & in, RunType & run, nat_t,
+			  nat_t & bytes)
+    {
+      in.read(reinterpret_cast<char *>(&run[0]), run.size() * sizeof(T));
+
+      nat_t count = in.gcount();
+
+      if (count % sizeof(T) != 0)
+	throw std::domain_error("Input size is not a multiple of the "
+				"record size");
+
+      bytes += count;
+      return count / sizeof(T);
+    }
+
+    static void write_run(std::ostream & out, const RunType & run, nat_t n)
+    {
+      out.write(reinterpret_cast<const char *>(&run[0]), n * sizeof(T));
+    }
+
+    // Single records go straight to the stream buffer, skipping sentries.
+    static bool read(std::istream & in, T & item)
+    {
+      return in.rdbuf()->sgetn(reinterpret_cast<char *>(&item), sizeof(T)) ==
+	std::streamsize(sizeof(T));
+    }
+
+    static void write(std::ostream & out, const T & item)
+    {
+      if (out.rdbuf()->sputn(reinterpret_cast<const char *>(&item),
+			     sizeof(T)) != std::streamsize(sizeof(T)))
+	out.setstate(std::ios::badbit);
+    }
+  };
+
+  /** Text lines. A run takes lines until the memory they hold reaches the
+   *  budget. Every output line ends with '\n'.
+   */
+  template <>
+  struct ExternalRecord<std::string>
+  {
+    using RunType = DynArray<std::string>;
+
+    static RunType make_run(nat_t)
+    {
+      return RunType();
+    }
+
+    static nat_t read_run(std::istream & in, RunType & run, nat_t budget,
+			  nat_t & bytes)
+    {
+      run.clear();
+
+      nat_t memory = 0;
+      std::string line;
+
+      while (memory < budget and std::getline(in, line))
+	{
+	  bytes += line.size() + 1;
+	  memory += line.capacity() + sizeof(std::string);
+	  run.append(std::move(line));
+	  line = std::string();
+	}
+
+      return run.size();
+    }
+
+    static void write_run(std::ostream & out, const RunType & run, nat_t n)
+    {
+      for (nat_t i = 0; i < n; ++i)
+	write(out, run[i]);
+    }
+
+    static bool read(std::istream & in, std::string & item)
+    {
+      return bool(std::getline(in, item));
+    }
+
+    static void write(std::ostream & out, const std::string & item)
+    {
+      out.write(item.data(), item.size());
+      out.put('\n');
+    }
+  };
+
+  /** Tournament tree of losers over k sources for k-way merging.
+   *
+   *  less(i, j) tells whether the current item of source i goes before
+   *  that of source j; exhausted sources must compare after the others.
+   *  Every internal node keeps the loser of its match, so after the
+   *  winner's source advances only the matches on its path to the root
+   *  are replayed: log2(k) comparisons per item.
+   */
+  template <class Less>
+  class LoserTree
+  {
+    nat_t k;
+    FixedArray<nat_t> tree;
+    Less & less;
+
+  public:
+    LoserTree(nat_t _k, Less & _less)
+      : k(_k), tree(std::max(_k, nat_t(1))), less(_less)
+    {
+      FixedArray<nat_t> winner(2 * k);
+
+      for (nat_t i = 0; i < k; ++i)
+	winner[k + i] = i;
+
+      for (nat_t i = k - 1; i > 0; --i)
+	{
+	  nat_t a = winner[2 * i];
+	  nat_t b = winner[2 * i + 1];
+
+	  if (less(b, a))
+	    std::swap(a, b);
+
+	  winner[i] = a;
+	  tree[i] = b;
+	}
+
+      tree[0] = k > 1 ? winner[1] : 0;
+    }
+
+    /// Source whose current item goes first.
+    nat_t winner() const
+    {
+      return tree[0];
+    }
+
+    /// Replays the matches of the winner after its source has advanced.
+    void replay()
+    {
+      nat_t w = tree[0];
+
+      for (nat_t node = (w + k) / 2; node > 0; node /= 2)
+	if (less(tree[node], w))
+	  std::swap(tree[node], w);
+
+      tree[0] = w;
+    }
+  };
+
+  /** Sorts streams of records which do not fit in memory.
+   *
+   *  The input is read in runs of about memory_budget bytes; each run is
+   *  sorted with parallel_sort() on the pool and spilled to a file in the
+   *  temporary directory. The runs are then merged with a loser tree,
+   *  each one read in blocks of buffer_size bytes. When there
+   *  are more runs than buffers fit in the budget, groups of runs are
+   *  first merged into longer runs. An input which fits in a single run
+   *  is written out directly.
+   *
+   *  Records are described by ExternalRecord<T>: raw fixed-size records
+   *  for trivially copyable types and text lines for std::string. Records
+   *  which compare equal may come out in any order.
+   */
+  template <typename T, class Cmp = std::less<T>>
+  class ExternalSort
+  {
+    using Record  = ExternalRecord<T>;
+    using RunType = typename Record::RunType;
+
+    // Reads a run in blocks of about buffer_size bytes of records.
+    struct RunReader
+    {
+      std::ifstream in;
+      RunType block;
+      nat_t budget;
+      nat_t pos = 0;
+      nat_t num = 0;
+      bool exhausted = false;
+
+      RunReader(const std::string & path, nat_t buffer_size)
+	: block(Record::make_run(buffer_size)), budget(buffer_size)
+      {
+	in.open(path, std::ios::binary);
+
+	if (not in)
+	  throw std::runtime_error("Cannot open " + path);
+
+	fill();
+      }
+
+      void fill()
+      {
+	nat_t bytes = 0;
+
+	pos = 0;
+	num = Record::read_run(in, block, budget, bytes);
+	exhausted = num == 0;
+      }
+
+      const T & item() const
+      {
+	return block[pos];
+      }
+
+      void advance()
+      {
+	if (++pos == num)
+	  fill();
+      }
+    };
+
+    Cmp cmp;
+    ThreadPool & pool;
+    nat_t memory_budget = ExternalSortMemoryBudget;
+    nat_t buffer_size   = ExternalSortBufferSize;
+    std::string temp_dir;
+
+    void open_output(std::ofstream & out, std::unique_ptr<char[]> & buffer,
+		     const std::string & path)
+    {
+      buffer.reset(new char[buffer_size]);
+      out.rdbuf()->pubsetbuf(buffer.get(), buffer_size);
+      out.open(path, std::ios::binary | std::ios::trunc);
+
+      if (not out)
+	throw std::runtime_error("Cannot create " + path);
+    }
+
+    void merge(const DynArray<std::string> & runs, nat_t b, nat_t e,
+	       std::ostream & out)
+    {
+      nat_t k = e - b;
+
+      FixedArray<std::unique_ptr<RunReader>> readers(k);
+
+      for (nat_t i = 0; i < k; ++i)
+	readers[i].reset(new RunReader(runs[b + i], buffer_size));
+
+      // Ties go to the earlier run.
+      auto less = [this, &readers] (nat_t i, nat_t j)
+	{
+	  const RunReader & x = *readers[i];
+	  const RunReader & y = *readers[j];
+
+	  if (x.exhausted or y.exhausted)
+	    return y.exhausted and (not x.exhausted or i < j);
+
+	  if (cmp(x.item(), y.item()))
+	    return true;
+
+	  return not cmp(y.item(), x.item()) and i < j;
+	};
+
+      LoserTree<decltype(less)> tree(k, less);
+
+      while (true)
+	{
+	  RunReader & r = *readers[tree.winner()];
+
+	  if (r.exhausted)
+	    break;
+
+	  Record::write(out, r.item());
+	  r.advance();
+	  tree.replay();
+	}
+
+      if (not out)
+	throw std::runtime_error("Error writing the sorted output");
+    }
+
+  public:
+    ExternalSort(Cmp _cmp = Cmp(), ThreadPool & _pool = ThreadPool::shared())
+      : cmp(_cmp), pool(_pool), temp_dir(default_temp_dir())
+    {
+      // empty
+    }
+
+    nat_t get_memory_budget() const
+    {
+      return memory_budget;
+    }
+
+    /// Bytes of records held in memory by each run.
+    void set_memory_budget(nat_t bytes)
+    {
+      if (bytes == 0)
+	throw std::domain_error("Memory budget must be positive");
+
+      memory_budget = bytes;
+    }
+
+    nat_t get_buffer_size() const
+    {
+      return buffer_size;
+    }
+
+    /// Bytes of the buffer of every temporary file while merging.
+    void set_buffer_size(nat_t bytes)
+    {
+      if (bytes == 0)
+	throw std::domain_error("Buffer size must be positive");
+
+      buffer_size = bytes;
+    }
+
+    const std::string & get_temp_dir() const
+    {
+      return temp_dir;
+    }
+
+    void set_temp_dir(const std::string & dir)
+    {
+      temp_dir = dir;
+    }
+
+    /// Most runs merged at once, so their buffers fit in the budget.
+    nat_t max_fan_in() const
+    {
+      return std::max(memory_budget / buffer_size, nat_t(3)) - 1;
+    }
+
+    /// Reads every record of in and writes them sorted to out.
+    ExternalSortStats sort(std::istream & in, std::ostream & out)
+    {
+      ExternalSortStats stats;
+      TempFileSet files(temp_dir);
+      DynArray<std::string> runs;
+
+      Now now(true);
+
+      {
+	RunType run = Record::make_run(memory_budget);
+	std::unique_ptr<char[]> buffer;
+
+	while (true)
+	  {
+	    nat_t n = Record::read_run(in, run, memory_budget,
+				       stats.num_bytes);
+
+	    if (n == 0)
+	      break;
+
+	    stats.num_items += n;
+	    ++stats.num_runs;
+
+	    parallel_sort(run, 0, n - 1, cmp, pool);
+
+	    // A single run goes straight to the output.
+	    if (runs.is_empty() and
+		in.peek() == std::istream::traits_type::eof())
+	      {
+		Record::write_run(out, run, n);
+
+		if (not out)
+		  throw std::runtime_error("Error writing the sorted output");
+
+		break;
+	      }
+
+	    std::string path = files.create();
+	    std::ofstream file;
+
+	    open_output(file, buffer, path);
+	    Record::write_run(file, run, n);
+
+	    if (not file.flush())
+	      throw std::runtime_error("Error writing " + path);
+
+	    runs.append(path);
+	  }
+      }
+
+      stats.run_time = now.elapsed();
+      now.start();
+
+      const nat_t fan_in = max_fan_in();
+
+      while (runs.size() > fan_in)
+	{
+	  DynArray<std::string> merged;
+
+	  for (nat_t b = 0; b < runs.size(); b += fan_in)
+	    {
+	      nat_t e = std::min(b + fan_in, runs.size());
+
+	      if (e - b == 1)
+		{
+		  merged.append(runs[b]);
+		  continue;
+		}
+
+	      std::string path = files.create();
+	      std::unique_ptr<char[]> buffer;
+	      std::ofstream file;
+
+	      open_output(file, buffer, path);
+	      merge(runs, b, e, file);
+	      file.close();
+
+	      for (nat_t i = b; i < e; ++i)
+		files.release(runs[i]);
+
+	      merged.append(path);
+	    }
+
+	  runs = std::move(merged);
+	  ++stats.num_merge_passes;
+	}
+
+      if (not runs.is_empty())
+	{
+	  merge(runs, 0, runs.size(), out);
+	  ++stats.num_merge_passes;
+	}
+
+      out.flush();
+      stats.merge_time = now.elapsed();
+
+      return stats;
+    }
+
+    /// Sorts the file at in_path into the file at out_path.
+    ExternalSortStats sort_file(const std::string & in_path,
+				const std::string & out_path)
+    {
+      std::unique_ptr<char[]> in_buffer(new char[buffer_size]);
+      std::ifstream in;
+
+      in.rdbuf()->pubsetbuf(in_buffer.get(), buffer_size);
+      in.open(in_path, std::ios::binary);
+
+      if (not in)
+	throw std::runtime_error("Cannot open " + in_path);
+
+      std::unique_ptr<char[]> out_buffer;
+      std::ofstream out;
+
+      open_output(out, out_buffer, out_path);
+
+      return sort(in, out);
+    }
+  };
+
+} // end namespace Designar
@@ -1549,7 +1549,7 @@ namespace Designar
     {
       using C = PtrCmp<Node, Cmp>;
       C c(cmp);
-      quicksort<Node, C>(*dl_to_node(&node_list), c);
+      mergesort<Node, C>(*dl_to_node(&node_list), c);
     }
 
     template <class Cmp>
@@ -1563,7 +1563,7 @@ namespace Designar
     {
       using C = PtrCmp<Arc, Cmp>;
       C c(cmp);
-      quicksort<Arc, C>(*dl_to_arc(&arc_list), c);
+      mergesort<Arc, C>(*dl_to_arc(&arc_list), c);
     }
 
     template <class Cmp>
@@ -2227,7 +2227,7 @@ namespace Designar
     template <class Cmp>
     void sort_nodes(Cmp & cmp)
     {
-      quicksort<Node, Cmp>(*dl_to_node(&node_list), cmp);
+      mergesort<Node, Cmp>(*dl_to_node(&node_list), cmp);
     }
 
     template <class Cmp>
@@ -2239,7 +2239,7 @@ namespace Designar
     template <class Cmp>
     void sort_arcs(Cmp & cmp)
     {
-      quicksort<Arc, Cmp>(*dl_to_arc(&arc_list), cmp);
+      mergesort<Arc, Cmp>(*dl_to_arc(&arc_list), cmp);
     }
 
     template <class Cmp>
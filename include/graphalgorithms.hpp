@@ -1086,6 +1086,12 @@ namespace Designar
     {
       return cmp(distance(a), distance(b));
     }
+
+    // Priority of a for RadixHeap and BucketQueue.
+    auto operator () (Arc<GT> * a) const
+    {
+      return distance(a);
+    }
   };
 
   template <class GT,
@@ -1193,20 +1199,33 @@ namespace Designar
     return tree;
   }
 
+  /** Heap of arcs keeping at most one arc per target node: an arc
+   *  towards a node already reached replaces the one in the heap if it is
+   *  not worse, through decrease_key(). HeapType is LHeap, PairingHeap or,
+   *  for monotone priorities, RadixHeap or BucketQueue.
+   */
   template <class GT,
 	    class Distance = DefaultDistance<GT>,
-	    class Cmp      = std::less<typename Distance::Type>>
-  class ArcHeap : public LHeap<Arc<GT> *, DistanceCmp<GT, Distance, Cmp>>
+	    class Cmp      = std::less<typename Distance::Type>,
+	    template <typename, class> class HeapType = LHeap>
+  class ArcHeap : public HeapType<Arc<GT> *, DistanceCmp<GT, Distance, Cmp>>
   {
     using NodeType = Node<GT>;
     using ArcType  = Arc<GT>;
     using Table    = HashMap<Node<GT> *, Arc<GT> **>;
-    using BaseHeap = LHeap<Arc<GT> *, DistanceCmp<GT, Distance, Cmp>>;
-    using BaseHeap::BaseHeap;
+    using ArcCmp   = DistanceCmp<GT, Distance, Cmp>;
+    using BaseHeap = HeapType<Arc<GT> *, ArcCmp>;
     
-    Table tgt_nodes;
+    ArcCmp & cmp;
+    Table    tgt_nodes;
     
   public:
+    ArcHeap(ArcCmp & _cmp)
+      : BaseHeap(_cmp), cmp(_cmp)
+    {
+      // empty
+    }
+
     void insert_arc(Arc<GT> * a, Node<GT> * t)
     {
       Arc<GT> *** result = tgt_nodes.search(t);
@@ -1219,11 +1238,10 @@ namespace Designar
 
       Arc<GT> ** ap = *result;
 
-      if (BaseHeap::get_cmp()(*ap, a))
+      if (cmp(*ap, a))
 	return;
 
-      BaseHeap::remove(*ap);
-      tgt_nodes[t] = const_cast<Arc<GT> **>(&BaseHeap::insert(a));
+      BaseHeap::decrease_key(*ap, a);
     }
 
     Arc<GT> * get_min_arc()
@@ -1246,7 +1264,8 @@ namespace Designar
   
   template <class GT,
 	    class Distance = DefaultDistance<GT>,
-	    class Cmp      = std::less<typename Distance::Type>>
+	    class Cmp      = std::less<typename Distance::Type>,
+	    template <typename, class> class HeapType = LHeap>
   class Prim
   {
   public:
@@ -1308,9 +1327,10 @@ namespace Designar
     }
   };
   
-  template <class GT, class Distance, class Cmp>
-  GT Prim<GT, Distance, Cmp>::build_min_spanning_tree(const GT & g,
-						      Node<GT> * start)
+  template <class GT, class Distance, class Cmp,
+	    template <typename, class> class HeapType>
+  GT Prim<GT, Distance, Cmp, HeapType>::
+  build_min_spanning_tree(const GT & g, Node<GT> * start)
   {
     g.reset_tag(TAG);
     g.reset_cookies();
@@ -1321,7 +1341,7 @@ namespace Designar
     start->visit(TAG);
 
     DistanceCmp<GT, Distance, Cmp> arc_heap_cmp(distance, cmp);
-    ArcHeap<GT, Distance, Cmp> arc_heap(arc_heap_cmp);
+    ArcHeap<GT, Distance, Cmp, HeapType> arc_heap(arc_heap_cmp);
 
     for (AdArcIt<GT> it(g, start); it.has_current(); it.next())
       {
@@ -1372,7 +1392,8 @@ namespace Designar
   template <class GT,
 	    class Distance = DefaultDistance<GT>,
             class Cmp      = std::less<typename Distance::Type>,
-            class Plus     = std::plus<typename Distance::Type>>
+            class Plus     = std::plus<typename Distance::Type>,
+	    template <typename, class> class HeapType = LHeap>
   class Dijkstra
   {
   public:
@@ -1388,7 +1409,7 @@ namespace Designar
     
     static constexpr GraphTag TAG = GraphTag::DIJKSTRA;
     
-    using PotHeap = ArcHeap<GT, GetPot<GT, Distance>, Cmp>;
+    using PotHeap = ArcHeap<GT, GetPot<GT, Distance>, Cmp, HeapType>;
     
     GT build_partial_min_path_tree(const GT &, Node<GT> *, Node<GT> *);
     
@@ -1472,8 +1493,9 @@ namespace Designar
     }
   };
   
-  template <class GT, class Distance, class Cmp, class Plus>
-  GT Dijkstra<GT, Distance, Cmp, Plus>::
+  template <class GT, class Distance, class Cmp, class Plus,
+	    template <typename, class> class HeapType>
+  GT Dijkstra<GT, Distance, Cmp, Plus, HeapType>::
   build_partial_min_path_tree(const GT & g, Node<GT> * start, Node<GT> * end)
   {
     g.reset_tag(TAG);
@@ -1556,8 +1578,9 @@ namespace Designar
     return tree;
   }
 
-  template <class GT, class Distance, class Cmp, class Plus>
-  GT Dijkstra<GT, Distance, Cmp, Plus>::
+  template <class GT, class Distance, class Cmp, class Plus,
+	    template <typename, class> class HeapType>
+  GT Dijkstra<GT, Distance, Cmp, Plus, HeapType>::
   build_min_path_tree(const GT & g, Node<GT> * start)
   {
     g.reset_tag(TAG);
@@ -1652,7 +1675,8 @@ namespace Designar
 	    class Distance  = DefaultDistance<GT>,
 	    class Heuristic = DefaultHeuristic<GT, Distance>,
 	    class Cmp       = std::less<typename Distance::Type>,
-            class Plus      = std::plus<typename Distance::Type>>
+            class Plus      = std::plus<typename Distance::Type>,
+	    template <typename, class> class HeapType = LHeap>
   class Astar
   {
   public:
@@ -1669,7 +1693,7 @@ namespace Designar
     
     static constexpr GraphTag TAG = GraphTag::ASTAR;
     
-    using PotHeap = ArcHeap<GT, GetPot<GT, Distance>, Cmp>;
+    using PotHeap = ArcHeap<GT, GetPot<GT, Distance>, Cmp, HeapType>;
     
     GT build_partial_min_path_tree(const GT &, Node<GT> *, Node<GT> *);
     
@@ -1734,8 +1758,9 @@ namespace Designar
     }
   };
   
-  template <class GT, class Distance, class Heuristic, class Cmp, class Plus>
-  GT Astar<GT, Distance, Heuristic, Cmp, Plus>::
+  template <class GT, class Distance, class Heuristic, class Cmp, class Plus,
+	    template <typename, class> class HeapType>
+  GT Astar<GT, Distance, Heuristic, Cmp, Plus, HeapType>::
   build_partial_min_path_tree(const GT & g, Node<GT> * start, Node<GT> * end)
   {
     g.reset_tag(TAG);
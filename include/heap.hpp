@@ -8,8 +8,10 @@
 
 #include <array.hpp>
 #include <queue.hpp>
+#include <stack.hpp>
 #include <nodesdef.hpp>
 #include <sort.hpp>
+#include <intutilities.hpp>
 
 namespace Designar
 {
@@ -322,6 +324,474 @@ namespace Designar
       }
   }
 
+  /** Heap of arity D with handles.
+   *
+   *  The items are kept in an array in breadth first order; the children
+   *  of position i are D * i + 1, ..., D * i + D. The array starts D - 1
+   *  slots after a cache line boundary, so the D children of any position
+   *  are contiguous and aligned: with D * sizeof(Key) <= CacheLineSize
+   *  they share one cache line and a level costs a single miss. A wider
+   *  heap is shallower, which pays off when sift_down dominates.
+   *
+   *  insert() returns a handle which keeps referring to its item while the
+   *  item stays in the heap, whatever its position is. Handles of removed
+   *  items are reused. A position map gives decrease_key(), increase_key(),
+   *  update() and remove() by handle in O(D log_D n).
+   */
+  template <typename Key, nat_t D = 4, class Cmp = std::less<Key>>
+  class DAryHeap
+  {
+    static_assert(D >= 2, "Arity must be at least 2");
+
+  public:
+    using Handle = nat_t;
+
+  private:
+    static constexpr nat_t NO_POSITION = std::numeric_limits<nat_t>::max();
+
+    void            * mem;       // raw storage of keys
+    Key             * keys;      // keys[i] is the item at position i
+    nat_t             cap;
+    nat_t             num_items;
+    DynArray<Handle>  handles;   // handle of the item at position i
+    DynArray<nat_t>   positions; // position of every handle
+    DynStack<Handle>  free_handles;
+    Cmp               cmp;
+
+    static nat_t parent(nat_t i)
+    {
+      return (i - 1) / D;
+    }
+
+    static nat_t first_child(nat_t i)
+    {
+      return D * i + 1;
+    }
+
+    void reserve(nat_t);
+
+    void place(nat_t i, Key && k, Handle h)
+    {
+      keys[i] = std::move(k);
+      handles[i] = h;
+      positions[h] = i;
+    }
+
+    void sift_up(nat_t);
+
+    void sift_down(nat_t);
+
+    Handle new_handle();
+
+    Handle insert_key(Key &&);
+
+    void check(Handle h) const
+    {
+      if (h >= positions.size() or positions[h] == NO_POSITION)
+	throw std::domain_error("Invalid handle");
+    }
+
+    Key remove_pos(nat_t);
+
+    void copy_heap(const DAryHeap &);
+
+  public:
+    using ItemType  = Key;
+    using KeyType   = Key;
+    using DataType  = Key;
+    using ValueType = Key;
+    using SizeType  = nat_t;
+    using CmpType   = Cmp;
+
+    DAryHeap(Cmp & _cmp)
+      : mem(nullptr), keys(nullptr), cap(0), num_items(0), cmp(_cmp)
+    {
+      // empty
+    }
+
+    DAryHeap(Cmp && _cmp = Cmp())
+      : DAryHeap(_cmp)
+    {
+      // empty
+    }
+
+    DAryHeap(const DAryHeap & h)
+      : DAryHeap(Cmp(h.cmp))
+    {
+      copy_heap(h);
+    }
+
+    DAryHeap(DAryHeap && h)
+      : DAryHeap()
+    {
+      swap(h);
+    }
+
+    DAryHeap & operator = (const DAryHeap & h)
+    {
+      if (this == &h)
+	return *this;
+
+      clear();
+      copy_heap(h);
+      cmp = h.cmp;
+      return *this;
+    }
+
+    DAryHeap & operator = (DAryHeap && h)
+    {
+      swap(h);
+      return *this;
+    }
+
+    ~DAryHeap();
+
+    void swap(DAryHeap & h)
+    {
+      std::swap(mem, h.mem);
+      std::swap(keys, h.keys);
+      std::swap(cap, h.cap);
+      std::swap(num_items, h.num_items);
+      handles.swap(h.handles);
+      positions.swap(h.positions);
+      std::swap(free_handles, h.free_handles);
+      std::swap(cmp, h.cmp);
+    }
+
+    Cmp & get_cmp()
+    {
+      return cmp;
+    }
+
+    const Cmp & get_cmp() const
+    {
+      return cmp;
+    }
+
+    void clear();
+
+    bool is_empty() const
+    {
+      return num_items == 0;
+    }
+
+    nat_t size() const
+    {
+      return num_items;
+    }
+
+    Handle insert(const Key & k)
+    {
+      return insert_key(Key(k));
+    }
+
+    Handle insert(Key && k)
+    {
+      return insert_key(std::forward<Key>(k));
+    }
+
+    /** Replaces the items by those of c in O(n) (Floyd's method). The
+     *  item at infix position i of c gets the handle i.
+     */
+    template <class ContainerType>
+    void heapify(const ContainerType & c);
+
+    const Key & top() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      return keys[0];
+    }
+
+    Handle top_handle() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      return handles[0];
+    }
+
+    Key get()
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      return remove_pos(0);
+    }
+
+    bool contains(Handle h) const
+    {
+      return h < positions.size() and positions[h] != NO_POSITION;
+    }
+
+    const Key & get_key(Handle h) const
+    {
+      check(h);
+      return keys[positions[h]];
+    }
+
+    /// Replaces the key of h by k, which must not go after it.
+    void decrease_key(Handle h, const Key & k)
+    {
+      check(h);
+
+      nat_t i = positions[h];
+
+      if (cmp(keys[i], k))
+	throw std::domain_error("New key is greater than current key");
+
+      keys[i] = k;
+      sift_up(i);
+    }
+
+    /// Replaces the key of h by k, which must not go before it.
+    void increase_key(Handle h, const Key & k)
+    {
+      check(h);
+
+      nat_t i = positions[h];
+
+      if (cmp(k, keys[i]))
+	throw std::domain_error("New key is less than current key");
+
+      keys[i] = k;
+      sift_down(i);
+    }
+
+    /// Replaces the key of h by k, in whichever direction.
+    void update(Handle h, const Key & k)
+    {
+      check(h);
+
+      nat_t i = positions[h];
+
+      if (cmp(k, keys[i]))
+	{
+	  keys[i] = k;
+	  sift_up(i);
+	}
+      else
+	{
+	  keys[i] = k;
+	  sift_down(i);
+	}
+    }
+
+    Key remove(Handle h)
+    {
+      check(h);
+      return remove_pos(positions[h]);
+    }
+
+    /// Checks the heap order and the position map.
+    bool verify() const;
+  };
+
+  template <typename Key, nat_t D, class Cmp>
+  constexpr nat_t DAryHeap<Key, D, Cmp>::NO_POSITION;
+
+  template <typename Key, nat_t D, class Cmp>
+  DAryHeap<Key, D, Cmp>::~DAryHeap()
+  {
+    clear();
+    ::operator delete(mem);
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  void DAryHeap<Key, D, Cmp>::clear()
+  {
+    for (nat_t i = 0; i < num_items; ++i)
+      keys[i].~Key();
+
+    num_items = 0;
+    handles.clear();
+    positions.clear();
+    free_handles.clear();
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  void DAryHeap<Key, D, Cmp>::reserve(nat_t n)
+  {
+    if (n <= cap)
+      return;
+
+    nat_t new_cap = std::max<nat_t>(n, std::max<nat_t>(2 * cap, 32));
+
+    // D - 1 slots before the root put the children groups on boundaries.
+    void * new_mem = ::operator new((new_cap + D - 1) * sizeof(Key) +
+				    CacheLineSize);
+    uintptr_t base = (reinterpret_cast<uintptr_t>(new_mem) +
+		      CacheLineSize - 1) & ~uintptr_t(CacheLineSize - 1);
+    Key * new_keys = reinterpret_cast<Key *>(base) + D - 1;
+
+    for (nat_t i = 0; i < num_items; ++i)
+      {
+	new (new_keys + i) Key(std::move(keys[i]));
+	keys[i].~Key();
+      }
+
+    ::operator delete(mem);
+
+    mem  = new_mem;
+    keys = new_keys;
+    cap  = new_cap;
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  void DAryHeap<Key, D, Cmp>::copy_heap(const DAryHeap & h)
+  {
+    reserve(h.num_items);
+
+    for (nat_t i = 0; i < h.num_items; ++i)
+      new (keys + i) Key(h.keys[i]);
+
+    num_items    = h.num_items;
+    handles      = h.handles;
+    positions    = h.positions;
+    free_handles = h.free_handles;
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  typename DAryHeap<Key, D, Cmp>::Handle DAryHeap<Key, D, Cmp>::new_handle()
+  {
+    if (not free_handles.is_empty())
+      return free_handles.pop();
+
+    positions.append(NO_POSITION);
+    return positions.size() - 1;
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  typename DAryHeap<Key, D, Cmp>::Handle
+  DAryHeap<Key, D, Cmp>::insert_key(Key && k)
+  {
+    reserve(num_items + 1);
+
+    Handle h = new_handle();
+
+    new (keys + num_items) Key(std::move(k));
+    handles.append(h);
+    positions[h] = num_items++;
+
+    sift_up(num_items - 1);
+    return h;
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  template <class ContainerType>
+  void DAryHeap<Key, D, Cmp>::heapify(const ContainerType & c)
+  {
+    clear();
+    reserve(c.size());
+
+    for (const Key & k : c)
+      {
+	new (keys + num_items) Key(k);
+	handles.append(num_items);
+	positions.append(num_items++);
+      }
+
+    if (num_items < 2)
+      return;
+
+    for (nat_t i = parent(num_items - 1) + 1; i-- > 0; )
+      sift_down(i);
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  void DAryHeap<Key, D, Cmp>::sift_up(nat_t i)
+  {
+    Key    k = std::move(keys[i]);
+    Handle h = handles[i];
+
+    while (i > 0)
+      {
+	nat_t p = parent(i);
+
+	if (not cmp(k, keys[p]))
+	  break;
+
+	place(i, std::move(keys[p]), handles[p]);
+	i = p;
+      }
+
+    place(i, std::move(k), h);
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  void DAryHeap<Key, D, Cmp>::sift_down(nat_t i)
+  {
+    Key    k = std::move(keys[i]);
+    Handle h = handles[i];
+
+    while (true)
+      {
+	nat_t c = first_child(i);
+
+	if (c >= num_items)
+	  break;
+
+	nat_t last = std::min(c + D, num_items);
+	nat_t best = c;
+
+	for (++c; c < last; ++c)
+	  if (cmp(keys[c], keys[best]))
+	    best = c;
+
+	if (not cmp(keys[best], k))
+	  break;
+
+	place(i, std::move(keys[best]), handles[best]);
+	i = best;
+      }
+
+    place(i, std::move(k), h);
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  Key DAryHeap<Key, D, Cmp>::remove_pos(nat_t i)
+  {
+    Key ret_val = std::move(keys[i]);
+    Handle h = handles[i];
+    nat_t last = --num_items;
+
+    if (i != last)
+      {
+	place(i, std::move(keys[last]), handles[last]);
+
+	if (i > 0 and cmp(keys[i], keys[parent(i)]))
+	  sift_up(i);
+	else
+	  sift_down(i);
+      }
+
+    keys[last].~Key();
+    handles.remove_last();
+    positions[h] = NO_POSITION;
+    free_handles.push(h);
+
+    return ret_val;
+  }
+
+  template <typename Key, nat_t D, class Cmp>
+  bool DAryHeap<Key, D, Cmp>::verify() const
+  {
+    if (handles.size() != num_items)
+      return false;
+
+    for (nat_t i = 0; i < num_items; ++i)
+      {
+	if (positions[handles[i]] != i)
+	  return false;
+
+	if (i > 0 and cmp(keys[i], keys[parent(i)]))
+	  return false;
+      }
+
+    return positions.size() == num_items + free_handles.size();
+  }
+
   template <typename Key>
   class HeapNode :
     public BaseBinTreeNode<Key, HeapNode<Key>, BinTreeNodeNullValue::NULLPTR>
@@ -440,6 +910,8 @@ namespace Designar
 
     static void destroy_rec(Node *, Node *);
 
+    bool verify(Node *, nat_t &) const;
+
     void swap_with_parent(Node * p)
     {
       assert(num_items >= 2);
@@ -921,8 +1393,52 @@ namespace Designar
       Node * p = remove(key_to_node(item));
       delete p;
     }
+
+    /// Replaces item by k, which must not go after it.
+    void decrease_key(Key & item, const Key & k)
+    {
+      if (cmp(item, k))
+	throw std::domain_error("New key is greater than current key");
+
+      item = k;
+      sift_up(key_to_node(item));
+    }
+
+    /// Replaces item by k, in whichever direction.
+    void update(Key & item, const Key & k)
+    {
+      item = k;
+      update(key_to_node(item));
+    }
+
+    /// Checks the heap order and the parent links.
+    bool verify() const
+    {
+      nat_t n = 0;
+      return root == nullptr ? num_items == 0 :
+	U(root) == head and verify(root, ++n) and n == num_items;
+    }
   };
 
+  template <typename Key, class Cmp>
+  bool LHeap<Key, Cmp>::verify(Node * p, nat_t & n) const
+  {
+    if (p->is_leaf())
+      return true;
+
+    Node * c = L(p);
+
+    if (U(c) != p or cmp(KEY(c), KEY(p)) or not verify(c, ++n))
+      return false;
+
+    if (not has_sibling(c))
+      return true;
+
+    c = R(p);
+
+    return U(c) == p and not cmp(KEY(c), KEY(p)) and verify(c, ++n);
+  }
+
   template <typename Key, class Cmp>
   void LHeap<Key, Cmp>::destroy_rec(Node * p, Node * n)
   {
@@ -987,5 +1503,1995 @@ namespace Designar
     last = head;
     num_items = 0;
   }
-  
+
+  /** Allocator of nodes of one type for the pointer based heaps.
+   *
+   *  Nodes are carved from blocks of NodePoolBlockSize slots and released
+   *  ones go to a free list for the next allocation, so a heap which
+   *  inserts and extracts all the time stops calling the system allocator
+   *  once it reaches its peak size. Blocks are freed by the destructor.
+   *
+   *  absorb() takes over the blocks and free slots of another pool in
+   *  O(1), which lets a heap merge the nodes of another one.
+   */
+  template <class Node>
+  class NodePool
+  {
+    union Slot
+    {
+      Slot * next;
+      alignas(Node) unsigned char node[sizeof(Node)];
+    };
+
+    // The first slot of every block links the blocks.
+    Slot * blocks     = nullptr;
+    Slot * last_block = nullptr;
+    Slot * free_list  = nullptr;
+    Slot * free_tail  = nullptr;
+    Slot * curr       = nullptr; // next unused slot of the last block
+    Slot * end        = nullptr;
+
+  public:
+    NodePool()
+    {
+      // empty
+    }
+
+    NodePool(const NodePool &) = delete;
+
+    NodePool & operator = (const NodePool &) = delete;
+
+    ~NodePool()
+    {
+      while (blocks != nullptr)
+	{
+	  Slot * next = blocks->next;
+	  delete [] blocks;
+	  blocks = next;
+	}
+    }
+
+    void swap(NodePool & p)
+    {
+      std::swap(blocks, p.blocks);
+      std::swap(last_block, p.last_block);
+      std::swap(free_list, p.free_list);
+      std::swap(free_tail, p.free_tail);
+      std::swap(curr, p.curr);
+      std::swap(end, p.end);
+    }
+
+    template <typename... Args>
+    Node * allocate(Args && ... args)
+    {
+      Slot * s = free_list;
+
+      if (s != nullptr)
+	free_list = s->next;
+      else
+	{
+	  if (curr == end)
+	    {
+	      Slot * b = new Slot[NodePoolBlockSize];
+	      b->next = blocks;
+	      blocks = b;
+
+	      if (last_block == nullptr)
+		last_block = b;
+
+	      curr = b + 1;
+	      end  = b + NodePoolBlockSize;
+	    }
+
+	  s = curr++;
+	}
+
+      return new (s->node) Node(std::forward<Args>(args)...);
+    }
+
+    void release(Node * p)
+    {
+      p->~Node();
+      Slot * s = reinterpret_cast<Slot *>(p);
+      s->next = free_list;
+
+      if (free_list == nullptr)
+	free_tail = s;
+
+      free_list = s;
+    }
+
+    /// Moves the memory of p to this pool; p is left empty.
+    void absorb(NodePool & p)
+    {
+      if (this == &p or p.blocks == nullptr)
+	return;
+
+      p.last_block->next = blocks;
+      blocks = p.blocks;
+
+      if (last_block == nullptr)
+	last_block = p.last_block;
+
+      if (p.free_list != nullptr)
+	{
+	  p.free_tail->next = free_list;
+
+	  if (free_list == nullptr)
+	    free_tail = p.free_tail;
+
+	  free_list = p.free_list;
+	}
+
+      // Unused slots of the smaller remainder stay owned but idle.
+      if (p.end - p.curr > end - curr)
+	{
+	  curr = p.curr;
+	  end  = p.end;
+	}
+
+      p.blocks = p.last_block = p.free_list = p.free_tail = nullptr;
+      p.curr = p.end = nullptr;
+    }
+  };
+
+  /** Pairing heap with intrusive nodes taken from a NodePool.
+   *
+   *  Every node keeps its first child, its next sibling and a back link
+   *  (previous sibling, or parent for a first child), so a node is cut off
+   *  in O(1). insert() and decrease_key() link a single node with the root
+   *  in O(1); get() and remove() merge the children of the removed node by
+   *  two passes in O(log n) amortized.
+   *
+   *  Like in LHeap, insert() returns a reference to the item in the heap
+   *  which stays valid until the item is removed; it is the handle for
+   *  decrease_key(), update() and remove().
+   */
+  template <typename Key, class Cmp = std::less<Key>>
+  class PairingHeap
+  {
+    struct Node
+    {
+      Key    key; // first member, so &key is the node address
+      Node * child = nullptr;
+      Node * next  = nullptr;
+      Node * prev  = nullptr;
+
+      Node(const Key & k)
+	: key(k)
+      {
+	// empty
+      }
+
+      Node(Key && k)
+	: key(std::forward<Key>(k))
+      {
+	// empty
+      }
+    };
+
+    static Node * key_to_node(Key & k)
+    {
+      return reinterpret_cast<Node *>(&k);
+    }
+
+    NodePool<Node> pool;
+    Node         * root;
+    nat_t          num_items;
+    Cmp          & cmp;
+
+    Node * link(Node * a, Node * b)
+    {
+      if (cmp(b->key, a->key))
+	std::swap(a, b);
+
+      b->next = a->child;
+
+      if (a->child != nullptr)
+	a->child->prev = b;
+
+      b->prev  = a;
+      a->child = b;
+
+      return a;
+    }
+
+    static void cut(Node * p)
+    {
+      if (p->prev->child == p)
+	p->prev->child = p->next;
+      else
+	p->prev->next = p->next;
+
+      if (p->next != nullptr)
+	p->next->prev = p->prev;
+
+      p->prev = p->next = nullptr;
+    }
+
+    Node * merge_pairs(Node *);
+
+    Node * insert_node(Node * p)
+    {
+      root = root == nullptr ? p : link(root, p);
+      ++num_items;
+      return p;
+    }
+
+    void remove_node(Node * p)
+    {
+      if (p != root)
+	cut(p);
+
+      Node * c = merge_pairs(p->child);
+
+      if (p == root)
+	root = c;
+      else if (c != nullptr)
+	root = link(root, c);
+
+      --num_items;
+    }
+
+    bool verify(Node *, nat_t &) const;
+
+  public:
+    using ItemType  = Key;
+    using KeyType   = Key;
+    using DataType  = Key;
+    using ValueType = Key;
+    using SizeType  = nat_t;
+    using CmpType   = Cmp;
+
+    PairingHeap(Cmp & _cmp)
+      : root(nullptr), num_items(0), cmp(_cmp)
+    {
+      // empty
+    }
+
+    PairingHeap(Cmp && _cmp = Cmp())
+      : PairingHeap(_cmp)
+    {
+      // empty
+    }
+
+    PairingHeap(PairingHeap && h)
+      : PairingHeap()
+    {
+      swap(h);
+    }
+
+    ~PairingHeap()
+    {
+      clear();
+    }
+
+    PairingHeap & operator = (PairingHeap && h)
+    {
+      swap(h);
+      return *this;
+    }
+
+    void swap(PairingHeap & h)
+    {
+      pool.swap(h.pool);
+      std::swap(root, h.root);
+      std::swap(num_items, h.num_items);
+      std::swap(cmp, h.cmp);
+    }
+
+    Cmp & get_cmp()
+    {
+      return cmp;
+    }
+
+    const Cmp & get_cmp() const
+    {
+      return cmp;
+    }
+
+    void clear();
+
+    nat_t size() const
+    {
+      return num_items;
+    }
+
+    bool is_empty() const
+    {
+      return num_items == 0;
+    }
+
+    const Key & insert(const Key & k)
+    {
+      return insert_node(pool.allocate(k))->key;
+    }
+
+    const Key & insert(Key && k)
+    {
+      return insert_node(pool.allocate(std::forward<Key>(k)))->key;
+    }
+
+    const Key & top() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      return root->key;
+    }
+
+    Key get()
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      Node * p = root;
+      remove_node(p);
+      Key ret_val = std::move(p->key);
+      pool.release(p);
+      return ret_val;
+    }
+
+    void remove(Key & item)
+    {
+      Node * p = key_to_node(item);
+      remove_node(p);
+      pool.release(p);
+    }
+
+    /// Replaces item by k, which must not go after it. O(1) amortized.
+    void decrease_key(Key & item, const Key & k)
+    {
+      if (cmp(item, k))
+	throw std::domain_error("New key is greater than current key");
+
+      Node * p = key_to_node(item);
+      p->key = k;
+
+      if (p == root)
+	return;
+
+      cut(p);
+      root = link(root, p);
+    }
+
+    /// Replaces item by k, in whichever direction.
+    void update(Key & item, const Key & k)
+    {
+      if (not cmp(item, k))
+	{
+	  decrease_key(item, k);
+	  return;
+	}
+
+      Node * p = key_to_node(item);
+      remove_node(p);
+      p->child = nullptr;
+      p->key = k;
+      insert_node(p);
+    }
+
+    /** Moves every item of h to this heap in O(1); references to them stay
+     *  valid and h is left empty.
+     */
+    void merge(PairingHeap & h)
+    {
+      if (this == &h or h.is_empty())
+	return;
+
+      pool.absorb(h.pool);
+      root = root == nullptr ? h.root : link(root, h.root);
+      num_items += h.num_items;
+      h.root = nullptr;
+      h.num_items = 0;
+    }
+
+    /// Checks the heap order and the links.
+    bool verify() const;
+  };
+
+  template <typename Key, class Cmp>
+  typename PairingHeap<Key, Cmp>::Node *
+  PairingHeap<Key, Cmp>::merge_pairs(Node * first)
+  {
+    if (first == nullptr)
+      return nullptr;
+
+    // Left to right, pairs are linked and pushed on a list through next.
+    Node * pairs = nullptr;
+
+    while (first != nullptr)
+      {
+	Node * a = first;
+	Node * b = a->next;
+
+	if (b == nullptr)
+	  {
+	    a->prev = nullptr;
+	    a->next = pairs;
+	    pairs = a;
+	    break;
+	  }
+
+	first = b->next;
+	a->prev = a->next = b->prev = b->next = nullptr;
+
+	Node * p = link(a, b);
+	p->next = pairs;
+	pairs = p;
+      }
+
+    // Right to left, every pair is linked with the accumulated tree.
+    Node * ret_val = pairs;
+    pairs = pairs->next;
+    ret_val->next = nullptr;
+
+    while (pairs != nullptr)
+      {
+	Node * p = pairs;
+	pairs = pairs->next;
+	p->next = nullptr;
+	ret_val = link(ret_val, p);
+      }
+
+    ret_val->prev = nullptr;
+
+    return ret_val;
+  }
+
+  template <typename Key, class Cmp>
+  void PairingHeap<Key, Cmp>::clear()
+  {
+    // Seen as a binary tree (child left, next right), right rotations
+    // leave every node without child when it is reached.
+    Node * p = root;
+
+    while (p != nullptr)
+      {
+	Node * c = p->child;
+
+	if (c != nullptr)
+	  {
+	    p->child = c->next;
+	    c->next = p;
+	    p = c;
+	    continue;
+	  }
+
+	Node * q = p->next;
+	pool.release(p);
+	p = q;
+      }
+
+    root = nullptr;
+    num_items = 0;
+  }
+
+  template <typename Key, class Cmp>
+  bool PairingHeap<Key, Cmp>::verify(Node * p, nat_t & n) const
+  {
+    Node * prev = p;
+
+    for (Node * c = p->child; c != nullptr; prev = c, c = c->next)
+      {
+	if (c->prev != prev or cmp(c->key, p->key))
+	  return false;
+
+	if (not verify(c, ++n))
+	  return false;
+      }
+
+    return true;
+  }
+
+  template <typename Key, class Cmp>
+  bool PairingHeap<Key, Cmp>::verify() const
+  {
+    if (root == nullptr)
+      return num_items == 0;
+
+    if (root->prev != nullptr or root->next != nullptr)
+      return false;
+
+    nat_t n = 1;
+
+    return verify(root, n) and n == num_items;
+  }
+
+  /** Leftist heap with intrusive nodes taken from a NodePool.
+   *
+   *  The rank of a node is the length of its right spine; the rank of the
+   *  left child is never less than the rank of the right one, so the
+   *  right spine of a heap of n items has at most log(n + 1) nodes.
+   *  Merging two heaps walks their right spines only, so merge(),
+   *  insert() and get() are O(log n) in the worst case. Parent links let
+   *  remove() replace a node by the merge of its children and repair the
+   *  ranks upwards, also in O(log n).
+   *
+   *  insert() returns a reference to the item in the heap which is its
+   *  handle for decrease_key(), update() and remove(); it stays valid
+   *  across merge().
+   */
+  template <typename Key, class Cmp = std::less<Key>>
+  class LeftistHeap
+  {
+    struct Node
+    {
+      Key    key; // first member, so &key is the node address
+      Node * left   = nullptr;
+      Node * right  = nullptr;
+      Node * parent = nullptr;
+      nat_t  rank   = 1;
+
+      Node(const Key & k)
+	: key(k)
+      {
+	// empty
+      }
+
+      Node(Key && k)
+	: key(std::forward<Key>(k))
+      {
+	// empty
+      }
+
+      void reset()
+      {
+	left = right = parent = nullptr;
+	rank = 1;
+      }
+    };
+
+    static Node * key_to_node(Key & k)
+    {
+      return reinterpret_cast<Node *>(&k);
+    }
+
+    static nat_t rank(Node * p)
+    {
+      return p == nullptr ? 0 : p->rank;
+    }
+
+    NodePool<Node> pool;
+    Node         * root;
+    nat_t          num_items;
+    Cmp          & cmp;
+
+    Node * merge(Node *, Node *);
+
+    static void fix_ranks(Node *);
+
+    void cut(Node * p)
+    {
+      Node * pp = p->parent;
+
+      if (pp == nullptr)
+	{
+	  root = nullptr;
+	  return;
+	}
+
+      if (pp->left == p)
+	pp->left = nullptr;
+      else
+	pp->right = nullptr;
+
+      p->parent = nullptr;
+      fix_ranks(pp);
+    }
+
+    void remove_node(Node *);
+
+    bool verify(Node *, nat_t &) const;
+
+  public:
+    using ItemType  = Key;
+    using KeyType   = Key;
+    using DataType  = Key;
+    using ValueType = Key;
+    using SizeType  = nat_t;
+    using CmpType   = Cmp;
+
+    LeftistHeap(Cmp & _cmp)
+      : root(nullptr), num_items(0), cmp(_cmp)
+    {
+      // empty
+    }
+
+    LeftistHeap(Cmp && _cmp = Cmp())
+      : LeftistHeap(_cmp)
+    {
+      // empty
+    }
+
+    LeftistHeap(LeftistHeap && h)
+      : LeftistHeap()
+    {
+      swap(h);
+    }
+
+    ~LeftistHeap()
+    {
+      clear();
+    }
+
+    LeftistHeap & operator = (LeftistHeap && h)
+    {
+      swap(h);
+      return *this;
+    }
+
+    void swap(LeftistHeap & h)
+    {
+      pool.swap(h.pool);
+      std::swap(root, h.root);
+      std::swap(num_items, h.num_items);
+      std::swap(cmp, h.cmp);
+    }
+
+    Cmp & get_cmp()
+    {
+      return cmp;
+    }
+
+    const Cmp & get_cmp() const
+    {
+      return cmp;
+    }
+
+    void clear();
+
+    nat_t size() const
+    {
+      return num_items;
+    }
+
+    bool is_empty() const
+    {
+      return num_items == 0;
+    }
+
+    const Key & insert(const Key & k)
+    {
+      Node * p = pool.allocate(k);
+      root = merge(root, p);
+      ++num_items;
+      return p->key;
+    }
+
+    const Key & insert(Key && k)
+    {
+      Node * p = pool.allocate(std::forward<Key>(k));
+      root = merge(root, p);
+      ++num_items;
+      return p->key;
+    }
+
+    const Key & top() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      return root->key;
+    }
+
+    Key get()
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      Node * p = root;
+      remove_node(p);
+      Key ret_val = std::move(p->key);
+      pool.release(p);
+      return ret_val;
+    }
+
+    void remove(Key & item)
+    {
+      Node * p = key_to_node(item);
+      remove_node(p);
+      pool.release(p);
+    }
+
+    /// Replaces item by k, which must not go after it.
+    void decrease_key(Key & item, const Key & k)
+    {
+      if (cmp(item, k))
+	throw std::domain_error("New key is greater than current key");
+
+      Node * p = key_to_node(item);
+      p->key = k;
+
+      if (p == root)
+	return;
+
+      cut(p);
+      root = merge(root, p);
+    }
+
+    /// Replaces item by k, in whichever direction.
+    void update(Key & item, const Key & k)
+    {
+      Node * p = key_to_node(item);
+      remove_node(p);
+      p->reset();
+      p->key = k;
+      root = merge(root, p);
+      ++num_items;
+    }
+
+    /** Moves every item of h to this heap in O(log n); references to them
+     *  stay valid and h is left empty.
+     */
+    void merge(LeftistHeap & h)
+    {
+      if (this == &h or h.is_empty())
+	return;
+
+      pool.absorb(h.pool);
+      root = merge(root, h.root);
+      num_items += h.num_items;
+      h.root = nullptr;
+      h.num_items = 0;
+    }
+
+    /// Checks the heap order, the ranks and the links.
+    bool verify() const;
+  };
+
+  template <typename Key, class Cmp>
+  typename LeftistHeap<Key, Cmp>::Node *
+  LeftistHeap<Key, Cmp>::merge(Node * a, Node * b)
+  {
+    if (a == nullptr)
+      return b;
+
+    if (b == nullptr)
+      return a;
+
+    // Both right spines are merged in order, then the ranks are repaired
+    // from the bottom of the new spine up.
+    Node * ret_val = nullptr;
+    Node * tail    = nullptr;
+
+    while (a != nullptr and b != nullptr)
+      {
+	if (cmp(b->key, a->key))
+	  std::swap(a, b);
+
+	if (tail == nullptr)
+	  {
+	    ret_val = a;
+	    a->parent = nullptr;
+	  }
+	else
+	  {
+	    tail->right = a;
+	    a->parent = tail;
+	  }
+
+	tail = a;
+	a = a->right;
+      }
+
+    tail->right = a != nullptr ? a : b;
+    tail->right->parent = tail;
+
+    for (Node * p = tail; p != nullptr; p = p->parent)
+      {
+	if (rank(p->left) < rank(p->right))
+	  std::swap(p->left, p->right);
+
+	p->rank = rank(p->right) + 1;
+      }
+
+    return ret_val;
+  }
+
+  template <typename Key, class Cmp>
+  void LeftistHeap<Key, Cmp>::fix_ranks(Node * p)
+  {
+    while (p != nullptr)
+      {
+	if (rank(p->left) < rank(p->right))
+	  std::swap(p->left, p->right);
+
+	nat_t r = rank(p->right) + 1;
+
+	if (r == p->rank)
+	  return;
+
+	p->rank = r;
+	p = p->parent;
+      }
+  }
+
+  template <typename Key, class Cmp>
+  void LeftistHeap<Key, Cmp>::remove_node(Node * p)
+  {
+    if (p->left != nullptr)
+      p->left->parent = nullptr;
+
+    if (p->right != nullptr)
+      p->right->parent = nullptr;
+
+    Node * s  = merge(p->left, p->right);
+    Node * pp = p->parent;
+
+    --num_items;
+
+    if (pp == nullptr)
+      {
+	root = s;
+	return;
+      }
+
+    if (pp->left == p)
+      pp->left = s;
+    else
+      pp->right = s;
+
+    if (s != nullptr)
+      s->parent = pp;
+
+    fix_ranks(pp);
+  }
+
+  template <typename Key, class Cmp>
+  void LeftistHeap<Key, Cmp>::clear()
+  {
+    // Right rotations leave every node without left child when reached.
+    Node * p = root;
+
+    while (p != nullptr)
+      {
+	Node * l = p->left;
+
+	if (l != nullptr)
+	  {
+	    p->left = l->right;
+	    l->right = p;
+	    p = l;
+	    continue;
+	  }
+
+	Node * q = p->right;
+	pool.release(p);
+	p = q;
+      }
+
+    root = nullptr;
+    num_items = 0;
+  }
+
+  template <typename Key, class Cmp>
+  bool LeftistHeap<Key, Cmp>::verify(Node * p, nat_t & n) const
+  {
+    ++n;
+
+    if (rank(p->left) < rank(p->right) or p->rank != rank(p->right) + 1)
+      return false;
+
+    for (Node * c : { p->left, p->right })
+      if (c != nullptr and
+	  (c->parent != p or cmp(c->key, p->key) or not verify(c, n)))
+	return false;
+
+    return true;
+  }
+
+  template <typename Key, class Cmp>
+  bool LeftistHeap<Key, Cmp>::verify() const
+  {
+    if (root == nullptr)
+      return num_items == 0;
+
+    nat_t n = 0;
+
+    return root->parent == nullptr and verify(root, n) and n == num_items;
+  }
+
+  /** Binomial heap with intrusive nodes taken from a NodePool.
+   *
+   *  The items are in a list of heap ordered binomial trees of distinct
+   *  orders, kept by increasing order; a tree of order k has 2^k nodes
+   *  and its root has children of orders k - 1, ..., 0. Merging two heaps
+   *  adds their lists like binary numbers, linking two trees of the same
+   *  order into one of the next order, so merge(), insert() and get() are
+   *  O(log n).
+   *
+   *  remove() does not move keys, so references stay valid: cutting the
+   *  path from the root of its tree down to the node splits the tree into
+   *  binomial trees of distinct orders, which are merged back in
+   *  O(log n).
+   *
+   *  insert() returns a reference to the item in the heap which is its
+   *  handle for decrease_key(), update() and remove(); it stays valid
+   *  across merge().
+   */
+  template <typename Key, class Cmp = std::less<Key>>
+  class BinomialHeap
+  {
+    static constexpr nat_t MAX_ORDER = 64;
+
+    struct Node
+    {
+      Key    key; // first member, so &key is the node address
+      Node * parent  = nullptr;
+      Node * child   = nullptr; // child of highest order
+      Node * sibling = nullptr; // next child of lower order, or next root
+      nat_t  order   = 0;
+
+      Node(const Key & k)
+	: key(k)
+      {
+	// empty
+      }
+
+      Node(Key && k)
+	: key(std::forward<Key>(k))
+      {
+	// empty
+      }
+
+      void reset()
+      {
+	parent = child = sibling = nullptr;
+	order = 0;
+      }
+    };
+
+    static Node * key_to_node(Key & k)
+    {
+      return reinterpret_cast<Node *>(&k);
+    }
+
+    NodePool<Node> pool;
+    Node         * head;     // roots by increasing order
+    Node         * min_root;
+    nat_t          num_items;
+    Cmp          & cmp;
+
+    static void link(Node * c, Node * p)
+    {
+      c->parent  = p;
+      c->sibling = p->child;
+      p->child   = c;
+      ++p->order;
+    }
+
+    Node * merge_lists(Node *, Node *);
+
+    void merge_roots(Node * list)
+    {
+      head = merge_lists(head, list);
+      update_min();
+    }
+
+    void update_min()
+    {
+      min_root = head;
+
+      for (Node * p = head; p != nullptr; p = p->sibling)
+	if (cmp(p->key, min_root->key))
+	  min_root = p;
+    }
+
+    void unlink_root(Node * r)
+    {
+      if (head == r)
+	{
+	  head = r->sibling;
+	  return;
+	}
+
+      Node * p = head;
+
+      while (p->sibling != r)
+	p = p->sibling;
+
+      p->sibling = r->sibling;
+    }
+
+    /* Adds a tree of order 0 like adding one to a binary counter, which
+     * is O(1) amortized. A min root linked below an equal key leaves that
+     * key at the root of the carry.
+     */
+    Node * insert_node(Node * p)
+    {
+      Node * r = p;
+
+      while (head != nullptr and head->order == r->order)
+	{
+	  Node * q = head;
+	  head = q->sibling;
+
+	  if (cmp(q->key, r->key))
+	    std::swap(q, r);
+
+	  link(q, r);
+	}
+
+      r->sibling = head;
+      head = r;
+
+      if (min_root == nullptr or min_root->parent != nullptr or
+	  cmp(r->key, min_root->key))
+	min_root = r;
+
+      ++num_items;
+      return p;
+    }
+
+    void remove_node(Node *);
+
+    bool verify(Node *, nat_t &) const;
+
+  public:
+    using ItemType  = Key;
+    using KeyType   = Key;
+    using DataType  = Key;
+    using ValueType = Key;
+    using SizeType  = nat_t;
+    using CmpType   = Cmp;
+
+    BinomialHeap(Cmp & _cmp)
+      : head(nullptr), min_root(nullptr), num_items(0), cmp(_cmp)
+    {
+      // empty
+    }
+
+    BinomialHeap(Cmp && _cmp = Cmp())
+      : BinomialHeap(_cmp)
+    {
+      // empty
+    }
+
+    BinomialHeap(BinomialHeap && h)
+      : BinomialHeap()
+    {
+      swap(h);
+    }
+
+    ~BinomialHeap()
+    {
+      clear();
+    }
+
+    BinomialHeap & operator = (BinomialHeap && h)
+    {
+      swap(h);
+      return *this;
+    }
+
+    void swap(BinomialHeap & h)
+    {
+      pool.swap(h.pool);
+      std::swap(head, h.head);
+      std::swap(min_root, h.min_root);
+      std::swap(num_items, h.num_items);
+      std::swap(cmp, h.cmp);
+    }
+
+    Cmp & get_cmp()
+    {
+      return cmp;
+    }
+
+    const Cmp & get_cmp() const
+    {
+      return cmp;
+    }
+
+    void clear();
+
+    nat_t size() const
+    {
+      return num_items;
+    }
+
+    bool is_empty() const
+    {
+      return num_items == 0;
+    }
+
+    const Key & insert(const Key & k)
+    {
+      return insert_node(pool.allocate(k))->key;
+    }
+
+    const Key & insert(Key && k)
+    {
+      return insert_node(pool.allocate(std::forward<Key>(k)))->key;
+    }
+
+    const Key & top() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      return min_root->key;
+    }
+
+    Key get()
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      Node * p = min_root;
+      remove_node(p);
+      Key ret_val = std::move(p->key);
+      pool.release(p);
+      return ret_val;
+    }
+
+    void remove(Key & item)
+    {
+      Node * p = key_to_node(item);
+      remove_node(p);
+      pool.release(p);
+    }
+
+    /// Replaces item by k, which must not go after it.
+    void decrease_key(Key & item, const Key & k)
+    {
+      if (cmp(item, k))
+	throw std::domain_error("New key is greater than current key");
+
+      update(item, k);
+    }
+
+    /// Replaces item by k, in whichever direction.
+    void update(Key & item, const Key & k)
+    {
+      Node * p = key_to_node(item);
+      remove_node(p);
+      p->reset();
+      p->key = k;
+      insert_node(p);
+    }
+
+    /** Moves every item of h to this heap in O(log n); references to them
+     *  stay valid and h is left empty.
+     */
+    void merge(BinomialHeap & h)
+    {
+      if (this == &h or h.is_empty())
+	return;
+
+      pool.absorb(h.pool);
+      merge_roots(h.head);
+      num_items += h.num_items;
+      h.head = h.min_root = nullptr;
+      h.num_items = 0;
+    }
+
+    /// Checks the heap order, the orders of the trees and the links.
+    bool verify() const;
+  };
+
+  template <typename Key, class Cmp>
+  constexpr nat_t BinomialHeap<Key, Cmp>::MAX_ORDER;
+
+  template <typename Key, class Cmp>
+  typename BinomialHeap<Key, Cmp>::Node *
+  BinomialHeap<Key, Cmp>::merge_lists(Node * a, Node * b)
+  {
+    // Both lists are merged by order, then equal orders are linked.
+    Node *  ret_val = nullptr;
+    Node ** tail    = &ret_val;
+
+    while (a != nullptr and b != nullptr)
+      {
+	if (b->order < a->order)
+	  std::swap(a, b);
+
+	*tail = a;
+	tail = &a->sibling;
+	a = a->sibling;
+      }
+
+    *tail = a != nullptr ? a : b;
+
+    Node * prev    = nullptr;
+    Node * p       = ret_val;
+
+    while (p != nullptr and p->sibling != nullptr)
+      {
+	Node * next = p->sibling;
+
+	if (p->order != next->order or
+	    (next->sibling != nullptr and next->sibling->order == p->order))
+	  {
+	    prev = p;
+	    p = next;
+	  }
+	else if (not cmp(next->key, p->key))
+	  {
+	    p->sibling = next->sibling;
+	    link(next, p);
+	  }
+	else
+	  {
+	    if (prev == nullptr)
+	      ret_val = next;
+	    else
+	      prev->sibling = next;
+
+	    link(p, next);
+	    p = next;
+	  }
+      }
+
+    return ret_val;
+  }
+
+  template <typename Key, class Cmp>
+  void BinomialHeap<Key, Cmp>::remove_node(Node * p)
+  {
+    --num_items;
+
+    if (p->parent == nullptr)
+      {
+	unlink_root(p);
+
+	// The children of a root become roots by increasing order.
+	Node * list = nullptr;
+
+	for (Node * c = p->child; c != nullptr; )
+	  {
+	    Node * next = c->sibling;
+	    c->parent  = nullptr;
+	    c->sibling = list;
+	    list = c;
+	    c = next;
+	  }
+
+	merge_roots(list);
+	return;
+      }
+
+    Node * r = p->parent;
+
+    while (r->parent != nullptr)
+      r = r->parent;
+
+    unlink_root(r);
+
+    // Pieces left by the cut have distinct orders; slot i holds order i.
+    Node * pieces[MAX_ORDER] = { nullptr };
+
+    for (Node * c = p->child; c != nullptr; c = c->sibling)
+      {
+	c->parent = nullptr;
+	pieces[c->order] = c;
+      }
+
+    // An ancestor keeps its children of lower order than the one on the
+    // path and its children of higher order become trees of their own.
+    nat_t order = p->order; // order of c before the cut
+
+    for (Node * c = p, * a = p->parent; a != nullptr; c = a, a = a->parent)
+      {
+	for (Node * s = a->child; s != c; s = s->sibling)
+	  {
+	    s->parent = nullptr;
+	    pieces[s->order] = s;
+	  }
+
+	nat_t a_order = a->order;
+
+	a->child = c->sibling;
+	a->order = order;
+	pieces[order] = a;
+	order = a_order;
+      }
+
+    Node * list = nullptr;
+
+    for (nat_t i = MAX_ORDER; i > 0; --i)
+      if (pieces[i - 1] != nullptr)
+	{
+	  pieces[i - 1]->sibling = list;
+	  list = pieces[i - 1];
+	}
+
+    for (Node * a = p->parent; a != nullptr; )
+      {
+	Node * next = a->parent;
+	a->parent = nullptr;
+	a = next;
+      }
+
+    merge_roots(list);
+  }
+
+  template <typename Key, class Cmp>
+  void BinomialHeap<Key, Cmp>::clear()
+  {
+    // Seen as a binary tree (child left, sibling right), right rotations
+    // leave every node without child when it is reached.
+    Node * p = head;
+
+    while (p != nullptr)
+      {
+	Node * c = p->child;
+
+	if (c != nullptr)
+	  {
+	    p->child = c->sibling;
+	    c->sibling = p;
+	    p = c;
+	    continue;
+	  }
+
+	Node * q = p->sibling;
+	pool.release(p);
+	p = q;
+      }
+
+    head = min_root = nullptr;
+    num_items = 0;
+  }
+
+  template <typename Key, class Cmp>
+  bool BinomialHeap<Key, Cmp>::verify(Node * p, nat_t & n) const
+  {
+    ++n;
+
+    nat_t order = p->order;
+
+    for (Node * c = p->child; c != nullptr; c = c->sibling)
+      if (c->parent != p or c->order != --order or cmp(c->key, p->key) or
+	  not verify(c, n))
+	return false;
+
+    return order == 0;
+  }
+
+  template <typename Key, class Cmp>
+  bool BinomialHeap<Key, Cmp>::verify() const
+  {
+    nat_t n = 0;
+
+    for (Node * p = head; p != nullptr; p = p->sibling)
+      {
+	if (p->parent != nullptr or cmp(p->key, min_root->key) or
+	    not verify(p, n))
+	  return false;
+
+	if (p->sibling != nullptr and p->sibling->order <= p->order)
+	  return false;
+      }
+
+    return n == num_items;
+  }
+
+  /** Monotone radix heap.
+   *
+   *  Priority maps an item to its priority, which radix_key() turns into
+   *  an unsigned integer p. Bucket 0 holds the items whose p equals the
+   *  last extracted one and bucket i > 0 those whose p first differs from
+   *  it at bit i - 1. Extraction takes bucket 0 and, when it is empty,
+   *  spreads the first non empty bucket over the lower ones; every item
+   *  moves down at most once per bit, so get() is O(log C) amortized for
+   *  priorities spanning C values and insert() and decrease_key() are
+   *  O(1).
+   *
+   *  The smallest priority is always extracted first, and the heap is
+   *  monotone: an item must not go before the last one returned by top()
+   *  or get(), otherwise domain_error is thrown. Dijkstra meets this with
+   *  non negative weights, as Astar with a consistent heuristic, but Prim
+   *  does not.
+   *
+   *  A DistanceCmp serves as Priority, so the heap plugs into ArcHeap.
+   */
+  template <typename Key, class Priority = RadixIdentity>
+  class RadixHeap
+  {
+    static constexpr nat_t NUM_BUCKETS = 65;
+
+    struct Node
+    {
+      Key    key; // first member, so &key is the node address
+      Node * prev = nullptr;
+      Node * next = nullptr;
+      nat_t  prio;
+      nat_t  bucket;
+
+      Node(const Key & k, nat_t p)
+	: key(k), prio(p)
+      {
+	// empty
+      }
+
+      Node(Key && k, nat_t p)
+	: key(std::forward<Key>(k)), prio(p)
+      {
+	// empty
+      }
+    };
+
+    static Node * key_to_node(Key & k)
+    {
+      return reinterpret_cast<Node *>(&k);
+    }
+
+    NodePool<Node>  pool;
+    mutable Node  * buckets[NUM_BUCKETS];
+    mutable nat_t   last;
+    nat_t           num_items;
+    Priority      & priority;
+
+    nat_t priority_of(const Key & k)
+    {
+      return radix_key(priority(k));
+    }
+
+    nat_t bucket_of(nat_t p) const
+    {
+      return p == last ? 0 : floor_log2(p ^ last) + 1;
+    }
+
+    void link(Node * p) const
+    {
+      nat_t i = p->bucket = bucket_of(p->prio);
+      p->prev = nullptr;
+      p->next = buckets[i];
+
+      if (buckets[i] != nullptr)
+	buckets[i]->prev = p;
+
+      buckets[i] = p;
+    }
+
+    void unlink(Node * p) const
+    {
+      if (p->prev != nullptr)
+	p->prev->next = p->next;
+      else
+	buckets[p->bucket] = p->next;
+
+      if (p->next != nullptr)
+	p->next->prev = p->prev;
+    }
+
+    void check_monotone(nat_t p) const
+    {
+      if (p < last)
+	throw std::domain_error("Key goes before the last extracted key");
+    }
+
+    void pull() const;
+
+    Node * insert_node(Node * p)
+    {
+      link(p);
+      ++num_items;
+      return p;
+    }
+
+    void relink(Node * p, const Key & k, nat_t prio)
+    {
+      unlink(p);
+      p->key  = k;
+      p->prio = prio;
+      link(p);
+    }
+
+  public:
+    using ItemType  = Key;
+    using KeyType   = Key;
+    using DataType  = Key;
+    using ValueType = Key;
+    using SizeType  = nat_t;
+
+    RadixHeap(Priority & _priority)
+      : last(0), num_items(0), priority(_priority)
+    {
+      std::fill(buckets, buckets + NUM_BUCKETS, nullptr);
+    }
+
+    RadixHeap(Priority && _priority = Priority())
+      : RadixHeap(_priority)
+    {
+      // empty
+    }
+
+    RadixHeap(RadixHeap && h)
+      : RadixHeap()
+    {
+      swap(h);
+    }
+
+    ~RadixHeap()
+    {
+      clear();
+    }
+
+    RadixHeap & operator = (RadixHeap && h)
+    {
+      swap(h);
+      return *this;
+    }
+
+    void swap(RadixHeap & h)
+    {
+      pool.swap(h.pool);
+      std::swap(buckets, h.buckets);
+      std::swap(last, h.last);
+      std::swap(num_items, h.num_items);
+      std::swap(priority, h.priority);
+    }
+
+    Priority & get_priority()
+    {
+      return priority;
+    }
+
+    const Priority & get_priority() const
+    {
+      return priority;
+    }
+
+    /// Removes every item; the heap is no longer bound to the last key.
+    void clear();
+
+    nat_t size() const
+    {
+      return num_items;
+    }
+
+    bool is_empty() const
+    {
+      return num_items == 0;
+    }
+
+    const Key & insert(const Key & k)
+    {
+      nat_t p = priority_of(k);
+      check_monotone(p);
+      return insert_node(pool.allocate(k, p))->key;
+    }
+
+    const Key & insert(Key && k)
+    {
+      nat_t p = priority_of(k);
+      check_monotone(p);
+      return insert_node(pool.allocate(std::forward<Key>(k), p))->key;
+    }
+
+    const Key & top() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      pull();
+      return buckets[0]->key;
+    }
+
+    Key get()
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      pull();
+
+      Node * p = buckets[0];
+      unlink(p);
+      --num_items;
+      Key ret_val = std::move(p->key);
+      pool.release(p);
+      return ret_val;
+    }
+
+    void remove(Key & item)
+    {
+      Node * p = key_to_node(item);
+      unlink(p);
+      --num_items;
+      pool.release(p);
+    }
+
+    /// Replaces item by k, which must not go after it. O(1).
+    void decrease_key(Key & item, const Key & k)
+    {
+      Node * p = key_to_node(item);
+      nat_t prio = priority_of(k);
+
+      if (prio > p->prio)
+	throw std::domain_error("New key is greater than current key");
+
+      check_monotone(prio);
+      relink(p, k, prio);
+    }
+
+    /// Replaces item by k, in whichever direction.
+    void update(Key & item, const Key & k)
+    {
+      nat_t prio = priority_of(k);
+      check_monotone(prio);
+      relink(key_to_node(item), k, prio);
+    }
+
+    /// Checks that every item is in the bucket its priority says.
+    bool verify() const;
+  };
+
+  template <typename Key, class Priority>
+  constexpr nat_t RadixHeap<Key, Priority>::NUM_BUCKETS;
+
+  template <typename Key, class Priority>
+  void RadixHeap<Key, Priority>::pull() const
+  {
+    if (buckets[0] != nullptr)
+      return;
+
+    nat_t i = 1;
+
+    while (buckets[i] == nullptr)
+      ++i;
+
+    Node * p = buckets[i];
+
+    last = p->prio;
+
+    for (Node * q = p->next; q != nullptr; q = q->next)
+      last = std::min(last, q->prio);
+
+    buckets[i] = nullptr;
+
+    while (p != nullptr)
+      {
+	Node * q = p->next;
+	link(p);
+	p = q;
+      }
+  }
+
+  template <typename Key, class Priority>
+  void RadixHeap<Key, Priority>::clear()
+  {
+    for (nat_t i = 0; i < NUM_BUCKETS; ++i)
+      {
+	Node * p = buckets[i];
+
+	while (p != nullptr)
+	  {
+	    Node * q = p->next;
+	    pool.release(p);
+	    p = q;
+	  }
+
+	buckets[i] = nullptr;
+      }
+
+    last = 0;
+    num_items = 0;
+  }
+
+  template <typename Key, class Priority>
+  bool RadixHeap<Key, Priority>::verify() const
+  {
+    nat_t n = 0;
+
+    for (nat_t i = 0; i < NUM_BUCKETS; ++i)
+      for (Node * p = buckets[i], * prev = nullptr; p != nullptr;
+	   prev = p, p = p->next, ++n)
+	if (p->prev != prev or p->bucket != i or bucket_of(p->prio) != i or
+	    p->prio < last)
+	  return false;
+
+    return n == num_items;
+  }
+
+  /** Dial's bucket queue for small non negative integer priorities.
+   *
+   *  Priority maps an item to an unsigned integer. The buckets form a
+   *  circular array of a power of two size which covers the priorities
+   *  from the last extracted one on, so a bucket holds a single priority
+   *  at a time; inserting beyond the window doubles it. get() scans
+   *  forward to the next non empty bucket, hence extracting every item
+   *  costs O(n + C) for priorities spanning C values, and insert(),
+   *  decrease_key() and remove() are O(1). It beats the radix heap when
+   *  weights are small integers, say less than a few thousand.
+   *
+   *  Like RadixHeap it extracts the smallest priority first, it is
+   *  monotone and a DistanceCmp serves as Priority.
+   */
+  template <typename Key, class Priority = RadixIdentity>
+  class BucketQueue
+  {
+    struct Node
+    {
+      Key    key; // first member, so &key is the node address
+      Node * prev = nullptr;
+      Node * next = nullptr;
+      nat_t  prio;
+
+      Node(const Key & k, nat_t p)
+	: key(k), prio(p)
+      {
+	// empty
+      }
+
+      Node(Key && k, nat_t p)
+	: key(std::forward<Key>(k)), prio(p)
+      {
+	// empty
+      }
+    };
+
+    static Node * key_to_node(Key & k)
+    {
+      return reinterpret_cast<Node *>(&k);
+    }
+
+    NodePool<Node>             pool;
+    mutable FixedArray<Node *> buckets;
+    mutable nat_t              curr; // priorities are in curr..curr + mask
+    nat_t                      mask;
+    nat_t                      num_items;
+    Priority                 & priority;
+
+    nat_t priority_of(const Key & k)
+    {
+      using Type = std::decay_t<decltype(priority(k))>;
+      static_assert(std::is_integral<Type>::value,
+		    "Priorities must be integers");
+      return nat_t(priority(k));
+    }
+
+    void link(Node * p) const
+    {
+      Node *& head = buckets[p->prio & mask];
+      p->prev = nullptr;
+      p->next = head;
+
+      if (head != nullptr)
+	head->prev = p;
+
+      head = p;
+    }
+
+    void unlink(Node * p) const
+    {
+      if (p->prev != nullptr)
+	p->prev->next = p->next;
+      else
+	buckets[p->prio & mask] = p->next;
+
+      if (p->next != nullptr)
+	p->next->prev = p->prev;
+    }
+
+    void check_priority(nat_t p)
+    {
+      if (p < curr)
+	throw std::domain_error("Key goes before the last extracted key");
+
+      if (p - curr > mask)
+	grow(p - curr);
+    }
+
+    void grow(nat_t);
+
+    void pull() const
+    {
+      while (buckets[curr & mask] == nullptr)
+	++curr;
+    }
+
+    Node * insert_node(Node * p)
+    {
+      link(p);
+      ++num_items;
+      return p;
+    }
+
+    void relink(Node * p, const Key & k, nat_t prio)
+    {
+      unlink(p);
+      p->key  = k;
+      p->prio = prio;
+      link(p);
+    }
+
+  public:
+    using ItemType  = Key;
+    using KeyType   = Key;
+    using DataType  = Key;
+    using ValueType = Key;
+    using SizeType  = nat_t;
+
+    BucketQueue(Priority & _priority)
+      : buckets(64, nullptr), curr(0), mask(63), num_items(0),
+	priority(_priority)
+    {
+      // empty
+    }
+
+    BucketQueue(Priority && _priority = Priority())
+      : BucketQueue(_priority)
+    {
+      // empty
+    }
+
+    BucketQueue(BucketQueue && h)
+      : BucketQueue()
+    {
+      swap(h);
+    }
+
+    ~BucketQueue()
+    {
+      clear();
+    }
+
+    BucketQueue & operator = (BucketQueue && h)
+    {
+      swap(h);
+      return *this;
+    }
+
+    void swap(BucketQueue & h)
+    {
+      pool.swap(h.pool);
+      buckets.swap(h.buckets);
+      std::swap(curr, h.curr);
+      std::swap(mask, h.mask);
+      std::swap(num_items, h.num_items);
+      std::swap(priority, h.priority);
+    }
+
+    Priority & get_priority()
+    {
+      return priority;
+    }
+
+    const Priority & get_priority() const
+    {
+      return priority;
+    }
+
+    /// Removes every item; the queue is no longer bound to the last key.
+    void clear();
+
+    nat_t size() const
+    {
+      return num_items;
+    }
+
+    bool is_empty() const
+    {
+      return num_items == 0;
+    }
+
+    const Key & insert(const Key & k)
+    {
+      nat_t p = priority_of(k);
+      check_priority(p);
+      return insert_node(pool.allocate(k, p))->key;
+    }
+
+    const Key & insert(Key && k)
+    {
+      nat_t p = priority_of(k);
+      check_priority(p);
+      return insert_node(pool.allocate(std::forward<Key>(k), p))->key;
+    }
+
+    const Key & top() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      pull();
+      return buckets[curr & mask]->key;
+    }
+
+    Key get()
+    {
+      if (is_empty())
+	throw std::underflow_error("Heap is empty");
+
+      pull();
+
+      Node * p = buckets[curr & mask];
+      unlink(p);
+      --num_items;
+      Key ret_val = std::move(p->key);
+      pool.release(p);
+      return ret_val;
+    }
+
+    void remove(Key & item)
+    {
+      Node * p = key_to_node(item);
+      unlink(p);
+      --num_items;
+      pool.release(p);
+    }
+
+    /// Replaces item by k, which must not go after it. O(1).
+    void decrease_key(Key & item, const Key & k)
+    {
+      Node * p = key_to_node(item);
+      nat_t prio = priority_of(k);
+
+      if (prio > p->prio)
+	throw std::domain_error("New key is greater than current key");
+
+      check_priority(prio);
+      relink(p, k, prio);
+    }
+
+    /// Replaces item by k, in whichever direction.
+    void update(Key & item, const Key & k)
+    {
+      nat_t prio = priority_of(k);
+      check_priority(prio);
+      relink(key_to_node(item), k, prio);
+    }
+
+    /// Checks that every item is in the bucket of its priority.
+    bool verify() const;
+  };
+
+  template <typename Key, class Priority>
+  void BucketQueue<Key, Priority>::grow(nat_t span)
+  {
+    nat_t cap = buckets.size();
+
+    while (cap <= span)
+      cap *= 2;
+
+    FixedArray<Node *> old(cap, nullptr);
+    buckets.swap(old);
+    mask = cap - 1;
+
+    for (Node * head : old)
+      for (Node * p = head; p != nullptr; )
+	{
+	  Node * q = p->next;
+	  link(p);
+	  p = q;
+	}
+  }
+
+  template <typename Key, class Priority>
+  void BucketQueue<Key, Priority>::clear()
+  {
+    for (Node *& head : buckets)
+      {
+	for (Node * p = head; p != nullptr; )
+	  {
+	    Node * q = p->next;
+	    pool.release(p);
+	    p = q;
+	  }
+
+	head = nullptr;
+      }
+
+    curr = 0;
+    num_items = 0;
+  }
+
+  template <typename Key, class Priority>
+  bool BucketQueue<Key, Priority>::verify() const
+  {
+    nat_t n = 0;
+
+    for (nat_t i = 0; i < buckets.size(); ++i)
+      for (Node * p = buckets[i], * prev = nullptr; p != nullptr;
+	   prev = p, p = p->next, ++n)
+	if (p->prev != prev or (p->prio & mask) != i or p->prio < curr or
+	    p->prio - curr > mask)
+	  return false;
+
+    return n == num_items;
+  }
+
 } // end namespace Designar
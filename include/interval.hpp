@@ -0,0 +1,314 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <map.hpp>
+
+namespace Designar
+{
+  /// Closed interval [lo, hi] of an arithmetic type.
+  template <typename T>
+  class Interval
+  {
+    static_assert(std::is_arithmetic<T>::value,
+		  "Template argument must be an arithmetic type");
+
+    T lo;
+    T hi;
+
+  public:
+    Interval()
+      : lo(), hi()
+    {
+      // empty
+    }
+
+    Interval(const T & _lo, const T & _hi)
+      : lo(_lo), hi(_hi)
+    {
+      if (hi < lo)
+	throw std::range_error("Low endpoint cannot be greater than high "
+			       "endpoint");
+    }
+
+    const T & get_lo() const
+    {
+      return lo;
+    }
+
+    const T & get_hi() const
+    {
+      return hi;
+    }
+
+    bool contains(const T & x) const
+    {
+      return not (x < lo) and not (hi < x);
+    }
+
+    bool overlaps(const Interval & i) const
+    {
+      return not (i.hi < lo) and not (hi < i.lo);
+    }
+
+    bool operator == (const Interval & i) const
+    {
+      return not (lo < i.lo) and not (i.lo < lo) and
+	not (hi < i.hi) and not (i.hi < hi);
+    }
+
+    bool operator != (const Interval & i) const
+    {
+      return not (*this == i);
+    }
+  };
+
+  /// Orders intervals by their low endpoints, then by the high ones.
+  template <typename T>
+  struct IntervalCmp
+  {
+    bool operator () (const Interval<T> & i, const Interval<T> & j) const
+    {
+      if (i.get_lo() < j.get_lo())
+	return true;
+
+      if (j.get_lo() < i.get_lo())
+	return false;
+
+      return i.get_hi() < j.get_hi();
+    }
+  };
+
+  // Interval of an item of an IntervalSet or an IntervalMap.
+  template <typename Item>
+  struct IntervalItem;
+
+  template <typename T>
+  struct IntervalItem<Interval<T>>
+  {
+    using EndpointType = T;
+
+    static const Interval<T> & get(const Interval<T> & i)
+    {
+      return i;
+    }
+  };
+
+  template <typename T, typename Value>
+  struct IntervalItem<MapKey<Interval<T>, Value>>
+  {
+    using EndpointType = T;
+
+    static const Interval<T> & get(const MapKey<Interval<T>, Value> & p)
+    {
+      return p.first;
+    }
+  };
+
+  /// Greatest high endpoint of the intervals of a subtree.
+  template <typename Item>
+  struct MaxHighEndpoint
+  {
+    using ValueType = typename IntervalItem<Item>::EndpointType;
+
+    static ValueType identity()
+    {
+      return std::numeric_limits<ValueType>::lowest();
+    }
+
+    static ValueType lift(const Item & item)
+    {
+      return IntervalItem<Item>::get(item).get_hi();
+    }
+
+    static ValueType combine(const ValueType & a, const ValueType & b)
+    {
+      return a < b ? b : a;
+    }
+  };
+
+  /** Interval tree: a treap of intervals ordered by IntervalCmp which
+   *  keeps the greatest high endpoint of every subtree.
+   *
+   *  A subtree whose greatest high endpoint is below x cannot hold an
+   *  interval which contains x, and neither can the keys after the first
+   *  one whose low endpoint is above x, so queries visit O(log n) nodes to
+   *  find each reported interval and O(log n) to find there are none.
+   *
+   *  It is the tree of IntervalSet and IntervalMap; items are intervals or
+   *  pairs (interval, value).
+   */
+  template <typename Item, class Cmp>
+  class IntervalTreap : public GenRankedTreap<Item, Cmp, MaxHighEndpoint<Item>>
+  {
+    using Base = GenRankedTreap<Item, Cmp, MaxHighEndpoint<Item>>;
+    using Node = typename Base::Node;
+    using T    = typename IntervalItem<Item>::EndpointType;
+
+    static const Interval<T> & interval(Node * p)
+    {
+      return IntervalItem<Item>::get(KEY(p));
+    }
+
+    template <class Op>
+    static void overlapping_rec(Node *, const T &, const T &, Op &);
+
+  public:
+    using Base::Base;
+
+    /// Applies op, in order, to the intervals which contain x.
+    template <class Op>
+    void for_each_containing(const T & x, Op & op) const
+    {
+      overlapping_rec<Op>(this->get_root(), x, x, op);
+    }
+
+    template <class Op>
+    void for_each_containing(const T & x, Op && op = Op()) const
+    {
+      for_each_containing<Op>(x, op);
+    }
+
+    /// Applies op, in order, to the intervals which overlap i.
+    template <class Op>
+    void for_each_overlapping(const Interval<T> & i, Op & op) const
+    {
+      overlapping_rec<Op>(this->get_root(), i.get_lo(), i.get_hi(), op);
+    }
+
+    template <class Op>
+    void for_each_overlapping(const Interval<T> & i, Op && op = Op()) const
+    {
+      for_each_overlapping<Op>(i, op);
+    }
+
+    /// Items whose intervals contain x, in order.
+    DynArray<Item> containing(const T & x) const
+    {
+      DynArray<Item> ret_val;
+      for_each_containing(x, [&ret_val] (const Item & item)
+			  {
+			    ret_val.append(item);
+			  });
+      return ret_val;
+    }
+
+    /// Items whose intervals overlap i, in order.
+    DynArray<Item> overlapping(const Interval<T> & i) const
+    {
+      DynArray<Item> ret_val;
+      for_each_overlapping(i, [&ret_val] (const Item & item)
+			   {
+			     ret_val.append(item);
+			   });
+      return ret_val;
+    }
+
+    /// Returns an item whose interval overlaps i, or nullptr, in O(log n).
+    const Item * search_overlap(const Interval<T> & i) const
+    {
+      Node * r = this->get_root();
+
+      while (r != Node::null)
+	{
+	  if (interval(r).overlaps(i))
+	    return &KEY(r);
+
+	  // If the left subtree reaches i and has no overlap, nothing does.
+	  if (L(r) != Node::null and not (AGG(L(r)) < i.get_lo()))
+	    r = L(r);
+	  else
+	    r = R(r);
+	}
+
+      return nullptr;
+    }
+
+    bool overlaps(const Interval<T> & i) const
+    {
+      return search_overlap(i) != nullptr;
+    }
+
+    /** Replaces the items by those in c, in any order, sorted in
+     *  O(n log n) and linked in O(n). Repeated items are kept once.
+     */
+    template <class ContainerType>
+    void bulk_load(const ContainerType & c)
+    {
+      DynArray<Item> items(c.size() + 1);
+
+      for (const Item & item : c)
+	items.append(item);
+
+      quicksort(items, this->get_cmp());
+
+      nat_t n = 0;
+
+      for (nat_t i = 0; i < items.size(); ++i)
+	if (n == 0 or this->get_cmp()(items[n - 1], items[i]))
+	  items[n++] = std::move(items[i]);
+
+      while (items.size() > n)
+	items.remove_last();
+
+      this->build_from_sorted(items);
+    }
+
+    /** Replaces the intervals by the unions of those which overlap, and
+     *  returns how many intervals were removed. Only for sets of intervals.
+     */
+    nat_t merge_overlaps()
+    {
+      DynArray<Item> merged(this->size() + 1);
+
+      for (const Item & i : *this)
+	{
+	  if (merged.is_empty() or merged.get_last().get_hi() < i.get_lo())
+	    {
+	      merged.append(i);
+	      continue;
+	    }
+
+	  Item & last = merged.get_last();
+
+	  if (last.get_hi() < i.get_hi())
+	    last = Item(last.get_lo(), i.get_hi());
+	}
+
+      nat_t ret_val = this->size() - merged.size();
+      this->build_from_sorted(merged);
+      return ret_val;
+    }
+  };
+
+  template <typename Item, class Cmp>
+  template <class Op>
+  void IntervalTreap<Item, Cmp>::overlapping_rec(Node * r, const T & lo,
+						 const T & hi, Op & op)
+  {
+    if (r == Node::null or AGG(r) < lo)
+      return;
+
+    overlapping_rec(L(r), lo, hi, op);
+
+    if (hi < interval(r).get_lo())
+      return;
+
+    if (not (interval(r).get_hi() < lo))
+      op(KEY(r));
+
+    overlapping_rec(R(r), lo, hi, op);
+  }
+
+  template <typename T>
+  using IntervalSet = TreeSet<Interval<T>, IntervalCmp<T>, IntervalTreap>;
+
+  template <typename T, typename Value>
+  using IntervalMap = TreeMap<Interval<T>, Value, IntervalCmp<T>,
+			      IntervalTreap>;
+
+} // end namespace Designar
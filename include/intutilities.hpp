@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <cstring>
+
 #include <types.hpp>
 
 namespace Designar
@@ -85,5 +87,87 @@ namespace Designar
 
     return backward_prod(n, n - r + T(1)) / factorial(r);
   }
-  
+
+  /// Number of zero bits below the lowest set bit of n; 64 if n == 0.
+  inline nat_t count_trailing_zeros(nat_t n)
+  {
+    if (n == 0)
+      return 64;
+
+#if defined(__GNUC__)
+    return __builtin_ctzll(n);
+#else
+    nat_t ret_val = 0;
+
+    for ( ; (n & 1) == 0; n >>= 1)
+      ++ret_val;
+
+    return ret_val;
+#endif
+  }
+
+  /// Position of the highest set bit of n, n > 0.
+  inline nat_t floor_log2(nat_t n)
+  {
+    if (n == 0)
+      throw std::domain_error("Argument must be positive");
+
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(n);
+#else
+    nat_t ret_val = 0;
+
+    while (n >>= 1)
+      ++ret_val;
+
+    return ret_val;
+#endif
+  }
+
+  /* Radix keys map a key to an unsigned integer with the same order, so
+   * every key type is sorted by the same byte-wise passes.
+   */
+  template <typename T>
+  inline std::enable_if_t<std::is_unsigned<T>::value, T> radix_key(T k)
+  {
+    return k;
+  }
+
+  // Flipping the sign bit moves negative values below positive ones.
+  template <typename T>
+  inline std::enable_if_t<std::is_signed<T>::value and
+			  std::is_integral<T>::value, std::make_unsigned_t<T>>
+  radix_key(T k)
+  {
+    using U = std::make_unsigned_t<T>;
+    return U(k) ^ (U(1) << (sizeof(T) * 8 - 1));
+  }
+
+  /* Positive values get the sign bit set and negative ones have every bit
+   * inverted, so larger magnitudes sort lower. -0.0 goes before 0.0 and
+   * NaNs go to the ends according to their sign bit.
+   */
+  inline uint32_t radix_key(float k)
+  {
+    uint32_t b;
+    std::memcpy(&b, &k, sizeof(b));
+    return b & (uint32_t(1) << 31) ? ~b : b | (uint32_t(1) << 31);
+  }
+
+  inline uint64_t radix_key(double k)
+  {
+    uint64_t b;
+    std::memcpy(&b, &k, sizeof(b));
+    return b & (uint64_t(1) << 63) ? ~b : b | (uint64_t(1) << 63);
+  }
+
+  struct RadixIdentity
+  {
+    template <typename T>
+    const T & operator () (const T & item) const
+    {
+      return item;
+    }
+  };
+
 } // end namespace Designar
@@ -7,6 +7,8 @@
 #pragma once
 
 #include <set.hpp>
+#include <random.hpp>
+#include <intutilities.hpp>
 
 namespace Designar
 {
@@ -486,6 +488,12 @@ namespace Designar
       // empty
     }
 
+    TreeMap(const DynArray<Item> & a)
+      : BaseMap(a)
+    {
+      // empty
+    }
+
     TreeMap(const TreeMap & map)
       : BaseMap(map)
     {
@@ -512,6 +520,58 @@ namespace Designar
       BaseMap::swap(m);
       return *this;
     }
+
+    // Range queries by key, with a TreeType which provides them.
+    auto lower_bound(const Key & k) const
+    {
+      return BaseMap::lower_bound(map_key(k, Value()));
+    }
+
+    auto upper_bound(const Key & k) const
+    {
+      return BaseMap::upper_bound(map_key(k, Value()));
+    }
+
+    nat_t count_range(const Key & lo, const Key & hi) const
+    {
+      return BaseMap::count_range(map_key(lo, Value()), map_key(hi, Value()));
+    }
+
+    template <class Op>
+    void for_each_in_range(const Key & lo, const Key & hi, Op & op) const
+    {
+      BaseMap::template for_each_in_range<Op>(map_key(lo, Value()),
+					      map_key(hi, Value()), op);
+    }
+
+    template <class Op>
+    void for_each_in_range(const Key & lo, const Key & hi,
+			   Op && op = Op()) const
+    {
+      for_each_in_range<Op>(lo, hi, op);
+    }
+
+    nat_t remove_range(const Key & lo, const Key & hi)
+    {
+      return BaseMap::remove_range(map_key(lo, Value()), map_key(hi, Value()));
+    }
+
+    // Aggregates, with a TreeType as GenRankedTreap.
+    auto aggregate() const
+    {
+      return BaseMap::aggregate();
+    }
+
+    auto aggregate(const Key & lo, const Key & hi) const
+    {
+      return BaseMap::aggregate(map_key(lo, Value()), map_key(hi, Value()));
+    }
+
+    /// Must be called after the value of k is changed in place.
+    bool refresh(const Key & k)
+    {
+      return BaseMap::refresh(map_key(k, Value()));
+    }
   };
 
   template<typename Key, typename Value, typename Fct>
@@ -621,5 +681,645 @@ namespace Designar
     for (const auto & item : l)
       BaseHash::append(item);
   }
-  
+
+  /** Lock-free ordered map: a skip list after Fraser and Herlihy-Shavit.
+   *
+   *  A node is removed by marking the low bit of its next pointers, from
+   *  the top level down to the bottom one, which is the linearization
+   *  point; searches for its key unlink it on every level. Reads never
+   *  write shared memory and every operation holds an EpochGuard, so the
+   *  unlinked nodes are handed to Epoch::retire() once both the thread
+   *  which inserted them and the one which removed them are done.
+   *
+   *  Values cannot be modified after insertion. Iteration is weakly
+   *  consistent: it sees every item present during the whole traversal
+   *  and may or may not see the concurrent updates. An iterator pins the
+   *  epoch of its thread until it reaches the end or it is destroyed, so
+   *  it must not be passed to other threads.
+   */
+  template <typename Key, typename Value, class Cmp = std::less<Key>>
+  class ConcurrentTreeMap
+  {
+    using Item = MapKey<Key, Value>;
+    using Link = std::atomic<uintptr_t>;
+
+    static constexpr nat_t MAX_LEVEL = 32;
+
+    struct Node
+    {
+      Item               item;
+      nat_t              height;
+      std::atomic<nat_t> num_done; // inserter and remover which finished
+
+      template <typename K, typename V>
+      Node(K && k, V && v, nat_t h)
+	: item(std::forward<K>(k), std::forward<V>(v)), height(h), num_done(0)
+      {
+	// empty
+      }
+
+      // The links are allocated right after the node.
+      Link * next()
+      {
+	return reinterpret_cast<Link *>(this + 1);
+      }
+    };
+
+    Link               * head;
+    std::atomic<nat_t>   top_level;
+    std::atomic<nat_t>   num_items;
+    mutable Cmp          cmp;
+
+    static Node * get_node(uintptr_t l)
+    {
+      return reinterpret_cast<Node *>(l & ~uintptr_t(1));
+    }
+
+    static uintptr_t to_link(Node * p)
+    {
+      return reinterpret_cast<uintptr_t>(p);
+    }
+
+    static bool is_marked(uintptr_t l)
+    {
+      return (l & 1) != 0;
+    }
+
+    template <typename K, typename V>
+    static Node * create_node(K && k, V && v, nat_t h)
+    {
+      void * mem = ::operator new(sizeof(Node) + h * sizeof(Link));
+      Node * p = new (mem) Node(std::forward<K>(k), std::forward<V>(v), h);
+
+      for (nat_t l = 0; l < h; ++l)
+	new (p->next() + l) Link(0);
+
+      return p;
+    }
+
+    static void destroy_node(void * ptr)
+    {
+      Node * p = static_cast<Node *>(ptr);
+      p->~Node();
+      ::operator delete(p);
+    }
+
+    static nat_t random_height()
+    {
+      static thread_local rng_t rng(get_random_seed());
+      return count_trailing_zeros(rng() | nat_t(1) << (MAX_LEVEL - 1)) + 1;
+    }
+
+    void raise_top_level(nat_t h)
+    {
+      nat_t t = top_level.load();
+
+      while (t < h and not top_level.compare_exchange_weak(t, h))
+	; // t was refreshed by the failed exchange
+    }
+
+    bool try_find(const Key &, Link **, Node **, Node *&) const;
+
+    /* Fills preds and succs with the links before k and the nodes after
+     * them on every level, unlinking the removed nodes on the way, and
+     * returns the node of k or nullptr.
+     */
+    Node * find(const Key & k, Link ** preds, Node ** succs) const
+    {
+      Node * ret_val;
+
+      while (not try_find(k, preds, succs, ret_val))
+	; // a link changed under the search
+
+      return ret_val;
+    }
+
+    // First node whose key is not less (greater if strict) than k.
+    Node * seek(const Key &, bool strict) const;
+
+    static Node * skip_removed(Node * p)
+    {
+      while (p != nullptr)
+	{
+	  uintptr_t succ = p->next()[0].load(std::memory_order_acquire);
+
+	  if (not is_marked(succ))
+	    break;
+
+	  p = get_node(succ);
+	}
+
+      return p;
+    }
+
+    // Called by the inserter and the remover of p when they are done.
+    static void finish(Node * p)
+    {
+      if (p->num_done.fetch_add(1) == 1)
+	Epoch::retire(p, &destroy_node);
+    }
+
+    template <typename K, typename V>
+    bool insert_node(K &&, V &&);
+
+    void link_upper(Node *, Link **, Node **);
+
+  public:
+    using ItemType  = Item;
+    using KeyType   = Key;
+    using ValueType = Value;
+    using SizeType  = nat_t;
+    using CmpType   = Cmp;
+
+    ConcurrentTreeMap(Cmp & _cmp)
+      : head(new Link[MAX_LEVEL]), top_level(1), num_items(0), cmp(_cmp)
+    {
+      for (nat_t l = 0; l < MAX_LEVEL; ++l)
+	head[l].store(0);
+    }
+
+    ConcurrentTreeMap(Cmp && _cmp = Cmp())
+      : ConcurrentTreeMap(_cmp)
+    {
+      // empty
+    }
+
+    ConcurrentTreeMap(const std::initializer_list<Item> & l)
+      : ConcurrentTreeMap()
+    {
+      for (const Item & item : l)
+	insert(item.first, item.second);
+    }
+
+    ConcurrentTreeMap(const ConcurrentTreeMap &) = delete;
+
+    ConcurrentTreeMap & operator = (const ConcurrentTreeMap &) = delete;
+
+    ~ConcurrentTreeMap();
+
+    Cmp & get_cmp()
+    {
+      return cmp;
+    }
+
+    const Cmp & get_cmp() const
+    {
+      return cmp;
+    }
+
+    /// Number of items; only a snapshot when other threads are working.
+    nat_t size() const
+    {
+      return num_items.load(std::memory_order_relaxed);
+    }
+
+    bool is_empty() const
+    {
+      EpochGuard guard;
+      return skip_removed(get_node(head[0].load())) == nullptr;
+    }
+
+    /// Removes every item, one by one, so it can run with other updates.
+    void clear();
+
+    /// Returns false if k was already in the map.
+    bool insert(const Key & k, const Value & v)
+    {
+      return insert_node(k, v);
+    }
+
+    bool insert(Key && k, Value && v)
+    {
+      return insert_node(std::forward<Key>(k), std::forward<Value>(v));
+    }
+
+    /// Returns false if k was not in the map.
+    bool remove(const Key &);
+
+    /// Copies the value of k into v, if k is in the map.
+    bool search(const Key & k, Value & v) const
+    {
+      EpochGuard guard;
+
+      Node * p = seek(k, false);
+
+      if (p == nullptr or cmp(k, p->item.first))
+	return false;
+
+      v = p->item.second;
+      return true;
+    }
+
+    bool contains(const Key & k) const
+    {
+      EpochGuard guard;
+
+      Node * p = seek(k, false);
+
+      return p != nullptr and not cmp(k, p->item.first);
+    }
+
+    Value find(const Key & k) const
+    {
+      Value ret_val;
+
+      if (not search(k, ret_val))
+	throw std::domain_error("Key not found");
+
+      return ret_val;
+    }
+
+    /// Applies op to the items, in order, while other threads work.
+    template <class Op>
+    void for_each(Op & op) const
+    {
+      EpochGuard guard;
+
+      for (Node * p = skip_removed(get_node(head[0].load()));
+	   p != nullptr; p = skip_removed(get_node(p->next()[0].load())))
+	op(p->item);
+    }
+
+    template <class Op>
+    void for_each(Op && op = Op()) const
+    {
+      for_each<Op>(op);
+    }
+
+    /// Applies op, in order, to the items whose keys are in [lo, hi].
+    template <class Op>
+    void for_each_in_range(const Key & lo, const Key & hi, Op & op) const
+    {
+      EpochGuard guard;
+
+      for (Node * p = seek(lo, false);
+	   p != nullptr and not cmp(hi, p->item.first);
+	   p = skip_removed(get_node(p->next()[0].load())))
+	op(p->item);
+    }
+
+    template <class Op>
+    void for_each_in_range(const Key & lo, const Key & hi,
+			   Op && op = Op()) const
+    {
+      for_each_in_range<Op>(lo, hi, op);
+    }
+
+    /// Checks the order of every level; only when no thread is working.
+    bool verify() const;
+
+    class Iterator : public ForwardIterator<Iterator, const Item>
+    {
+      friend class BasicIterator<Iterator, const Item>;
+
+      Node * curr   = nullptr;
+      bool   pinned = false;
+
+      void unpin()
+      {
+	if (pinned)
+	  Epoch::exit();
+
+	pinned = false;
+      }
+
+    protected:
+      const Item * get_location() const
+      {
+	return curr == nullptr ? nullptr : &curr->item;
+      }
+
+    public:
+      Iterator()
+      {
+	// empty
+      }
+
+      // p must have been read inside of a critical region.
+      Iterator(Node * p)
+	: curr(skip_removed(p))
+      {
+	if (curr != nullptr)
+	  {
+	    Epoch::enter();
+	    pinned = true;
+	  }
+      }
+
+      Iterator(const Iterator & it)
+	: curr(it.curr), pinned(it.pinned)
+      {
+	if (pinned)
+	  Epoch::enter();
+      }
+
+      Iterator & operator = (const Iterator & it)
+      {
+	if (it.pinned)
+	  Epoch::enter();
+
+	unpin();
+	curr   = it.curr;
+	pinned = it.pinned;
+	return *this;
+      }
+
+      ~Iterator()
+      {
+	unpin();
+      }
+
+      bool has_current() const
+      {
+	return curr != nullptr;
+      }
+
+      const Item & get_current() const
+      {
+	if (not has_current())
+	  throw std::overflow_error("There is not current element");
+
+	return curr->item;
+      }
+
+      void next()
+      {
+	if (not has_current())
+	  throw std::overflow_error("There is not current element");
+
+	curr = skip_removed(get_node(curr->next()[0].load()));
+
+	if (curr == nullptr)
+	  unpin();
+      }
+    };
+
+    Iterator begin() const
+    {
+      EpochGuard guard;
+      return Iterator(get_node(head[0].load()));
+    }
+
+    Iterator end() const
+    {
+      return Iterator();
+    }
+
+    /// Iterator to the first item whose key is not less than k.
+    Iterator lower_bound(const Key & k) const
+    {
+      EpochGuard guard;
+      return Iterator(seek(k, false));
+    }
+
+    /// Iterator to the first item whose key is greater than k.
+    Iterator upper_bound(const Key & k) const
+    {
+      EpochGuard guard;
+      return Iterator(seek(k, true));
+    }
+  };
+
+  template <typename Key, typename Value, class Cmp>
+  ConcurrentTreeMap<Key, Value, Cmp>::~ConcurrentTreeMap()
+  {
+    uintptr_t l = head[0].load();
+
+    while (get_node(l) != nullptr)
+      {
+	Node * p = get_node(l);
+	l = p->next()[0].load();
+	destroy_node(p);
+      }
+
+    delete [] head;
+  }
+
+  template <typename Key, typename Value, class Cmp>
+  bool ConcurrentTreeMap<Key, Value, Cmp>::
+  try_find(const Key & k, Link ** preds, Node ** succs, Node *& ret_val) const
+  {
+    Link * pred = head;
+    Node * curr = nullptr;
+
+    for (nat_t l = top_level.load(); l-- > 0; )
+      {
+	curr = get_node(pred[l].load(std::memory_order_acquire));
+
+	while (curr != nullptr)
+	  {
+	    uintptr_t succ = curr->next()[l].load(std::memory_order_acquire);
+
+	    if (is_marked(succ))
+	      {
+		uintptr_t expected = to_link(curr);
+
+		if (not pred[l].compare_exchange_strong(expected,
+							succ & ~uintptr_t(1)))
+		  return false;
+
+		curr = get_node(succ);
+		continue;
+	      }
+
+	    if (not cmp(curr->item.first, k))
+	      break;
+
+	    pred = curr->next();
+	    curr = get_node(succ);
+	  }
+
+	preds[l] = pred;
+	succs[l] = curr;
+      }
+
+    ret_val = curr != nullptr and not cmp(k, curr->item.first) ? curr : nullptr;
+    return true;
+  }
+
+  template <typename Key, typename Value, class Cmp>
+  typename ConcurrentTreeMap<Key, Value, Cmp>::Node *
+  ConcurrentTreeMap<Key, Value, Cmp>::seek(const Key & k, bool strict) const
+  {
+    Link * pred = head;
+    Node * curr = nullptr;
+
+    for (nat_t l = top_level.load(std::memory_order_acquire); l-- > 0; )
+      {
+	curr = get_node(pred[l].load(std::memory_order_acquire));
+
+	while (curr != nullptr)
+	  {
+	    uintptr_t succ = curr->next()[l].load(std::memory_order_acquire);
+
+	    if (is_marked(succ))
+	      {
+		curr = get_node(succ);
+		continue;
+	      }
+
+	    if (cmp(k, curr->item.first) or
+		(not strict and not cmp(curr->item.first, k)))
+	      break;
+
+	    pred = curr->next();
+	    curr = get_node(succ);
+	  }
+      }
+
+    return curr;
+  }
+
+  template <typename Key, typename Value, class Cmp>
+  template <typename K, typename V>
+  bool ConcurrentTreeMap<Key, Value, Cmp>::insert_node(K && k, V && v)
+  {
+    EpochGuard guard;
+
+    Link * preds[MAX_LEVEL];
+    Node * succs[MAX_LEVEL];
+
+    nat_t h = random_height();
+    raise_top_level(h);
+
+    if (find(k, preds, succs) != nullptr)
+      return false;
+
+    Node * p = create_node(std::forward<K>(k), std::forward<V>(v), h);
+
+    while (true)
+      {
+	for (nat_t l = 0; l < h; ++l)
+	  p->next()[l].store(to_link(succs[l]), std::memory_order_relaxed);
+
+	uintptr_t expected = to_link(succs[0]);
+
+	if (preds[0][0].compare_exchange_strong(expected, to_link(p)))
+	  break;
+
+	if (find(p->item.first, preds, succs) != nullptr)
+	  {
+	    destroy_node(p);
+	    return false;
+	  }
+      }
+
+    num_items.fetch_add(1, std::memory_order_relaxed);
+
+    link_upper(p, preds, succs);
+
+    // A remover may have searched p before it was linked on every level.
+    if (is_marked(p->next()[0].load()))
+      find(p->item.first, preds, succs);
+
+    finish(p);
+    return true;
+  }
+
+  template <typename Key, typename Value, class Cmp>
+  void ConcurrentTreeMap<Key, Value, Cmp>::
+  link_upper(Node * p, Link ** preds, Node ** succs)
+  {
+    for (nat_t l = 1; l < p->height; ++l)
+      while (true)
+	{
+	  uintptr_t succ = p->next()[l].load();
+
+	  // Only a remover writes the links of p meanwhile, by marking them.
+	  if (is_marked(succ) or
+	      (get_node(succ) != succs[l] and
+	       not p->next()[l].compare_exchange_strong(succ,
+							to_link(succs[l]))))
+	    return;
+
+	  uintptr_t expected = to_link(succs[l]);
+
+	  if (preds[l][l].compare_exchange_strong(expected, to_link(p)))
+	    break;
+
+	  if (find(p->item.first, preds, succs) != p)
+	    return;
+	}
+  }
+
+  template <typename Key, typename Value, class Cmp>
+  bool ConcurrentTreeMap<Key, Value, Cmp>::remove(const Key & k)
+  {
+    EpochGuard guard;
+
+    Link * preds[MAX_LEVEL];
+    Node * succs[MAX_LEVEL];
+
+    Node * p = find(k, preds, succs);
+
+    if (p == nullptr)
+      return false;
+
+    for (nat_t l = p->height; l-- > 1; )
+      {
+	uintptr_t succ = p->next()[l].load();
+
+	while (not is_marked(succ) and
+	       not p->next()[l].compare_exchange_weak(succ, succ | 1))
+	  ; // succ was refreshed by the failed exchange
+      }
+
+    uintptr_t succ = p->next()[0].load();
+
+    while (true)
+      {
+	if (is_marked(succ))
+	  return false; // another thread removed it first
+
+	if (p->next()[0].compare_exchange_weak(succ, succ | 1))
+	  break;
+      }
+
+    num_items.fetch_sub(1, std::memory_order_relaxed);
+
+    find(k, preds, succs);
+    finish(p);
+    return true;
+  }
+
+  template <typename Key, typename Value, class Cmp>
+  void ConcurrentTreeMap<Key, Value, Cmp>::clear()
+  {
+    EpochGuard guard;
+
+    for (Node * p = skip_removed(get_node(head[0].load())); p != nullptr;
+	 p = skip_removed(get_node(head[0].load())))
+      remove(p->item.first);
+  }
+
+  template <typename Key, typename Value, class Cmp>
+  bool ConcurrentTreeMap<Key, Value, Cmp>::verify() const
+  {
+    nat_t n = 0;
+
+    for (nat_t l = 0; l < MAX_LEVEL; ++l)
+      {
+	Node * prev = nullptr;
+
+	for (uintptr_t p = head[l].load(); get_node(p) != nullptr;
+	     p = get_node(p)->next()[l].load())
+	  {
+	    Node * curr = get_node(p);
+
+	    if (is_marked(p) or l >= curr->height or l >= top_level.load())
+	      return false;
+
+	    if (prev != nullptr and not cmp(prev->item.first, curr->item.first))
+	      return false;
+
+	    if (l == 0)
+	      ++n;
+
+	    prev = curr;
+	  }
+      }
+
+    return n == size();
+  }
+
 } // end namespace Designar
@@ -0,0 +1,100 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <threadpool.hpp>
+#include <range.hpp>
+
+namespace Designar
+{
+  /** How the positions of a range are distributed among the workers.
+   *
+   *  STATIC gives one contiguous block to each worker. DYNAMIC hands out
+   *  chunks of grain positions on demand. GUIDED hands out chunks which
+   *  shrink as the work runs out, never smaller than grain.
+   */
+  enum class Schedule
+    {
+      STATIC,
+      DYNAMIC,
+      GUIDED
+    };
+
+  using ChunkBody = std::function<void(nat_t, nat_t, nat_t)>;
+
+  /** Splits the positions [0, n) into chunks and runs body(b, e, w) on
+   *  every chunk [b, e), where w < num_workers identifies the worker.
+   *
+   *  The calling thread works as worker 0 and the others run on pool.
+   *
+   *  @return The number of workers used.
+   */
+  nat_t parallel_chunks(nat_t n, Schedule, nat_t grain, ThreadPool &,
+			const ChunkBody & body);
+
+  /// Number of workers parallel_chunks() would use for n positions.
+  nat_t num_workers_for(nat_t n, nat_t grain, ThreadPool &);
+
+  /** Calls op(item) for every item of r in parallel.
+   *
+   *  Items are computed as r.at(i), so splitting the range is O(1).
+   */
+  template <typename T, class Op>
+  void parallel_for(const Range<T> & r, Op && op,
+		    Schedule schedule = Schedule::STATIC, nat_t grain = 1,
+		    ThreadPool & pool = ThreadPool::shared())
+  {
+    parallel_chunks(r.size(), schedule, grain, pool,
+		    [&r, &op] (nat_t b, nat_t e, nat_t)
+		    {
+		      for (nat_t i = b; i < e; ++i)
+			op(r.at(i));
+		    });
+  }
+
+  /** Reduces r in parallel.
+   *
+   *  Every worker folds its chunks with acc = op(item, acc) starting from
+   *  init, so init must be the identity of combine; partial results are
+   *  merged with combine(left, right) in worker order. With DYNAMIC or
+   *  GUIDED a worker owns scattered chunks, so combine must commute.
+   */
+  template <typename RetT, typename T, class Op, class Combine>
+  RetT parallel_reduce(const Range<T> & r, const RetT & init, Op && op,
+		       Combine && combine,
+		       Schedule schedule = Schedule::STATIC, nat_t grain = 1,
+		       ThreadPool & pool = ThreadPool::shared())
+  {
+    nat_t n = r.size();
+    nat_t num_workers = num_workers_for(n, grain, pool);
+
+    if (num_workers <= 1)
+      return r.fold(init, op);
+
+    // Partials are written once per chunk to avoid false sharing.
+    FixedArray<RetT> partials(num_workers, init);
+
+    parallel_chunks(n, schedule, grain, pool,
+		    [&] (nat_t b, nat_t e, nat_t w)
+		    {
+		      RetT acc = partials[w];
+
+		      for (nat_t i = b; i < e; ++i)
+			acc = op(r.at(i), acc);
+
+		      partials[w] = acc;
+		    });
+
+    RetT ret_val = partials[0];
+
+    for (nat_t w = 1; w < num_workers; ++w)
+      ret_val = combine(ret_val, partials[w]);
+
+    return ret_val;
+  }
+
+} // end namespace Designar
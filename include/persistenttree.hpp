@@ -0,0 +1,746 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <mutex>
+
+#include <epoch.hpp>
+#include <stack.hpp>
+#include <iterator.hpp>
+#include <random.hpp>
+
+namespace Designar
+{
+  /** Persistent treap with ranks.
+   *
+   *  Updates never modify a published node: insert() and remove() copy
+   *  the O(log n) nodes of the path they touch and share the rest with
+   *  the previous version, which stays valid. snapshot() hands out an
+   *  immutable version in O(1) that can be read from any thread without
+   *  locks while updates go on.
+   *
+   *  Nodes are counted by the versions and parent nodes which reference
+   *  them and freed when the count drops to zero. The reference of the
+   *  tree to its current root is released through Epoch::retire(), since
+   *  a reader taking a snapshot may have loaded the old root and not yet
+   *  counted its reference. Updates are serialized by a mutex.
+   *
+   *  Usage example:
+   *  \code{.cpp}
+   *  PersistentTreap<int_t> tree = {1, 2, 3};
+   *  auto s = tree.snapshot();
+   *  tree.remove(2);
+   *  assert(s.contains(2) and not tree.snapshot().contains(2));
+   *  \endcode
+   */
+  template <typename Key, class Cmp = std::less<Key>>
+  class PersistentTreap
+  {
+    struct Node
+    {
+      Key                key;
+      Node             * lchild = nullptr;
+      Node             * rchild = nullptr;
+      nat_t              count  = 1;
+      rng_seed_t         prior  = 0;
+      std::atomic<nat_t> refs;
+
+      Node(const Key & k)
+	: key(k), refs(1)
+      {
+	// empty
+      }
+
+      Node(Key && k)
+	: key(std::forward<Key>(k)), refs(1)
+      {
+	// empty
+      }
+    };
+
+    static nat_t count(Node * p)
+    {
+      return p == nullptr ? 0 : p->count;
+    }
+
+    static void update(Node * p)
+    {
+      p->count = count(p->lchild) + count(p->rchild) + 1;
+    }
+
+    static Node * retain(Node * p)
+    {
+      if (p != nullptr)
+	p->refs.fetch_add(1, std::memory_order_relaxed);
+
+      return p;
+    }
+
+    static void release(Node *);
+
+    static void release_root(void * p)
+    {
+      release(static_cast<Node *>(p));
+    }
+
+    static Node * clone(Node *);
+
+    static void set_left(Node * p, Node * l)
+    {
+      release(p->lchild);
+      p->lchild = l;
+      update(p);
+    }
+
+    static void set_right(Node * p, Node * r)
+    {
+      release(p->rchild);
+      p->rchild = r;
+      update(p);
+    }
+
+    static void split(Node *, const Key &, Node *&, Node *&, Cmp &);
+
+    static Node * join(Node *, Node *);
+
+    static Node * insert(Node *, Node *, Cmp &);
+
+    static Node * remove(Node *, const Key &, Cmp &);
+
+    static Node * search(Node *, const Key &, Cmp &);
+
+    static bool verify(Node *, Cmp &);
+
+    static nat_t rank(Node *, const Key &, Cmp &, bool);
+
+    template <class Op>
+    static void range_rec(Node *, const Key &, const Key &, Op &, Cmp &);
+
+    std::atomic<Node *> root;
+    std::mutex          mtx;
+    Cmp               & cmp;
+    rng_t               rng;
+
+    void publish(Node * r)
+    {
+      Node * old = root.exchange(r, std::memory_order_acq_rel);
+
+      if (old != nullptr)
+	Epoch::retire(old, &release_root);
+    }
+
+  public:
+    using ItemType  = Key;
+    using KeyType   = Key;
+    using DataType  = Key;
+    using ValueType = Key;
+    using SizeType  = nat_t;
+    using CmpType   = Cmp;
+
+    /** Immutable version of the tree.
+     *
+     *  It owns a reference to its root, so it stays valid whatever happens
+     *  to the tree, even after the tree is destroyed. Copies are O(1).
+     */
+    class Snapshot
+    {
+      friend class PersistentTreap;
+
+      Node * root = nullptr;
+      Cmp  * cmp_ptr = nullptr;
+
+      Snapshot(Node * r, Cmp & cmp)
+	: root(r), cmp_ptr(&cmp)
+      {
+	// empty
+      }
+
+    public:
+      Snapshot()
+      {
+	// empty
+      }
+
+      Snapshot(const Snapshot & s)
+	: root(retain(s.root)), cmp_ptr(s.cmp_ptr)
+      {
+	// empty
+      }
+
+      Snapshot(Snapshot && s)
+      {
+	swap(s);
+      }
+
+      ~Snapshot()
+      {
+	release(root);
+      }
+
+      Snapshot & operator = (const Snapshot & s)
+      {
+	Snapshot cpy = s;
+	swap(cpy);
+	return *this;
+      }
+
+      Snapshot & operator = (Snapshot && s)
+      {
+	swap(s);
+	return *this;
+      }
+
+      void swap(Snapshot & s)
+      {
+	std::swap(root, s.root);
+	std::swap(cmp_ptr, s.cmp_ptr);
+      }
+
+      bool verify() const
+      {
+	return root == nullptr or PersistentTreap::verify(root, *cmp_ptr);
+      }
+
+      bool is_empty() const
+      {
+	return root == nullptr;
+      }
+
+      nat_t size() const
+      {
+	return count(root);
+      }
+
+      const Key * search(const Key & k) const
+      {
+	Node * p = PersistentTreap::search(root, k, *cmp_ptr);
+	return p == nullptr ? nullptr : &p->key;
+      }
+
+      bool contains(const Key & k) const
+      {
+	return search(k) != nullptr;
+      }
+
+      bool has(const Key & k) const
+      {
+	return contains(k);
+      }
+
+      const Key & find(const Key & k) const
+      {
+	const Key * result = search(k);
+
+	if (result == nullptr)
+	  throw std::domain_error("Key not found");
+
+	return *result;
+      }
+
+      const Key & select(nat_t) const;
+
+      const Key & operator [] (nat_t i) const
+      {
+	return select(i);
+      }
+
+      int_t position(const Key & k) const
+      {
+	if (not contains(k))
+	  return -1;
+
+	return rank(root, k, *cmp_ptr, false);
+      }
+
+      /// Number of keys k such that lo <= k <= hi.
+      nat_t count_range(const Key & lo, const Key & hi) const
+      {
+	if (root == nullptr or (*cmp_ptr)(hi, lo))
+	  return 0;
+
+	return rank(root, hi, *cmp_ptr, true) -
+	  rank(root, lo, *cmp_ptr, false);
+      }
+
+      /// Applies op to the keys k such that lo <= k <= hi, in order.
+      template <class Op>
+      void for_each_in_range(const Key & lo, const Key & hi, Op & op) const
+      {
+	range_rec<Op>(root, lo, hi, op, *cmp_ptr);
+      }
+
+      template <class Op>
+      void for_each_in_range(const Key & lo, const Key & hi,
+			     Op && op = Op()) const
+      {
+	for_each_in_range<Op>(lo, hi, op);
+      }
+
+      const Key & min() const
+      {
+	if (is_empty())
+	  throw std::underflow_error("Tree is empty");
+
+	return select(0);
+      }
+
+      const Key & max() const
+      {
+	if (is_empty())
+	  throw std::underflow_error("Tree is empty");
+
+	return select(size() - 1);
+      }
+
+      template <class Op>
+      void for_each(Op & op) const
+      {
+	for (const Key & k : *this)
+	  op(k);
+      }
+
+      template <class Op>
+      void for_each(Op && op = Op()) const
+      {
+	for_each<Op>(op);
+      }
+
+      /// In-order iterator; valid while the snapshot lives.
+      class Iterator : public ForwardIterator<Iterator, const Key>
+      {
+	friend class BasicIterator<Iterator, const Key>;
+
+	InlineStack<Node *, TreeIteratorStackSize> stack;
+
+	void push_min(Node * p)
+	{
+	  for ( ; p != nullptr; p = p->lchild)
+	    {
+	      prefetch(p->rchild);
+	      stack.push(p);
+	    }
+	}
+
+      protected:
+	const Key * get_location() const
+	{
+	  return stack.is_empty() ? nullptr : &stack.top()->key;
+	}
+
+      public:
+	Iterator()
+	{
+	  // empty
+	}
+
+	Iterator(const Snapshot & s)
+	{
+	  push_min(s.root);
+	}
+
+	bool has_current() const
+	{
+	  return not stack.is_empty();
+	}
+
+	const Key & get_current() const
+	{
+	  if (not has_current())
+	    throw std::overflow_error("There is not current element");
+
+	  return stack.top()->key;
+	}
+
+	void next()
+	{
+	  if (not has_current())
+	    throw std::overflow_error("There is not current element");
+
+	  push_min(stack.pop()->rchild);
+	}
+      };
+
+      Iterator begin() const
+      {
+	return Iterator(*this);
+      }
+
+      Iterator end() const
+      {
+	return Iterator();
+      }
+    };
+
+    PersistentTreap(rng_seed_t seed, Cmp & _cmp)
+      : root(nullptr), cmp(_cmp), rng(seed)
+    {
+      // empty
+    }
+
+    PersistentTreap(Cmp & _cmp)
+      : PersistentTreap(time(nullptr), _cmp)
+    {
+      // empty
+    }
+
+    PersistentTreap(Cmp && _cmp = Cmp())
+      : PersistentTreap(_cmp)
+    {
+      // empty
+    }
+
+    PersistentTreap(rng_seed_t seed, Cmp && _cmp = Cmp())
+      : PersistentTreap(seed, _cmp)
+    {
+      // empty
+    }
+
+    /// O(1): both trees share the nodes until they are updated.
+    PersistentTreap(const PersistentTreap & t)
+      : PersistentTreap(t.cmp)
+    {
+      Snapshot s = t.snapshot();
+      root = s.root;
+      s.root = nullptr;
+    }
+
+    PersistentTreap(const std::initializer_list<Key> & l)
+      : PersistentTreap()
+    {
+      for (const Key & k : l)
+	insert(k);
+    }
+
+    PersistentTreap & operator = (const PersistentTreap &) = delete;
+
+    ~PersistentTreap()
+    {
+      release(root.load());
+    }
+
+    Cmp & get_cmp()
+    {
+      return cmp;
+    }
+
+    const Cmp & get_cmp() const
+    {
+      return cmp;
+    }
+
+    /** Current version of the tree, in O(1) and without locks.
+     *
+     *  Later updates are not seen by the returned snapshot.
+     */
+    Snapshot snapshot() const
+    {
+      EpochGuard guard;
+      Node * r = retain(root.load(std::memory_order_acquire));
+      return Snapshot(r, cmp);
+    }
+
+    bool is_empty() const
+    {
+      return root.load(std::memory_order_acquire) == nullptr;
+    }
+
+    nat_t size() const
+    {
+      return snapshot().size();
+    }
+
+    bool contains(const Key & k) const
+    {
+      return snapshot().contains(k);
+    }
+
+    bool has(const Key & k) const
+    {
+      return contains(k);
+    }
+
+    /// Returns false, and leaves the tree as it was, if k already is in.
+    bool insert(const Key & k)
+    {
+      Node * p = new Node(k);
+      return insert(p);
+    }
+
+    bool insert(Key && k)
+    {
+      Node * p = new Node(std::forward<Key>(k));
+      return insert(p);
+    }
+
+    bool append(const Key & k)
+    {
+      return insert(k);
+    }
+
+    bool append(Key && k)
+    {
+      return insert(std::forward<Key>(k));
+    }
+
+    bool remove(const Key & k)
+    {
+      std::lock_guard<std::mutex> lck(mtx);
+
+      Node * r = root.load(std::memory_order_relaxed);
+
+      if (search(r, k, cmp) == nullptr)
+	return false;
+
+      publish(remove(r, k, cmp));
+      return true;
+    }
+
+    void clear()
+    {
+      std::lock_guard<std::mutex> lck(mtx);
+      publish(nullptr);
+    }
+
+  private:
+    bool insert(Node * p)
+    {
+      std::lock_guard<std::mutex> lck(mtx);
+
+      Node * r = root.load(std::memory_order_relaxed);
+
+      if (search(r, p->key, cmp) != nullptr)
+	{
+	  delete p;
+	  return false;
+	}
+
+      p->prior = rng();
+      publish(insert(r, p, cmp));
+      return true;
+    }
+  };
+
+  template <typename Key, class Cmp>
+  void PersistentTreap<Key, Cmp>::release(Node * p)
+  {
+    if (p == nullptr or p->refs.fetch_sub(1, std::memory_order_acq_rel) > 1)
+      return;
+
+    release(p->lchild);
+    release(p->rchild);
+    delete p;
+  }
+
+  // Unpublished copy of p, which shares the children of p.
+  template <typename Key, class Cmp>
+  typename PersistentTreap<Key, Cmp>::Node *
+  PersistentTreap<Key, Cmp>::clone(Node * p)
+  {
+    Node * q = new Node(p->key);
+    q->lchild = retain(p->lchild);
+    q->rchild = retain(p->rchild);
+    q->count = p->count;
+    q->prior = p->prior;
+    return q;
+  }
+
+  // The nodes of ts and tg on the path to k are new copies.
+  template <typename Key, class Cmp>
+  void PersistentTreap<Key, Cmp>::split(Node * r, const Key & k,
+					Node *& ts, Node *& tg, Cmp & cmp)
+  {
+    if (r == nullptr)
+      {
+	ts = tg = nullptr;
+	return;
+      }
+
+    Node * p = clone(r);
+
+    if (cmp(k, r->key))
+      {
+	Node * l;
+	split(r->lchild, k, ts, l, cmp);
+	set_left(p, l);
+	tg = p;
+      }
+    else
+      {
+	Node * g;
+	split(r->rchild, k, g, tg, cmp);
+	set_right(p, g);
+	ts = p;
+      }
+  }
+
+  template <typename Key, class Cmp>
+  typename PersistentTreap<Key, Cmp>::Node *
+  PersistentTreap<Key, Cmp>::join(Node * ts, Node * tg)
+  {
+    if (ts == nullptr)
+      return retain(tg);
+
+    if (tg == nullptr)
+      return retain(ts);
+
+    if (ts->prior < tg->prior)
+      {
+	Node * p = clone(ts);
+	set_right(p, join(ts->rchild, tg));
+	return p;
+      }
+
+    Node * p = clone(tg);
+    set_left(p, join(ts, tg->lchild));
+    return p;
+  }
+
+  // New version of r with p, which is not in r, inserted.
+  template <typename Key, class Cmp>
+  typename PersistentTreap<Key, Cmp>::Node *
+  PersistentTreap<Key, Cmp>::insert(Node * r, Node * p, Cmp & cmp)
+  {
+    if (r == nullptr)
+      return p;
+
+    if (p->prior < r->prior)
+      {
+	split(r, p->key, p->lchild, p->rchild, cmp);
+	update(p);
+	return p;
+      }
+
+    Node * q = clone(r);
+
+    if (cmp(p->key, r->key))
+      set_left(q, insert(r->lchild, p, cmp));
+    else
+      set_right(q, insert(r->rchild, p, cmp));
+
+    return q;
+  }
+
+  // New version of r without k, which is in r.
+  template <typename Key, class Cmp>
+  typename PersistentTreap<Key, Cmp>::Node *
+  PersistentTreap<Key, Cmp>::remove(Node * r, const Key & k, Cmp & cmp)
+  {
+    if (cmp(k, r->key))
+      {
+	Node * q = clone(r);
+	set_left(q, remove(r->lchild, k, cmp));
+	return q;
+      }
+
+    if (cmp(r->key, k))
+      {
+	Node * q = clone(r);
+	set_right(q, remove(r->rchild, k, cmp));
+	return q;
+      }
+
+    return join(r->lchild, r->rchild);
+  }
+
+  template <typename Key, class Cmp>
+  typename PersistentTreap<Key, Cmp>::Node *
+  PersistentTreap<Key, Cmp>::search(Node * r, const Key & k, Cmp & cmp)
+  {
+    while (r != nullptr)
+      if (cmp(k, r->key))
+	r = r->lchild;
+      else if (cmp(r->key, k))
+	r = r->rchild;
+      else
+	return r;
+
+    return nullptr;
+  }
+
+  template <typename Key, class Cmp>
+  bool PersistentTreap<Key, Cmp>::verify(Node * r, Cmp & cmp)
+  {
+    if (r == nullptr)
+      return true;
+
+    Node * l = r->lchild;
+    Node * g = r->rchild;
+
+    if (l != nullptr and (not cmp(l->key, r->key) or l->prior < r->prior))
+      return false;
+
+    if (g != nullptr and (not cmp(r->key, g->key) or g->prior < r->prior))
+      return false;
+
+    if (r->count != count(l) + count(g) + 1)
+      return false;
+
+    return verify(l, cmp) and verify(g, cmp);
+  }
+
+  // Number of keys less than k, or not greater than k if inclusive.
+  template <typename Key, class Cmp>
+  nat_t PersistentTreap<Key, Cmp>::rank(Node * r, const Key & k, Cmp & cmp,
+					bool inclusive)
+  {
+    nat_t ret_val = 0;
+
+    while (r != nullptr)
+      if (inclusive ? cmp(k, r->key) : not cmp(r->key, k))
+	r = r->lchild;
+      else
+	{
+	  ret_val += count(r->lchild) + 1;
+	  r = r->rchild;
+	}
+
+    return ret_val;
+  }
+
+  template <typename Key, class Cmp>
+  template <class Op>
+  void PersistentTreap<Key, Cmp>::range_rec(Node * r, const Key & lo,
+					    const Key & hi, Op & op,
+					    Cmp & cmp)
+  {
+    if (r == nullptr)
+      return;
+
+    bool over_lo = not cmp(r->key, lo);
+    bool under_hi = not cmp(hi, r->key);
+
+    if (over_lo)
+      range_rec(r->lchild, lo, hi, op, cmp);
+
+    if (over_lo and under_hi)
+      op(r->key);
+
+    if (under_hi)
+      range_rec(r->rchild, lo, hi, op, cmp);
+  }
+
+  template <typename Key, class Cmp>
+  const Key & PersistentTreap<Key, Cmp>::Snapshot::select(nat_t i) const
+  {
+    if (i >= size())
+      throw std::out_of_range("Infix position is out of range");
+
+    Node * r = root;
+
+    while (i != count(r->lchild))
+      if (i < count(r->lchild))
+	r = r->lchild;
+      else
+	{
+	  i -= count(r->lchild) + 1;
+	  r = r->rchild;
+	}
+
+    return r->key;
+  }
+
+} // end namespace Designar
@@ -0,0 +1,564 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <string>
+#include <exception>
+
+#include <queue.hpp>
+#include <heap.hpp>
+#include <now.hpp>
+
+namespace Designar
+{
+  /** Multi-stage streaming pipeline.
+   *
+   *  A pipeline begins with a source (a generator called until it returns
+   *  false), followed by any number of transformation stages and ends in
+   *  a sink. Every stage runs on its own threads with a given parallelism
+   *  degree and stages are connected by bounded queues, so a slow stage
+   *  throttles the ones before it instead of accumulating items.
+   *
+   *  Items travel between stages in batches of batch_size items. Each
+   *  batch is numbered by the source; an ORDERED stage emits batches in
+   *  that order even if its workers finish them out of order, so an
+   *  ORDERED sink sees items exactly as the source produced them.
+   *
+   *  stop() makes the source stop producing; items already in flight are
+   *  still processed, so every stage drains before the pipeline ends. If
+   *  a stage function throws, the pipeline stops and wait() rethrows the
+   *  first exception.
+   *
+   *  Usage example:
+   *  \code{.cpp}
+   *  Pipeline pipeline;
+   *  nat_t i = 0;
+   *  nat_t sum = 0; // the sink runs on a single thread by default
+   *
+   *  pipeline.source<nat_t>([&i] (nat_t & item) {
+   *                           item = i++;
+   *                           return i <= 1000000; })
+   *    .then([] (nat_t item) { return item * item; }, 4)
+   *    .sink([&sum] (nat_t item) { sum += item; });
+   *
+   *  pipeline.run();
+   *  \endcode
+   *
+   *  @ingroup utils
+   */
+  class Pipeline
+  {
+  public:
+    enum class Ordering
+      {
+	UNORDERED,
+	ORDERED
+      };
+
+    struct StageStats
+    {
+      std::string name;
+      nat_t       parallelism;
+      bool        ordered;
+      nat_t       num_items;
+      nat_t       num_batches;
+      nat_t       queue_depth;     // batches waiting in its input queue
+      nat_t       max_queue_depth;
+      double      elapsed;         // milliseconds
+
+      /// Processed items per second.
+      double throughput() const
+      {
+	return elapsed > 0 ? num_items * 1000.0 / elapsed : 0;
+      }
+    };
+
+    template <typename T> class Stage;
+
+  private:
+    template <typename T>
+    struct Batch
+    {
+      nat_t       seq = 0;
+      DynArray<T> items;
+    };
+
+    template <typename T>
+    using Channel = BoundedConcurrentQueue<Batch<T>>;
+
+    // Releases batches in sequence order.
+    template <typename T>
+    class Sequencer
+    {
+      struct Cmp
+      {
+	bool operator () (const Batch<T> & a, const Batch<T> & b) const
+	{
+	  return a.seq < b.seq;
+	}
+      };
+
+      std::mutex              mtx;
+      Cmp                     cmp;
+      DynHeap<Batch<T>, Cmp>  pending;
+      nat_t                   next_seq;
+
+    public:
+      Sequencer()
+	: pending(cmp), next_seq(0)
+      {
+	// empty
+      }
+
+      template <class Op>
+      void emit(Batch<T> &&, Op &);
+    };
+
+    class BaseStage
+    {
+      friend class Pipeline;
+
+      std::atomic<nat_t>  active;
+      std::atomic<double> end_time;
+
+    protected:
+      Pipeline                & pipeline;
+      std::string               name;
+      nat_t                     parallelism;
+      Ordering                  ordering;
+      FixedArray<std::thread>   workers;
+      bool                      connected;
+      time_point_t              start_time;
+      std::atomic<nat_t>        num_items;
+      std::atomic<nat_t>        num_batches;
+      std::atomic<nat_t>        max_queue_depth;
+
+      void update_counters(nat_t items, nat_t depth);
+
+      // Loop executed by every worker thread.
+      virtual void work() = 0;
+
+      // Called by the last worker when it finishes.
+      virtual void finish() = 0;
+
+      virtual nat_t queue_depth() const = 0;
+
+      virtual bool has_output() const = 0;
+
+      void run_worker();
+
+    public:
+      BaseStage(Pipeline &, const std::string &, nat_t, Ordering);
+
+      BaseStage(const BaseStage &) = delete;
+
+      BaseStage & operator = (const BaseStage &) = delete;
+
+      virtual ~BaseStage();
+
+      void start();
+
+      void join();
+
+      StageStats stats() const;
+    };
+
+    template <typename T, class Gen>
+    class SourceStage : public BaseStage
+    {
+      friend class Pipeline;
+
+      Gen        gen;
+      Channel<T> out;
+
+      void work() override;
+
+      void finish() override
+      {
+	out.close();
+      }
+
+      nat_t queue_depth() const override
+      {
+	return 0;
+      }
+
+      bool has_output() const override
+      {
+	return true;
+      }
+
+    public:
+      SourceStage(Pipeline & p, const std::string & n, Gen & g)
+	: BaseStage(p, n, 1, Ordering::ORDERED), gen(g),
+	  out(p.queue_capacity)
+      {
+	// empty
+      }
+    };
+
+    template <typename In, typename Out, class Op>
+    class MapStage : public BaseStage
+    {
+      friend class Pipeline;
+
+      Op             op;
+      Channel<In>  & in;
+      Channel<Out>   out;
+      Sequencer<Out> sequencer;
+
+      void work() override;
+
+      void finish() override
+      {
+	out.close();
+      }
+
+      nat_t queue_depth() const override
+      {
+	return in.size();
+      }
+
+      bool has_output() const override
+      {
+	return true;
+      }
+
+    public:
+      MapStage(Pipeline & p, const std::string & n, nat_t par, Ordering ord,
+	       Op & _op, Channel<In> & _in)
+	: BaseStage(p, n, par, ord), op(_op), in(_in), out(p.queue_capacity)
+      {
+	// empty
+      }
+    };
+
+    template <typename In, class Op>
+    class SinkStage : public BaseStage
+    {
+      friend class Pipeline;
+
+      Op            op;
+      Channel<In> & in;
+      Sequencer<In> sequencer;
+
+      void work() override;
+
+      void finish() override
+      {
+	// empty
+      }
+
+      nat_t queue_depth() const override
+      {
+	return in.size();
+      }
+
+      bool has_output() const override
+      {
+	return false;
+      }
+
+    public:
+      SinkStage(Pipeline & p, const std::string & n, nat_t par, Ordering ord,
+		Op & _op, Channel<In> & _in)
+	: BaseStage(p, n, par, ord), op(_op), in(_in)
+      {
+	// empty
+      }
+    };
+
+    nat_t                  queue_capacity;
+    nat_t                  batch_size;
+    DynArray<BaseStage *>  stages;
+    bool                   started;
+    bool                   joined;
+    std::atomic<bool>      stop_requested;
+    std::atomic<bool>      failed;
+    std::mutex             error_mtx;
+    std::exception_ptr     error;
+
+    void fail(std::exception_ptr);
+
+    std::string stage_name(const std::string &) const;
+
+    void connect(BaseStage *);
+
+    template <typename T, class Op>
+    Stage<std::decay_t<std::result_of_t<Op(T &)>>>
+    add_map(BaseStage *, Channel<T> &, Op &, nat_t, Ordering,
+	    const std::string &);
+
+    template <typename T, class Op>
+    void add_sink(BaseStage *, Channel<T> &, Op &, nat_t, Ordering,
+		  const std::string &);
+
+  public:
+    /** Builds an empty pipeline.
+     *
+     *  @param queue_cap Number of batches each queue between stages holds.
+     *  @param batch Number of items per batch.
+     */
+    Pipeline(nat_t queue_cap = 64, nat_t batch = 64);
+
+    Pipeline(const Pipeline &) = delete;
+
+    Pipeline & operator = (const Pipeline &) = delete;
+
+    /// Stops the pipeline, drains it and waits for every stage.
+    ~Pipeline();
+
+    nat_t get_queue_capacity() const
+    {
+      return queue_capacity;
+    }
+
+    nat_t get_batch_size() const
+    {
+      return batch_size;
+    }
+
+    nat_t num_stages() const
+    {
+      return stages.size();
+    }
+
+    /** Adds a source stage.
+     *
+     *  gen is called with a reference to fill as bool gen(T & item) and
+     *  returns false when there are no more items.
+     */
+    template <typename T, class Gen>
+    Stage<T> source(Gen gen, const std::string & name = "");
+
+    /// Launches the threads of every stage.
+    void start();
+
+    /// Waits for the pipeline to drain; rethrows a stage exception.
+    void wait();
+
+    /// Equivalent to start() followed by wait().
+    void run()
+    {
+      start();
+      wait();
+    }
+
+    /// Requests a graceful shutdown: the sources stop producing.
+    void stop()
+    {
+      stop_requested = true;
+    }
+
+    bool is_stopped() const
+    {
+      return stop_requested;
+    }
+
+    /// Counters of every stage in the order they were added.
+    DynArray<StageStats> stats() const;
+  };
+
+  /// Handle to the output of a stage, used to chain the next one.
+  template <typename T>
+  class Pipeline::Stage
+  {
+    friend class Pipeline;
+
+    Pipeline   * pipeline;
+    BaseStage  * owner;
+    Channel<T> * channel;
+
+    Stage(Pipeline * p, BaseStage * o, Channel<T> * c)
+      : pipeline(p), owner(o), channel(c)
+    {
+      // empty
+    }
+
+  public:
+    using ItemType = T;
+
+    /** Adds a stage which transforms every item with op(T &).
+     *
+     *  @param op Transformation; its result is the item of the next stage.
+     *  @param parallelism Number of threads running op.
+     *  @param ordering If ORDERED, items leave in source order.
+     *  @param name Name shown in the stats.
+     */
+    template <class Op>
+    Stage<std::decay_t<std::result_of_t<Op(T &)>>>
+    then(Op op, nat_t parallelism = 1,
+	 Ordering ordering = Ordering::UNORDERED,
+	 const std::string & name = "")
+    {
+      return pipeline->add_map(owner, *channel, op, parallelism, ordering,
+			       name);
+    }
+
+    /// Adds the final stage, which consumes every item with op(T &).
+    template <class Op>
+    void sink(Op op, nat_t parallelism = 1,
+	      Ordering ordering = Ordering::UNORDERED,
+	      const std::string & name = "")
+    {
+      pipeline->add_sink(owner, *channel, op, parallelism, ordering, name);
+    }
+  };
+
+  template <typename T>
+  template <class Op>
+  void Pipeline::Sequencer<T>::emit(Batch<T> && batch, Op & deliver)
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+
+    if (batch.seq != next_seq)
+      {
+	pending.insert(std::move(batch));
+	return;
+      }
+
+    deliver(batch);
+    ++next_seq;
+
+    while (not pending.is_empty() and pending.top().seq == next_seq)
+      {
+	Batch<T> b = pending.get();
+	deliver(b);
+	++next_seq;
+      }
+  }
+
+  template <typename T, class Gen>
+  void Pipeline::SourceStage<T, Gen>::work()
+  {
+    nat_t seq = 0;
+    bool more = true;
+
+    while (more and not pipeline.stop_requested)
+      {
+	Batch<T> batch;
+	batch.seq = seq;
+
+	T item;
+
+	while (batch.items.size() < pipeline.batch_size and (more = gen(item)))
+	  batch.items.append(std::move(item));
+
+	if (batch.items.is_empty())
+	  break;
+
+	update_counters(batch.items.size(), 0);
+	out.put(std::move(batch));
+	++seq;
+      }
+  }
+
+  template <typename In, typename Out, class Op>
+  void Pipeline::MapStage<In, Out, Op>::work()
+  {
+    auto deliver = [this] (Batch<Out> & b) { out.put(std::move(b)); };
+
+    Batch<In> batch;
+
+    while (in.get(batch))
+      {
+	nat_t depth = in.size();
+
+	Batch<Out> result;
+	result.seq = batch.seq;
+
+	// After a failure batches keep flowing empty, so the stages drain.
+	if (not pipeline.failed)
+	  try
+	    {
+	      for (nat_t i = 0; i < batch.items.size(); ++i)
+		result.items.append(op(batch.items[i]));
+	    }
+	  catch (...)
+	    {
+	      pipeline.fail(std::current_exception());
+	      result.items.clear();
+	    }
+
+	update_counters(result.items.size(), depth);
+
+	if (ordering == Ordering::ORDERED)
+	  sequencer.emit(std::move(result), deliver);
+	else
+	  deliver(result);
+      }
+  }
+
+  template <typename In, class Op>
+  void Pipeline::SinkStage<In, Op>::work()
+  {
+    auto deliver = [this] (Batch<In> & b)
+      {
+	if (pipeline.failed)
+	  return;
+
+	try
+	  {
+	    for (nat_t i = 0; i < b.items.size(); ++i)
+	      op(b.items[i]);
+	  }
+	catch (...)
+	  {
+	    pipeline.fail(std::current_exception());
+	  }
+      };
+
+    Batch<In> batch;
+
+    while (in.get(batch))
+      {
+	update_counters(batch.items.size(), in.size());
+
+	if (ordering == Ordering::ORDERED)
+	  sequencer.emit(std::move(batch), deliver);
+	else
+	  deliver(batch);
+      }
+  }
+
+  template <typename T, class Gen>
+  Pipeline::Stage<T> Pipeline::source(Gen gen, const std::string & name)
+  {
+    auto stage = new SourceStage<T, Gen>(*this, stage_name(name), gen);
+    stages.append(stage);
+    return Stage<T>(this, stage, &stage->out);
+  }
+
+  template <typename T, class Op>
+  Pipeline::Stage<std::decay_t<std::result_of_t<Op(T &)>>>
+  Pipeline::add_map(BaseStage * prev, Channel<T> & in, Op & op,
+		    nat_t parallelism, Ordering ordering,
+		    const std::string & name)
+  {
+    using Out = std::decay_t<std::result_of_t<Op(T &)>>;
+
+    connect(prev);
+
+    auto stage = new MapStage<T, Out, Op>(*this, stage_name(name),
+					  parallelism, ordering, op, in);
+    stages.append(stage);
+    return Stage<Out>(this, stage, &stage->out);
+  }
+
+  template <typename T, class Op>
+  void Pipeline::add_sink(BaseStage * prev, Channel<T> & in, Op & op,
+			  nat_t parallelism, Ordering ordering,
+			  const std::string & name)
+  {
+    connect(prev);
+
+    auto stage = new SinkStage<T, Op>(*this, stage_name(name), parallelism,
+				      ordering, op, in);
+    stages.append(stage);
+  }
+
+} // end namespace Designar
@@ -8,6 +8,7 @@
 
 #include <array.hpp>
 #include <list.hpp>
+#include <epoch.hpp>
 
 namespace Designar
 {
@@ -549,5 +550,468 @@ namespace Designar
       return queue.is_empty();
     }
   };
+
+  /** Blocking queue with a maximum capacity.
+   *
+   *  put() blocks while the queue is full and get() blocks while it is
+   *  empty. Once close() is called no more items are accepted and get()
+   *  returns false when the remaining items have been consumed, so
+   *  consumers drain the queue before they finish.
+   */
+  template <typename T, class Queue = ListQueue<T>>
+  class BoundedConcurrentQueue
+  {
+    std::mutex              mtx;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    Queue                   queue;
+    nat_t                   cap;
+    bool                    closed;
+
+  public:
+    using ItemType  = T;
+    using KeyType   = T;
+    using DataType  = T;
+    using ValueType = T;
+    using SizeType  = nat_t;
+
+    BoundedConcurrentQueue(nat_t _cap)
+      : queue(), cap(_cap), closed(false)
+    {
+      if (cap == 0)
+	throw std::domain_error("Capacity must be greater than zero");
+    }
+
+    BoundedConcurrentQueue(const BoundedConcurrentQueue &) = delete;
+
+    BoundedConcurrentQueue &
+    operator = (const BoundedConcurrentQueue &) = delete;
+
+    void put(const T & item)
+    {
+      T cpy = item;
+      put(std::move(cpy));
+    }
+
+    void put(T && item)
+    {
+      std::unique_lock<std::mutex> lck(mtx);
+      not_full.wait(lck, [this] { return closed or queue.size() < cap; });
+
+      if (closed)
+	throw std::domain_error("Queue is closed");
+
+      queue.put(std::forward<T>(item));
+      not_empty.notify_one();
+    }
+
+    /// Waits for an item; returns false if the queue is closed and empty.
+    bool get(T & item)
+    {
+      std::unique_lock<std::mutex> lck(mtx);
+      not_empty.wait(lck, [this] { return closed or not queue.is_empty(); });
+
+      if (queue.is_empty())
+	return false;
+
+      item = queue.get();
+      not_full.notify_one();
+      return true;
+    }
+
+    bool try_get(T & item)
+    {
+      std::lock_guard<std::mutex> lck(mtx);
+
+      if (queue.is_empty())
+	return false;
+
+      item = queue.get();
+      not_full.notify_one();
+      return true;
+    }
+
+    /// Stops accepting items and wakes up every waiting thread.
+    void close()
+    {
+      std::lock_guard<std::mutex> lck(mtx);
+      closed = true;
+      not_empty.notify_all();
+      not_full.notify_all();
+    }
+
+    bool is_closed() const
+    {
+      std::lock_guard<std::mutex> lck(const_cast<std::mutex &>(mtx));
+      return closed;
+    }
+
+    nat_t get_capacity() const
+    {
+      return cap;
+    }
+
+    nat_t size() const
+    {
+      std::lock_guard<std::mutex> lck(const_cast<std::mutex &>(mtx));
+      return queue.size();
+    }
+
+    bool is_empty() const
+    {
+      std::lock_guard<std::mutex> lck(const_cast<std::mutex &>(mtx));
+      return queue.is_empty();
+    }
+  };
+
+  /** Michael-Scott lock-free queue.
+   *
+   *  Unlike ConcurrentQueue, get() does not block: it throws if the queue
+   *  is empty. Dequeued nodes are reclaimed through Epoch.
+   */
+  template <typename T>
+  class ConcurrentListQueue
+  {
+    struct Node
+    {
+      T                   item;
+      std::atomic<Node *> next;
+
+      Node()
+	: item(), next(nullptr)
+      {
+	// empty
+      }
+
+      Node(const T & i)
+	: item(i), next(nullptr)
+      {
+	// empty
+      }
+
+      Node(T && i)
+	: item(std::forward<T>(i)), next(nullptr)
+      {
+	// empty
+      }
+    };
+
+    std::atomic<Node *> head;
+    std::atomic<Node *> tail;
+    std::atomic<nat_t>  num_items;
+
+    void put_node(Node *);
+
+  public:
+    using ItemType  = T;
+    using KeyType   = T;
+    using DataType  = T;
+    using ValueType = T;
+    using SizeType  = nat_t;
+
+    ConcurrentListQueue()
+      : head(new Node), tail(head.load()), num_items(0)
+    {
+      // empty
+    }
+
+    ConcurrentListQueue(const ConcurrentListQueue &) = delete;
+
+    ConcurrentListQueue & operator = (const ConcurrentListQueue &) = delete;
+
+    ~ConcurrentListQueue()
+    {
+      Node * p = head.load();
+
+      while (p != nullptr)
+	{
+	  Node * q = p->next.load();
+	  delete p;
+	  p = q;
+	}
+    }
+
+    bool is_empty() const
+    {
+      EpochGuard guard;
+      return head.load()->next.load() == nullptr;
+    }
+
+    /// Number of items; only a snapshot when other threads are working.
+    nat_t size() const
+    {
+      return num_items.load(std::memory_order_relaxed);
+    }
+
+    void clear()
+    {
+      T item;
+
+      while (try_get(item))
+	; // empty
+    }
+
+    void put(const T & item)
+    {
+      put_node(new Node(item));
+    }
+
+    void put(T && item)
+    {
+      put_node(new Node(std::forward<T>(item)));
+    }
+
+    bool try_get(T &);
+
+    T get()
+    {
+      T ret_val;
+
+      if (not try_get(ret_val))
+	throw std::underflow_error("Queue is empty");
+
+      return ret_val;
+    }
+  };
+
+  template <typename T>
+  void ConcurrentListQueue<T>::put_node(Node * p)
+  {
+    EpochGuard guard;
+
+    // Counted before p is linked, so try_get() never decrements first.
+    num_items.fetch_add(1, std::memory_order_relaxed);
+
+    while (true)
+      {
+	Node * t = tail.load();
+	Node * next = t->next.load();
+
+	if (t != tail.load())
+	  continue;
+
+	if (next != nullptr)
+	  {
+	    // Tail is lagging behind, help to move it.
+	    tail.compare_exchange_weak(t, next);
+	    continue;
+	  }
+
+	if (t->next.compare_exchange_weak(next, p))
+	  {
+	    tail.compare_exchange_strong(t, p);
+	    break;
+	  }
+      }
+  }
+
+  template <typename T>
+  bool ConcurrentListQueue<T>::try_get(T & item)
+  {
+    EpochGuard guard;
+
+    while (true)
+      {
+	Node * h = head.load();
+	Node * t = tail.load();
+	Node * next = h->next.load();
+
+	if (h != head.load())
+	  continue;
+
+	if (next == nullptr)
+	  return false;
+
+	if (h == t)
+	  {
+	    tail.compare_exchange_weak(t, next);
+	    continue;
+	  }
+
+	if (head.compare_exchange_weak(h, next))
+	  {
+	    // next is the new dummy; only this thread touches its item.
+	    item = std::move(next->item);
+	    num_items.fetch_sub(1, std::memory_order_relaxed);
+	    Epoch::retire(h);
+	    return true;
+	  }
+      }
+  }
+
+  /** Chase-Lev work-stealing deque.
+   *
+   *  Only the owner thread may call push() and try_pop(), which work on the
+   *  bottom end in LIFO order. Any other thread may call try_steal(), which
+   *  takes from the top end in FIFO order. The circular buffer grows on
+   *  demand; replaced buffers are reclaimed through Epoch because thieves
+   *  may still be reading them.
+   *
+   *  T must be trivially copyable (typically a pointer or an index) because
+   *  a thief may read a slot while the owner overwrites it.
+   */
+  template <typename T>
+  class WorkStealingDeque
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+		  "Template argument must be trivially copyable");
+
+    static constexpr nat_t MIN_SIZE = 32;
+
+    struct Buffer
+    {
+      nat_t             cap;
+      nat_t             mask;
+      std::atomic<T>  * slots;
+
+      Buffer(nat_t c)
+	: cap(c), mask(c - 1), slots(new std::atomic<T>[c])
+      {
+	assert((c & mask) == 0);
+      }
+
+      ~Buffer()
+      {
+	delete [] slots;
+      }
+
+      T get(int_t i) const
+      {
+	return slots[i & mask].load(std::memory_order_relaxed);
+      }
+
+      void put(int_t i, const T & item)
+      {
+	slots[i & mask].store(item, std::memory_order_relaxed);
+      }
+    };
+
+    std::atomic<int_t>    top;
+    std::atomic<int_t>    bottom;
+    std::atomic<Buffer *> buffer;
+
+    Buffer * grow(Buffer * a, int_t b, int_t t)
+    {
+      Buffer * new_a = new Buffer(a->cap * 2);
+
+      for (int_t i = t; i < b; ++i)
+	new_a->put(i, a->get(i));
+
+      buffer.store(new_a, std::memory_order_release);
+      Epoch::retire(a);
+
+      return new_a;
+    }
+
+  public:
+    using ItemType  = T;
+    using KeyType   = T;
+    using DataType  = T;
+    using ValueType = T;
+    using SizeType  = nat_t;
+
+    WorkStealingDeque(nat_t cap = MIN_SIZE)
+      : top(0), bottom(0), buffer(nullptr)
+    {
+      nat_t c = MIN_SIZE;
+
+      while (c < cap)
+	c <<= 1;
+
+      buffer.store(new Buffer(c));
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+
+    WorkStealingDeque & operator = (const WorkStealingDeque &) = delete;
+
+    ~WorkStealingDeque()
+    {
+      delete buffer.load();
+    }
+
+    /// Number of items; only a snapshot when thieves are working.
+    nat_t size() const
+    {
+      int_t b = bottom.load(std::memory_order_relaxed);
+      int_t t = top.load(std::memory_order_relaxed);
+      return b > t ? b - t : 0;
+    }
+
+    bool is_empty() const
+    {
+      return size() == 0;
+    }
+
+    nat_t get_capacity() const
+    {
+      return buffer.load(std::memory_order_relaxed)->cap;
+    }
+
+    void push(const T & item)
+    {
+      int_t b = bottom.load(std::memory_order_relaxed);
+      int_t t = top.load(std::memory_order_acquire);
+      Buffer * a = buffer.load(std::memory_order_relaxed);
+
+      if (b - t > int_t(a->cap) - 1)
+	a = grow(a, b, t);
+
+      a->put(b, item);
+      std::atomic_thread_fence(std::memory_order_release);
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    bool try_pop(T & item)
+    {
+      int_t b = bottom.load(std::memory_order_relaxed) - 1;
+      Buffer * a = buffer.load(std::memory_order_relaxed);
+      bottom.store(b, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int_t t = top.load(std::memory_order_relaxed);
+
+      if (t > b)
+	{
+	  bottom.store(b + 1, std::memory_order_relaxed);
+	  return false;
+	}
+
+      item = a->get(b);
+
+      if (t < b)
+	return true;
+
+      // Last item: race against thieves for it.
+      bool won = top.compare_exchange_strong(t, t + 1,
+					     std::memory_order_seq_cst,
+					     std::memory_order_relaxed);
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+
+    /// Takes the oldest item; it may fail spuriously under contention.
+    bool try_steal(T & item)
+    {
+      EpochGuard guard;
+
+      int_t t = top.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int_t b = bottom.load(std::memory_order_acquire);
+
+      if (t >= b)
+	return false;
+
+      Buffer * a = buffer.load(std::memory_order_acquire);
+      T ret_val = a->get(t);
+
+      if (not top.compare_exchange_strong(t, t + 1,
+					  std::memory_order_seq_cst,
+					  std::memory_order_relaxed))
+	return false;
+
+      item = ret_val;
+      return true;
+    }
+  };
   
 } // end namespace Designar
@@ -0,0 +1,433 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <string>
+
+#include <intutilities.hpp>
+#include <sort.hpp>
+#include <stack.hpp>
+#include <parallel.hpp>
+
+namespace Designar
+{
+  constexpr nat_t RadixBits = 8;
+
+  constexpr nat_t RadixSize = nat_t(1) << RadixBits;
+
+  template <class ArrayType, class Key>
+  void radix_sort(ArrayType &, int_t, int_t, Key &);
+
+  template <class ArrayType, class Key>
+  void parallel_radix_sort(ArrayType &, int_t, int_t, Key &, ThreadPool &);
+
+  template <class ArrayType>
+  void msd_radix_sort(ArrayType &, int_t, int_t);
+
+  template <class ArrayType>
+  void american_flag_sort(ArrayType &, int_t, int_t);
+
+  template <class ArrayType, class Key>
+  inline auto radix_key_of(const ArrayType & a, nat_t i, Key & key)
+  {
+    return radix_key(key(a[i]));
+  }
+
+  template <class ArrayType, class Key>
+  void radix_insertion_sort(ArrayType & a, int_t l, int_t r, Key & key)
+  {
+    auto cmp = [&key] (const typename ArrayType::DataType & x,
+		       const typename ArrayType::DataType & y)
+      {
+	return radix_key(key(x)) < radix_key(key(y));
+      };
+
+    insertion_sort(a, l, r, cmp);
+  }
+
+  /* Moves src[sl + i] to dst[dl + offset[digit]] for i in [0, n), bumping
+   * the offset of the digit each time. Equal digits keep their order.
+   */
+  template <class SrcArray, class TgtArray, class Key>
+  void radix_scatter(SrcArray & src, nat_t sl, TgtArray & dst, nat_t dl,
+		     nat_t n, nat_t shift, nat_t * offset, Key & key)
+  {
+    for (nat_t i = 0; i < n; ++i)
+      {
+	nat_t digit = (radix_key_of(src, sl + i, key) >> shift) &
+	  (RadixSize - 1);
+	dst[dl + offset[digit]++] = std::move(src[sl + i]);
+      }
+  }
+
+  /** Sorts a[l..r] by radix_key(key(item)) with an LSD radix sort.
+   *
+   *  One pass over the items counts every digit; then there is one
+   *  stable scatter per byte of the key, skipping bytes where all keys
+   *  agree. It is stable and needs a buffer of r - l + 1 items. Ranges
+   *  under QuicksortThreshold items are insertion sorted.
+   */
+  template <class ArrayType, class Key>
+  void radix_sort(ArrayType & a, int_t l, int_t r, Key & key)
+  {
+    if (r - l < QuicksortThreshold)
+      {
+	radix_insertion_sort(a, l, r, key);
+	return;
+      }
+
+    using KeyType = decltype(radix_key_of(a, l, key));
+
+    constexpr nat_t NUM_DIGITS = sizeof(KeyType) * 8 / RadixBits;
+
+    nat_t n = r - l + 1;
+    nat_t count[NUM_DIGITS][RadixSize] = { };
+
+    for (nat_t i = l; i <= nat_t(r); ++i)
+      {
+	KeyType k = radix_key_of(a, i, key);
+
+	for (nat_t d = 0; d < NUM_DIGITS; ++d)
+	  ++count[d][(k >> (d * RadixBits)) & (RadixSize - 1)];
+      }
+
+    KeyType first = radix_key_of(a, l, key);
+
+    FixedArray<typename ArrayType::DataType> buf(n);
+    bool in_buf = false;
+
+    for (nat_t d = 0; d < NUM_DIGITS; ++d)
+      {
+	nat_t shift = d * RadixBits;
+
+	if (count[d][(first >> shift) & (RadixSize - 1)] == n)
+	  continue;
+
+	nat_t sum = 0;
+
+	for (nat_t c = 0; c < RadixSize; ++c)
+	  {
+	    nat_t t = count[d][c];
+	    count[d][c] = sum;
+	    sum += t;
+	  }
+
+	if (in_buf)
+	  radix_scatter(buf, 0, a, l, n, shift, count[d], key);
+	else
+	  radix_scatter(a, l, buf, 0, n, shift, count[d], key);
+
+	in_buf = not in_buf;
+      }
+
+    if (in_buf)
+      for (nat_t i = 0; i < n; ++i)
+	a[l + i] = std::move(buf[i]);
+  }
+
+  template <class ArrayType, class Key = RadixIdentity>
+  inline void radix_sort(ArrayType & a, int_t l, int_t r, Key && key = Key())
+  {
+    radix_sort<ArrayType, Key>(a, l, r, key);
+  }
+
+  template <class ArrayType, class Key>
+  inline void radix_sort(ArrayType & a, Key & key)
+  {
+    radix_sort(a, 0, a.size() - 1, key);
+  }
+
+  template <class ArrayType, class Key = RadixIdentity>
+  inline void radix_sort(ArrayType & a, Key && key = Key())
+  {
+    radix_sort<ArrayType, Key>(a, key);
+  }
+
+  /** Sorts a[l..r] by radix_key(key(item)) with an LSD radix sort on pool.
+   *
+   *  Every pass splits the range into one block per worker. Each worker
+   *  counts the digits of its block into its own histogram, the
+   *  histograms are turned into disjoint offsets (digit major, worker
+   *  minor) and each worker scatters its block without synchronization.
+   *  It is stable. Ranges up to ParallelSortThreshold items are sorted by
+   *  radix_sort().
+   */
+  template <class ArrayType, class Key>
+  void parallel_radix_sort(ArrayType & a, int_t l, int_t r, Key & key,
+			   ThreadPool & pool)
+  {
+    if (r - l < ParallelSortThreshold)
+      {
+	radix_sort(a, l, r, key);
+	return;
+      }
+
+    using KeyType = decltype(radix_key_of(a, l, key));
+
+    constexpr nat_t NUM_DIGITS = sizeof(KeyType) * 8 / RadixBits;
+
+    const nat_t n     = r - l + 1;
+    const nat_t grain = ParallelSortThreshold;
+    const nat_t num_workers = num_workers_for(n, grain, pool);
+
+    FixedArray<typename ArrayType::DataType> buf(n);
+    FixedArray<nat_t> hist(num_workers * RadixSize);
+    bool in_buf = false;
+
+    for (nat_t d = 0; d < NUM_DIGITS; ++d)
+      {
+	nat_t shift = d * RadixBits;
+
+	auto count = [&] (auto & src, nat_t sl, nat_t b, nat_t e, nat_t w)
+	  {
+	    nat_t * h = &hist[w * RadixSize];
+
+	    std::fill(h, h + RadixSize, 0);
+
+	    for (nat_t i = b; i < e; ++i)
+	      ++h[(radix_key_of(src, sl + i, key) >> shift) & (RadixSize - 1)];
+	  };
+
+	parallel_chunks(n, Schedule::STATIC, grain, pool,
+			[&] (nat_t b, nat_t e, nat_t w)
+			{
+			  if (in_buf)
+			    count(buf, 0, b, e, w);
+			  else
+			    count(a, l, b, e, w);
+			});
+
+	nat_t sum = 0;
+	bool trivial = false;
+
+	for (nat_t c = 0; c < RadixSize; ++c)
+	  {
+	    nat_t prev = sum;
+
+	    for (nat_t w = 0; w < num_workers; ++w)
+	      {
+		nat_t t = hist[w * RadixSize + c];
+		hist[w * RadixSize + c] = sum;
+		sum += t;
+	      }
+
+	    trivial = trivial or sum - prev == n;
+	  }
+
+	if (trivial)
+	  continue;
+
+	parallel_chunks(n, Schedule::STATIC, grain, pool,
+			[&] (nat_t b, nat_t e, nat_t w)
+			{
+			  nat_t * offset = &hist[w * RadixSize];
+
+			  if (in_buf)
+			    radix_scatter(buf, b, a, l, e - b, shift, offset,
+					  key);
+			  else
+			    radix_scatter(a, l + b, buf, 0, e - b, shift,
+					  offset, key);
+			});
+
+	in_buf = not in_buf;
+      }
+
+    if (in_buf)
+      parallel_chunks(n, Schedule::STATIC, grain, pool,
+		      [&a, &buf, l] (nat_t b, nat_t e, nat_t)
+		      {
+			for (nat_t i = b; i < e; ++i)
+			  a[l + i] = std::move(buf[i]);
+		      });
+  }
+
+  template <class ArrayType, class Key = RadixIdentity>
+  inline void parallel_radix_sort(ArrayType & a, int_t l, int_t r,
+				  Key && key = Key(),
+				  ThreadPool & pool = ThreadPool::shared())
+  {
+    parallel_radix_sort<ArrayType, Key>(a, l, r, key, pool);
+  }
+
+  template <class ArrayType, class Key>
+  inline void parallel_radix_sort(ArrayType & a, Key & key,
+				  ThreadPool & pool = ThreadPool::shared())
+  {
+    parallel_radix_sort(a, 0, a.size() - 1, key, pool);
+  }
+
+  template <class ArrayType, class Key = RadixIdentity>
+  inline void parallel_radix_sort(ArrayType & a, Key && key = Key(),
+				  ThreadPool & pool = ThreadPool::shared())
+  {
+    parallel_radix_sort<ArrayType, Key>(a, key, pool);
+  }
+
+  /* Byte d of s shifted by one, so the end of the string is digit 0 and
+   * shorter strings go first.
+   */
+  inline nat_t string_digit(const std::string & s, nat_t d)
+  {
+    return d < s.size() ? nat_t((unsigned char) s[d]) + 1 : 0;
+  }
+
+  constexpr nat_t StringRadixSize = 257;
+
+  // A bucket a[l, r) whose strings share their first d bytes.
+  struct StringBucket
+  {
+    nat_t l;
+    nat_t r;
+    nat_t d;
+  };
+
+  // Stable insertion sort of a[l, r) skipping the d shared bytes.
+  template <class ArrayType>
+  void string_insertion_sort(ArrayType & a, nat_t l, nat_t r, nat_t d)
+  {
+    for (nat_t i = l + 1; i < r; ++i)
+      {
+	std::string s = std::move(a[i]);
+
+	nat_t j = i;
+
+	for ( ; j > l and s.compare(d, std::string::npos,
+				     a[j - 1], d, std::string::npos) < 0; --j)
+	  a[j] = std::move(a[j - 1]);
+
+	a[j] = std::move(s);
+      }
+  }
+
+  /** Sorts the strings of a[l..r] with an MSD radix sort.
+   *
+   *  Buckets are distributed byte by byte through a buffer of r - l + 1
+   *  strings and kept on an explicit stack, so long common prefixes do not
+   *  grow the call stack. Buckets under QuicksortThreshold strings are
+   *  insertion sorted. It is stable.
+   */
+  template <class ArrayType>
+  void msd_radix_sort(ArrayType & a, int_t l, int_t r)
+  {
+    if (l >= r)
+      return;
+
+    FixedArray<std::string> buf(r - l + 1);
+    DynStack<StringBucket> stack;
+
+    stack.push(StringBucket{nat_t(l), nat_t(r) + 1, 0});
+
+    while (not stack.is_empty())
+      {
+	StringBucket b = stack.pop();
+
+	if (b.r - b.l < nat_t(QuicksortThreshold))
+	  {
+	    string_insertion_sort(a, b.l, b.r, b.d);
+	    continue;
+	  }
+
+	nat_t count[StringRadixSize + 1] = { };
+
+	for (nat_t i = b.l; i < b.r; ++i)
+	  ++count[string_digit(a[i], b.d) + 1];
+
+	for (nat_t c = 0; c < StringRadixSize; ++c)
+	  count[c + 1] += count[c];
+
+	for (nat_t i = b.l; i < b.r; ++i)
+	  {
+	    nat_t c = string_digit(a[i], b.d);
+	    buf[count[c]++] = std::move(a[i]);
+	  }
+
+	for (nat_t i = b.l; i < b.r; ++i)
+	  a[i] = std::move(buf[i - b.l]);
+
+	// count[c] is now the end of bucket c; bucket 0 is already done.
+	for (nat_t c = 1; c < StringRadixSize; ++c)
+	  if (count[c] - count[c - 1] > 1)
+	    stack.push(StringBucket{b.l + count[c - 1], b.l + count[c],
+		  b.d + 1});
+      }
+  }
+
+  template <class ArrayType>
+  inline void msd_radix_sort(ArrayType & a)
+  {
+    msd_radix_sort(a, 0, a.size() - 1);
+  }
+
+  /** Sorts the strings of a[l..r] with American flag sort.
+   *
+   *  It is the in-place MSD radix sort: after counting a bucket, strings
+   *  are swapped along permutation cycles straight into their sub-bucket,
+   *  so no buffer is needed. Buckets are kept on an explicit stack and
+   *  those under QuicksortThreshold strings are insertion sorted. It is
+   *  not stable.
+   */
+  template <class ArrayType>
+  void american_flag_sort(ArrayType & a, int_t l, int_t r)
+  {
+    if (l >= r)
+      return;
+
+    DynStack<StringBucket> stack;
+
+    stack.push(StringBucket{nat_t(l), nat_t(r) + 1, 0});
+
+    while (not stack.is_empty())
+      {
+	StringBucket b = stack.pop();
+
+	if (b.r - b.l < nat_t(QuicksortThreshold))
+	  {
+	    string_insertion_sort(a, b.l, b.r, b.d);
+	    continue;
+	  }
+
+	nat_t count[StringRadixSize] = { };
+
+	for (nat_t i = b.l; i < b.r; ++i)
+	  ++count[string_digit(a[i], b.d)];
+
+	nat_t next[StringRadixSize];
+	nat_t end[StringRadixSize];
+	nat_t sum = b.l;
+
+	for (nat_t c = 0; c < StringRadixSize; ++c)
+	  {
+	    next[c] = sum;
+	    sum += count[c];
+	    end[c] = sum;
+	  }
+
+	for (nat_t c = 0; c < StringRadixSize; ++c)
+	  while (next[c] < end[c])
+	    {
+	      nat_t x = string_digit(a[next[c]], b.d);
+
+	      if (x == c)
+		++next[c];
+	      else
+		std::swap(a[next[c]], a[next[x]++]);
+	    }
+
+	for (nat_t c = 1; c < StringRadixSize; ++c)
+	  if (count[c] > 1)
+	    stack.push(StringBucket{end[c] - count[c], end[c], b.d + 1});
+      }
+  }
+
+  template <class ArrayType>
+  inline void american_flag_sort(ArrayType & a)
+  {
+    american_flag_sort(a, 0, a.size() - 1);
+  }
+
+} // end namespace Designar
@@ -28,10 +28,35 @@ namespace Designar
     using SizeType  = nat_t;
 
   private:
+    using BaseAlgorithms = ContainerAlgorithms<Range<T>, T>;
+
+    template <class Op>
+    struct is_plus : std::false_type { };
+
+    template <typename U>
+    struct is_plus<std::plus<U>> : std::true_type { };
+
     T first;
     T last;
     T step;
 
+    template <typename RetT, class Op>
+    RetT fold_dispatch(const RetT & init_val, Op & op, std::false_type) const
+    {
+      return BaseAlgorithms::fold(init_val, op);
+    }
+
+    template <typename RetT, class Op>
+    RetT fold_dispatch(const RetT & init_val, Op & op, std::true_type) const
+    {
+      nat_t n = size();
+
+      // n * (n - 1) / 2 without overflowing before the division.
+      nat_t pairs = n % 2 == 0 ? (n / 2) * (n - 1) : n * ((n - 1) / 2);
+
+      return op(T(n) * first + T(pairs) * step, init_val);
+    }
+
   public:
     Range(T _first, T _last, T _step = T(1))
       : first(_first), last(_last), step(_step)
@@ -75,6 +100,40 @@ namespace Designar
       return std::ceil(double(last - first) / step);
     }
 
+    /// Value at position i, computed as min() + i * step_size().
+    T at(nat_t i) const
+    {
+      return first + T(i) * step;
+    }
+
+    /// Subrange with the items at positions [b, e).
+    Range slice(nat_t b, nat_t e) const
+    {
+      e = std::min(e, size());
+      b = std::min(b, e);
+      
+      return Range(at(b), b == e ? at(b) : std::min(at(e), last), step);
+    }
+
+    /** Folds the range with op(item, acc).
+     *
+     *  Sums of integral ranges with std::plus are computed in O(1) as the
+     *  sum of an arithmetic progression; other folds visit every item.
+     */
+    template <typename RetT = T, class Op>
+    RetT fold(const RetT & init_val, Op && op = Op()) const
+    {
+      return fold_dispatch(init_val, op,
+			   std::integral_constant<bool, std::is_integral<T>::value
+			   and is_plus<std::decay_t<Op>>::value>());
+    }
+
+    /// Sum of the items in O(1) for integral types.
+    T sum() const
+    {
+      return fold(T(0), std::plus<T>());
+    }
+
     bool operator == (const Range & r) const
     {
       return num_equal(first, r.first) and num_equal(last, r.last)
@@ -108,7 +167,7 @@ namespace Designar
       }
 
       Iterator(const Range & _r, nat_t pos)
-	: r(_r), c((r.max() - r.min()) * pos), p(pos)
+	: r(_r), c(r.at(pos)), p(pos)
       {
 	// empty
       }
@@ -141,7 +200,7 @@ namespace Designar
 	  return;
 
 	p = std::min(p + n, r.size());
-	c = std::min(c + r.step_size() * n, r.size() * r.step_size());
+	c = r.at(p);
       }
 
       void prev()
@@ -164,13 +223,14 @@ namespace Designar
 
       void reset_first()
       {
+	p = 0;
 	c = r.min();
       }
 
       void reset_last()
       {
 	p = r.size() - 1;
-	c = p * r.step();
+	c = r.at(p);
       }
     };
 
@@ -0,0 +1,323 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <sort.hpp>
+#include <intutilities.hpp>
+
+namespace Designar
+{
+  /** Frozen copy of a sorted array laid out in Eytzinger (breadth-first)
+   *  order: the children of slot k are slots 2k and 2k + 1.
+   *
+   *  The first levels of the implicit tree share a few cache lines, and
+   *  the descent computes the next slot without branches while it
+   *  prefetches the cache line holding the descendants of the current
+   *  slot a few levels ahead. The tree is padded to a complete one with
+   *  copies of the greatest key, so ranks are computed from slots in
+   *  O(1); it takes up to twice the memory of the keys.
+   *
+   *  Positions returned are ranks in the sorted order of the source.
+   */
+  template <typename Key, class Cmp = std::less<Key>>
+  class EytzingerArray
+  {
+    // Keys in a cache line: the prefetch distance in slots per level.
+    static constexpr nat_t LINE_KEYS =
+      sizeof(Key) < 64 ? 64 / sizeof(Key) : 1;
+
+    FixedArray<Key> tree;
+    nat_t n;
+    nat_t height;
+    Cmp cmp;
+
+    template <class ArrayType>
+    nat_t fill(const ArrayType & a, nat_t k, nat_t i)
+    {
+      if (k >= tree.size())
+	return i;
+
+      i = fill(a, 2 * k, i);
+      tree[k] = a[std::min(i, n - 1)];
+
+      return fill(a, 2 * k + 1, i + 1);
+    }
+
+    // In-order position of slot k in the complete tree.
+    nat_t rank_of(nat_t k) const
+    {
+      nat_t d = floor_log2(k);
+
+      return ((2 * (k - (nat_t(1) << d)) + 1) << (height - 1 - d)) - 1;
+    }
+
+    nat_t slot_of(nat_t r) const
+    {
+      nat_t p = r + 1;
+      nat_t z = count_trailing_zeros(p);
+
+      return (nat_t(1) << (height - 1 - z)) + (p >> (z + 1));
+    }
+
+    // Slot of the first key for which go_right is false; 0 if none.
+    template <class GoRight>
+    nat_t descend(GoRight && go_right) const
+    {
+      const Key * t = &tree[0];
+      const nat_t m = tree.size();
+
+      nat_t k = 1;
+
+      while (k < m)
+	{
+	  prefetch(t + k * LINE_KEYS);
+	  k = 2 * k + nat_t(go_right(t[k]));
+	}
+
+      // Undoes the right turns after the last left one.
+      return k >> (count_trailing_zeros(~k) + 1);
+    }
+
+  public:
+    /// Builds the layout from the n sorted items a[0..n - 1].
+    template <class ArrayType>
+    EytzingerArray(const ArrayType & a, Cmp _cmp = Cmp())
+      : tree(nat_t(1) << (a.size() == 0 ? 0 : floor_log2(a.size()) + 1)),
+	n(a.size()), height(floor_log2(tree.size())), cmp(_cmp)
+    {
+      if (n > 0)
+	fill(a, 1, 0);
+    }
+
+    nat_t size() const
+    {
+      return n;
+    }
+
+    bool is_empty() const
+    {
+      return n == 0;
+    }
+
+    /// Key of rank i.
+    const Key & select(nat_t i) const
+    {
+      if (i >= n)
+	throw std::out_of_range("Index out of range");
+
+      return tree[slot_of(i)];
+    }
+
+    /// Rank of the first key which is not less than k.
+    nat_t lower_bound(const Key & k) const
+    {
+      nat_t slot = descend([this, &k] (const Key & x) { return cmp(x, k); });
+
+      return slot == 0 ? n : std::min(rank_of(slot), n);
+    }
+
+    /// Rank of the first key which is greater than k.
+    nat_t upper_bound(const Key & k) const
+    {
+      nat_t slot = descend([this, &k] (const Key & x)
+			   {
+			     return not cmp(k, x);
+			   });
+
+      return slot == 0 ? n : std::min(rank_of(slot), n);
+    }
+
+    std::pair<nat_t, nat_t> equal_range(const Key & k) const
+    {
+      return std::make_pair(lower_bound(k), upper_bound(k));
+    }
+
+    const Key * search(const Key & k) const
+    {
+      nat_t slot = descend([this, &k] (const Key & x) { return cmp(x, k); });
+
+      if (slot == 0 or cmp(k, tree[slot]))
+	return nullptr;
+
+      return &tree[slot];
+    }
+
+    bool contains(const Key & k) const
+    {
+      return search(k) != nullptr;
+    }
+  };
+
+  /** Frozen copy of a sorted array laid out as a static B+ tree (S-tree)
+   *  with nodes of STreeBlockSize keys.
+   *
+   *  The leaves hold the keys in sorted order, padded with copies of the
+   *  greatest key, and the internal layers are stored above them, so a
+   *  lookup reads one node per layer: about log(n) / log(17) nodes. Inside
+   *  a node the position is the number of keys which compare less, a
+   *  fixed-length loop without branches that compilers turn into vector
+   *  comparisons for plain numbers. Ranks are positions in the leaves.
+   */
+  template <typename Key, class Cmp = std::less<Key>>
+  class STreeArray
+  {
+    static constexpr nat_t B = STreeBlockSize;
+
+    FixedArray<Key> tree;
+    FixedArray<nat_t> offset;
+    nat_t n;
+    nat_t height;
+    Cmp cmp;
+
+    static nat_t num_blocks(nat_t m)
+    {
+      return (m + B - 1) / B;
+    }
+
+    // Keys of the layer above one with m keys.
+    static nat_t prev_keys(nat_t m)
+    {
+      return (num_blocks(m) + B) / (B + 1) * B;
+    }
+
+    static nat_t height_for(nat_t m)
+    {
+      nat_t h = 1;
+
+      for ( ; m > B; m = prev_keys(m))
+	++h;
+
+      return h;
+    }
+
+    static FixedArray<nat_t> offsets_for(nat_t m, nat_t h)
+    {
+      FixedArray<nat_t> ret_val(h + 1);
+
+      ret_val[0] = 0;
+
+      for (nat_t i = 0; i < h; ++i, m = prev_keys(m))
+	ret_val[i + 1] = ret_val[i] + num_blocks(m) * B;
+
+      return ret_val;
+    }
+
+    template <class Less>
+    static nat_t rank_in_node(const Key * node, Less & less)
+    {
+      nat_t r = 0;
+
+      for (nat_t j = 0; j < B; ++j)
+	r += nat_t(less(node[j]));
+
+      return r;
+    }
+
+    template <class Less>
+    nat_t descend(Less && less) const
+    {
+      const Key * t = &tree[0];
+
+      nat_t k = 0;
+
+      for (nat_t h = height - 1; h > 0; --h)
+	k = k * (B + 1) + rank_in_node(t + offset[h] + k, less) * B;
+
+      return k + rank_in_node(t + k, less);
+    }
+
+  public:
+    /// Builds the layout from the n sorted items a[0..n - 1].
+    template <class ArrayType>
+    STreeArray(const ArrayType & a, Cmp _cmp = Cmp())
+      : tree(1), offset(1), n(a.size()), height(0), cmp(_cmp)
+    {
+      if (n == 0)
+	return;
+
+      height = height_for(n);
+      offset = offsets_for(n, height);
+      tree = FixedArray<Key>(offset[height]);
+
+      const Key & max = a[n - 1];
+
+      for (nat_t i = 0; i < offset[1]; ++i)
+	tree[i] = i < n ? a[i] : max;
+
+      // Every key of a layer is the smallest one to its right below.
+      for (nat_t h = 1; h < height; ++h)
+	for (nat_t i = 0; i < offset[h + 1] - offset[h]; ++i)
+	  {
+	    nat_t k = i / B * (B + 1) + i % B + 1;
+
+	    for (nat_t l = 1; l < h; ++l)
+	      k *= B + 1;
+
+	    tree[offset[h] + i] = k * B < n ? tree[k * B] : max;
+	  }
+    }
+
+    nat_t size() const
+    {
+      return n;
+    }
+
+    bool is_empty() const
+    {
+      return n == 0;
+    }
+
+    /// Key of rank i.
+    const Key & select(nat_t i) const
+    {
+      if (i >= n)
+	throw std::out_of_range("Index out of range");
+
+      return tree[i];
+    }
+
+    /// Rank of the first key which is not less than k.
+    nat_t lower_bound(const Key & k) const
+    {
+      // Past the greatest key the padding would be counted.
+      if (n == 0 or cmp(tree[n - 1], k))
+	return n;
+
+      return descend([this, &k] (const Key & x) { return cmp(x, k); });
+    }
+
+    /// Rank of the first key which is greater than k.
+    nat_t upper_bound(const Key & k) const
+    {
+      if (n == 0 or not cmp(k, tree[n - 1]))
+	return n;
+
+      return descend([this, &k] (const Key & x) { return not cmp(k, x); });
+    }
+
+    std::pair<nat_t, nat_t> equal_range(const Key & k) const
+    {
+      return std::make_pair(lower_bound(k), upper_bound(k));
+    }
+
+    const Key * search(const Key & k) const
+    {
+      nat_t r = lower_bound(k);
+
+      if (r == n or cmp(k, tree[r]))
+	return nullptr;
+
+      return &tree[r];
+    }
+
+    bool contains(const Key & k) const
+    {
+      return search(k) != nullptr;
+    }
+  };
+
+} // end namespace Designar
@@ -72,7 +72,46 @@ namespace Designar
 
     int_t search(const Key & k, int_t l, int_t r) const
     {
-      return binary_search(array, k, l, r, cmp);
+      return Designar::lower_bound(array, l, r + 1, k, cmp);
+    }
+
+    /* Sorts a and keeps the first of every run of equal items. The sort
+     * is stable so the first one is that of the input; input which is
+     * already a set is detected in O(n).
+     */
+    static void make_set(DynArray<Key> & a, Cmp & cmp)
+    {
+      nat_t i = 1;
+
+      while (i < a.size() and cmp(a[i - 1], a[i]))
+	++i;
+
+      if (i >= a.size())
+	return;
+
+      stable_sort(a, cmp);
+
+      nat_t k = 0;
+
+      for (i = 1; i < a.size(); ++i)
+	if (cmp(a[k], a[i]) and ++k != i)
+	  a[k] = std::move(a[i]);
+
+      while (a.size() > k + 1)
+	a.remove_last();
+    }
+
+    template <class ContainerType>
+    static DynArray<Key> make_set(const ContainerType & c, Cmp & cmp)
+    {
+      DynArray<Key> ret_val(c.size() + 1);
+
+      for (const Key & item : c)
+	ret_val.append(item);
+
+      make_set(ret_val, cmp);
+
+      return ret_val;
     }
 
   public:
@@ -81,12 +120,65 @@ namespace Designar
     {
       // empty
     }
+
+    /// Position of the first item which is not less than k.
+    nat_t lower_bound(const Key & k) const
+    {
+      return Designar::lower_bound(array, 0, array.size(), k, cmp);
+    }
+
+    /// Position of the first item which is greater than k.
+    nat_t upper_bound(const Key & k) const
+    {
+      return Designar::upper_bound(array, 0, array.size(), k, cmp);
+    }
+
+    /// Positions [lower_bound(k), upper_bound(k)).
+    std::pair<nat_t, nat_t> equal_range(const Key & k) const
+    {
+      return Designar::equal_range(array, 0, array.size(), k, cmp);
+    }
     
     bool is_sorted() const
     {
       return true;
     }
 
+    /** Replaces the items by those of c, which may come in any order, in
+     *  O(n log n) instead of the O(n^2) of inserting them one by one. Of
+     *  the items which compare equal, the first one in c is kept.
+     */
+    template <class ContainerType>
+    void build_from_unsorted(const ContainerType & c)
+    {
+      DynArray<Key> items = make_set(c, cmp);
+      array.swap(items);
+    }
+
+    void build_from_unsorted(DynArray<Key> && a)
+    {
+      array.swap(a);
+      make_set(array, cmp);
+    }
+
+    /** Inserts the items of c which are not in the set. The m items of c
+     *  are sorted and merged with the n of the set in O(n + m log m).
+     *  Returns the number of items inserted.
+     */
+    template <class ContainerType>
+    nat_t insert_bulk(const ContainerType & c)
+    {
+      DynArray<Key> items = make_set(c, cmp);
+      DynArray<Key> merged(array.size() + items.size() + 1);
+
+      sorted_union(array, items, merged, cmp);
+
+      nat_t ret_val = merged.size() - array.size();
+      array.swap(merged);
+
+      return ret_val;
+    }
+
     Key * insert(const Key & item)
     {
       int_t pos = search(item, 0, array.size() - 1);
@@ -525,6 +617,54 @@ namespace Designar
   {
     using Base = GenArraySet<Key, Cmp, SortedArraySetOp<Key, Cmp>>;
     using Base::Base;
+
+  public:
+    SortedArraySet(const std::initializer_list<Key> & l)
+      : Base(l.size() + 1)
+    {
+      this->build_from_unsorted(l);
+    }
+
+    // The set algebra merges both arrays instead of inserting items.
+
+    static SortedArraySet join(const SortedArraySet & s1,
+			       const SortedArraySet & s2)
+    {
+      SortedArraySet ret_val(s1.size() + s2.size() + 1, s1.cmp);
+      sorted_union(s1.array, s2.array, ret_val.array, ret_val.cmp);
+      return ret_val;
+    }
+
+    SortedArraySet join(const SortedArraySet & s) const
+    {
+      return join(*this, s);
+    }
+
+    static SortedArraySet intersect(const SortedArraySet & s1,
+				    const SortedArraySet & s2)
+    {
+      SortedArraySet ret_val(std::min(s1.size(), s2.size()) + 1, s1.cmp);
+      sorted_intersection(s1.array, s2.array, ret_val.array, ret_val.cmp);
+      return ret_val;
+    }
+
+    SortedArraySet intersect(const SortedArraySet & s) const
+    {
+      return intersect(*this, s);
+    }
+
+    static SortedArraySet difference(const SortedArraySet & s1,
+				     const SortedArraySet & s2)
+    {
+      SortedArraySet ret_val(s1.size() + 1, s1.cmp);
+      sorted_difference(s1.array, s2.array, ret_val.array, ret_val.cmp);
+      return ret_val;
+    }
+
+    SortedArraySet difference(const SortedArraySet & s) const
+    {
+      return difference(*this, s);
+    }
   };
 
   template <typename Key, class Cmp = std::less<Key>,
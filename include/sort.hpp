@@ -8,6 +8,7 @@
 
 #include <array.hpp>
 #include <list.hpp>
+#include <threadpool.hpp>
 
 namespace Designar
 {
@@ -33,12 +34,57 @@ namespace Designar
   template <typename ArrayType, class Cmp>
   void quicksort(ArrayType &, int_t, int_t, Cmp &);
 
+  template <class ArrayType, typename T, class Cmp>
+  int_t lower_bound(const ArrayType &, int_t, int_t, const T &, Cmp &);
+
+  template <class ArrayType, typename T, class Cmp>
+  int_t upper_bound(const ArrayType &, int_t, int_t, const T &, Cmp &);
+
+  template <class ArrayType, class Cmp>
+  void nth_element(ArrayType &, int_t, int_t, int_t, Cmp &);
+
+  template <class ArrayType, class Cmp>
+  void partial_sort(ArrayType &, int_t, int_t, int_t, Cmp &);
+
+  template <class It, class Cmp>
+  auto top_k_it(const It &, const It &, nat_t, Cmp &);
+
+  template <class It, class Cmp>
+  auto top_k_unsorted_it(const It &, const It &, nat_t, Cmp &);
+
+  template <class ArrayType, class Cmp>
+  void parallel_sort(ArrayType &, int_t, int_t, Cmp &, ThreadPool &);
+
+  template <class ArrayType, class Cmp>
+  void parallel_stable_sort(ArrayType &, int_t, int_t, Cmp &, ThreadPool &);
+
   template <typename T, class Cmp>
   void sift_up(T *, nat_t, nat_t, Cmp &);
 
   template <typename T, class Cmp>
   void sift_down(T *, nat_t, nat_t, Cmp &);
 
+  template <class ArrayType, class Cmp>
+  void make_heap(ArrayType &, int_t, int_t, Cmp &);
+
+  template <class ArrayType, class Cmp>
+  void push_heap(ArrayType &, int_t, int_t, Cmp &);
+
+  template <class ArrayType, class Cmp>
+  void pop_heap(ArrayType &, int_t, int_t, Cmp &);
+
+  template <class ArrayType, class Cmp>
+  void sort_heap(ArrayType &, int_t, int_t, Cmp &);
+
+  template <class ArrayType, class Cmp>
+  bool is_heap(const ArrayType &, int_t, int_t, Cmp &);
+
+  template <class ArrayType, class Cmp>
+  void heapsort(ArrayType &, int_t, int_t, Cmp &);
+
+  template <class ArrayType, class Cmp>
+  void stable_sort(ArrayType &, int_t, int_t, Cmp &);
+
   template <typename T, class Cmp>
   std::tuple<NodeSLList<T>, typename NodeSLList<T>::Node *, NodeSLList<T>>
   partition(NodeSLList<T> &, Cmp &);
@@ -52,6 +98,18 @@ namespace Designar
   template <class Cmp>
   void quicksort(DL &, Cmp &);
 
+  template <class Node, class Next, class Cmp>
+  Node * merge_chains(Node *, Node *, Node *, Node *, Node *&, Next &, Cmp &);
+
+  template <class Node, class Next, class Cmp>
+  Node * natural_merge_sort(Node *, Node *&, Next &, Cmp &);
+
+  template <typename T, class Cmp>
+  void mergesort(NodeSLList<T> &, Cmp &);
+
+  template <class Cmp>
+  void mergesort(DL &, Cmp &);
+
   template <class ArrayType>
   ArrayType reverse(const ArrayType &);
 
@@ -196,9 +254,16 @@ namespace Designar
     
     int_t m = (l + r) / 2;
 
-    int_t partial_min = cmp(a[l], a[m]) ? l : m;
+    int_t lo = l, hi = m;
 
-    return cmp(a[partial_min], a[r]) ? partial_min : r;    
+    if (cmp(a[hi], a[lo]))
+      std::swap(lo, hi);
+
+    // Median of a[l], a[m] and a[r].
+    if (cmp(a[r], a[lo]))
+      return lo;
+
+    return cmp(a[r], a[hi]) ? r : hi;
   }
 
   template <typename ArrayType, class Cmp>
@@ -230,231 +295,2002 @@ namespace Designar
     return i;
   }
 
-  template <typename ArrayType, class Cmp>
-  void quicksort(ArrayType & a, int_t l, int_t r, Cmp & cmp)
+  /* Moves v into the hole h[i] of the heap h[0, n), whose subtrees below
+   * the hole are heaps. Bottom-up (Wegener): the hole sinks to a leaf along
+   * the greater children with one comparison per level and v rises from
+   * there, usually a level or two, since v mostly comes from the bottom of
+   * the heap.
+   */
+  template <typename T, class Cmp>
+  void heap_hole_sift(T * h, nat_t i, nat_t n, T v, Cmp & cmp)
   {
-    if (l >= r)
-      return;
-    
-    if (r - l + 1 <= QuicksortThreshold)
+    nat_t top = i;
+    nat_t c = 2 * i + 1;
+
+    while (c + 1 < n)
       {
-	insertion_sort(a, l, r, cmp);
-	return;
-      }
+	if (cmp(h[c], h[c + 1]))
+	  ++c;
 
-    int_t pivot = partition(a, l, r, cmp);
+	h[i] = std::move(h[c]);
+	i = c;
+	c = 2 * i + 1;
+      }
 
-    if (pivot - l < r - pivot)
+    if (c < n)
       {
-	quicksort(a, l, pivot - 1, cmp);
-	quicksort(a, pivot + 1, r, cmp);
+	h[i] = std::move(h[c]);
+	i = c;
       }
-    else
+
+    while (i > top)
       {
-	quicksort(a, pivot + 1, r, cmp);
-	quicksort(a, l, pivot - 1, cmp);
+	nat_t p = (i - 1) / 2;
+
+	if (not cmp(h[p], v))
+	  break;
+
+	h[i] = std::move(h[p]);
+	i = p;
       }
+
+    h[i] = std::move(v);
+  }
+
+  /** Rearranges a[l..r] as a heap whose top a[l] is the greatest item
+   *  according to cmp. Floyd's construction, O(n).
+   */
+  template <class ArrayType, class Cmp>
+  void make_heap(ArrayType & a, int_t l, int_t r, Cmp & cmp)
+  {
+    if (l >= r)
+      return;
+
+    auto * h = &a[l];
+    nat_t n = r - l + 1;
+
+    for (nat_t i = n / 2; i > 0; --i)
+      heap_hole_sift(h, i - 1, n, std::move(h[i - 1]), cmp);
   }
 
   template <class ArrayType,
 	    class Cmp = std::less<typename ArrayType::DataType>> inline
-  void quicksort(ArrayType & a, int_t l, int_t r, Cmp && cmp = Cmp())
+  void make_heap(ArrayType & a, int_t l, int_t r, Cmp && cmp = Cmp())
   {
-    quicksort<ArrayType, Cmp>(a, l, r, cmp);
+    make_heap<ArrayType, Cmp>(a, l, r, cmp);
   }
 
   template <class ArrayType, class Cmp>
-  inline void quicksort(ArrayType & a, int_t size, Cmp & cmp)
+  inline void make_heap(ArrayType & a, Cmp & cmp)
   {
-    quicksort(a, 0, size - 1, cmp);
+    make_heap(a, 0, a.size() - 1, cmp);
   }
 
   template <class ArrayType,
 	    class Cmp = std::less<typename ArrayType::DataType>>
-  inline void quicksort(ArrayType & a, int_t size, Cmp && cmp = Cmp())
+  inline void make_heap(ArrayType & a, Cmp && cmp = Cmp())
   {
-    quicksort<ArrayType, Cmp>(a, size, cmp);
+    make_heap<ArrayType, Cmp>(a, cmp);
   }
 
+  /// Adds a[r] to the heap a[l..r - 1]. O(log n).
   template <class ArrayType, class Cmp>
-  inline void quicksort(ArrayType & a, Cmp & cmp)
+  void push_heap(ArrayType & a, int_t l, int_t r, Cmp & cmp)
   {
-    quicksort(a, a.size(), cmp);
+    if (l >= r)
+      return;
+
+    auto * h = &a[l];
+    nat_t i = r - l;
+    auto v = std::move(h[i]);
+
+    while (i > 0)
+      {
+	nat_t p = (i - 1) / 2;
+
+	if (not cmp(h[p], v))
+	  break;
+
+	h[i] = std::move(h[p]);
+	i = p;
+      }
+
+    h[i] = std::move(v);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>> inline
+  void push_heap(ArrayType & a, int_t l, int_t r, Cmp && cmp = Cmp())
+  {
+    push_heap<ArrayType, Cmp>(a, l, r, cmp);
+  }
+
+  template <class ArrayType, class Cmp>
+  inline void push_heap(ArrayType & a, Cmp & cmp)
+  {
+    push_heap(a, 0, a.size() - 1, cmp);
   }
 
   template <class ArrayType,
 	    class Cmp = std::less<typename ArrayType::DataType>>
-  inline void quicksort(ArrayType & a, Cmp && cmp = Cmp())
+  inline void push_heap(ArrayType & a, Cmp && cmp = Cmp())
   {
-    quicksort<ArrayType, Cmp>(a, cmp);
+    push_heap<ArrayType, Cmp>(a, cmp);
   }
 
-  template <typename T, class Cmp = std::less<T>>
-  inline void quicksort(FixedArray<T> & a, Cmp & cmp)
+  /// Moves the top of the heap a[l..r] to a[r] and leaves a[l..r - 1] a heap.
+  template <class ArrayType, class Cmp>
+  void pop_heap(ArrayType & a, int_t l, int_t r, Cmp & cmp)
   {
-    quicksort<FixedArray<T>, Cmp>(a, cmp);
+    if (l >= r)
+      return;
+
+    auto * h = &a[l];
+    nat_t n = r - l;
+    auto v = std::move(h[n]);
+    h[n] = std::move(h[0]);
+    heap_hole_sift(h, 0, n, std::move(v), cmp);
   }
 
-  template <typename T, class Cmp = std::less<T>>
-  inline void quicksort(FixedArray<T> & a, Cmp && cmp = Cmp())
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>> inline
+  void pop_heap(ArrayType & a, int_t l, int_t r, Cmp && cmp = Cmp())
   {
-    quicksort<T, Cmp>(a, cmp);
+    pop_heap<ArrayType, Cmp>(a, l, r, cmp);
   }
 
-  template <typename T, class Cmp = std::less<T>>
-  inline void quicksort(DynArray<T> & a, Cmp & cmp)
+  template <class ArrayType, class Cmp>
+  inline void pop_heap(ArrayType & a, Cmp & cmp)
   {
-    quicksort<DynArray<T>, Cmp>(a, cmp);
+    pop_heap(a, 0, a.size() - 1, cmp);
   }
 
-  template <typename T, class Cmp = std::less<T>>
-  inline void quicksort(DynArray<T> & a, Cmp && cmp = Cmp())
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void pop_heap(ArrayType & a, Cmp && cmp = Cmp())
   {
-    quicksort<T, Cmp>(a, cmp);
+    pop_heap<ArrayType, Cmp>(a, cmp);
   }
 
-  template <typename T, class Cmp>
-  void sift_up(T * a, nat_t l, nat_t r, Cmp & cmp)
+  /// Sorts the heap a[l..r] in ascending order according to cmp.
+  template <class ArrayType, class Cmp>
+  void sort_heap(ArrayType & a, int_t l, int_t r, Cmp & cmp)
   {
-    nat_t i = r;
+    if (l >= r)
+      return;
 
-    nat_t u = i / 2;
+    auto * h = &a[l];
 
-    while (u >= l and cmp(a[i], a[u]))
+    for (nat_t n = r - l; n > 0; --n)
       {
-	std::swap(a[i], a[u]);
-	i = u;
-	u = i / 2;
+	auto v = std::move(h[n]);
+	h[n] = std::move(h[0]);
+	heap_hole_sift(h, 0, n, std::move(v), cmp);
       }
   }
 
-  template <typename T, class Cmp>
-  inline void sift_up(T * a, nat_t l, nat_t r, Cmp && cmp = Cmp())
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>> inline
+  void sort_heap(ArrayType & a, int_t l, int_t r, Cmp && cmp = Cmp())
   {
-    return sift_up<T, Cmp>(a, l, r, cmp);
+    sort_heap<ArrayType, Cmp>(a, l, r, cmp);
   }
 
-  template <typename T, class Cmp>
-  void sift_down(T * a, nat_t l, nat_t r, Cmp & cmp)
+  template <class ArrayType, class Cmp>
+  inline void sort_heap(ArrayType & a, Cmp & cmp)
   {
-    nat_t i = l;
+    sort_heap(a, 0, a.size() - 1, cmp);
+  }
 
-    nat_t c = i * 2;
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void sort_heap(ArrayType & a, Cmp && cmp = Cmp())
+  {
+    sort_heap<ArrayType, Cmp>(a, cmp);
+  }
 
-    while (c <= r)
-      {
-	if (c < r)
-	  if (cmp(a[c + 1], a[c]))
-	    ++c;
+  template <class ArrayType, class Cmp>
+  bool is_heap(const ArrayType & a, int_t l, int_t r, Cmp & cmp)
+  {
+    if (l >= r)
+      return true;
 
-	if (not cmp(a[c], a[i]))
-	  break;
+    const auto * h = &a[l];
+    nat_t n = r - l + 1;
 
-	std::swap(a[c], a[i]);
-	i = c;
-	c = i * 2;
-      }
+    for (nat_t i = 1; i < n; ++i)
+      if (cmp(h[(i - 1) / 2], h[i]))
+	return false;
+
+    return true;
   }
 
-  template <typename T, class Cmp>
-  inline void sift_down(T * a, nat_t l, nat_t r, Cmp && cmp = Cmp())
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>> inline
+  bool is_heap(const ArrayType & a, int_t l, int_t r, Cmp && cmp = Cmp())
   {
-    return sift_down<T, Cmp>(a, l, r, cmp);
+    return is_heap<ArrayType, Cmp>(a, l, r, cmp);
   }
 
-  template <typename T, class Cmp>
-  std::tuple<NodeSLList<T>, typename NodeSLList<T>::Node *, NodeSLList<T>>
-  partition(NodeSLList<T> & l, Cmp & cmp)
+  template <class ArrayType, class Cmp>
+  inline bool is_heap(const ArrayType & a, Cmp & cmp)
   {
-    auto pivot = l.remove_first();
+    return is_heap(a, 0, a.size() - 1, cmp);
+  }
 
-    NodeSLList<T> ls, gs;
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline bool is_heap(const ArrayType & a, Cmp && cmp = Cmp())
+  {
+    return is_heap<ArrayType, Cmp>(a, cmp);
+  }
 
-    while (not l.is_empty())
-      {
-	auto p = l.remove_first();
+  /** Bottom-up heapsort of a[l..r]: about n log n comparisons instead of
+   *  the 2 n log n of the classic sift-down, O(n log n) in the worst case
+   *  and in place, which is why quicksort falls back to it.
+   */
+  template <class ArrayType, class Cmp>
+  void heapsort(ArrayType & a, int_t l, int_t r, Cmp & cmp)
+  {
+    make_heap(a, l, r, cmp);
+    sort_heap(a, l, r, cmp);
+  }
 
-	if (cmp(p->get_item(), pivot->get_item()))
-	  ls.append(p);
-	else
-	  gs.append(p);
-      }
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>> inline
+  void heapsort(ArrayType & a, int_t l, int_t r, Cmp && cmp = Cmp())
+  {
+    heapsort<ArrayType, Cmp>(a, l, r, cmp);
+  }
 
-    return std::make_tuple(std::move(ls), pivot, std::move(gs));
+  template <class ArrayType, class Cmp>
+  inline void heapsort(ArrayType & a, Cmp & cmp)
+  {
+    heapsort(a, 0, a.size() - 1, cmp);
   }
 
-  template <typename T, class Cmp>
-  void quicksort(NodeSLList<T> & l, Cmp & cmp)
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void heapsort(ArrayType & a, Cmp && cmp = Cmp())
   {
-    if (l.is_unitarian_or_empty())
+    heapsort<ArrayType, Cmp>(a, cmp);
+  }
+
+  /* Merges the sorted runs a[l, m) and a[m, r). Only the left run is
+   * moved to buf, and ties keep its items first.
+   */
+  template <class ArrayType, class BufType, class Cmp>
+  void merge_runs(ArrayType & a, BufType & buf, int_t l, int_t m, int_t r,
+		  Cmp & cmp)
+  {
+    if (not cmp(a[m], a[m - 1]))
       return;
 
-    auto part = partition(l, cmp);
+    int_t n = m - l;
 
-    quicksort(std::get<0>(part), cmp);
-    quicksort(std::get<2>(part), cmp);
+    for (int_t i = 0; i < n; ++i)
+      buf[i] = std::move(a[l + i]);
 
-    l.concat(std::get<0>(part));
-    l.append(std::get<1>(part));
-    l.concat(std::get<2>(part));
-  }
+    int_t i = 0;
+    int_t k = l;
 
-  template <typename T, class Cmp = std::less<T>>
-  inline void quicksort(NodeSLList<T> & l, Cmp && cmp = Cmp())
-  {
-    quicksort<T, Cmp>(l, cmp);
+    while (i < n and m < r)
+      if (cmp(a[m], buf[i]))
+	a[k++] = std::move(a[m++]);
+      else
+	a[k++] = std::move(buf[i++]);
+
+    while (i < n)
+      a[k++] = std::move(buf[i++]);
   }
 
-  template <class Cmp>
-  std::tuple<DL, DL *, DL> partition(DL & l, Cmp & cmp)
+  // Sorts a[l, r) through buf, which holds at least (r - l) / 2 items.
+  template <class ArrayType, class BufType, class Cmp>
+  void merge_sort_runs(ArrayType & a, BufType & buf, int_t l, int_t r,
+		       Cmp & cmp)
   {
-    auto pivot = l.remove_next();
-
-    DL ls, gs;
-
-    while (not l.is_empty())
+    if (r - l <= QuicksortThreshold)
       {
-	auto p = l.remove_next();
-
-	if (cmp(p, pivot))
-	  ls.insert_prev(p);
-	else
-	  gs.insert_prev(p);
+	insertion_sort(a, l, r - 1, cmp);
+	return;
       }
 
-    return std::make_tuple(std::move(ls), pivot, std::move(gs));
+    int_t m = l + (r - l) / 2;
+
+    merge_sort_runs(a, buf, l, m, cmp);
+    merge_sort_runs(a, buf, m, r, cmp);
+    merge_runs(a, buf, l, m, r, cmp);
   }
 
-  template <class Cmp>
-  void quicksort(DL & l, Cmp & cmp)
+  /** Sorts a[l..r] with a sequential stable merge sort.
+   *
+   *  Ranges up to QuicksortThreshold items are insertion sorted in place;
+   *  larger ones need a buffer of half the range.
+   */
+  template <class ArrayType, class Cmp>
+  void stable_sort(ArrayType & a, int_t l, int_t r, Cmp & cmp)
   {
-    if (l.is_unitarian_or_empty())
-      return;
+    if (r - l + 1 <= QuicksortThreshold)
+      {
+	insertion_sort(a, l, r, cmp);
+	return;
+      }
 
-    auto part = partition(l, cmp);
+    FixedArray<typename ArrayType::DataType> buf((r - l + 1) / 2);
 
-    quicksort(std::get<0>(part), cmp);
-    quicksort(std::get<2>(part), cmp);
+    merge_sort_runs(a, buf, l, r + 1, cmp);
+  }
 
-    l.concat(std::get<0>(part));
-    l.insert_prev(std::get<1>(part));
-    l.concat(std::get<2>(part));
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>> inline
+  void stable_sort(ArrayType & a, int_t l, int_t r, Cmp && cmp = Cmp())
+  {
+    stable_sort<ArrayType, Cmp>(a, l, r, cmp);
   }
 
-  template <class Cmp>
-  inline void quicksort(DL & l, Cmp && cmp = Cmp())
+  template <class ArrayType, class Cmp>
+  inline void stable_sort(ArrayType & a, Cmp & cmp)
   {
-    quicksort<Cmp>(l, cmp);
+    stable_sort(a, 0, a.size() - 1, cmp);
   }
 
-  template <typename T, class Cmp>
-  struct KeyCmp
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void stable_sort(ArrayType & a, Cmp && cmp = Cmp())
   {
-    Cmp & cmp;
+    stable_sort<ArrayType, Cmp>(a, cmp);
+  }
 
-    KeyCmp(Cmp & _cmp)
-      : cmp(_cmp)
-    {
+  template <class ArrayType, class Cmp>
+  inline void sort3(ArrayType & a, int_t i, int_t j, int_t k, Cmp & cmp)
+  {
+    if (cmp(a[j], a[i]))
+      std::swap(a[i], a[j]);
+
+    if (cmp(a[k], a[j]))
+      std::swap(a[j], a[k]);
+
+    if (cmp(a[j], a[i]))
+      std::swap(a[i], a[j]);
+  }
+
+  // Insertion sort of a[l..r] which relies on a[l - 1] as sentinel.
+  template <class ArrayType, class Cmp>
+  void unguarded_insertion_sort(ArrayType & a, int_t l, int_t r, Cmp & cmp)
+  {
+    for (int_t i = l + 1; i <= r; ++i)
+      {
+	if (not cmp(a[i], a[i - 1]))
+	  continue;
+
+	typename ArrayType::DataType data = std::move(a[i]);
+
+	int_t j = i;
+
+	do
+	  {
+	    a[j] = std::move(a[j - 1]);
+	    --j;
+	  }
+	while (cmp(data, a[j - 1]));
+
+	a[j] = std::move(data);
+      }
+  }
+
+  /* Insertion sort of a[b, e) which gives up when it has moved more than
+   * PartialInsertionSortLimit items. Returns true if a[b, e) got sorted.
+   */
+  template <class ArrayType, class Cmp>
+  bool partial_insertion_sort(ArrayType & a, int_t b, int_t e, Cmp & cmp)
+  {
+    int_t moves = 0;
+
+    for (int_t i = b + 1; i < e; ++i)
+      {
+	if (cmp(a[i], a[i - 1]))
+	  {
+	    typename ArrayType::DataType data = std::move(a[i]);
+
+	    int_t j = i;
+
+	    do
+	      {
+		a[j] = std::move(a[j - 1]);
+		--j;
+	      }
+	    while (j > b and cmp(data, a[j - 1]));
+
+	    a[j] = std::move(data);
+	    moves += i - j;
+	  }
+
+	if (moves > PartialInsertionSortLimit)
+	  return false;
+      }
+
+    return true;
+  }
+
+  /* Moves the pivot of a[b, e) to a[b]: median of three for small ranges
+   * and pseudomedian of nine for large ones. Afterwards a[e - 1] is not
+   * less than the pivot and some a[i], b < i < e, is not greater.
+   */
+  template <class ArrayType, class Cmp>
+  void choose_pivot(ArrayType & a, int_t b, int_t e, Cmp & cmp)
+  {
+    int_t m = b + (e - b) / 2;
+
+    if (e - b > NintherThreshold)
+      {
+	sort3(a, b, m, e - 1, cmp);
+	sort3(a, b + 1, m - 1, e - 2, cmp);
+	sort3(a, b + 2, m + 1, e - 3, cmp);
+	sort3(a, m - 1, m, m + 1, cmp);
+	std::swap(a[b], a[m]);
+      }
+    else
+      sort3(a, m, b, e - 1, cmp);
+  }
+
+  /* Partitions a[b, e) around the pivot a[b]; items equal to the pivot go
+   * to the right. Returns the final position of the pivot and whether the
+   * range was already partitioned.
+   */
+  template <class ArrayType, class Cmp>
+  std::pair<int_t, bool> partition_right(ArrayType & a, int_t b, int_t e,
+					 Cmp & cmp)
+  {
+    typename ArrayType::DataType pivot = std::move(a[b]);
+
+    int_t first = b;
+    int_t last = e;
+
+    while (cmp(a[++first], pivot));
+
+    if (first - 1 == b)
+      while (first < last and not cmp(a[--last], pivot));
+    else
+      while (not cmp(a[--last], pivot));
+
+    bool already_partitioned = first >= last;
+
+    while (first < last)
+      {
+	std::swap(a[first], a[last]);
+	while (cmp(a[++first], pivot));
+	while (not cmp(a[--last], pivot));
+      }
+
+    int_t pivot_pos = first - 1;
+    a[b] = std::move(a[pivot_pos]);
+    a[pivot_pos] = std::move(pivot);
+
+    return std::make_pair(pivot_pos, already_partitioned);
+  }
+
+  template <class ArrayType>
+  inline void swap_offsets(ArrayType & a, int_t first, int_t last,
+			   const unsigned char * offsets_l,
+			   const unsigned char * offsets_r,
+			   int_t num, bool use_swaps)
+  {
+    if (use_swaps)
+      {
+	for (int_t i = 0; i < num; ++i)
+	  std::swap(a[first + offsets_l[i]], a[last - offsets_r[i]]);
+
+	return;
+      }
+
+    if (num == 0)
+      return;
+
+    // Cyclic permutation: one move per item instead of three.
+    int_t l = first + offsets_l[0];
+    int_t r = last - offsets_r[0];
+
+    typename ArrayType::DataType tmp = std::move(a[l]);
+    a[l] = std::move(a[r]);
+
+    for (int_t i = 1; i < num; ++i)
+      {
+	l = first + offsets_l[i];
+	a[r] = std::move(a[l]);
+	r = last - offsets_r[i];
+	a[l] = std::move(a[r]);
+      }
+
+    a[r] = std::move(tmp);
+  }
+
+  /* Same as partition_right, but comparisons are recorded into offset
+   * buffers of PartitionBlockSize items and the swaps are done afterwards,
+   * so the loops have no branches depending on the keys (BlockQuicksort).
+   */
+  template <class ArrayType, class Cmp>
+  std::pair<int_t, bool>
+  partition_right_branchless(ArrayType & a, int_t b, int_t e, Cmp & cmp)
+  {
+    constexpr int_t B = PartitionBlockSize;
+
+    typename ArrayType::DataType pivot = std::move(a[b]);
+
+    int_t first = b;
+    int_t last = e;
+
+    while (cmp(a[++first], pivot));
+
+    if (first - 1 == b)
+      while (first < last and not cmp(a[--last], pivot));
+    else
+      while (not cmp(a[--last], pivot));
+
+    bool already_partitioned = first >= last;
+
+    if (not already_partitioned)
+      {
+	std::swap(a[first], a[last]);
+	++first;
+
+	unsigned char offsets_l_buf[B];
+	unsigned char offsets_r_buf[B];
+	unsigned char * offsets_l = offsets_l_buf;
+	unsigned char * offsets_r = offsets_r_buf;
+
+	int_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+	while (last - first > 2 * B)
+	  {
+	    if (num_l == 0)
+	      {
+		start_l = 0;
+
+		for (int_t i = 0; i < B; ++i)
+		  {
+		    offsets_l[num_l] = i;
+		    num_l += not cmp(a[first + i], pivot);
+		  }
+	      }
+
+	    if (num_r == 0)
+	      {
+		start_r = 0;
+
+		for (int_t i = 0; i < B; ++i)
+		  {
+		    offsets_r[num_r] = i + 1;
+		    num_r += cmp(a[last - i - 1], pivot);
+		  }
+	      }
+
+	    int_t num = std::min(num_l, num_r);
+	    swap_offsets(a, first, last, offsets_l + start_l,
+			 offsets_r + start_r, num, num_l == num_r);
+	    num_l -= num;
+	    num_r -= num;
+	    start_l += num;
+	    start_r += num;
+
+	    if (num_l == 0)
+	      first += B;
+
+	    if (num_r == 0)
+	      last -= B;
+	  }
+
+	int_t l_size = 0, r_size = 0;
+	int_t unknown = (last - first) - ((num_r or num_l) ? B : 0);
+
+	if (num_r)
+	  {
+	    l_size = unknown;
+	    r_size = B;
+	  }
+	else if (num_l)
+	  {
+	    l_size = B;
+	    r_size = unknown;
+	  }
+	else
+	  {
+	    l_size = unknown / 2;
+	    r_size = unknown - l_size;
+	  }
+
+	if (unknown and not num_l)
+	  {
+	    start_l = 0;
+
+	    for (int_t i = 0; i < l_size; ++i)
+	      {
+		offsets_l[num_l] = i;
+		num_l += not cmp(a[first + i], pivot);
+	      }
+	  }
+
+	if (unknown and not num_r)
+	  {
+	    start_r = 0;
+
+	    for (int_t i = 0; i < r_size; ++i)
+	      {
+		offsets_r[num_r] = i + 1;
+		num_r += cmp(a[last - i - 1], pivot);
+	      }
+	  }
+
+	int_t num = std::min(num_l, num_r);
+	swap_offsets(a, first, last, offsets_l + start_l, offsets_r + start_r,
+		     num, num_l == num_r);
+	num_l -= num;
+	num_r -= num;
+	start_l += num;
+	start_r += num;
+
+	if (num_l == 0)
+	  first += l_size;
+
+	if (num_r == 0)
+	  last -= r_size;
+
+	// Only one of the buffers may have items left.
+	if (num_l)
+	  {
+	    offsets_l += start_l;
+
+	    while (num_l--)
+	      std::swap(a[first + offsets_l[num_l]], a[--last]);
+
+	    first = last;
+	  }
+
+	if (num_r)
+	  {
+	    offsets_r += start_r;
+
+	    while (num_r--)
+	      std::swap(a[last - offsets_r[num_r]], a[first++]);
+
+	    last = first;
+	  }
+      }
+
+    int_t pivot_pos = first - 1;
+    a[b] = std::move(a[pivot_pos]);
+    a[pivot_pos] = std::move(pivot);
+
+    return std::make_pair(pivot_pos, already_partitioned);
+  }
+
+  /* Partitions a[b, e) around the pivot a[b]; items equal to the pivot go
+   * to the left. Used when the pivot equals the item before the range, so
+   * runs of equal keys are consumed in linear time.
+   */
+  template <class ArrayType, class Cmp>
+  int_t partition_left(ArrayType & a, int_t b, int_t e, Cmp & cmp)
+  {
+    typename ArrayType::DataType pivot = std::move(a[b]);
+
+    int_t first = b;
+    int_t last = e;
+
+    while (cmp(pivot, a[--last]));
+
+    if (last + 1 == e)
+      while (first < last and not cmp(pivot, a[++first]));
+    else
+      while (not cmp(pivot, a[++first]));
+
+    while (first < last)
+      {
+	std::swap(a[first], a[last]);
+	while (cmp(pivot, a[--last]));
+	while (not cmp(pivot, a[++first]));
+      }
+
+    a[b] = std::move(a[last]);
+    a[last] = std::move(pivot);
+
+    return last;
+  }
+
+  // Block partitioning pays off for cheap comparisons of plain numbers.
+  template <typename T, class Cmp>
+  struct UseBranchlessPartition
+    : std::integral_constant<bool, std::is_arithmetic<T>::value and
+			     (std::is_same<Cmp, std::less<T>>::value or
+			      std::is_same<Cmp, std::greater<T>>::value)>
+  {
+    // empty
+  };
+
+  template <class ArrayType, class Cmp>
+  inline std::pair<int_t, bool>
+  partition_right(ArrayType & a, int_t b, int_t e, Cmp & cmp, std::true_type)
+  {
+    return partition_right_branchless(a, b, e, cmp);
+  }
+
+  template <class ArrayType, class Cmp>
+  inline std::pair<int_t, bool>
+  partition_right(ArrayType & a, int_t b, int_t e, Cmp & cmp, std::false_type)
+  {
+    return partition_right(a, b, e, cmp);
+  }
+
+  /* Pattern-defeating quicksort of a[b, e) (Orson Peters). bad_allowed is
+   * the number of highly unbalanced partitions tolerated before switching
+   * to heapsort; leftmost is false when a[b - 1] is a lower bound of the
+   * range.
+   */
+  template <class ArrayType, class Cmp>
+  void pdqsort(ArrayType & a, int_t b, int_t e, Cmp & cmp, int_t bad_allowed,
+	       bool leftmost)
+  {
+    using Branchless =
+      UseBranchlessPartition<typename ArrayType::DataType, Cmp>;
+
+    while (true)
+      {
+	int_t size = e - b;
+
+	if (size <= QuicksortThreshold)
+	  {
+	    if (leftmost)
+	      insertion_sort(a, b, e - 1, cmp);
+	    else
+	      unguarded_insertion_sort(a, b, e - 1, cmp);
+
+	    return;
+	  }
+
+	choose_pivot(a, b, e, cmp);
+
+	if (not leftmost and not cmp(a[b - 1], a[b]))
+	  {
+	    b = partition_left(a, b, e, cmp) + 1;
+	    continue;
+	  }
+
+	std::pair<int_t, bool> part = partition_right(a, b, e, cmp,
+						      Branchless());
+	int_t pivot_pos = part.first;
+	int_t l_size = pivot_pos - b;
+	int_t r_size = e - (pivot_pos + 1);
+
+	if (l_size < size / 8 or r_size < size / 8)
+	  {
+	    if (--bad_allowed == 0)
+	      {
+		heapsort(a, b, e - 1, cmp);
+		return;
+	      }
+
+	    // Breaks patterns which could fool the pivot selection.
+	    if (l_size >= QuicksortThreshold)
+	      {
+		std::swap(a[b], a[b + l_size / 4]);
+		std::swap(a[pivot_pos - 1], a[pivot_pos - l_size / 4]);
+
+		if (l_size > NintherThreshold)
+		  {
+		    std::swap(a[b + 1], a[b + (l_size / 4 + 1)]);
+		    std::swap(a[b + 2], a[b + (l_size / 4 + 2)]);
+		    std::swap(a[pivot_pos - 2], a[pivot_pos - (l_size / 4 + 1)]);
+		    std::swap(a[pivot_pos - 3], a[pivot_pos - (l_size / 4 + 2)]);
+		  }
+	      }
+
+	    if (r_size >= QuicksortThreshold)
+	      {
+		std::swap(a[pivot_pos + 1], a[pivot_pos + (1 + r_size / 4)]);
+		std::swap(a[e - 1], a[e - r_size / 4]);
+
+		if (r_size > NintherThreshold)
+		  {
+		    std::swap(a[pivot_pos + 2], a[pivot_pos + (2 + r_size / 4)]);
+		    std::swap(a[pivot_pos + 3], a[pivot_pos + (3 + r_size / 4)]);
+		    std::swap(a[e - 2], a[e - (1 + r_size / 4)]);
+		    std::swap(a[e - 3], a[e - (2 + r_size / 4)]);
+		  }
+	      }
+	  }
+	else if (part.second and
+		 partial_insertion_sort(a, b, pivot_pos, cmp) and
+		 partial_insertion_sort(a, pivot_pos + 1, e, cmp))
+	  return;
+
+	// Recursion on the smaller side bounds the stack to O(log n).
+	if (l_size < r_size)
+	  {
+	    pdqsort(a, b, pivot_pos, cmp, bad_allowed, leftmost);
+	    b = pivot_pos + 1;
+	    leftmost = false;
+	  }
+	else
+	  {
+	    pdqsort(a, pivot_pos + 1, e, cmp, bad_allowed, false);
+	    e = pivot_pos;
+	  }
+      }
+  }
+
+  /* Returns true if a[l..r] was already sorted or sorted in reverse; in
+   * the latter case it is reversed. The scan stops at the first item out
+   * of order, so it is cheap on random inputs.
+   */
+  template <class ArrayType, class Cmp>
+  bool sort_monotonic_run(ArrayType & a, int_t l, int_t r, Cmp & cmp)
+  {
+    int_t i = l + 1;
+
+    while (i <= r and not cmp(a[i], a[i - 1]))
+      ++i;
+
+    if (i > r)
+      return true;
+
+    if (i != l + 1)
+      return false;
+
+    while (i <= r and not cmp(a[i - 1], a[i]))
+      ++i;
+
+    if (i <= r)
+      return false;
+
+    for (int_t j = l, k = r; j < k; ++j, --k)
+      std::swap(a[j], a[k]);
+
+    return true;
+  }
+
+  /** Sorts a[l..r].
+   *
+   *  It is a pattern-defeating quicksort: median of three or nine pivots,
+   *  partitions which consume repeated keys in linear time, insertion
+   *  sort for small or almost sorted ranges and a switch to heapsort after
+   *  log(n) bad partitions, so the worst case is O(n log n). Sorted and
+   *  reverse-sorted inputs take linear time. Numbers compared with
+   *  std::less or std::greater are partitioned without branches.
+   */
+  template <typename ArrayType, class Cmp>
+  void quicksort(ArrayType & a, int_t l, int_t r, Cmp & cmp)
+  {
+    if (l >= r or sort_monotonic_run(a, l, r, cmp))
+      return;
+
+    pdqsort(a, l, r + 1, cmp, std::log2(r - l + 1), true);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>> inline
+  void quicksort(ArrayType & a, int_t l, int_t r, Cmp && cmp = Cmp())
+  {
+    quicksort<ArrayType, Cmp>(a, l, r, cmp);
+  }
+
+  template <class ArrayType, class Cmp>
+  inline void quicksort(ArrayType & a, int_t size, Cmp & cmp)
+  {
+    quicksort(a, 0, size - 1, cmp);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void quicksort(ArrayType & a, int_t size, Cmp && cmp = Cmp())
+  {
+    quicksort<ArrayType, Cmp>(a, size, cmp);
+  }
+
+  template <class ArrayType, class Cmp>
+  inline void quicksort(ArrayType & a, Cmp & cmp)
+  {
+    quicksort(a, a.size(), cmp);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void quicksort(ArrayType & a, Cmp && cmp = Cmp())
+  {
+    quicksort<ArrayType, Cmp>(a, cmp);
+  }
+
+  template <typename T, class Cmp = std::less<T>>
+  inline void quicksort(FixedArray<T> & a, Cmp & cmp)
+  {
+    quicksort<FixedArray<T>, Cmp>(a, cmp);
+  }
+
+  template <typename T, class Cmp = std::less<T>>
+  inline void quicksort(FixedArray<T> & a, Cmp && cmp = Cmp())
+  {
+    quicksort<T, Cmp>(a, cmp);
+  }
+
+  template <typename T, class Cmp = std::less<T>>
+  inline void quicksort(DynArray<T> & a, Cmp & cmp)
+  {
+    quicksort<DynArray<T>, Cmp>(a, cmp);
+  }
+
+  template <typename T, class Cmp = std::less<T>>
+  inline void quicksort(DynArray<T> & a, Cmp && cmp = Cmp())
+  {
+    quicksort<T, Cmp>(a, cmp);
+  }
+
+  /** Rearranges a[l..r] so that a[n] holds the item which would be there
+   *  if the range were sorted, items before it are not greater and items
+   *  after it are not less.
+   *
+   *  It is an introselect: the pivoting and partitions of quicksort, but
+   *  only the side holding position n is followed, so it takes O(n)
+   *  expected time. Runs of keys equal to an earlier pivot are consumed
+   *  at once, and after log(n) bad partitions the rest is heapsorted, so
+   *  the worst case is O(n log n).
+   *
+   *  @throw out_of_range if n is not in [l, r].
+   */
+  template <class ArrayType, class Cmp>
+  void nth_element(ArrayType & a, int_t l, int_t r, int_t n, Cmp & cmp)
+  {
+    if (n < l or n > r)
+      throw std::out_of_range("Index out of range");
+
+    using Branchless =
+      UseBranchlessPartition<typename ArrayType::DataType, Cmp>;
+
+    int_t b = l;
+    int_t e = r + 1;
+    int_t bad_allowed = std::log2(e - b);
+
+    while (e - b > QuicksortThreshold)
+      {
+	int_t size = e - b;
+
+	choose_pivot(a, b, e, cmp);
+
+	// a[b - 1] is a lower bound of the range and equals the pivot.
+	if (b > l and not cmp(a[b - 1], a[b]))
+	  {
+	    int_t last = partition_left(a, b, e, cmp);
+
+	    if (n <= last)
+	      return;
+
+	    b = last + 1;
+	    continue;
+	  }
+
+	int_t pivot_pos = partition_right(a, b, e, cmp, Branchless()).first;
+
+	if (pivot_pos == n)
+	  return;
+
+	if ((pivot_pos - b < size / 8 or e - pivot_pos - 1 < size / 8) and
+	    --bad_allowed == 0)
+	  {
+	    heapsort(a, b, e - 1, cmp);
+	    return;
+	  }
+
+	if (n < pivot_pos)
+	  e = pivot_pos;
+	else
+	  b = pivot_pos + 1;
+      }
+
+    insertion_sort(a, b, e - 1, cmp);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>> inline
+  void nth_element(ArrayType & a, int_t l, int_t r, int_t n,
+		   Cmp && cmp = Cmp())
+  {
+    nth_element<ArrayType, Cmp>(a, l, r, n, cmp);
+  }
+
+  template <class ArrayType, class Cmp>
+  inline void nth_element(ArrayType & a, int_t n, Cmp & cmp)
+  {
+    nth_element(a, 0, a.size() - 1, n, cmp);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void nth_element(ArrayType & a, int_t n, Cmp && cmp = Cmp())
+  {
+    nth_element<ArrayType, Cmp>(a, n, cmp);
+  }
+
+  /** Leaves the k smallest items of a[l..r] sorted in a[l..l + k - 1];
+   *  the order of the rest is unspecified.
+   *
+   *  It selects with nth_element() and sorts only the first k items, so
+   *  it takes O(n + k log k) expected time. When the k items need not be
+   *  sorted, nth_element(a, l, r, l + k - 1) alone is enough.
+   */
+  template <class ArrayType, class Cmp>
+  void partial_sort(ArrayType & a, int_t l, int_t r, int_t k, Cmp & cmp)
+  {
+    k = std::min(k, r - l + 1);
+
+    if (k <= 0)
+      return;
+
+    int_t m = l + k - 1;
+
+    if (m == r)
+      {
+	quicksort(a, l, r, cmp);
+	return;
+      }
+
+    nth_element(a, l, r, m, cmp);
+    quicksort(a, l, m - 1, cmp);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>> inline
+  void partial_sort(ArrayType & a, int_t l, int_t r, int_t k,
+		    Cmp && cmp = Cmp())
+  {
+    partial_sort<ArrayType, Cmp>(a, l, r, k, cmp);
+  }
+
+  template <class ArrayType, class Cmp>
+  inline void partial_sort(ArrayType & a, int_t k, Cmp & cmp)
+  {
+    partial_sort(a, 0, a.size() - 1, k, cmp);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void partial_sort(ArrayType & a, int_t k, Cmp && cmp = Cmp())
+  {
+    partial_sort<ArrayType, Cmp>(a, k, cmp);
+  }
+
+  /* Keeps the k smallest items of [b, e) in heap[1..k], a heap whose top
+   * is the greatest of them. Returns how many items were kept.
+   */
+  template <class It, typename T, class Cmp>
+  nat_t bounded_heap_select(const It & b, const It & e, nat_t k,
+			    FixedArray<T> & heap, Cmp & cmp)
+  {
+    auto rcmp = [&cmp] (const T & x, const T & y) { return cmp(y, x); };
+
+    T * h = &heap[0];
+    nat_t n = 0;
+
+    for (It it = b; it != e; ++it)
+      if (n < k)
+	{
+	  h[++n] = *it;
+	  sift_up(h, 1, n, rcmp);
+	}
+      else if (cmp(*it, h[1]))
+	{
+	  h[1] = *it;
+	  sift_down(h, 1, n, rcmp);
+	}
+
+    return n;
+  }
+
+  /** Returns the k smallest items of [b, e) in no particular order.
+   *
+   *  The range is read once, as a stream, keeping a bounded heap of k
+   *  items, so it takes O(n log k) time and O(k) memory and works with
+   *  any iterator.
+   */
+  template <class It, class Cmp>
+  auto top_k_unsorted_it(const It & b, const It & e, nat_t k, Cmp & cmp)
+  {
+    using T = std::decay_t<decltype(*b)>;
+
+    DynArray<T> ret;
+
+    if (k == 0)
+      return ret;
+
+    FixedArray<T> heap(k + 1);
+    nat_t n = bounded_heap_select(b, e, k, heap, cmp);
+
+    for (nat_t i = 1; i <= n; ++i)
+      ret.append(std::move(heap[i]));
+
+    return ret;
+  }
+
+  template <class It,
+	    class Cmp = std::less<std::decay_t<decltype(*std::declval<It>())>>>
+  inline auto top_k_unsorted_it(const It & b, const It & e, nat_t k,
+				Cmp && cmp = Cmp())
+  {
+    return top_k_unsorted_it<It, Cmp>(b, e, k, cmp);
+  }
+
+  /** Returns the k smallest items of [b, e) sorted.
+   *
+   *  Same as top_k_unsorted_it(), but the heap is drained in order before
+   *  returning, which adds O(k log k) time.
+   */
+  template <class It, class Cmp>
+  auto top_k_it(const It & b, const It & e, nat_t k, Cmp & cmp)
+  {
+    using T = std::decay_t<decltype(*b)>;
+
+    DynArray<T> ret;
+
+    if (k == 0)
+      return ret;
+
+    FixedArray<T> heap(k + 1);
+    nat_t n = bounded_heap_select(b, e, k, heap, cmp);
+
+    auto rcmp = [&cmp] (const T & x, const T & y) { return cmp(y, x); };
+
+    T * h = &heap[0];
+
+    for (nat_t i = n; i > 1; --i)
+      {
+	std::swap(h[1], h[i]);
+	sift_down(h, 1, i - 1, rcmp);
+      }
+
+    for (nat_t i = 1; i <= n; ++i)
+      ret.append(std::move(h[i]));
+
+    return ret;
+  }
+
+  template <class It,
+	    class Cmp = std::less<std::decay_t<decltype(*std::declval<It>())>>>
+  inline auto top_k_it(const It & b, const It & e, nat_t k,
+		       Cmp && cmp = Cmp())
+  {
+    return top_k_it<It, Cmp>(b, e, k, cmp);
+  }
+
+  template <class ContainerType, class Cmp>
+  inline auto top_k(const ContainerType & c, nat_t k, Cmp & cmp)
+  {
+    return top_k_it(c.begin(), c.end(), k, cmp);
+  }
+
+  template <class ContainerType,
+	    class Cmp = std::less<typename ContainerType::DataType>>
+  inline auto top_k(const ContainerType & c, nat_t k, Cmp && cmp = Cmp())
+  {
+    return top_k<ContainerType, Cmp>(c, k, cmp);
+  }
+
+  template <class ContainerType, class Cmp>
+  inline auto top_k_unsorted(const ContainerType & c, nat_t k, Cmp & cmp)
+  {
+    return top_k_unsorted_it(c.begin(), c.end(), k, cmp);
+  }
+
+  template <class ContainerType,
+	    class Cmp = std::less<typename ContainerType::DataType>>
+  inline auto top_k_unsorted(const ContainerType & c, nat_t k,
+			     Cmp && cmp = Cmp())
+  {
+    return top_k_unsorted<ContainerType, Cmp>(c, k, cmp);
+  }
+
+  /** First position in [l, r) whose item is not less than k.
+   *
+   *  The range shrinks by half on every step without a branch on the
+   *  comparison, and the two positions the next step may probe are
+   *  prefetched, so the loads of a step overlap those of the last.
+   */
+  template <class ArrayType, typename T, class Cmp>
+  int_t lower_bound(const ArrayType & a, int_t l, int_t r, const T & k,
+		    Cmp & cmp)
+  {
+    int_t n = r - l;
+
+    if (n <= 0)
+      return l;
+
+    while (n > 1)
+      {
+	int_t half = n / 2;
+
+	prefetch(&a[l + half / 2]);
+	prefetch(&a[l + half + half / 2]);
+
+	l += half * int_t(cmp(a[l + half - 1], k));
+	n -= half;
+      }
+
+    return l + int_t(cmp(a[l], k));
+  }
+
+  template <class ArrayType, typename T,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline int_t lower_bound(const ArrayType & a, int_t l, int_t r,
+			   const T & k, Cmp && cmp = Cmp())
+  {
+    return lower_bound<ArrayType, T, Cmp>(a, l, r, k, cmp);
+  }
+
+  /// First position in [l, r) whose item is greater than k.
+  template <class ArrayType, typename T, class Cmp>
+  int_t upper_bound(const ArrayType & a, int_t l, int_t r, const T & k,
+		    Cmp & cmp)
+  {
+    int_t n = r - l;
+
+    if (n <= 0)
+      return l;
+
+    while (n > 1)
+      {
+	int_t half = n / 2;
+
+	prefetch(&a[l + half / 2]);
+	prefetch(&a[l + half + half / 2]);
+
+	l += half * int_t(not cmp(k, a[l + half - 1]));
+	n -= half;
+      }
+
+    return l + int_t(not cmp(k, a[l]));
+  }
+
+  template <class ArrayType, typename T,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline int_t upper_bound(const ArrayType & a, int_t l, int_t r,
+			   const T & k, Cmp && cmp = Cmp())
+  {
+    return upper_bound<ArrayType, T, Cmp>(a, l, r, k, cmp);
+  }
+
+  /// Positions [lower_bound, upper_bound) of the items equal to k in [l, r).
+  template <class ArrayType, typename T, class Cmp>
+  std::pair<int_t, int_t> equal_range(const ArrayType & a, int_t l, int_t r,
+				      const T & k, Cmp & cmp)
+  {
+    int_t b = lower_bound(a, l, r, k, cmp);
+
+    return std::make_pair(b, upper_bound(a, b, r, k, cmp));
+  }
+
+  template <class ArrayType, typename T,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline std::pair<int_t, int_t>
+  equal_range(const ArrayType & a, int_t l, int_t r, const T & k,
+	      Cmp && cmp = Cmp())
+  {
+    return equal_range<ArrayType, T, Cmp>(a, l, r, k, cmp);
+  }
+
+  /** First position in [l, r) whose item is not less than k, probing
+   *  l + 1, l + 3, l + 7, ... before a binary search of the last gap. It
+   *  takes O(log d) comparisons when the answer is d positions past l.
+   */
+  template <class ArrayType, typename T, class Cmp>
+  int_t gallop_lower_bound(const ArrayType & a, int_t l, int_t r,
+			   const T & k, Cmp & cmp)
+  {
+    if (l >= r or not cmp(a[l], k))
+      return l;
+
+    int_t step = 1;
+    int_t hi = l + 1;
+
+    while (hi < r and cmp(a[hi], k))
+      {
+	l = hi;
+	step *= 2;
+	hi = l + step;
+      }
+
+    return lower_bound(a, l + 1, std::min(hi, r), k, cmp);
+  }
+
+  template <class ArrayType, typename T,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline int_t gallop_lower_bound(const ArrayType & a, int_t l, int_t r,
+				  const T & k, Cmp && cmp = Cmp())
+  {
+    return gallop_lower_bound<ArrayType, T, Cmp>(a, l, r, k, cmp);
+  }
+
+  /* The set operations below take arrays sorted by cmp without repeated
+   * items and append the result to out. When an item is in both, the
+   * one of a is taken.
+   */
+
+  /// Appends the items of a or b to out in O(|a| + |b|).
+  template <class ArrayA, class ArrayB, class OutArray, class Cmp>
+  void sorted_union(const ArrayA & a, const ArrayB & b, OutArray & out,
+		    Cmp & cmp)
+  {
+    nat_t i = 0;
+    nat_t j = 0;
+
+    while (i < a.size() and j < b.size())
+      if (cmp(a[i], b[j]))
+	out.append(a[i++]);
+      else if (cmp(b[j], a[i]))
+	out.append(b[j++]);
+      else
+	{
+	  out.append(a[i++]);
+	  ++j;
+	}
+
+    while (i < a.size())
+      out.append(a[i++]);
+
+    while (j < b.size())
+      out.append(b[j++]);
+  }
+
+  template <class ArrayA, class ArrayB, class OutArray,
+	    class Cmp = std::less<typename ArrayA::DataType>>
+  inline void sorted_union(const ArrayA & a, const ArrayB & b,
+			   OutArray & out, Cmp && cmp = Cmp())
+  {
+    sorted_union<ArrayA, ArrayB, OutArray, Cmp>(a, b, out, cmp);
+  }
+
+  template <class ArrayA, class ArrayB, class OutArray, class Cmp>
+  void merge_intersection(const ArrayA & a, const ArrayB & b,
+			  OutArray & out, Cmp & cmp, std::false_type)
+  {
+    nat_t i = 0;
+    nat_t j = 0;
+
+    while (i < a.size() and j < b.size())
+      if (cmp(a[i], b[j]))
+	++i;
+      else if (cmp(b[j], a[i]))
+	++j;
+      else
+	{
+	  out.append(a[i++]);
+	  ++j;
+	}
+  }
+
+  /* For numbers the outcome of each comparison is unpredictable, so the
+   * cursors advance without branches and every item is stored in a
+   * buffer, where only the common ones stay.
+   */
+  template <class ArrayA, class ArrayB, class OutArray, class Cmp>
+  void merge_intersection(const ArrayA & a, const ArrayB & b,
+			  OutArray & out, Cmp & cmp, std::true_type)
+  {
+    using T = typename ArrayA::DataType;
+
+    const nat_t na = a.size();
+    const nat_t nb = b.size();
+
+    if (na == 0 or nb == 0)
+      return;
+
+    FixedArray<T> buf(std::min(na, nb));
+
+    T * pbuf = &buf[0];
+
+    nat_t i = 0;
+    nat_t j = 0;
+    nat_t k = 0;
+
+    while (i < na and j < nb)
+      {
+	const T x = a[i];
+	const T y = b[j];
+	const bool lt = cmp(x, y);
+	const bool gt = cmp(y, x);
+
+	pbuf[k] = x;
+	k += nat_t(not lt and not gt);
+	i += nat_t(not gt);
+	j += nat_t(not lt);
+      }
+
+    for (nat_t t = 0; t < k; ++t)
+      out.append(pbuf[t]);
+  }
+
+  /** Appends the items of a which are also in b to out.
+   *
+   *  When one array has more than GallopRatio times the items of the
+   *  other, every item of the small one is searched in the large one
+   *  with gallop_lower_bound from the last position found, in
+   *  O(m log(n / m)). Otherwise both are merged in O(|a| + |b|).
+   */
+  template <class ArrayA, class ArrayB, class OutArray, class Cmp>
+  void sorted_intersection(const ArrayA & a, const ArrayB & b,
+			   OutArray & out, Cmp & cmp)
+  {
+    using T = typename ArrayA::DataType;
+
+    const int_t na = a.size();
+    const int_t nb = b.size();
+
+    if (nat_t(na) * GallopRatio < nat_t(nb))
+      {
+	for (int_t i = 0, j = 0; i < na and j < nb; ++i)
+	  {
+	    j = gallop_lower_bound(b, j, nb, a[i], cmp);
+
+	    if (j < nb and not cmp(a[i], b[j]))
+	      out.append(a[i]);
+	  }
+
+	return;
+      }
+
+    if (nat_t(nb) * GallopRatio < nat_t(na))
+      {
+	for (int_t i = 0, j = 0; i < na and j < nb; ++j)
+	  {
+	    i = gallop_lower_bound(a, i, na, b[j], cmp);
+
+	    if (i < na and not cmp(b[j], a[i]))
+	      out.append(a[i++]);
+	  }
+
+	return;
+      }
+
+    using Numeric =
+      std::integral_constant<bool, std::is_arithmetic<T>::value and
+			     std::is_same<T, typename ArrayB::DataType>::value>;
+
+    merge_intersection(a, b, out, cmp, Numeric());
+  }
+
+  template <class ArrayA, class ArrayB, class OutArray,
+	    class Cmp = std::less<typename ArrayA::DataType>>
+  inline void sorted_intersection(const ArrayA & a, const ArrayB & b,
+				  OutArray & out, Cmp && cmp = Cmp())
+  {
+    sorted_intersection<ArrayA, ArrayB, OutArray, Cmp>(a, b, out, cmp);
+  }
+
+  /** Appends the items of a which are not in b to out, galloping over
+   *  the skewed side as sorted_intersection does.
+   */
+  template <class ArrayA, class ArrayB, class OutArray, class Cmp>
+  void sorted_difference(const ArrayA & a, const ArrayB & b,
+			 OutArray & out, Cmp & cmp)
+  {
+    const int_t na = a.size();
+    const int_t nb = b.size();
+
+    int_t i = 0;
+    int_t j = 0;
+
+    if (nat_t(na) * GallopRatio < nat_t(nb))
+      for ( ; i < na and j < nb; ++i)
+	{
+	  j = gallop_lower_bound(b, j, nb, a[i], cmp);
+
+	  if (j == nb or cmp(a[i], b[j]))
+	    out.append(a[i]);
+	}
+    else if (nat_t(nb) * GallopRatio < nat_t(na))
+      for ( ; i < na and j < nb; ++j)
+	{
+	  int_t p = gallop_lower_bound(a, i, na, b[j], cmp);
+
+	  while (i < p)
+	    out.append(a[i++]);
+
+	  if (i < na and not cmp(b[j], a[i]))
+	    ++i;
+	}
+    else
+      while (i < na and j < nb)
+	if (cmp(a[i], b[j]))
+	  out.append(a[i++]);
+	else if (cmp(b[j], a[i]))
+	  ++j;
+	else
+	  {
+	    ++i;
+	    ++j;
+	  }
+
+    while (i < na)
+      out.append(a[i++]);
+  }
+
+  template <class ArrayA, class ArrayB, class OutArray,
+	    class Cmp = std::less<typename ArrayA::DataType>>
+  inline void sorted_difference(const ArrayA & a, const ArrayB & b,
+				OutArray & out, Cmp && cmp = Cmp())
+  {
+    sorted_difference<ArrayA, ArrayB, OutArray, Cmp>(a, b, out, cmp);
+  }
+
+  /* Partitions a[b, e) around pivot, the items less than it first, and
+   * returns the position of the first one which is not less. Lomuto
+   * without branches on the keys: every item is swapped with the first
+   * not less one and the boundary advances only if it was less.
+   */
+  template <class ArrayType, typename T, class Cmp>
+  int_t block_partition(ArrayType & a, int_t b, int_t e, const T & pivot,
+			Cmp & cmp)
+  {
+    if (b >= e)
+      return b;
+
+    T * p = &a[b];
+    int_t n = e - b;
+    int_t k = 0;
+
+    for (int_t i = 0; i < n; ++i)
+      {
+	bool less = cmp(p[i], pivot);
+	std::swap(p[k], p[i]);
+	k += less;
+      }
+
+    return b + k;
+  }
+
+  /* Partitions a[l..r] around the pivot a[l] with num_blocks tasks and
+   * returns the final position of the pivot; items equal to it go to the
+   * right. Every task partitions its own block, then the items which are
+   * not less than the pivot and ended left of the boundary are swapped
+   * with the less ones which ended right of it, again split among the
+   * tasks, so no pass over the range is sequential.
+   */
+  template <class ArrayType, class Cmp>
+  int_t parallel_partition(ArrayType & a, int_t l, int_t r, Cmp & cmp,
+			   nat_t num_blocks, ThreadPool & pool)
+  {
+    using T = typename ArrayType::DataType;
+
+    const T & pivot = a[l];
+    int_t n = r - l;
+
+    FixedArray<int_t> first(num_blocks + 1);
+    FixedArray<int_t> mid(num_blocks);
+
+    for (nat_t i = 0; i <= num_blocks; ++i)
+      first[i] = l + 1 + n * i / num_blocks;
+
+    auto for_each_block = [num_blocks, &pool] (auto op)
+      {
+	TaskGroup group(pool);
+
+	for (nat_t i = 1; i < num_blocks; ++i)
+	  group.run([&op, i] () { op(i); });
+
+	op(0);
+	group.wait();
+      };
+
+    for_each_block([&] (nat_t i)
+		   {
+		     mid[i] = block_partition(a, first[i], first[i + 1],
+					      pivot, cmp);
+		   });
+
+    int_t m = l + 1;
+
+    for (nat_t i = 0; i < num_blocks; ++i)
+      m += mid[i] - first[i];
+
+    // Misplaced runs: not less items in [l + 1, m), less ones in [m, r].
+    FixedArray<int_t> gbeg(num_blocks), glen(num_blocks);
+    FixedArray<int_t> lbeg(num_blocks), llen(num_blocks);
+    int_t num_misplaced = 0;
+
+    for (nat_t i = 0; i < num_blocks; ++i)
+      {
+	gbeg[i] = mid[i];
+	glen[i] = std::max<int_t>(0, std::min(first[i + 1], m) - mid[i]);
+	lbeg[i] = std::max(first[i], m);
+	llen[i] = std::max<int_t>(0, mid[i] - lbeg[i]);
+	num_misplaced += glen[i];
+      }
+
+    // Position of the k-th item of the runs beg[i, i + len[i]).
+    auto locate = [num_blocks] (const FixedArray<int_t> & len, int_t k,
+				nat_t & i, int_t & off)
+      {
+	for (i = 0; i < num_blocks and k >= len[i]; ++i)
+	  k -= len[i];
+
+	off = k;
+      };
+
+    for_each_block([&] (nat_t t)
+		   {
+		     int_t k = num_misplaced * t / num_blocks;
+		     int_t k_end = num_misplaced * (t + 1) / num_blocks;
+
+		     nat_t gi, li;
+		     int_t goff, loff;
+		     locate(glen, k, gi, goff);
+		     locate(llen, k, li, loff);
+
+		     for (; k < k_end; ++k)
+		       {
+			 std::swap(a[gbeg[gi] + goff], a[lbeg[li] + loff]);
+
+			 if (++goff == glen[gi])
+			   locate(glen, k + 1, gi, goff);
+
+			 if (++loff == llen[li])
+			   locate(llen, k + 1, li, loff);
+		       }
+		   });
+
+    std::swap(a[l], a[m - 1]);
+
+    return m - 1;
+  }
+
+  template <class ArrayType, class Cmp>
+  void parallel_quicksort(ArrayType & a, int_t l, int_t r, Cmp & cmp,
+			  TaskGroup & group, int_t bad_allowed)
+  {
+    using Branchless =
+      UseBranchlessPartition<typename ArrayType::DataType, Cmp>;
+
+    while (r - l + 1 > ParallelSortThreshold)
+      {
+	int_t size = r - l + 1;
+
+	choose_pivot(a, l, r + 1, cmp);
+
+	nat_t num_blocks = std::min<nat_t>(group.get_pool().num_threads(),
+					   size / ParallelSortThreshold);
+
+	int_t pivot = num_blocks > 1 ?
+	  parallel_partition(a, l, r, cmp, num_blocks, group.get_pool()) :
+	  partition_right(a, l, r + 1, cmp, Branchless()).first;
+
+	// Bad partitions are left to the sequential sort, which is safe.
+	if ((pivot - l < size / 8 or r - pivot < size / 8) and
+	    --bad_allowed == 0)
+	  break;
+
+	// The smaller side becomes a task and this thread keeps the other.
+	int_t tl = l;
+	int_t tr = pivot - 1;
+
+	if (pivot - l < r - pivot)
+	  l = pivot + 1;
+	else
+	  {
+	    tl = pivot + 1;
+	    tr = r;
+	    r = pivot - 1;
+	  }
+
+	group.run([&a, tl, tr, &cmp, &group, bad_allowed] ()
+		  {
+		    parallel_quicksort(a, tl, tr, cmp, group, bad_allowed);
+		  });
+      }
+
+    quicksort(a, l, r, cmp);
+  }
+
+  /** Sorts a[l..r] with a parallel quicksort on pool.
+   *
+   *  Both sides of every partition larger than ParallelSortThreshold are
+   *  sorted by different tasks, and ranges of several times that size are
+   *  partitioned by up to one task per thread. cmp is shared by every
+   *  thread. Not stable.
+   */
+  template <class ArrayType, class Cmp>
+  void parallel_sort(ArrayType & a, int_t l, int_t r, Cmp & cmp,
+		     ThreadPool & pool)
+  {
+    if (r - l + 1 <= ParallelSortThreshold or pool.num_threads() == 1)
+      {
+	quicksort(a, l, r, cmp);
+	return;
+      }
+
+    if (sort_monotonic_run(a, l, r, cmp))
+      return;
+
+    TaskGroup group(pool);
+    parallel_quicksort(a, l, r, cmp, group, std::log2(r - l + 1));
+    group.wait();
+  }
+
+  template <class ArrayType, class Cmp>
+  inline void parallel_sort(ArrayType & a, Cmp & cmp,
+			    ThreadPool & pool = ThreadPool::shared())
+  {
+    parallel_sort(a, 0, a.size() - 1, cmp, pool);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void parallel_sort(ArrayType & a, Cmp && cmp = Cmp(),
+			    ThreadPool & pool = ThreadPool::shared())
+  {
+    parallel_sort<ArrayType, Cmp>(a, cmp, pool);
+  }
+
+  /* Merges src[l1, r1) and src[l2, r2) into tgt from position k. Large
+   * merges are split around the median of the longer run, so both halves
+   * are merged in parallel. Ties keep the items of the first run first.
+   */
+  template <class SrcArray, class TgtArray, class Cmp>
+  void parallel_merge(SrcArray & src, int_t l1, int_t r1, int_t l2, int_t r2,
+		      TgtArray & tgt, int_t k, Cmp & cmp, ThreadPool & pool)
+  {
+    if (r1 - l1 + r2 - l2 > ParallelSortThreshold)
+      {
+	int_t m1, m2;
+
+	if (r1 - l1 >= r2 - l2)
+	  {
+	    m1 = l1 + (r1 - l1) / 2;
+	    m2 = lower_bound(src, l2, r2, src[m1], cmp);
+	  }
+	else
+	  {
+	    m2 = l2 + (r2 - l2) / 2;
+	    m1 = upper_bound(src, l1, r1, src[m2], cmp);
+	  }
+
+	TaskGroup group(pool);
+
+	group.run([&src, l1, m1, l2, m2, &tgt, k, &cmp, &pool] ()
+		  {
+		    parallel_merge(src, l1, m1, l2, m2, tgt, k, cmp, pool);
+		  });
+
+	parallel_merge(src, m1, r1, m2, r2, tgt, k + (m1 - l1) + (m2 - l2),
+		       cmp, pool);
+	group.wait();
+	return;
+      }
+
+    while (l1 < r1 and l2 < r2)
+      if (cmp(src[l2], src[l1]))
+	tgt[k++] = std::move(src[l2++]);
+      else
+	tgt[k++] = std::move(src[l1++]);
+
+    while (l1 < r1)
+      tgt[k++] = std::move(src[l1++]);
+
+    while (l2 < r2)
+      tgt[k++] = std::move(src[l2++]);
+  }
+
+  /* Sorts a[l, r); if in_buf the sorted items are left in buf[l - off,
+   * r - off). buf[0] matches a[off].
+   */
+  template <class ArrayType, class BufType, class Cmp>
+  void parallel_merge_sort(ArrayType & a, BufType & buf, int_t off, int_t l,
+			   int_t r, bool in_buf, Cmp & cmp, ThreadPool & pool)
+  {
+    if (r - l <= QuicksortThreshold)
+      {
+	insertion_sort(a, l, r - 1, cmp);
+
+	if (in_buf)
+	  for (int_t i = l; i < r; ++i)
+	    buf[i - off] = std::move(a[i]);
+
+	return;
+      }
+
+    int_t m = l + (r - l) / 2;
+
+    if (r - l > ParallelSortThreshold)
+      {
+	TaskGroup group(pool);
+
+	group.run([&a, &buf, off, l, m, in_buf, &cmp, &pool] ()
+		  {
+		    parallel_merge_sort(a, buf, off, l, m, not in_buf, cmp,
+					pool);
+		  });
+
+	parallel_merge_sort(a, buf, off, m, r, not in_buf, cmp, pool);
+	group.wait();
+      }
+    else
+      {
+	parallel_merge_sort(a, buf, off, l, m, not in_buf, cmp, pool);
+	parallel_merge_sort(a, buf, off, m, r, not in_buf, cmp, pool);
+      }
+
+    if (in_buf)
+      parallel_merge(a, l, m, m, r, buf, l - off, cmp, pool);
+    else
+      parallel_merge(buf, l - off, m - off, m - off, r - off, a, l, cmp, pool);
+  }
+
+  /** Sorts a[l..r] with a stable parallel merge sort on pool.
+   *
+   *  Halves are sorted and merged by different tasks down to
+   *  ParallelSortThreshold items. It needs a buffer of r - l + 1 items.
+   */
+  template <class ArrayType, class Cmp>
+  void parallel_stable_sort(ArrayType & a, int_t l, int_t r, Cmp & cmp,
+			    ThreadPool & pool)
+  {
+    if (l >= r)
+      return;
+
+    FixedArray<typename ArrayType::DataType> buf(r - l + 1);
+
+    parallel_merge_sort(a, buf, l, l, r + 1, false, cmp, pool);
+  }
+
+  template <class ArrayType, class Cmp>
+  inline void parallel_stable_sort(ArrayType & a, Cmp & cmp,
+				   ThreadPool & pool = ThreadPool::shared())
+  {
+    parallel_stable_sort(a, 0, a.size() - 1, cmp, pool);
+  }
+
+  template <class ArrayType,
+	    class Cmp = std::less<typename ArrayType::DataType>>
+  inline void parallel_stable_sort(ArrayType & a, Cmp && cmp = Cmp(),
+				   ThreadPool & pool = ThreadPool::shared())
+  {
+    parallel_stable_sort<ArrayType, Cmp>(a, cmp, pool);
+  }
+
+  template <typename T, class Cmp>
+  void sift_up(T * a, nat_t l, nat_t r, Cmp & cmp)
+  {
+    nat_t i = r;
+
+    nat_t u = i / 2;
+
+    while (u >= l and cmp(a[i], a[u]))
+      {
+	std::swap(a[i], a[u]);
+	i = u;
+	u = i / 2;
+      }
+  }
+
+  template <typename T, class Cmp>
+  inline void sift_up(T * a, nat_t l, nat_t r, Cmp && cmp = Cmp())
+  {
+    return sift_up<T, Cmp>(a, l, r, cmp);
+  }
+
+  template <typename T, class Cmp>
+  void sift_down(T * a, nat_t l, nat_t r, Cmp & cmp)
+  {
+    nat_t i = l;
+
+    nat_t c = i * 2;
+
+    while (c <= r)
+      {
+	if (c < r)
+	  if (cmp(a[c + 1], a[c]))
+	    ++c;
+
+	if (not cmp(a[c], a[i]))
+	  break;
+
+	std::swap(a[c], a[i]);
+	i = c;
+	c = i * 2;
+      }
+  }
+
+  template <typename T, class Cmp>
+  inline void sift_down(T * a, nat_t l, nat_t r, Cmp && cmp = Cmp())
+  {
+    return sift_down<T, Cmp>(a, l, r, cmp);
+  }
+
+  template <typename T, class Cmp>
+  std::tuple<NodeSLList<T>, typename NodeSLList<T>::Node *, NodeSLList<T>>
+  partition(NodeSLList<T> & l, Cmp & cmp)
+  {
+    auto pivot = l.remove_first();
+
+    NodeSLList<T> ls, gs;
+
+    while (not l.is_empty())
+      {
+	auto p = l.remove_first();
+
+	if (cmp(p->get_item(), pivot->get_item()))
+	  ls.append(p);
+	else
+	  gs.append(p);
+      }
+
+    return std::make_tuple(std::move(ls), pivot, std::move(gs));
+  }
+
+  template <typename T, class Cmp>
+  void quicksort(NodeSLList<T> & l, Cmp & cmp)
+  {
+    if (l.is_unitarian_or_empty())
+      return;
+
+    auto part = partition(l, cmp);
+
+    quicksort(std::get<0>(part), cmp);
+    quicksort(std::get<2>(part), cmp);
+
+    l.concat(std::get<0>(part));
+    l.append(std::get<1>(part));
+    l.concat(std::get<2>(part));
+  }
+
+  template <typename T, class Cmp = std::less<T>>
+  inline void quicksort(NodeSLList<T> & l, Cmp && cmp = Cmp())
+  {
+    quicksort<T, Cmp>(l, cmp);
+  }
+
+  template <class Cmp>
+  std::tuple<DL, DL *, DL> partition(DL & l, Cmp & cmp)
+  {
+    auto pivot = l.remove_next();
+
+    DL ls, gs;
+
+    while (not l.is_empty())
+      {
+	auto p = l.remove_next();
+
+	if (cmp(p, pivot))
+	  ls.insert_prev(p);
+	else
+	  gs.insert_prev(p);
+      }
+
+    return std::make_tuple(std::move(ls), pivot, std::move(gs));
+  }
+
+  template <class Cmp>
+  void quicksort(DL & l, Cmp & cmp)
+  {
+    if (l.is_unitarian_or_empty())
+      return;
+
+    auto part = partition(l, cmp);
+
+    quicksort(std::get<0>(part), cmp);
+    quicksort(std::get<2>(part), cmp);
+
+    l.concat(std::get<0>(part));
+    l.insert_prev(std::get<1>(part));
+    l.concat(std::get<2>(part));
+  }
+
+  template <class Cmp>
+  inline void quicksort(DL & l, Cmp && cmp = Cmp())
+  {
+    quicksort<Cmp>(l, cmp);
+  }
+
+  template <typename T, class Cmp>
+  struct KeyCmp
+  {
+    Cmp & cmp;
+
+    KeyCmp(Cmp & _cmp)
+      : cmp(_cmp)
+    {
       // empty
     }
 
@@ -520,11 +2356,236 @@ namespace Designar
     quicksort<T, Cmp>(l, cmp);
   }
 
+  /* Merges the null-terminated sorted chains a and b; ties take the node
+   * of a. Returns the head and sets last to the last node.
+   */
+  template <class Node, class Next, class Cmp>
+  Node * merge_chains(Node * a, Node * a_last, Node * b, Node * b_last,
+		      Node *& last, Next & next, Cmp & cmp)
+  {
+    Node *  head = nullptr;
+    Node ** tail = &head;
+
+    while (a != nullptr and b != nullptr)
+      if (cmp(b, a))
+	{
+	  *tail = b;
+	  tail = &next(b);
+	  b = next(b);
+	}
+      else
+	{
+	  *tail = a;
+	  tail = &next(a);
+	  a = next(a);
+	}
+
+    if (a != nullptr)
+      {
+	*tail = a;
+	last = a_last;
+      }
+    else
+      {
+	*tail = b;
+	last = b_last;
+      }
+
+    return head;
+  }
+
+  /* Sorts the null-terminated chain which begins at head, where next(p)
+   * gives a reference to the link of p and cmp compares two nodes.
+   *
+   * Nondecreasing runs are taken as they appear and merged like a binary
+   * counter: bin k holds the merge of 2^k runs, so merges stay among
+   * recently visited nodes and a sorted chain takes one pass. It is
+   * stable, O(n log n) in the worst case and uses a fixed array of 64
+   * bins as extra memory. Returns the new head and sets last to the last
+   * node.
+   */
+  template <class Node, class Next, class Cmp>
+  Node * natural_merge_sort(Node * head, Node *& last, Next & next, Cmp & cmp)
+  {
+    constexpr nat_t NUM_BINS = 64;
+
+    Node * bins[NUM_BINS];
+    Node * bins_last[NUM_BINS];
+    nat_t  num_bins = 0;
+
+    last = head;
+
+    while (head != nullptr)
+      {
+	Node * run = head;
+	Node * run_last = head;
+
+	while (next(run_last) != nullptr and
+	       not cmp(next(run_last), run_last))
+	  run_last = next(run_last);
+
+	head = next(run_last);
+	next(run_last) = nullptr;
+
+	// Older bins hold earlier items, so they go first in the merge.
+	nat_t k = 0;
+
+	for ( ; k < num_bins and bins[k] != nullptr; ++k)
+	  {
+	    run = merge_chains(bins[k], bins_last[k], run, run_last, run_last,
+			       next, cmp);
+	    bins[k] = nullptr;
+	  }
+
+	if (k == NUM_BINS)
+	  --k;
+	else if (k == num_bins)
+	  ++num_bins;
+
+	bins[k] = run;
+	bins_last[k] = run_last;
+      }
+
+    Node * result = nullptr;
+
+    for (nat_t k = 0; k < num_bins; ++k)
+      if (bins[k] != nullptr)
+	{
+	  if (result == nullptr)
+	    {
+	      result = bins[k];
+	      last = bins_last[k];
+	    }
+	  else
+	    result = merge_chains(bins[k], bins_last[k], result, last, last,
+				  next, cmp);
+	}
+
+    return result;
+  }
+
+  template <typename T, class Cmp>
+  void mergesort(NodeSLList<T> & l, Cmp & cmp)
+  {
+    using Node = typename NodeSLList<T>::Node;
+
+    if (l.is_unitarian_or_empty())
+      return;
+
+    auto next = [] (Node * p) -> Node *& { return p->get_next(); };
+
+    auto node_cmp = [&cmp] (Node * p, Node * q)
+      {
+	return cmp(p->get_item(), q->get_item());
+      };
+
+    l.get_first() = natural_merge_sort(l.get_first(), l.get_last(), next,
+				       node_cmp);
+  }
+
+  template <typename T, class Cmp = std::less<T>>
+  inline void mergesort(NodeSLList<T> & l, Cmp && cmp = Cmp())
+  {
+    mergesort<T, Cmp>(l, cmp);
+  }
+
+  template <typename T, class Cmp>
+  inline void mergesort(SLList<T> & l, Cmp & cmp)
+  {
+    mergesort<T, Cmp>((NodeSLList<T> &) l, cmp);
+  }
+
+  template <typename T, class Cmp = std::less<T>>
+  inline void mergesort(SLList<T> & l, Cmp && cmp = Cmp())
+  {
+    mergesort<T, Cmp>(l, cmp);
+  }
+
+  /// Natural merge sort of the nodes of l; cmp compares DL pointers.
+  template <class Cmp>
+  void mergesort(DL & l, Cmp & cmp)
+  {
+    if (l.is_unitarian_or_empty())
+      return;
+
+    auto next = [] (DL * p) -> DL *& { return p->get_next(); };
+
+    // The ring is opened, sorted as a singly linked chain and relinked.
+    DL * last = l.get_prev();
+    last->get_next() = nullptr;
+
+    DL * first = natural_merge_sort(l.get_next(), last, next, cmp);
+
+    DL * prev = &l;
+
+    for (DL * p = first; p != nullptr; p = p->get_next())
+      {
+	p->get_prev() = prev;
+	prev = p;
+      }
+
+    l.get_next() = first;
+    l.get_prev() = last;
+    last->get_next() = &l;
+  }
+
+  template <class Cmp>
+  inline void mergesort(DL & l, Cmp && cmp = Cmp())
+  {
+    mergesort<Cmp>(l, cmp);
+  }
+
+  template <typename T, class Cmp>
+  inline void mergesort(DLNode<T> & l, Cmp & cmp)
+  {
+    KeyCmp<T, Cmp> key_cmp(cmp);
+    mergesort<KeyCmp<T, Cmp>>(l, key_cmp);
+  }
+
+  template <typename T, class Cmp = std::less<T>>
+  inline void mergesort(DLNode<T> & l, Cmp && cmp = Cmp())
+  {
+    mergesort<T, Cmp>(l, cmp);
+  }
+
+  template <typename T, class Cmp>
+  inline void mergesort(DLList<T> & l, Cmp & cmp)
+  {
+    KeyCmp<T, Cmp> key_cmp(cmp);
+    mergesort<KeyCmp<T, Cmp>>(l, key_cmp);
+  }
+
+  template <typename T, class Cmp = std::less<T>>
+  inline void mergesort(DLList<T> & l, Cmp && cmp = Cmp())
+  {
+    mergesort<T, Cmp>(l, cmp);
+  }
+
+  // Default sort of sort() and inline_sort(): quicksort for arrays...
+  template <typename T, class Cmp, class SeqType>
+  inline void default_sort(SeqType & s, Cmp & cmp)
+  {
+    quicksort<T, Cmp>(s, cmp);
+  }
+
+  // ... and natural merge sort for lists, which is stable.
+  template <typename T, class Cmp>
+  inline void default_sort(SLList<T> & l, Cmp & cmp)
+  {
+    mergesort<T, Cmp>(l, cmp);
+  }
+
+  template <typename T, class Cmp>
+  inline void default_sort(DLList<T> & l, Cmp & cmp)
+  {
+    mergesort<T, Cmp>(l, cmp);
+  }
+
   template <typename SeqType, class Cmp = std::less<typename SeqType::ItemType>>
   inline SeqType sort(const SeqType & s, Cmp & cmp)
   {
     SeqType ret_val = s;
-    quicksort<typename SeqType::ItemType, Cmp>(ret_val, cmp);
+    default_sort<typename SeqType::ItemType, Cmp>(ret_val, cmp);
     return ret_val;
   }
 
@@ -537,7 +2598,7 @@ namespace Designar
   template <typename SeqType, class Cmp = std::less<typename SeqType::ItemType>>
   inline void inline_sort(SeqType & s, Cmp & cmp)
   {
-    quicksort<typename SeqType::ItemType, Cmp>(s, cmp);
+    default_sort<typename SeqType::ItemType, Cmp>(s, cmp);
   }
 
   template <typename SeqType, class Cmp = std::less<typename SeqType::ItemType>>
@@ -8,6 +8,7 @@
 
 #include <array.hpp>
 #include <list.hpp>
+#include <epoch.hpp>
 
 namespace Designar
 {
@@ -298,6 +299,183 @@ namespace Designar
       pop();
   }
 
+  /** Stack which keeps its first CAP items inside of the object, so that
+   *  it does not allocate while it holds at most CAP items. The items
+   *  beyond them go to a DynStack created on demand.
+   *
+   *  It suits short lived stacks of bounded expected depth, as the ones
+   *  of tree iterators; copying it copies only the items in use.
+   */
+  template <typename T, nat_t CAP = 64>
+  class InlineStack
+  {
+    T             array[CAP];
+    nat_t         num_items;
+    DynStack<T> * spill;
+
+    void copy_stack(const InlineStack &);
+
+  public:
+    using ItemType  = T;
+    using KeyType   = T;
+    using DataType  = T;
+    using ValueType = T;
+    using SizeType  = nat_t;
+
+    InlineStack()
+      : num_items(0), spill(nullptr)
+    {
+      // empty
+    }
+
+    InlineStack(const InlineStack & s)
+      : InlineStack()
+    {
+      copy_stack(s);
+    }
+
+    InlineStack(InlineStack && s)
+      : InlineStack()
+    {
+      swap(s);
+    }
+
+    InlineStack & operator = (const InlineStack & s)
+    {
+      if (this == &s)
+	return *this;
+
+      copy_stack(s);
+      return *this;
+    }
+
+    InlineStack & operator = (InlineStack && s)
+    {
+      swap(s);
+      return *this;
+    }
+
+    ~InlineStack()
+    {
+      delete spill;
+    }
+
+    void swap(InlineStack & s);
+
+    bool is_empty() const
+    {
+      return num_items == 0;
+    }
+
+    void clear()
+    {
+      num_items = 0;
+
+      if (spill != nullptr)
+	spill->clear();
+    }
+
+    nat_t size() const
+    {
+      return num_items + (spill == nullptr ? 0 : spill->size());
+    }
+
+    T & push(const T & item)
+    {
+      if (num_items < CAP)
+	return array[num_items++] = item;
+
+      if (spill == nullptr)
+	spill = new DynStack<T>;
+
+      return spill->push(item);
+    }
+
+    T & push(T && item)
+    {
+      if (num_items < CAP)
+	return array[num_items++] = std::move(item);
+
+      if (spill == nullptr)
+	spill = new DynStack<T>;
+
+      return spill->push(std::forward<T>(item));
+    }
+
+    T & top()
+    {
+      if (is_empty())
+	throw std::underflow_error("Stack is empty");
+
+      if (spill != nullptr and not spill->is_empty())
+	return spill->top();
+
+      return array[num_items - 1];
+    }
+
+    const T & top() const
+    {
+      if (is_empty())
+	throw std::underflow_error("Stack is empty");
+
+      if (spill != nullptr and not spill->is_empty())
+	return spill->top();
+
+      return array[num_items - 1];
+    }
+
+    T pop()
+    {
+      if (is_empty())
+	throw std::underflow_error("Stack is empty");
+
+      if (spill != nullptr and not spill->is_empty())
+	return spill->pop();
+
+      return std::move(array[--num_items]);
+    }
+
+    void popn(nat_t n)
+    {
+      if (n > size())
+	throw std::underflow_error("n is to large");
+
+      while (n-- > 0)
+	pop();
+    }
+  };
+
+  template <typename T, nat_t CAP>
+  void InlineStack<T, CAP>::copy_stack(const InlineStack & s)
+  {
+    for (nat_t i = 0; i < s.num_items; ++i)
+      array[i] = s.array[i];
+
+    num_items = s.num_items;
+
+    if (s.spill != nullptr and not s.spill->is_empty())
+      {
+	if (spill == nullptr)
+	  spill = new DynStack<T>(*s.spill);
+	else
+	  *spill = *s.spill;
+      }
+    else if (spill != nullptr)
+      spill->clear();
+  }
+
+  template <typename T, nat_t CAP>
+  void InlineStack<T, CAP>::swap(InlineStack & s)
+  {
+    nat_t n = std::max(num_items, s.num_items);
+
+    for (nat_t i = 0; i < n; ++i)
+      std::swap(array[i], s.array[i]);
+
+    std::swap(num_items, s.num_items);
+    std::swap(spill, s.spill);
+  }
+
   template <typename T>
   class ListStack : private SLList<T>
   {
@@ -420,5 +598,143 @@ namespace Designar
     while (n-- > 0)
       pop();
   }
+
+  /** Treiber lock-free stack.
+   *
+   *  push() and pop() are single compare-and-swap loops on the top node;
+   *  pop() throws if the stack is empty. Popped nodes are reclaimed
+   *  through Epoch.
+   */
+  template <typename T>
+  class ConcurrentStack
+  {
+    struct Node
+    {
+      T      item;
+      Node * next;
+
+      Node(const T & i)
+	: item(i), next(nullptr)
+      {
+	// empty
+      }
+
+      Node(T && i)
+	: item(std::forward<T>(i)), next(nullptr)
+      {
+	// empty
+      }
+    };
+
+    std::atomic<Node *> head;
+    std::atomic<nat_t>  num_items;
+
+    /* The counter goes up before p is published and down after it is
+     * unlinked, so a pop can never decrement it ahead of the push and
+     * wrap it around.
+     */
+    void push_node(Node * p)
+    {
+      num_items.fetch_add(1, std::memory_order_relaxed);
+
+      p->next = head.load(std::memory_order_relaxed);
+
+      while (not head.compare_exchange_weak(p->next, p,
+					    std::memory_order_release,
+					    std::memory_order_relaxed))
+	; // p->next was refreshed by the failed exchange
+    }
+
+    Node * pop_node()
+    {
+      Node * p = head.load(std::memory_order_acquire);
+
+      while (p != nullptr and
+	     not head.compare_exchange_weak(p, p->next,
+					    std::memory_order_acquire,
+					    std::memory_order_acquire))
+	; // p was refreshed by the failed exchange
+
+      if (p != nullptr)
+	num_items.fetch_sub(1, std::memory_order_relaxed);
+
+      return p;
+    }
+
+  public:
+    using ItemType  = T;
+    using KeyType   = T;
+    using DataType  = T;
+    using ValueType = T;
+    using SizeType  = nat_t;
+
+    ConcurrentStack()
+      : head(nullptr), num_items(0)
+    {
+      // empty
+    }
+
+    ConcurrentStack(const ConcurrentStack &) = delete;
+
+    ConcurrentStack & operator = (const ConcurrentStack &) = delete;
+
+    ~ConcurrentStack()
+    {
+      clear();
+    }
+
+    bool is_empty() const
+    {
+      return head.load(std::memory_order_acquire) == nullptr;
+    }
+
+    /// Number of items; only a snapshot when other threads are working.
+    nat_t size() const
+    {
+      return num_items.load(std::memory_order_relaxed);
+    }
+
+    void clear()
+    {
+      T item;
+
+      while (try_pop(item))
+	; // empty
+    }
+
+    void push(const T & item)
+    {
+      push_node(new Node(item));
+    }
+
+    void push(T && item)
+    {
+      push_node(new Node(std::forward<T>(item)));
+    }
+
+    bool try_pop(T & item)
+    {
+      EpochGuard guard;
+
+      Node * p = pop_node();
+
+      if (p == nullptr)
+	return false;
+
+      item = std::move(p->item);
+      Epoch::retire(p);
+      return true;
+    }
+
+    T pop()
+    {
+      T ret_val;
+
+      if (not try_pop(ret_val))
+	throw std::underflow_error("Stack is empty");
+
+      return ret_val;
+    }
+  };
   
 } // end namespace Designar
@@ -0,0 +1,160 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#pragma once
+
+#include <functional>
+#include <future>
+#include <exception>
+
+#include <types.hpp>
+#include <array.hpp>
+#include <queue.hpp>
+
+namespace Designar
+{
+  /** Fixed set of worker threads running submitted tasks in FIFO order.
+   *
+   *  ThreadPool::shared() returns a process-wide pool with one worker per
+   *  hardware thread; the parallel algorithms run on it by default. The
+   *  destructor runs the pending tasks before joining the workers.
+   *
+   *  @ingroup utils
+   */
+  class ThreadPool
+  {
+  public:
+    using Task = std::function<void()>;
+
+  private:
+    std::mutex              mtx;
+    std::condition_variable cond_var;
+    ListQueue<Task>         tasks;
+    FixedArray<std::thread> workers;
+    bool                    stopped;
+
+    void work();
+
+    bool pop_task(Task &);
+
+  public:
+    ThreadPool(nat_t num_threads = std::thread::hardware_concurrency());
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool & operator = (const ThreadPool &) = delete;
+
+    ~ThreadPool();
+
+    /// Pool shared by the whole process.
+    static ThreadPool & shared();
+
+    nat_t num_threads() const
+    {
+      return workers.size();
+    }
+
+    /// Number of tasks waiting for a worker.
+    nat_t num_pending() const;
+
+    /// Enqueues a task; it is run by some worker.
+    void submit(Task);
+
+    /// Enqueues f and returns a future for its result.
+    template <class F>
+    std::future<std::result_of_t<F()>> async(F && f)
+    {
+      using RetT = std::result_of_t<F()>;
+
+      auto task =
+	std::make_shared<std::packaged_task<RetT()>>(std::forward<F>(f));
+
+      std::future<RetT> ret_val = task->get_future();
+      submit([task] () { (*task)(); });
+      return ret_val;
+    }
+
+    /** Runs one pending task in the calling thread.
+     *
+     *  Threads waiting for other tasks call it so they help instead of
+     *  blocking, which avoids deadlocks on nested parallelism.
+     *
+     *  @return false if there was no pending task.
+     */
+    bool run_pending_task();
+  };
+
+  /** Set of tasks which can be waited for together.
+   *
+   *  wait() runs pending tasks of the pool while the group is not done and
+   *  rethrows the first exception thrown by a task of the group.
+   *
+   *  Usage example:
+   *  \code{.cpp}
+   *  TaskGroup group;
+   *  group.run([&] { left = solve(a); });
+   *  right = solve(b);
+   *  group.wait();
+   *  \endcode
+   */
+  class TaskGroup
+  {
+    ThreadPool            & pool;
+    std::mutex              mtx;
+    std::condition_variable cond_var;
+    nat_t                   num_running;
+    std::exception_ptr      error;
+
+    void finish_task(std::exception_ptr);
+
+  public:
+    TaskGroup(ThreadPool & _pool = ThreadPool::shared())
+      : pool(_pool), num_running(0), error(nullptr)
+    {
+      // empty
+    }
+
+    TaskGroup(const TaskGroup &) = delete;
+
+    TaskGroup & operator = (const TaskGroup &) = delete;
+
+    ~TaskGroup();
+
+    ThreadPool & get_pool()
+    {
+      return pool;
+    }
+
+    template <class F>
+    void run(F && f)
+    {
+      {
+	std::lock_guard<std::mutex> lck(mtx);
+	++num_running;
+      }
+
+      pool.submit([this, f] () mutable
+		  {
+		    std::exception_ptr e = nullptr;
+
+		    try
+		      {
+			f();
+		      }
+		    catch (...)
+		      {
+			e = std::current_exception();
+		      }
+
+		    finish_task(e);
+		  });
+    }
+
+    /// Waits for every task run in the group.
+    void wait();
+  };
+
+} // end namespace Designar
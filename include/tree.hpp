@@ -11,40 +11,116 @@
 #include <setalgorithms.hpp>
 #include <stack.hpp>
 #include <iterator.hpp>
+#include <threadpool.hpp>
 
 namespace Designar
 {
-  template <typename Key>
-  class TreapRkNode : public BaseBinTreeNode<Key, TreapRkNode<Key>,
-					     BinTreeNodeNullValue::SENTINEL>
+  /** Monoid of GenRankedTreap when no aggregate is kept.
+   *
+   *  An augmentation provides the type of the aggregate, its identity,
+   *  the aggregate of a single key and an associative combine(), which
+   *  receives the aggregate of the lesser keys first:
+   *  \code{.cpp}
+   *  struct SumOfValues
+   *  {
+   *    using ValueType = int_t;
+   *    static int_t identity() { return 0; }
+   *    static int_t lift(const MapKey<string, int_t> & p) { return p.second; }
+   *    static int_t combine(int_t a, int_t b) { return a + b; }
+   *  };
+   *  \endcode
+   */
+  struct NoAugment
   {
-    using BaseNode = BaseBinTreeNode<Key, TreapRkNode<Key>,
+    using ValueType = EmptyClass;
+
+    static EmptyClass identity()
+    {
+      return EmptyClass();
+    }
+
+    template <typename Key>
+    static EmptyClass lift(const Key &)
+    {
+      return EmptyClass();
+    }
+
+    static EmptyClass combine(const EmptyClass &, const EmptyClass &)
+    {
+      return EmptyClass();
+    }
+  };
+
+  template <typename T>
+  class TreapAggregate
+  {
+    T aggregate;
+
+  public:
+    TreapAggregate(const T & a)
+      : aggregate(a)
+    {
+      // empty
+    }
+
+    T & get_aggregate()
+    {
+      return aggregate;
+    }
+  };
+
+  // Empty aggregates take no space in the node.
+  template <>
+  class TreapAggregate<EmptyClass> : public EmptyClass
+  {
+  public:
+    TreapAggregate(const EmptyClass &)
+    {
+      // empty
+    }
+
+    EmptyClass & get_aggregate()
+    {
+      return *this;
+    }
+  };
+
+  template <typename Key, class Augment = NoAugment>
+  class TreapRkNode
+    : public BaseBinTreeNode<Key, TreapRkNode<Key, Augment>,
+			     BinTreeNodeNullValue::SENTINEL>,
+      public TreapAggregate<typename Augment::ValueType>
+  {
+    using BaseNode = BaseBinTreeNode<Key, TreapRkNode<Key, Augment>,
 				     BinTreeNodeNullValue::SENTINEL>;
+    using BaseAggregate = TreapAggregate<typename Augment::ValueType>;
     
     nat_t      count;
     rng_seed_t prior;
     
   public:
     TreapRkNode()
-      : BaseNode()
+      : BaseNode(), BaseAggregate(Augment::identity())
     {
       // empty
     }
     
     TreapRkNode(const Key & k)
-      : BaseNode(k), count(1), prior(0)
+      : BaseNode(k), BaseAggregate(Augment::lift(k)), count(1), prior(0)
     {
       // empty
     }
     
     TreapRkNode(Key && k)
-      : BaseNode(std::forward<Key>(k)), count(1), prior(0)
+      : BaseNode(std::forward<Key>(k)), BaseAggregate(Augment::identity()),
+	count(1), prior(0)
     {
-      // empty
+      this->get_aggregate() = Augment::lift(this->get_key());
     }
     
     TreapRkNode(BinTreeNodeCtor ctor)
-      : BaseNode(ctor), count(0), prior(rng_t::max())
+      : BaseNode(ctor), BaseAggregate(Augment::identity()), count(0),
+	prior(rng_t::max())
     {
       // empty
     }
@@ -63,6 +139,7 @@ namespace Designar
     {
       BaseNode::reset();
       count = 1;
+      this->get_aggregate() = Augment::lift(this->get_key());
     }
   };
 
@@ -77,14 +154,27 @@ namespace Designar
   {
     return p->get_priority();
   }
-  
-  
-  template <typename Key, class Cmp = std::less<Key>>
-    class RankedTreap : public ContainerAlgorithms<RankedTreap<Key, Cmp>, Key>,
-			public SetAlgorithms<RankedTreap<Key, Cmp>, Key>
+
+  template <class TreapNode>
+  inline auto & AGG(TreapNode * p)
+  {
+    return p->get_aggregate();
+  }
+
+  /** Treap with ranks, which also keeps in every node the aggregate of
+   *  its subtree under the monoid Augment (see NoAugment). Rotations,
+   *  splits and joins recompute it along with the count, so aggregates of
+   *  key and rank ranges take O(log n).
+   */
+  template <typename Key, class Cmp = std::less<Key>,
+	    class Augment = NoAugment>
+    class GenRankedTreap
+      : public ContainerAlgorithms<GenRankedTreap<Key, Cmp, Augment>, Key>,
+	public SetAlgorithms<GenRankedTreap<Key, Cmp, Augment>, Key>
     {
     public:
-      using Node = TreapRkNode<Key>;
+      using Node = TreapRkNode<Key, Augment>;
+      using AggType = typename Augment::ValueType;
       
     private:    
       Node    head;
@@ -100,6 +190,24 @@ namespace Designar
       static Node * copy(Node *);
 
       static void destroy(Node *&);
+
+      static void update(Node * p)
+      {
+	COUNT(p) = COUNT(L(p)) + COUNT(R(p)) + 1;
+	AGG(p) = Augment::combine(Augment::combine(AGG(L(p)),
+						   Augment::lift(KEY(p))),
+				  AGG(R(p)));
+      }
+
+      static AggType aggregate_from(Node *, const Key &, Cmp &);
+
+      static AggType aggregate_to(Node *, const Key &, Cmp &);
+
+      static AggType aggregate_from_pos(Node *, nat_t);
+
+      static AggType aggregate_to_pos(Node *, nat_t);
+
+      static bool refresh(Node *, const Key &, Cmp &);
     
       static Node * rotate_left(Node *);
 
@@ -115,6 +223,14 @@ namespace Designar
       static Node * exclusive_join(Node *&, Node *&);
 
       static void join_dup(Node *&, Node *&, Cmp &);
+
+      static Node * split_node(Node *, const Key &, Node *&, Node *&, Cmp &);
+
+      static Node * join(Node *, Node *, Cmp &, ThreadPool *);
+
+      static Node * intersect(Node *, Node *, Cmp &, ThreadPool *);
+
+      static Node * difference(Node *, Node *, Cmp &, ThreadPool *);
     
       static Node * insert(Node *&, Node *, Cmp &);
       
@@ -140,6 +256,11 @@ namespace Designar
       static Node * select(Node *, nat_t);
       
       static int_t position(Node *, const Key &, Cmp &);
+
+      static nat_t rank(Node *, const Key &, Cmp &, bool);
+
+      template <class Op>
+      static void range_rec(Node *, const Key &, const Key &, Op &, Cmp &);
       
       static Node * min(Node *);
       
@@ -153,6 +274,12 @@ namespace Designar
       
       template <class Op>
       static void postorder_rec(Node *, Op &);
+
+      template <class It>
+      static bool strictly_sorted(const It &, const It &, Cmp &);
+
+      template <class It>
+      void load(const It &, const It &);
       
       Key * insert(Node * p)
       {
@@ -182,6 +309,13 @@ namespace Designar
 	
 	return &KEY(result);
       }
+
+    protected:
+      // For extensions which walk the tree guided by the aggregates.
+      Node * get_root() const
+      {
+	return root;
+      }
       
     public:
       using ItemType  = Key;
@@ -201,50 +335,53 @@ namespace Designar
 	return verify_dup(root, cmp);
       }
       
-      RankedTreap(rng_seed_t seed, Cmp & _cmp)
+      GenRankedTreap(rng_seed_t seed, Cmp & _cmp)
 	: head(), root(L(&head)), cmp(_cmp), rng(seed)
       {
 	// empty
       }
 
-      RankedTreap(Cmp & _cmp)
-	: RankedTreap(time(nullptr), _cmp)
+      GenRankedTreap(Cmp & _cmp)
+	: GenRankedTreap(time(nullptr), _cmp)
       {
 	// empty
       }
 
-      RankedTreap(Cmp && _cmp = Cmp())
-	: RankedTreap(_cmp)
+      GenRankedTreap(Cmp && _cmp = Cmp())
+	: GenRankedTreap(_cmp)
       {
 	// empty
       }
 
-      RankedTreap(rng_seed_t seed, Cmp && _cmp = Cmp())
-	: RankedTreap(seed, _cmp)
+      GenRankedTreap(rng_seed_t seed, Cmp && _cmp = Cmp())
+	: GenRankedTreap(seed, _cmp)
       {
 	// empty
       }
 
-      RankedTreap(const RankedTreap & t)
-	: RankedTreap(t.cmp)
+      GenRankedTreap(const GenRankedTreap & t)
+	: GenRankedTreap(t.cmp)
       {
 	root = copy(t.root);
       }
 
-      RankedTreap(RankedTreap && t)
-	: RankedTreap()
+      GenRankedTreap(GenRankedTreap && t)
+	: GenRankedTreap()
       {
 	swap(t);
       }
 
-      RankedTreap(const std::initializer_list<Key> &);
+      GenRankedTreap(const std::initializer_list<Key> &);
 
-      ~RankedTreap()
+      /// Built in O(n) when the items of a are sorted and distinct.
+      GenRankedTreap(const DynArray<Key> &);
+
+      ~GenRankedTreap()
       {
 	clear();
       }
 
-      RankedTreap & operator = (const RankedTreap & t)
+      GenRankedTreap & operator = (const GenRankedTreap & t)
       {
 	if (this == &t)
 	  return *this;
@@ -255,13 +392,13 @@ namespace Designar
 	return *this;
       }
 
-      RankedTreap & operator = (RankedTreap && t)
+      GenRankedTreap & operator = (GenRankedTreap && t)
       {
 	swap(t);
 	return *this;
       }
 
-      void swap(RankedTreap & t)
+      void swap(GenRankedTreap & t)
       {
 	std::swap(root, t.root);
 	std::swap(cmp, t.cmp);
@@ -287,6 +424,24 @@ namespace Designar
 	destroy(root);
       }
 
+      /** Replaces the keys by those in [b, e), which must be sorted by cmp,
+       *  in O(n) instead of O(n log n) insertions. Equal keys are all kept,
+       *  as insert_dup does.
+       *
+       *  Keys are read in order and hung from the right spine of the tree
+       *  built so far, the Cartesian tree of their random priorities: the
+       *  nodes of the spine with greater priority than the new one become
+       *  its left subtree, and their counts are final at that point.
+       */
+      template <class It>
+      void build_from_sorted(const It &, const It &);
+
+      template <class ContainerType>
+      void build_from_sorted(const ContainerType & c)
+      {
+	build_from_sorted(c.begin(), c.end());
+      }
+
       Cmp & get_cmp()
       {
 	return cmp;
@@ -432,20 +587,20 @@ namespace Designar
 	return KEY(max(root));
       }
 
-      std::tuple<RankedTreap, RankedTreap> split_pos(nat_t i)
+      std::tuple<GenRankedTreap, GenRankedTreap> split_pos(nat_t i)
       {
 	if (i >= size())
 	  throw std::out_of_range("Infix position is out of range");
 	
-	RankedTreap ts, tg;
+	GenRankedTreap ts, tg;
 	split_pos(root, i, ts.root, tg.root);
 	root = Node::null;
 	return std::make_tuple(std::move(ts), std::move(tg));
       }
 
-      std::tuple<RankedTreap, RankedTreap> split_key(const Key & k)
+      std::tuple<GenRankedTreap, GenRankedTreap> split_key(const Key & k)
       {
-	RankedTreap ts, tg;
+	GenRankedTreap ts, tg;
 
 	if (split_key(root, k, ts.root, tg.root, cmp))
 	  root = Node::null;
@@ -453,27 +608,114 @@ namespace Designar
 	return std::make_tuple(std::move(ts), std::move(tg));
       }
 
-      std::tuple<RankedTreap, RankedTreap> split_key_dup(const Key & k)
+      std::tuple<GenRankedTreap, GenRankedTreap> split_key_dup(const Key & k)
       {
-	RankedTreap ts, tg;
+	GenRankedTreap ts, tg;
 	split_key_dup(root, k, ts.root, tg.root, cmp);
 	root = Node::null;
 	return std::make_tuple(std::move(ts), std::move(tg));
       }
 
-      void exclusive_join(RankedTreap & ts, RankedTreap & tg)
+      void exclusive_join(GenRankedTreap & ts, GenRankedTreap & tg)
       {
 	root = exclusive_join(ts.root, tg.root);
 	ts.root = tg.root = Node::null;
       }
 
-      void join_dup(RankedTreap & ts, RankedTreap & tg)
+      void join_dup(GenRankedTreap & ts, GenRankedTreap & tg)
       {
 	join_dup(ts.root, tg.root, cmp);
 	root = ts.root;
 	ts.root = tg.root = Node::null;
       }
 
+      /** Keeps the union of the keys of this and t, and leaves t empty.
+       *  Keys of this are kept over the equal ones of t.
+       *
+       *  The root with less priority stays, the other tree is split by its
+       *  key and both sides are joined recursively; sides over
+       *  ParallelJoinThreshold keys run as tasks of pool, or of
+       *  ThreadPool::shared() when pool is null, so smaller joins start no
+       *  thread. It takes O(m log(n/m + 1)) work for sizes m <= n, against
+       *  O(m log n) of m insertions, and O(log n log m) span.
+       */
+      void join_with(GenRankedTreap & t, ThreadPool * pool = nullptr)
+      {
+	root = join(root, t.root, cmp, pool);
+	t.root = Node::null;
+      }
+
+      /// Keeps the keys of this which are also in t, and leaves t empty.
+      void intersect_with(GenRankedTreap & t, ThreadPool * pool = nullptr)
+      {
+	root = intersect(root, t.root, cmp, pool);
+	t.root = Node::null;
+      }
+
+      /// Keeps the keys of this which are not in t, and leaves t empty.
+      void difference_with(GenRankedTreap & t, ThreadPool * pool = nullptr)
+      {
+	root = difference(root, t.root, cmp, pool);
+	t.root = Node::null;
+      }
+
+      static GenRankedTreap join(const GenRankedTreap & s1,
+				 const GenRankedTreap & s2)
+      {
+	GenRankedTreap ret_val = s1;
+	GenRankedTreap t = s2;
+	ret_val.join_with(t);
+	return ret_val;
+      }
+
+      GenRankedTreap join(const GenRankedTreap & s) const
+      {
+	return join(*this, s);
+      }
+
+      static GenRankedTreap intersect(const GenRankedTreap & s1,
+				   const GenRankedTreap & s2)
+      {
+	GenRankedTreap ret_val = s1;
+	GenRankedTreap t = s2;
+	ret_val.intersect_with(t);
+	return ret_val;
+      }
+
+      GenRankedTreap intersect(const GenRankedTreap & s) const
+      {
+	return intersect(*this, s);
+      }
+
+      static GenRankedTreap difference(const GenRankedTreap & s1,
+				    const GenRankedTreap & s2)
+      {
+	GenRankedTreap ret_val = s1;
+	GenRankedTreap t = s2;
+	ret_val.difference_with(t);
+	return ret_val;
+      }
+
+      GenRankedTreap difference(const GenRankedTreap & s) const
+      {
+	return difference(*this, s);
+      }
+
+      /** Inserts the keys of batch which are not in the tree yet and
+       *  returns how many were. The batch is built in O(m) when sorted and
+       *  joined with the tree by join_with.
+       */
+      template <class ContainerType>
+      nat_t multi_insert(const ContainerType & batch,
+			 ThreadPool * pool = nullptr)
+      {
+	nat_t old_size = size();
+	GenRankedTreap t(rng(), cmp);
+	t.load(batch.begin(), batch.end());
+	join_with(t, pool);
+	return size() - old_size;
+      }
+
       Key & select(nat_t i)
       {
 	if (i >= size())
@@ -495,6 +737,130 @@ namespace Designar
 	return position(root, k, cmp);
       }
 
+      /// Aggregate of all the keys.
+      AggType aggregate() const
+      {
+	return AGG(root);
+      }
+
+      /// Aggregate of the keys k such that lo <= k <= hi, in O(log n).
+      AggType aggregate(const Key & lo, const Key & hi) const
+      {
+	Node * r = root;
+
+	if (cmp(hi, lo))
+	  return Augment::identity();
+
+	while (r != Node::null)
+	  if (cmp(KEY(r), lo))
+	    r = R(r);
+	  else if (cmp(hi, KEY(r)))
+	    r = L(r);
+	  else
+	    break;
+
+	if (r == Node::null)
+	  return Augment::identity();
+
+	return Augment::combine(Augment::combine(aggregate_from(L(r), lo, cmp),
+						 Augment::lift(KEY(r))),
+				aggregate_to(R(r), hi, cmp));
+      }
+
+      /// Aggregate of the keys at infix positions i to j, in O(log n).
+      AggType aggregate_pos(nat_t i, nat_t j) const
+      {
+	if (i > j or j >= size())
+	  throw std::out_of_range("Infix position is out of range");
+
+	Node * r = root;
+
+	while (true)
+	  if (j < COUNT(L(r)))
+	    r = L(r);
+	  else if (i > COUNT(L(r)))
+	    {
+	      i -= COUNT(L(r)) + 1;
+	      j -= COUNT(L(r)) + 1;
+	      r = R(r);
+	    }
+	  else
+	    break;
+
+	AggType ret_val = Augment::combine(aggregate_from_pos(L(r), i),
+					   Augment::lift(KEY(r)));
+
+	if (j == COUNT(L(r)))
+	  return ret_val;
+
+	return Augment::combine(ret_val,
+				aggregate_to_pos(R(r), j - COUNT(L(r)) - 1));
+      }
+
+      /** Recomputes the aggregates on the path to k, after a change to the
+       *  parts of a key which do not take part in the comparison (as the
+       *  value in a TreeMap). Returns false if k is not in the tree.
+       */
+      bool refresh(const Key & k)
+      {
+	return refresh(root, k, cmp);
+      }
+
+      /// Number of keys k such that lo <= k <= hi, in O(log n).
+      nat_t count_range(const Key & lo, const Key & hi) const
+      {
+	if (cmp(hi, lo))
+	  return 0;
+
+	return rank(root, hi, cmp, true) - rank(root, lo, cmp, false);
+      }
+
+      /// Applies op to the keys k such that lo <= k <= hi, in order.
+      template <class Op>
+      void for_each_in_range(const Key & lo, const Key & hi, Op & op) const
+      {
+	range_rec<Op>(root, lo, hi, op, cmp);
+      }
+
+      template <class Op>
+      void for_each_in_range(const Key & lo, const Key & hi,
+			     Op && op = Op()) const
+      {
+	for_each_in_range<Op>(lo, hi, op);
+      }
+
+      /** Removes the keys k such that lo <= k <= hi and returns how many
+       *  were. The tree is split at the ranks of lo and hi and its ends are
+       *  joined back, in O(log n) plus the release of the removed nodes.
+       */
+      nat_t remove_range(const Key & lo, const Key & hi)
+      {
+	if (cmp(hi, lo))
+	  return 0;
+
+	nat_t i = rank(root, lo, cmp, false);
+	nat_t j = rank(root, hi, cmp, true);
+
+	if (i == j)
+	  return 0;
+
+	Node * ts = Node::null, * mid = root, * tg = Node::null;
+
+	if (j < size())
+	  split_pos(root, j, mid, tg);
+
+	if (i > 0)
+	  {
+	    Node * r = mid;
+	    split_pos(r, i, ts, mid);
+	  }
+
+	destroy(mid);
+	root = exclusive_join(ts, tg);
+
+	return j - i;
+      }
+
       Key & operator [] (nat_t i)
       {
 	return select(i);
@@ -543,16 +909,16 @@ namespace Designar
 
       class PreorderIterator
       {
-	friend class RankedTreap;
+	friend class GenRankedTreap;
       
-	DynStack<Node *> stack;
+	InlineStack<Node *, TreeIteratorStackSize> stack;
 	Node *    root = Node::null;
 	Node *    curr = Node::null;
 
 	Node * last(Node *);
 
       protected:
-	PreorderIterator(const RankedTreap & t, int)
+	PreorderIterator(const GenRankedTreap & t, int)
 	  : root(t.root), curr(Node::null)
 	{
 	  // empty
@@ -564,7 +930,7 @@ namespace Designar
 	}
 
       public:
-	PreorderIterator(const RankedTreap & t)
+	PreorderIterator(const GenRankedTreap & t)
 	  : root(t.root), curr(root)
 	{
 	  // empty
@@ -601,7 +967,7 @@ namespace Designar
       
 	void swap(PreorderIterator & it)
 	{
-	  std::swap(stack, it.stack);
+	  stack.swap(it.stack);
 	  std::swap(root, it.root);
 	  std::swap(curr, it.curr);
 	}
@@ -652,10 +1018,10 @@ namespace Designar
 
       class InorderIterator
       {
-	friend class RankedTreap;
+	friend class GenRankedTreap;
 	
-	RankedTreap * set_ptr = nullptr;
-	DynStack<Node *> stack;
+	GenRankedTreap * set_ptr = nullptr;
+	InlineStack<Node *, TreeIteratorStackSize> stack;
 	Node * root = Node::null;
 	Node * curr = Node::null;
 	
@@ -672,8 +1038,8 @@ namespace Designar
 	}
 
       protected:
-	InorderIterator(const RankedTreap & t, int)
-	  : set_ptr(const_cast<RankedTreap *>(&t)), root(set_ptr->root),
+	InorderIterator(const GenRankedTreap & t, int)
+	  : set_ptr(const_cast<GenRankedTreap *>(&t)), root(set_ptr->root),
 	    curr(Node::null)
 	{
 	  // empty
@@ -685,8 +1051,8 @@ namespace Designar
 	}
 	
       public:
-	InorderIterator(const RankedTreap & t)
-	  : set_ptr(const_cast<RankedTreap *>(&t)), root(set_ptr->root)
+	InorderIterator(const GenRankedTreap & t)
+	  : set_ptr(const_cast<GenRankedTreap *>(&t)), root(set_ptr->root)
 	{
 	  init();
 	}
@@ -707,6 +1073,7 @@ namespace Designar
 	  if (this == &it)
 	    return *this;
 
+	  set_ptr = it.set_ptr;
 	  stack = it.stack;
 	  root = it.root;
 	  curr = it.curr;
@@ -722,7 +1089,8 @@ namespace Designar
       
 	void swap(InorderIterator & it)
 	{
-	  std::swap(stack, it.stack);
+	  std::swap(set_ptr, it.set_ptr);
+	  stack.swap(it.stack);
 	  std::swap(root, it.root);
 	  std::swap(curr, it.curr);
 	}
@@ -785,13 +1153,61 @@ namespace Designar
 
 	  return to_remove;
 	}
+
+      private:
+	// The nodes left behind on the way down are the pending ancestors.
+	void seek_key(const Key & k, bool inclusive)
+	{
+	  Cmp & cmp = set_ptr->cmp;
+	  Node * r = root;
+
+	  stack.clear();
+	  curr = Node::null;
+
+	  while (r != Node::null)
+	    if (inclusive ? not cmp(k, KEY(r)) : cmp(KEY(r), k))
+	      r = R(r);
+	    else
+	      {
+		stack.push(r);
+		r = L(r);
+	      }
+
+	  if (not stack.is_empty())
+	    curr = stack.pop();
+	}
+
+	void seek_pos(nat_t i)
+	{
+	  Node * r = root;
+
+	  stack.clear();
+	  curr = Node::null;
+
+	  while (r != Node::null)
+	    if (i < COUNT(L(r)))
+	      {
+		stack.push(r);
+		r = L(r);
+	      }
+	    else if (i == COUNT(L(r)))
+	      {
+		curr = r;
+		return;
+	      }
+	    else
+	      {
+		i -= COUNT(L(r)) + 1;
+		r = R(r);
+	      }
+	}
       };
 
       class PostorderIterator
       {
-	friend class RankedTreap;
+	friend class GenRankedTreap;
       
-	DynStack<Node *> stack;
+	InlineStack<Node *, TreeIteratorStackSize> stack;
 	Node * root = Node::null;
 	Node * curr = Node::null;
 
@@ -806,7 +1222,7 @@ namespace Designar
 	}
 
       protected:
-	PostorderIterator(const RankedTreap & t, int)
+	PostorderIterator(const GenRankedTreap & t, int)
 	  : root(t.root), curr(Node::null)
 	{
 	  // empty
@@ -818,7 +1234,7 @@ namespace Designar
 	}
 
       public:
-	PostorderIterator(const RankedTreap & t)
+	PostorderIterator(const GenRankedTreap & t)
 	  : root(t.root)
 	{
 	  init();
@@ -855,7 +1271,7 @@ namespace Designar
       
 	void swap(PostorderIterator & it)
 	{
-	  std::swap(stack, it.stack);
+	  stack.swap(it.stack);
 	  std::swap(root, it.root);
 	  std::swap(curr, it.curr);
 	}
@@ -920,7 +1336,7 @@ namespace Designar
       class Iterator : public InorderIterator,
 		       public ForwardIterator<Iterator, Key>
       {
-	friend class RankedTreap;
+	friend class GenRankedTreap;
 	friend class BasicIterator<Iterator, Key>;
 	using Base = InorderIterator;
 	using Base::Base;
@@ -945,18 +1361,123 @@ namespace Designar
       {
 	return Iterator(*this, 0);
       }
+
+      /// Iterator to the first key not less than k, in O(log n).
+      Iterator lower_bound(const Key & k) const
+      {
+	Iterator it(*this, 0);
+	it.seek_key(k, false);
+	return it;
+      }
+
+      /// Iterator to the first key greater than k, in O(log n).
+      Iterator upper_bound(const Key & k) const
+      {
+	Iterator it(*this, 0);
+	it.seek_key(k, true);
+	return it;
+      }
+
+      /// Iterator to the key at infix position i, or end() if i >= size().
+      Iterator seek(nat_t i) const
+      {
+	Iterator it(*this, 0);
+	it.seek_pos(i);
+	return it;
+      }
     };
 
-  template <typename Key, class Cmp>
-  RankedTreap<Key, Cmp>::RankedTreap(const std::initializer_list<Key> & l)
-    : RankedTreap()
+  template <typename Key, class Cmp = std::less<Key>>
+  using RankedTreap = GenRankedTreap<Key, Cmp, NoAugment>;
+
+  template <typename Key, class Cmp, class Augment>
+  GenRankedTreap<Key, Cmp, Augment>::
+  GenRankedTreap(const std::initializer_list<Key> & l)
+    : GenRankedTreap()
   {
-    for (const auto & item : l)
-      append(item);
+    load(l.begin(), l.end());
   }
 
-  template <typename Key, class Cmp>
-  bool RankedTreap<Key, Cmp>::verify(Node * r, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  GenRankedTreap<Key, Cmp, Augment>::GenRankedTreap(const DynArray<Key> & a)
+    : GenRankedTreap()
+  {
+    load(a.begin(), a.end());
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  template <class It>
+  bool
+  GenRankedTreap<Key, Cmp, Augment>::strictly_sorted(const It & b, const It & e,
+						     Cmp & cmp)
+  {
+    if (b == e)
+      return true;
+
+    It prev = b;
+
+    for (It it = b; ++it != e; prev = it)
+      if (not cmp(*prev, *it))
+	return false;
+
+    return true;
+  }
+
+  // Builds from sorted input in O(n); anything else is inserted.
+  template <typename Key, class Cmp, class Augment>
+  template <class It>
+  void GenRankedTreap<Key, Cmp, Augment>::load(const It & b, const It & e)
+  {
+    if (strictly_sorted(b, e, cmp))
+      {
+	build_from_sorted(b, e);
+	return;
+      }
+
+    for (It it = b; it != e; ++it)
+      append(*it);
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  template <class It>
+  void
+  GenRankedTreap<Key, Cmp, Augment>::build_from_sorted(const It & b,
+							const It & e)
+  {
+    clear();
+
+    DynStack<Node *> spine;
+
+    for (It it = b; it != e; ++it)
+      {
+	Node * p = new Node(*it);
+	PRIOR(p) = rng();
+
+	Node * last = Node::null;
+
+	while (not spine.is_empty() and PRIOR(p) < PRIOR(spine.top()))
+	  {
+	    last = spine.pop();
+	    update(last);
+	  }
+
+	L(p) = last;
+
+	if (not spine.is_empty())
+	  R(spine.top()) = p;
+
+	spine.push(p);
+      }
+
+    while (not spine.is_empty())
+      {
+	root = spine.pop();
+	update(root);
+      }
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  bool GenRankedTreap<Key, Cmp, Augment>::verify(Node * r, Cmp & cmp)
   {
     if (r == Node::null)
       return true;
@@ -982,8 +1503,8 @@ namespace Designar
     return test;
   }
 
-  template <typename Key, class Cmp>
-  bool RankedTreap<Key, Cmp>::verify_dup(Node * r, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  bool GenRankedTreap<Key, Cmp, Augment>::verify_dup(Node * r, Cmp & cmp)
   {
     if (r == Node::null)
       return true;
@@ -1009,22 +1530,24 @@ namespace Designar
     return test;
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node * RankedTreap<Key, Cmp>::copy(Node * r)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::copy(Node * r)
   {
     if (r == Node::null)
       return Node::null;
 
     Node * p = new Node(KEY(r));
     COUNT(p) = COUNT(r);
+    AGG(p) = AGG(r);
     PRIOR(p) = PRIOR(r);
     L(p) = copy(L(r));
     R(p) = copy(R(r));
     return p;
   }
   
-  template <typename Key, class Cmp>
-  void RankedTreap<Key, Cmp>::destroy(Node *& r)
+  template <typename Key, class Cmp, class Augment>
+  void GenRankedTreap<Key, Cmp, Augment>::destroy(Node *& r)
   {
     if (r == Node::null)
       return;
@@ -1035,44 +1558,44 @@ namespace Designar
     r = Node::null;
   }
   
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::rotate_left(Node * r)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::rotate_left(Node * r)
   {
     Node * q = R(r);
     R(r) = L(q);
     L(q) = r;
     
-    COUNT(r) = COUNT(L(r)) + COUNT(R(r)) + 1;
-    COUNT(q) = COUNT(L(q)) + COUNT(R(q)) + 1;
+    update(r);
+    update(q);
     
     return q;
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::rotate_right(Node * r)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::rotate_right(Node * r)
   {
     Node * q = L(r);
     L(r) = R(q);
     R(q) = r;
       
-    COUNT(r) = COUNT(L(r)) + COUNT(R(r)) + 1;
-    COUNT(q) = COUNT(L(q)) + COUNT(R(q)) + 1;
+    update(r);
+    update(q);
     
     return q;
   }
 
-  template <typename Key, class Cmp>
-  void RankedTreap<Key, Cmp>::split_pos(Node * r, nat_t i,
-					Node *& ts, Node *& tg)
+  template <typename Key, class Cmp, class Augment>
+  void GenRankedTreap<Key, Cmp, Augment>::split_pos(Node * r, nat_t i,
+						    Node *& ts, Node *& tg)
   {
     if (i == COUNT(L(r)))
       {
 	ts = L(r);
 	tg = r;
 	L(tg) = Node::null;
-	COUNT(tg) -= COUNT(ts);
+	update(tg);
 	return;
       }
 
@@ -1080,19 +1603,20 @@ namespace Designar
       {
 	split_pos(L(r), i, ts, L(r));
 	tg = r;
-	COUNT(r) -= COUNT(ts);
+	update(r);
       }
     else
       {
 	split_pos(R(r), i - (COUNT(L(r)) + 1), R(r), tg);
 	ts = r;
-	COUNT(r) -= COUNT(tg);
+	update(r);
       }
   }
 
-  template <typename Key, class Cmp>
-  bool RankedTreap<Key, Cmp>::split_key(Node * r, const Key & k,
-					Node *& ts, Node *& tg, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  bool GenRankedTreap<Key, Cmp, Augment>::split_key(Node * r, const Key & k,
+						    Node *& ts, Node *& tg,
+						    Cmp & cmp)
   {
     if (r == Node::null)
       {
@@ -1105,7 +1629,7 @@ namespace Designar
 	if (split_key(L(r), k, ts, L(r), cmp))
 	  {
 	    tg = r;
-	    COUNT(tg) -= COUNT(ts);
+	    update(tg);
 	    return true;
 	  }
       }
@@ -1114,7 +1638,7 @@ namespace Designar
 	if (split_key(R(r), k, R(r), tg, cmp))
 	  {
 	    ts = r;
-	    COUNT(ts) -= COUNT(tg);
+	    update(ts);
 	    return true;
 	  }
       }
@@ -1122,10 +1646,10 @@ namespace Designar
     return false;
   }
 
-  template <typename Key, class Cmp>
-  void RankedTreap<Key, Cmp>::split_key_dup(Node * r, const Key & k,
-					    Node *& ts, Node *& tg,
-					    Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  void GenRankedTreap<Key, Cmp, Augment>::split_key_dup(Node * r, const Key & k,
+							Node *& ts, Node *& tg,
+							Cmp & cmp)
   {
     if (r == Node::null)
       {
@@ -1137,19 +1661,19 @@ namespace Designar
       {
 	split_key_dup(L(r), k, ts, L(r), cmp);
 	tg = r;
-	COUNT(tg) -= COUNT(ts);
+	update(tg);
       }
     else
       {
 	split_key_dup(R(r), k, R(r), tg, cmp);
 	ts = r;
-	COUNT(ts) -= COUNT(tg);
+	update(ts);
       }
   }
   
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::exclusive_join(Node *& ts, Node *& tg)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::exclusive_join(Node *& ts, Node *& tg)
   {
     if (ts == Node::null)
       return tg;
@@ -1159,20 +1683,21 @@ namespace Designar
 
     if (PRIOR(ts) < PRIOR(tg))
       {
-	COUNT(ts) += COUNT(tg);
 	R(ts) = exclusive_join(R(ts), tg);
+	update(ts);
 	return ts;
       }
     else
       {
-	COUNT(tg) += COUNT(ts);
 	L(tg) = exclusive_join(ts, L(tg));
+	update(tg);
 	return tg;
       }
   }
 
-  template <typename Key, class Cmp>
-  void RankedTreap<Key, Cmp>::join_dup(Node *& t1, Node *& t2, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  void
+  GenRankedTreap<Key, Cmp, Augment>::join_dup(Node *& t1, Node *& t2, Cmp & cmp)
   {
     if (t2 == Node::null)
       return;
@@ -1186,9 +1711,228 @@ namespace Designar
     join_dup(t1, r, cmp);
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::insert(Node *& r, Node * p, Cmp & cmp)
+  // As split_key, but the node with key k, if any, is detached and returned.
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::split_node(Node * r, const Key & k,
+						Node *& ts, Node *& tg,
+						Cmp & cmp)
+  {
+    if (r == Node::null)
+      {
+	ts = tg = Node::null;
+	return Node::null;
+      }
+
+    Node * ret_val;
+
+    if (cmp(k, KEY(r)))
+      {
+	ret_val = split_node(L(r), k, ts, L(r), cmp);
+	tg = r;
+	update(tg);
+      }
+    else if (cmp(KEY(r), k))
+      {
+	ret_val = split_node(R(r), k, R(r), tg, cmp);
+	ts = r;
+	update(ts);
+      }
+    else
+      {
+	ts = L(r);
+	tg = R(r);
+	r->reset();
+	ret_val = r;
+      }
+
+    return ret_val;
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::join(Node * t1, Node * t2, Cmp & cmp,
+					  ThreadPool * pool)
+  {
+    if (t1 == Node::null)
+      return t2;
+
+    if (t2 == Node::null)
+      return t1;
+
+    const bool parallel = COUNT(t1) + COUNT(t2) > ParallelJoinThreshold;
+
+    if (parallel and pool == nullptr)
+      pool = &ThreadPool::shared();
+
+    // Keys of t1 win, so they go first in the recursive calls.
+    if (PRIOR(t2) < PRIOR(t1))
+      {
+	Node * ts, * tg;
+	Node * p = split_node(t1, KEY(t2), ts, tg, cmp);
+
+	if (p != Node::null)
+	  {
+	    KEY(t2) = std::move(KEY(p));
+	    delete p;
+	  }
+
+	if (parallel)
+	  {
+	    TaskGroup group(*pool);
+	    group.run([&] { L(t2) = join(ts, L(t2), cmp, pool); });
+	    R(t2) = join(tg, R(t2), cmp, pool);
+	    group.wait();
+	  }
+	else
+	  {
+	    L(t2) = join(ts, L(t2), cmp, pool);
+	    R(t2) = join(tg, R(t2), cmp, pool);
+	  }
+
+	update(t2);
+	return t2;
+      }
+
+    Node * ts, * tg;
+    Node * p = split_node(t2, KEY(t1), ts, tg, cmp);
+
+    if (p != Node::null)
+      delete p;
+
+    if (parallel)
+      {
+	TaskGroup group(*pool);
+	group.run([&] { L(t1) = join(L(t1), ts, cmp, pool); });
+	R(t1) = join(R(t1), tg, cmp, pool);
+	group.wait();
+      }
+    else
+      {
+	L(t1) = join(L(t1), ts, cmp, pool);
+	R(t1) = join(R(t1), tg, cmp, pool);
+      }
+
+    update(t1);
+    return t1;
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::intersect(Node * t1, Node * t2, Cmp & cmp,
+					       ThreadPool * pool)
+  {
+    if (t1 == Node::null or t2 == Node::null)
+      {
+	destroy(t1);
+	destroy(t2);
+	return Node::null;
+      }
+
+    const bool parallel = COUNT(t1) + COUNT(t2) > ParallelJoinThreshold;
+
+    if (parallel and pool == nullptr)
+      pool = &ThreadPool::shared();
+    const bool swapped = PRIOR(t2) < PRIOR(t1);
+
+    if (swapped)
+      std::swap(t1, t2);
+
+    Node * ts, * tg;
+    Node * p = split_node(t2, KEY(t1), ts, tg, cmp);
+    Node * l = L(t1);
+    Node * r = R(t1);
+
+    // Keys of the first argument win.
+    if (swapped)
+      {
+	std::swap(l, ts);
+	std::swap(r, tg);
+      }
+
+    if (parallel)
+      {
+	TaskGroup group(*pool);
+	group.run([&] { l = intersect(l, ts, cmp, pool); });
+	r = intersect(r, tg, cmp, pool);
+	group.wait();
+      }
+    else
+      {
+	l = intersect(l, ts, cmp, pool);
+	r = intersect(r, tg, cmp, pool);
+      }
+
+    if (p == Node::null)
+      {
+	delete t1;
+	return exclusive_join(l, r);
+      }
+
+    if (swapped)
+      KEY(t1) = std::move(KEY(p));
+
+    delete p;
+
+    L(t1) = l;
+    R(t1) = r;
+    update(t1);
+    return t1;
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::difference(Node * t1, Node * t2, Cmp & cmp,
+						ThreadPool * pool)
+  {
+    if (t1 == Node::null)
+      {
+	destroy(t2);
+	return Node::null;
+      }
+
+    if (t2 == Node::null)
+      return t1;
+
+    const bool parallel = COUNT(t1) + COUNT(t2) > ParallelJoinThreshold;
+
+    if (parallel and pool == nullptr)
+      pool = &ThreadPool::shared();
+
+    Node * ts, * tg;
+    Node * p = split_node(t2, KEY(t1), ts, tg, cmp);
+    Node * l = L(t1);
+    Node * r = R(t1);
+
+    if (parallel)
+      {
+	TaskGroup group(*pool);
+	group.run([&] { l = difference(l, ts, cmp, pool); });
+	r = difference(r, tg, cmp, pool);
+	group.wait();
+      }
+    else
+      {
+	l = difference(l, ts, cmp, pool);
+	r = difference(r, tg, cmp, pool);
+      }
+
+    if (p != Node::null)
+      {
+	delete p;
+	delete t1;
+	return exclusive_join(l, r);
+      }
+
+    L(t1) = l;
+    R(t1) = r;
+    update(t1);
+    return t1;
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::insert(Node *& r, Node * p, Cmp & cmp)
   {
     if (r == Node::null)
       {
@@ -1203,7 +1947,7 @@ namespace Designar
 	if (result == Node::null)
 	  return Node::null;
 	
-	++COUNT(r);
+	update(r);
 	    
 	if (PRIOR(L(r)) < PRIOR(r))
 	  r = result = rotate_right(r);
@@ -1217,7 +1961,7 @@ namespace Designar
 	if (result == Node::null)
 	  return Node::null;
 	
-	++COUNT(r);
+	update(r);
 	    
 	if (PRIOR(R(r)) < PRIOR(r))
 	  r = result = rotate_left(r);
@@ -1228,9 +1972,9 @@ namespace Designar
     return Node::null;
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::insert_dup(Node *& r, Node * p, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::insert_dup(Node *& r, Node * p, Cmp & cmp)
   {
     if (r == Node::null)
       {
@@ -1245,7 +1989,7 @@ namespace Designar
 	if (result == Node::null)
 	  return Node::null;
 	
-	++COUNT(r);
+	update(r);
 	    
 	if (PRIOR(L(r)) < PRIOR(r))
 	  r = result = rotate_right(r);
@@ -1258,7 +2002,7 @@ namespace Designar
     if (result == Node::null)
       return Node::null;
     
-    ++COUNT(r);
+    update(r);
     
     if (PRIOR(R(r)) < PRIOR(r))
       r = result = rotate_left(r);
@@ -1266,9 +2010,9 @@ namespace Designar
     return result;	
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::search(Node * r, const Key & k, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::search(Node * r, const Key & k, Cmp & cmp)
   {
     if (r == Node::null)
       return Node::null;
@@ -1281,9 +2025,9 @@ namespace Designar
     return r;
   }
   
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::search(Node * r, Key && k, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::search(Node * r, Key && k, Cmp & cmp)
   {
     if (r == Node::null)
       return Node::null;
@@ -1297,9 +2041,10 @@ namespace Designar
   }
 
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::search_or_insert(Node *& r, Node * p, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::search_or_insert(Node *& r, Node * p,
+						       Cmp & cmp)
   {
     if (r == Node::null)
       {
@@ -1313,7 +2058,7 @@ namespace Designar
 
 	if (result == p)
 	  {	
-	    ++COUNT(r);
+	    update(r);
 	    
 	    if (PRIOR(L(r)) < PRIOR(r))
 	      r = result = rotate_right(r);
@@ -1327,7 +2072,7 @@ namespace Designar
 	
 	if (result == p)
 	  {
-	    ++COUNT(r);
+	    update(r);
 	    
 	    if (PRIOR(R(r)) < PRIOR(r))
 	      r = result = rotate_left(r);
@@ -1339,9 +2084,9 @@ namespace Designar
     return r;
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::remove(Node *& r, const Key & k, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::remove(Node *& r, const Key & k, Cmp & cmp)
   {
     if (r == Node::null)
       return Node::null;
@@ -1351,7 +2096,7 @@ namespace Designar
 	Node * result = remove(L(r), k, cmp);
 
 	if (result != Node::null)
-	  --COUNT(r);
+	  update(r);
 
 	return result;
       }
@@ -1360,7 +2105,7 @@ namespace Designar
 	Node * result = remove(R(r), k, cmp);
 
 	if (result != Node::null)
-	  --COUNT(r);
+	  update(r);
 
 	return result;
       }
@@ -1368,9 +2113,9 @@ namespace Designar
     return remove_root(r);
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::remove_pos(Node *& r, nat_t i)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::remove_pos(Node *& r, nat_t i)
   {
     if (COUNT(L(r)) == i)
       return remove_root(r);
@@ -1382,13 +2127,13 @@ namespace Designar
     else
       result = remove_pos(R(r), i - COUNT(L(r)) - 1);
 
-    --COUNT(r);    
+    update(r);    
     return result;
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::select(Node * r, nat_t i)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::select(Node * r, nat_t i)
   {
     if (COUNT(L(r)) == i)
       return r;
@@ -1399,8 +2144,10 @@ namespace Designar
     return select(R(r), i - COUNT(L(r)) - 1);
   }
 
-  template <typename Key, class Cmp>
-  int_t RankedTreap<Key, Cmp>::position(Node * r, const Key & k, Cmp & cmp)
+  template <typename Key, class Cmp, class Augment>
+  int_t
+  GenRankedTreap<Key, Cmp, Augment>::position(Node * r, const Key & k,
+					       Cmp & cmp)
   {
     if (r == Node::null)
       return -1;
@@ -1419,8 +2166,163 @@ namespace Designar
 
     return COUNT(L(r));
   }
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node * RankedTreap<Key, Cmp>::min(Node * r)
+  // Aggregate of the keys of r not less than lo.
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::AggType
+  GenRankedTreap<Key, Cmp, Augment>::aggregate_from(Node * r, const Key & lo,
+						    Cmp & cmp)
+  {
+    AggType ret_val = Augment::identity();
+
+    while (r != Node::null)
+      if (cmp(KEY(r), lo))
+	r = R(r);
+      else
+	{
+	  ret_val = Augment::combine(Augment::combine(Augment::lift(KEY(r)),
+						      AGG(R(r))), ret_val);
+	  r = L(r);
+	}
+
+    return ret_val;
+  }
+
+  // Aggregate of the keys of r not greater than hi.
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::AggType
+  GenRankedTreap<Key, Cmp, Augment>::aggregate_to(Node * r, const Key & hi,
+						  Cmp & cmp)
+  {
+    AggType ret_val = Augment::identity();
+
+    while (r != Node::null)
+      if (cmp(hi, KEY(r)))
+	r = L(r);
+      else
+	{
+	  ret_val = Augment::combine(ret_val,
+				     Augment::combine(AGG(L(r)),
+						      Augment::lift(KEY(r))));
+	  r = R(r);
+	}
+
+    return ret_val;
+  }
+
+  // Aggregate of the keys of r from infix position i on.
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::AggType
+  GenRankedTreap<Key, Cmp, Augment>::aggregate_from_pos(Node * r, nat_t i)
+  {
+    AggType ret_val = Augment::identity();
+
+    while (r != Node::null)
+      if (i > COUNT(L(r)))
+	{
+	  i -= COUNT(L(r)) + 1;
+	  r = R(r);
+	}
+      else
+	{
+	  ret_val = Augment::combine(Augment::combine(Augment::lift(KEY(r)),
+						      AGG(R(r))), ret_val);
+	  r = L(r);
+	}
+
+    return ret_val;
+  }
+
+  // Aggregate of the keys of r up to infix position j.
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::AggType
+  GenRankedTreap<Key, Cmp, Augment>::aggregate_to_pos(Node * r, nat_t j)
+  {
+    AggType ret_val = Augment::identity();
+
+    while (r != Node::null)
+      if (j < COUNT(L(r)))
+	r = L(r);
+      else
+	{
+	  ret_val = Augment::combine(ret_val,
+				     Augment::combine(AGG(L(r)),
+						      Augment::lift(KEY(r))));
+
+	  if (j == COUNT(L(r)))
+	    break;
+
+	  j -= COUNT(L(r)) + 1;
+	  r = R(r);
+	}
+
+    return ret_val;
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  bool GenRankedTreap<Key, Cmp, Augment>::refresh(Node * r, const Key & k,
+						  Cmp & cmp)
+  {
+    if (r == Node::null)
+      return false;
+
+    bool found = true;
+
+    if (cmp(k, KEY(r)))
+      found = refresh(L(r), k, cmp);
+    else if (cmp(KEY(r), k))
+      found = refresh(R(r), k, cmp);
+
+    if (found)
+      update(r);
+
+    return found;
+  }
+
+  // Number of keys less than k, or not greater than k if inclusive.
+  template <typename Key, class Cmp, class Augment>
+  nat_t
+  GenRankedTreap<Key, Cmp, Augment>::rank(Node * r, const Key & k, Cmp & cmp,
+					  bool inclusive)
+  {
+    nat_t ret_val = 0;
+
+    while (r != Node::null)
+      if (inclusive ? cmp(k, KEY(r)) : not cmp(KEY(r), k))
+	r = L(r);
+      else
+	{
+	  ret_val += COUNT(L(r)) + 1;
+	  r = R(r);
+	}
+
+    return ret_val;
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  template <class Op>
+  void GenRankedTreap<Key, Cmp, Augment>::range_rec(Node * r, const Key & lo,
+						    const Key & hi, Op & op,
+						    Cmp & cmp)
+  {
+    if (r == Node::null)
+      return;
+
+    bool over_lo = not cmp(KEY(r), lo);
+    bool under_hi = not cmp(hi, KEY(r));
+
+    if (over_lo)
+      range_rec(L(r), lo, hi, op, cmp);
+
+    if (over_lo and under_hi)
+      op(KEY(r));
+
+    if (under_hi)
+      range_rec(R(r), lo, hi, op, cmp);
+  }
+
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::min(Node * r)
   {
     while (L(r) != Node::null)
       r = L(r);
@@ -1428,8 +2330,9 @@ namespace Designar
     return r;
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node * RankedTreap<Key, Cmp>::max(Node * r)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::max(Node * r)
   {
     while (R(r) != Node::null)
       r = R(r);
@@ -1437,9 +2340,9 @@ namespace Designar
     return r;
   }
   
-  template <typename Key, class Cmp>
+  template <typename Key, class Cmp, class Augment>
   template <class Op>
-  void RankedTreap<Key, Cmp>::preorder_rec(Node * r, Op & op)
+  void GenRankedTreap<Key, Cmp, Augment>::preorder_rec(Node * r, Op & op)
   {
     if (r == Node::null)
       return;
@@ -1449,9 +2352,9 @@ namespace Designar
     preorder_rec(R(r), op);
   }
 
-  template <typename Key, class Cmp>
+  template <typename Key, class Cmp, class Augment>
   template <class Op>
-  void RankedTreap<Key, Cmp>::inorder_rec(Node * r, Op & op)
+  void GenRankedTreap<Key, Cmp, Augment>::inorder_rec(Node * r, Op & op)
   {
     if (r == Node::null)
       return;
@@ -1461,9 +2364,9 @@ namespace Designar
     inorder_rec(R(r), op);
   }
 
-  template <typename Key, class Cmp>
+  template <typename Key, class Cmp, class Augment>
   template <class Op>
-  void RankedTreap<Key, Cmp>::postorder_rec(Node * r, Op & op)
+  void GenRankedTreap<Key, Cmp, Augment>::postorder_rec(Node * r, Op & op)
   {
     if (r == Node::null)
       return;
@@ -1473,9 +2376,9 @@ namespace Designar
     op(KEY(r));
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::PreorderIterator::last(Node * r)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::PreorderIterator::last(Node * r)
   {
     while (true)
       {
@@ -1491,12 +2394,15 @@ namespace Designar
     return r;
   }
   
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::InorderIterator::search_min(Node * r)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::InorderIterator::search_min(Node * r)
   {
+    // The right subtree of r is visited once its left one is; loading it
+    // now overlaps the misses of both.
     while (L(r) != Node::null)
       {
+	prefetch(R(r));
 	stack.push(r);
 	r = L(r);
       }
@@ -1504,9 +2410,9 @@ namespace Designar
     return r;
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::InorderIterator::search_max(Node * r)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::InorderIterator::search_max(Node * r)
   {
     while (R(r) != Node::null)
       r = R(r);
@@ -1514,9 +2420,9 @@ namespace Designar
     return r;
   }
 
-  template <typename Key, class Cmp>
-  typename RankedTreap<Key, Cmp>::Node *
-  RankedTreap<Key, Cmp>::PostorderIterator::first(Node * r)
+  template <typename Key, class Cmp, class Augment>
+  typename GenRankedTreap<Key, Cmp, Augment>::Node *
+  GenRankedTreap<Key, Cmp, Augment>::PostorderIterator::first(Node * r)
   {
     while (true)
       {
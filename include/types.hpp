@@ -37,7 +37,29 @@ namespace Designar
   using time_point_t = clock_t::time_point;
   using duration_t   = clock_t::duration;
 
-  constexpr int_t QuicksortThreshold = 40;
+  constexpr int_t QuicksortThreshold = 24;
+
+  constexpr int_t NintherThreshold = 128;
+
+  constexpr int_t PartialInsertionSortLimit = 8;
+
+  constexpr int_t PartitionBlockSize = 64;
+
+  constexpr int_t ParallelSortThreshold = 1 << 14;
+
+  constexpr nat_t STreeBlockSize = 16;
+
+  constexpr nat_t GallopRatio = 16;
+
+  constexpr nat_t BTreeNodeSize = 512;
+
+  constexpr nat_t ParallelJoinThreshold = 1 << 12;
+
+  constexpr nat_t TreeIteratorStackSize = 64;
+
+  constexpr nat_t CacheLineSize = 64;
+
+  constexpr nat_t NodePoolBlockSize = 256;
 
   class EmptyClass
   {
@@ -76,5 +98,15 @@ namespace Designar
       return in;
     }
   };
+
+  // Hint to load the cache line holding p; it never faults.
+  inline void prefetch(const void * p)
+  {
+#if defined(__GNUC__)
+    __builtin_prefetch(p);
+#else
+    (void) p;
+#endif
+  }
   
 } // end namespace Designar
@@ -0,0 +1,111 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <btree.hpp>
+#include <tree.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Compares BPlusTree with RankedTreap on n random keys: insertion,
+ * successful searches, a full in-order scan and the bytes taken by the
+ * nodes, without the overhead of the allocator. Times are in
+ * nanoseconds per key.
+ *
+ * Usage: demo-btree [n]
+ */
+
+struct Result
+{
+  double insert;
+  double search;
+  double scan;
+  double bytes;
+};
+
+template <class Tree>
+Result run(Tree & tree, const FixedArray<nat_t> & keys, nat_t & check)
+{
+  Result ret_val;
+  const nat_t n = keys.size();
+
+  Now now(Now::Precision::NANOSECONDS, true);
+
+  for (nat_t i = 0; i < n; ++i)
+    tree.insert(keys[i]);
+
+  ret_val.insert = now.elapsed() / n;
+
+  now.start();
+
+  for (nat_t i = 0; i < n; ++i)
+    check += *tree.search(keys[n - 1 - i]);
+
+  ret_val.search = now.elapsed() / n;
+
+  now.start();
+
+  for (const nat_t & k : tree)
+    check += k;
+
+  ret_val.scan = now.elapsed() / n;
+
+  return ret_val;
+}
+
+void print(const char * name, const Result & r, const Result & base)
+{
+  cout << setw(12) << name << setw(12) << r.insert << setw(12) << r.search
+       << setw(12) << r.scan << setw(14) << r.bytes << endl;
+
+  if (&r != &base)
+    cout << setw(12) << "speedup" << setw(12) << base.insert / r.insert
+	 << setw(12) << base.search / r.search << setw(12)
+	 << base.scan / r.scan << setw(14) << base.bytes / r.bytes << endl;
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t n = argc > 1 ? atol(argv[1]) : 1 << 20;
+
+  rng_t rng(get_random_seed());
+
+  FixedArray<nat_t> keys(n);
+
+  for (nat_t i = 0; i < n; ++i)
+    keys[i] = random_uniform(rng, std::numeric_limits<nat_t>::max());
+
+  nat_t check = 0;
+  Result treap_result, btree_result;
+
+  {
+    RankedTreap<nat_t> treap;
+    treap_result = run(treap, keys, check);
+    treap_result.bytes = double(sizeof(RankedTreap<nat_t>::Node));
+  }
+
+  {
+    BPlusTree<nat_t> btree;
+    btree_result = run(btree, keys, check);
+    btree_result.bytes = double(btree.node_bytes()) / btree.size();
+  }
+
+  cout << "n = " << n << "   (" << check << ")\n\n" << fixed
+       << setprecision(1) << setw(12) << "tree" << setw(12) << "insert"
+       << setw(12) << "search" << setw(12) << "scan" << setw(14)
+       << "bytes/key" << endl;
+
+  print("treap", treap_result, treap_result);
+  print("b+ tree", btree_result, treap_result);
+
+  return 0;
+}
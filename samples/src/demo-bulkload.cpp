@@ -0,0 +1,68 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <set.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Loads n sorted keys in a TreeSet by n insertions and by the linear
+ * construction the TreeSet constructor takes for sorted input. Times
+ * are in milliseconds.
+ *
+ * Usage: demo-bulkload [n]
+ */
+
+int main(int argc, char * argv[])
+{
+  nat_t n = argc > 1 ? atol(argv[1]) : 10000000;
+
+  DynArray<nat_t> keys(n + 1);
+
+  for (nat_t i = 0; i < n; ++i)
+    keys.append(2 * i + 1);
+
+  cout << "n = " << n << "\n\n" << fixed << setprecision(1);
+
+  double t_insert, t_build;
+
+  {
+    Now now(true);
+
+    TreeSet<nat_t> set;
+
+    for (nat_t i = 0; i < n; ++i)
+      set.insert(keys[i]);
+
+    t_insert = now.elapsed();
+
+    cout << setw(16) << "insert" << setw(12) << t_insert << " ms   ("
+	 << set.size() << " keys)" << endl;
+  }
+
+  {
+    Now now(true);
+
+    TreeSet<nat_t> set = keys;
+
+    t_build = now.elapsed();
+
+    cout << setw(16) << "sorted load" << setw(12) << t_build << " ms   ("
+	 << set.size() << " keys)" << endl;
+
+    if (not set.verify())
+      cout << "Invalid treap!" << endl;
+  }
+
+  cout << setw(16) << "speedup" << setw(12) << t_insert / t_build << endl;
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <queue.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Compares the lock-free ConcurrentListQueue against the mutex based
+ * ConcurrentQueue and measures the bare cost of the epoch machinery.
+ *
+ * Usage: demo-concurrentlistqueue [max_threads] [items_per_thread]
+ */
+
+template <class Queue, class Get>
+double producers_consumers(Queue & q, nat_t num_threads, nat_t num_items,
+			   Get get)
+{
+  FixedArray<thread> producers(num_threads);
+  FixedArray<thread> consumers(num_threads);
+
+  Now now(true);
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    {
+      producers[i] = thread([&q, num_items] ()
+			    {
+			      for (nat_t j = 0; j < num_items; ++j)
+				q.put(j);
+			    });
+
+      consumers[i] = thread([&q, num_items, get] ()
+			    {
+			      for (nat_t j = 0; j < num_items; ++j)
+				get(q);
+			    });
+    }
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    {
+      producers[i].join();
+      consumers[i].join();
+    }
+
+  return now.elapsed();
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t max_threads = argc > 1 ? atol(argv[1]) : 32;
+  nat_t num_items   = argc > 2 ? atol(argv[2]) : 100000;
+
+  constexpr nat_t num_ops = 10000000;
+
+  Now now(Now::Precision::NANOSECONDS, true);
+
+  for (nat_t i = 0; i < num_ops; ++i)
+    EpochGuard guard;
+
+  cout << "EpochGuard enter/exit: " << now.elapsed() / num_ops << " ns\n";
+
+  {
+    EpochGuard guard;
+
+    now.start();
+
+    for (nat_t i = 0; i < num_ops; ++i)
+      EpochGuard nested;
+
+    cout << "Nested EpochGuard:     " << now.elapsed() / num_ops << " ns\n";
+  }
+
+  now.start();
+
+  for (nat_t i = 0; i < num_ops; ++i)
+    Epoch::retire(new nat_t(i));
+
+  Epoch::synchronize();
+
+  cout << "new + retire + free:   " << now.elapsed() / num_ops << " ns\n\n";
+
+  cout << "Throughput in millions of items per second "
+       << "(N producers and N consumers)\n\n"
+       << setw(8) << "N" << setw(22) << "ConcurrentListQueue"
+       << setw(18) << "ConcurrentQueue\n";
+
+  for (nat_t n = 1; n <= max_threads; n *= 2)
+    {
+      ConcurrentListQueue<nat_t> lock_free;
+      ConcurrentQueue<nat_t> locked;
+
+      real_t items = n * num_items / 1000.0;
+
+      double t1 = producers_consumers(lock_free, n, num_items,
+				      [] (ConcurrentListQueue<nat_t> & q)
+				      {
+					nat_t item;
+
+					while (not q.try_get(item))
+					  this_thread::yield();
+				      });
+
+      double t2 = producers_consumers(locked, n, num_items,
+				      [] (ConcurrentQueue<nat_t> & q)
+				      {
+					q.get();
+				      });
+
+      cout << setw(8) << n << fixed << setprecision(2)
+	   << setw(22) << items / t1 << setw(18) << items / t2 << endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+
+using namespace std;
+
+#include <map.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Throughput of ConcurrentTreeMap against a TreeMap guarded by a mutex,
+ * on random keys in [0, 2 * num_keys) with a read-mostly mix (90% search)
+ * and an update-heavy one (50% search). Both maps start with num_keys
+ * keys.
+ *
+ * Usage: demo-concurrentmap [max_threads] [ops_per_thread] [num_keys]
+ */
+
+class LockedTreeMap
+{
+  std::mutex            mtx;
+  TreeMap<nat_t, nat_t> map;
+
+public:
+  bool insert(nat_t k, nat_t v)
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+    return map.insert(k, v) != nullptr;
+  }
+
+  bool remove(nat_t k)
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+    return map.remove(k);
+  }
+
+  bool search(nat_t k, nat_t & v)
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+
+    nat_t * p = map.search(k);
+
+    if (p == nullptr)
+      return false;
+
+    v = *p;
+    return true;
+  }
+};
+
+// Keeps the compiler from discarding the searches.
+std::atomic<nat_t> num_hits(0);
+
+template <class Map>
+double run(Map & map, nat_t num_threads, nat_t num_ops, nat_t num_keys,
+	   nat_t search_pct)
+{
+  FixedArray<thread> threads(num_threads);
+
+  Now now(true);
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    threads[i] = thread([&map, i, num_ops, num_keys, search_pct] ()
+			{
+			  rng_t rng(i);
+			  nat_t v, n = 0;
+
+			  for (nat_t j = 0; j < num_ops; ++j)
+			    {
+			      nat_t k = random_uniform(rng, 2 * num_keys);
+			      nat_t op = random_uniform(rng, 100);
+
+			      if (op < search_pct)
+				n += map.search(k, v);
+			      else if (op % 2 == 0)
+				n += map.insert(k, k);
+			      else
+				n += map.remove(k);
+			    }
+
+			  num_hits += n;
+			});
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    threads[i].join();
+
+  return now.elapsed();
+}
+
+template <class Map>
+void fill(Map & map, nat_t num_keys)
+{
+  rng_t rng(get_random_seed());
+
+  for (nat_t n = 0; n < num_keys; )
+    n += map.insert(random_uniform(rng, 2 * num_keys), 0);
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t max_threads = argc > 1 ? atol(argv[1]) : 64;
+  nat_t num_ops     = argc > 2 ? atol(argv[2]) : 200000;
+  nat_t num_keys    = argc > 3 ? atol(argv[3]) : 1 << 16;
+
+  cout << "Throughput in millions of operations per second\n\n"
+       << setw(8) << "" << setw(24) << "90% search" << setw(24)
+       << "50% search\n"
+       << setw(8) << "threads" << setw(12) << "lock-free" << setw(12)
+       << "locked" << setw(12) << "lock-free" << setw(12) << "locked\n";
+
+  for (nat_t n = 1; n <= max_threads; n *= 2)
+    {
+      real_t ops = real_t(n) * num_ops / 1000.0;
+
+      cout << setw(8) << n << fixed << setprecision(2);
+
+      for (nat_t search_pct : { 90, 50 })
+	{
+	  ConcurrentTreeMap<nat_t, nat_t> lock_free;
+	  LockedTreeMap locked;
+
+	  fill(lock_free, num_keys);
+	  fill(locked, num_keys);
+
+	  cout << setw(12)
+	       << ops / run(lock_free, n, num_ops, num_keys, search_pct)
+	       << setw(12)
+	       << ops / run(locked, n, num_ops, num_keys, search_pct);
+	}
+
+      cout << endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <stack.hpp>
+#include <queue.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Contention benchmark for ConcurrentStack and WorkStealingDeque.
+ *
+ * Usage: demo-concurrentstack [max_threads] [ops_per_thread]
+ */
+
+class LockedStack
+{
+  std::mutex      mtx;
+  DynStack<nat_t> stack;
+
+public:
+  void push(nat_t item)
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+    stack.push(item);
+  }
+
+  bool try_pop(nat_t & item)
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+
+    if (stack.is_empty())
+      return false;
+
+    item = stack.pop();
+    return true;
+  }
+};
+
+template <class Stack>
+double push_pop(Stack & stack, nat_t num_threads, nat_t num_ops)
+{
+  FixedArray<thread> threads(num_threads);
+
+  Now now(true);
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    threads[i] = thread([&stack, num_ops] ()
+			{
+			  nat_t item;
+
+			  for (nat_t j = 0; j < num_ops; ++j)
+			    {
+			      stack.push(j);
+			      stack.try_pop(item);
+			    }
+			});
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    threads[i].join();
+
+  return now.elapsed();
+}
+
+double push_steal(nat_t num_threads, nat_t num_ops)
+{
+  WorkStealingDeque<nat_t> deque;
+  std::atomic<bool> done(false);
+  FixedArray<thread> thieves(num_threads - 1);
+
+  Now now(true);
+
+  for (nat_t i = 0; i < thieves.size(); ++i)
+    thieves[i] = thread([&deque, &done] ()
+			{
+			  nat_t item;
+
+			  while (not done)
+			    deque.try_steal(item);
+			});
+
+  nat_t item;
+
+  for (nat_t j = 0; j < num_ops * num_threads; ++j)
+    {
+      deque.push(j);
+
+      if (j % 2 == 0)
+	deque.try_pop(item);
+    }
+
+  while (deque.try_pop(item));
+
+  done = true;
+
+  for (nat_t i = 0; i < thieves.size(); ++i)
+    thieves[i].join();
+
+  return now.elapsed();
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t max_threads = argc > 1 ? atol(argv[1]) : 64;
+  nat_t num_ops     = argc > 2 ? atol(argv[2]) : 100000;
+
+  cout << "Throughput in millions of operations per second\n\n"
+       << setw(8) << "threads" << setw(16) << "ConcurrentStack"
+       << setw(16) << "locked DynStack" << setw(16) << "deque+steal\n";
+
+  for (nat_t n = 1; n <= max_threads; n *= 2)
+    {
+      ConcurrentStack<nat_t> lock_free;
+      LockedStack locked;
+
+      real_t ops = 2.0 * n * num_ops / 1000.0;
+
+      cout << setw(8) << n << fixed << setprecision(2)
+	   << setw(16) << ops / push_pop(lock_free, n, num_ops)
+	   << setw(16) << ops / push_pop(locked, n, num_ops)
+	   << setw(16) << 1.5 * n * num_ops / 1000.0 / push_steal(n, num_ops)
+	   << endl;
+    }
+
+  return 0;
+}
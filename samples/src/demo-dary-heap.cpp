@@ -0,0 +1,231 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <heap.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Dijkstra on a random digraph of n nodes and n * deg arcs with each
+ * heap: DynHeap inserts a new entry on every relaxation and skips the
+ * stale ones, LHeap removes and reinserts the entry of the node, and
+ * DAryHeap calls decrease_key on its handle. It also compares building a
+ * DAryHeap of n keys by heapify and by n inserts. Times are in
+ * milliseconds.
+ *
+ * Usage: demo-dary-heap [n] [deg]
+ */
+
+struct Graph
+{
+  nat_t            num_nodes;
+  nat_t            deg;
+  DynArray<nat_t>  tgt;
+  DynArray<nat_t>  weight;
+};
+
+using Entry = std::pair<nat_t, nat_t>; // (distance, node)
+
+struct CmpEntry
+{
+  bool operator () (const Entry & a, const Entry & b) const
+  {
+    return a.first < b.first;
+  }
+};
+
+constexpr nat_t INF = std::numeric_limits<nat_t>::max();
+
+DynArray<nat_t> dijkstra_lazy(const Graph & g)
+{
+  DynArray<nat_t> dist(g.num_nodes, INF);
+  DynHeap<Entry, CmpEntry> heap;
+
+  dist[0] = 0;
+  heap.insert(Entry(0, 0));
+
+  while (not heap.is_empty())
+    {
+      Entry e = heap.get();
+      nat_t u = e.second;
+
+      if (e.first > dist[u])
+	continue;
+
+      for (nat_t a = u * g.deg; a < (u + 1) * g.deg; ++a)
+	{
+	  nat_t v = g.tgt[a];
+	  nat_t d = dist[u] + g.weight[a];
+
+	  if (d < dist[v])
+	    {
+	      dist[v] = d;
+	      heap.insert(Entry(d, v));
+	    }
+	}
+    }
+
+  return dist;
+}
+
+DynArray<nat_t> dijkstra_lheap(const Graph & g)
+{
+  DynArray<nat_t> dist(g.num_nodes, INF);
+  DynArray<Entry *> entry(g.num_nodes, nullptr);
+  LHeap<Entry, CmpEntry> heap;
+
+  dist[0] = 0;
+  entry[0] = &const_cast<Entry &>(heap.insert(Entry(0, 0)));
+
+  while (not heap.is_empty())
+    {
+      nat_t u = heap.get().second;
+
+      for (nat_t a = u * g.deg; a < (u + 1) * g.deg; ++a)
+	{
+	  nat_t v = g.tgt[a];
+	  nat_t d = dist[u] + g.weight[a];
+
+	  if (d >= dist[v])
+	    continue;
+
+	  if (dist[v] != INF)
+	    heap.remove(*entry[v]);
+
+	  dist[v] = d;
+	  entry[v] = &const_cast<Entry &>(heap.insert(Entry(d, v)));
+	}
+    }
+
+  return dist;
+}
+
+template <nat_t D>
+DynArray<nat_t> dijkstra_dary(const Graph & g)
+{
+  using Heap = DAryHeap<Entry, D, CmpEntry>;
+
+  DynArray<nat_t> dist(g.num_nodes, INF);
+  DynArray<typename Heap::Handle> handle(g.num_nodes, 0);
+  Heap heap;
+
+  dist[0] = 0;
+  handle[0] = heap.insert(Entry(0, 0));
+
+  while (not heap.is_empty())
+    {
+      nat_t u = heap.get().second;
+
+      for (nat_t a = u * g.deg; a < (u + 1) * g.deg; ++a)
+	{
+	  nat_t v = g.tgt[a];
+	  nat_t d = dist[u] + g.weight[a];
+
+	  if (d >= dist[v])
+	    continue;
+
+	  if (dist[v] == INF)
+	    handle[v] = heap.insert(Entry(d, v));
+	  else
+	    heap.decrease_key(handle[v], Entry(d, v));
+
+	  dist[v] = d;
+	}
+    }
+
+  return dist;
+}
+
+template <class Fct>
+void measure(const char * name, Fct fct, const DynArray<nat_t> & expected)
+{
+  Now now(true);
+  DynArray<nat_t> dist = fct();
+  double t = now.elapsed();
+
+  cout << setw(20) << name << setw(12) << t << " ms";
+
+  for (nat_t i = 0; i < dist.size(); ++i)
+    if (dist[i] != expected[i])
+      {
+	cout << "   wrong distances!";
+	break;
+      }
+
+  cout << endl;
+}
+
+template <nat_t D>
+void measure_build(const DynArray<nat_t> & keys)
+{
+  DAryHeap<nat_t, D> h1, h2;
+
+  Now now(true);
+
+  h1.heapify(keys);
+
+  double t_heapify = now.elapsed();
+
+  now.start();
+
+  for (nat_t k : keys)
+    h2.insert(k);
+
+  double t_insert = now.elapsed();
+
+  cout << setw(8) << D << setw(12) << t_heapify << setw(12) << t_insert
+       << endl;
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t n   = argc > 1 ? atol(argv[1]) : 1 << 20;
+  nat_t deg = argc > 2 ? atol(argv[2]) : 8;
+
+  rng_t rng(get_random_seed());
+
+  Graph g;
+  g.num_nodes = n;
+  g.deg = deg;
+
+  for (nat_t a = 0; a < n * deg; ++a)
+    {
+      g.tgt.append(random_uniform(rng, n));
+      g.weight.append(1 + random_uniform(rng, 1000));
+    }
+
+  cout << "Dijkstra, n = " << n << ", " << n * deg << " arcs\n\n"
+       << fixed << setprecision(1);
+
+  DynArray<nat_t> expected = dijkstra_lazy(g);
+
+  measure("DynHeap (lazy)", [&g] () { return dijkstra_lazy(g); }, expected);
+  measure("LHeap", [&g] () { return dijkstra_lheap(g); }, expected);
+  measure("DAryHeap<2>", [&g] () { return dijkstra_dary<2>(g); }, expected);
+  measure("DAryHeap<4>", [&g] () { return dijkstra_dary<4>(g); }, expected);
+  measure("DAryHeap<8>", [&g] () { return dijkstra_dary<8>(g); }, expected);
+
+  DynArray<nat_t> keys(n + 1);
+
+  for (nat_t i = 0; i < n; ++i)
+    keys.append(random_uniform(rng, n));
+
+  cout << "\nBuilding a heap of " << n << " keys (ms)\n\n"
+       << setw(8) << "D" << setw(12) << "heapify" << setw(12) << "insert"
+       << endl;
+
+  measure_build<2>(keys);
+  measure_build<4>(keys);
+  measure_build<8>(keys);
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+
+using namespace std;
+
+#include <externalsort.hpp>
+#include <random.hpp>
+
+using namespace Designar;
+
+/* Writes n random 8-byte keys to a file in the temporary directory and
+ * sorts it with ExternalSort under a memory budget of budget MB, so the
+ * input takes about n * 8 / (budget * 2^20) runs. Reports the time of
+ * each phase and the throughput.
+ *
+ * Usage: demo-externalsort [n] [budget] [temp_dir]
+ */
+
+int main(int argc, char * argv[])
+{
+  nat_t n      = argc > 1 ? atol(argv[1]) : 50000000;
+  nat_t budget = argc > 2 ? atol(argv[2]) : 64;
+
+  ExternalSort<nat_t> sorter;
+  sorter.set_memory_budget(budget << 20);
+
+  if (argc > 3)
+    sorter.set_temp_dir(argv[3]);
+
+  TempFileSet files(sorter.get_temp_dir());
+  string in_path  = files.create();
+  string out_path = files.create();
+
+  {
+    rng_t rng(get_random_seed());
+    ofstream out(in_path, ios::binary);
+    nat_t block[4096];
+
+    for (nat_t i = 0; i < n; i += 4096)
+      {
+	nat_t m = std::min(n - i, nat_t(4096));
+
+	for (nat_t j = 0; j < m; ++j)
+	  block[j] = rng();
+
+	out.write(reinterpret_cast<const char *>(block), m * sizeof(nat_t));
+      }
+  }
+
+  cout << "Sorting " << n * sizeof(nat_t) / 1e6 << " MB in "
+       << sorter.get_temp_dir() << " with a budget of " << budget
+       << " MB and up to " << sorter.max_fan_in() << " runs per merge\n\n";
+
+  ExternalSortStats stats = sorter.sort_file(in_path, out_path);
+
+  cout << fixed << setprecision(1)
+       << setw(14) << "runs" << setw(12) << stats.num_runs << endl
+       << setw(14) << "merge passes" << setw(12) << stats.num_merge_passes
+       << endl
+       << setw(14) << "runs (ms)" << setw(12) << stats.run_time << endl
+       << setw(14) << "merge (ms)" << setw(12) << stats.merge_time << endl
+       << setw(14) << "MB/s" << setw(12) << stats.throughput() << endl;
+
+  ifstream in(out_path, ios::binary);
+  nat_t prev = 0, curr, count = 0;
+
+  while (ExternalRecord<nat_t>::read(in, curr))
+    {
+      if (curr < prev)
+	break;
+
+      prev = curr;
+      ++count;
+    }
+
+  if (count != n)
+    cout << "\nOutput is not sorted\n";
+
+  return 0;
+}
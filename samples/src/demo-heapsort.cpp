@@ -0,0 +1,185 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+#include <sort.hpp>
+#include <heap.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Bottom-up heapsort against the classic sift-down heapsort and
+ * std::make_heap + std::sort_heap on several input distributions, in
+ * milliseconds and in comparisons per item. Then n push_heap and n
+ * pop_heap over a DynArray against the same operations on a DynHeap.
+ *
+ * Usage: demo-heapsort [n]
+ */
+
+void fill(FixedArray<nat_t> & a, nat_t d, rng_t & rng)
+{
+  nat_t n = a.size();
+
+  for (nat_t i = 0; i < n; ++i)
+    switch (d)
+      {
+      case 0: a[i] = random_uniform(rng, numeric_limits<nat_t>::max()); break;
+      case 1: a[i] = i; break;
+      case 2: a[i] = n - i; break;
+      case 3: a[i] = random_uniform(rng, nat_t(16)); break;
+      default: a[i] = i < n / 2 ? i : n - i;
+      }
+}
+
+// Sifts each item down from the top with two comparisons per level.
+template <class Cmp>
+void classic_heapsort(FixedArray<nat_t> & a, Cmp & cmp)
+{
+  auto rcmp = [&cmp] (nat_t x, nat_t y) { return cmp(y, x); };
+
+  nat_t * h = &a[0] - 1;
+  nat_t n = a.size();
+
+  for (nat_t i = n / 2; i > 0; --i)
+    sift_down(h, i, n, rcmp);
+
+  for (nat_t i = n; i > 1; --i)
+    {
+      std::swap(h[1], h[i]);
+      sift_down(h, 1, i - 1, rcmp);
+    }
+}
+
+template <class Cmp>
+void std_heapsort(FixedArray<nat_t> & a, Cmp & cmp)
+{
+  std::make_heap(&a[0], &a[0] + a.size(), cmp);
+  std::sort_heap(&a[0], &a[0] + a.size(), cmp);
+}
+
+template <class Cmp>
+void bottom_up_heapsort(FixedArray<nat_t> & a, Cmp & cmp)
+{
+  heapsort(a, cmp);
+}
+
+template <class Sort>
+void measure(Sort sort, const FixedArray<nat_t> & input, double & t,
+	     double & cmp_per_item)
+{
+  FixedArray<nat_t> a = input;
+  std::less<nat_t> less;
+
+  Now now(true);
+  sort(a, less);
+  t = now.elapsed();
+
+  a = input;
+  nat_t num_cmp = 0;
+  auto count = [&num_cmp] (nat_t x, nat_t y)
+    {
+      ++num_cmp;
+      return x < y;
+    };
+
+  sort(a, count);
+  cmp_per_item = double(num_cmp) / a.size();
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t n = argc > 1 ? atol(argv[1]) : 10000000;
+
+  rng_t rng(get_random_seed());
+
+  const char * names[] = { "random", "sorted", "reversed", "few unique",
+			   "organ pipe" };
+
+  cout << "n = " << n << "\n\n" << setw(12) << "input"
+       << setw(20) << "bottom-up" << setw(20) << "classic"
+       << setw(20) << "std heap" << endl;
+
+  FixedArray<nat_t> input(n);
+  nat_t checksum = 0;
+
+  for (nat_t d = 0; d < 5; ++d)
+    {
+      fill(input, d, rng);
+
+      double t[3], c[3];
+
+      measure([] (FixedArray<nat_t> & a, auto & cmp)
+	      {
+		bottom_up_heapsort(a, cmp);
+	      }, input, t[0], c[0]);
+
+      measure([] (FixedArray<nat_t> & a, auto & cmp)
+	      {
+		classic_heapsort(a, cmp);
+	      }, input, t[1], c[1]);
+
+      measure([] (FixedArray<nat_t> & a, auto & cmp)
+	      {
+		std_heapsort(a, cmp);
+	      }, input, t[2], c[2]);
+
+      cout << setw(12) << names[d] << fixed << setprecision(1);
+
+      for (nat_t i = 0; i < 3; ++i)
+	cout << setw(10) << t[i] << " ms" << setw(5) << c[i] << " c";
+
+      cout << endl;
+    }
+
+  cout << "\nn push + n pop\n\n";
+
+  fill(input, 0, rng);
+
+  Now now(true);
+
+  DynArray<nat_t> a;
+
+  for (nat_t i = 0; i < n; ++i)
+    {
+      a.append(input[i]);
+      push_heap(a);
+    }
+
+  while (not a.is_empty())
+    {
+      pop_heap(a);
+      checksum += a.remove_last() * a.size();
+    }
+
+  double ta = now.elapsed();
+
+  now.start();
+
+  DynHeap<nat_t, std::greater<nat_t>> h;
+
+  for (nat_t i = 0; i < n; ++i)
+    h.insert(input[i]);
+
+  while (not h.is_empty())
+    {
+      nat_t k = h.get();
+      checksum += k * h.size();
+    }
+
+  double th = now.elapsed();
+
+  cout << setw(12) << "push_heap" << setw(10) << ta << " ms\n"
+       << setw(12) << "DynHeap" << setw(10) << th << " ms\n"
+       << "\n(checksum " << checksum << ")" << endl;
+
+  return 0;
+}
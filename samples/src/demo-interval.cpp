@@ -0,0 +1,130 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <interval.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Builds a set of n random intervals by insertion and by bulk_load, then
+ * answers q stabbing and q overlap queries with the set and with a linear
+ * scan of an array. Times are in milliseconds.
+ *
+ * Usage: demo-interval [n] [q]
+ */
+
+int main(int argc, char * argv[])
+{
+  nat_t n = argc > 1 ? atol(argv[1]) : 1 << 20;
+  nat_t q = argc > 2 ? atol(argv[2]) : 1000;
+
+  rng_t rng(get_random_seed());
+
+  DynArray<Interval<nat_t>> intervals(n + 1);
+
+  for (nat_t i = 0; i < n; ++i)
+    {
+      nat_t lo = random_uniform(rng, 64 * n);
+      intervals.append(Interval<nat_t>(lo, lo + random_uniform(rng, 64)));
+    }
+
+  DynArray<nat_t> points(q + 1);
+
+  for (nat_t i = 0; i < q; ++i)
+    points.append(random_uniform(rng, 64 * n));
+
+  cout << "n = " << n << "   q = " << q << "\n\n" << fixed << setprecision(1);
+
+  IntervalSet<nat_t> set;
+
+  {
+    Now now(true);
+
+    for (const auto & i : intervals)
+      set.insert(i);
+
+    cout << setw(16) << "insert" << setw(12) << now.elapsed() << " ms\n";
+  }
+
+  {
+    Now now(true);
+
+    set.bulk_load(intervals);
+
+    cout << setw(16) << "bulk_load" << setw(12) << now.elapsed() << " ms\n\n";
+  }
+
+  nat_t by_set = 0, by_scan = 0;
+  double t_set, t_scan;
+
+  {
+    Now now(true);
+
+    for (nat_t x : points)
+      set.for_each_containing(x, [&by_set] (const Interval<nat_t> &)
+			      {
+				++by_set;
+			      });
+
+    t_set = now.elapsed();
+  }
+
+  {
+    Now now(true);
+
+    for (nat_t x : points)
+      for (const auto & i : intervals)
+	by_scan += i.contains(x);
+
+    t_scan = now.elapsed();
+  }
+
+  cout << setw(16) << "stab, set" << setw(12) << t_set << " ms   ("
+       << by_set << " found)\n"
+       << setw(16) << "stab, scan" << setw(12) << t_scan << " ms   ("
+       << by_scan << " found)   speedup " << t_scan / t_set << "\n\n";
+
+  by_set = by_scan = 0;
+
+  {
+    Now now(true);
+
+    for (nat_t x : points)
+      by_set += set.overlapping(Interval<nat_t>(x, x + 256)).size();
+
+    t_set = now.elapsed();
+  }
+
+  {
+    Now now(true);
+
+    for (nat_t x : points)
+      {
+	Interval<nat_t> w(x, x + 256);
+
+	for (const auto & i : intervals)
+	  by_scan += i.overlaps(w);
+      }
+
+    t_scan = now.elapsed();
+  }
+
+  cout << setw(16) << "overlap, set" << setw(12) << t_set << " ms   ("
+       << by_set << " found)\n"
+       << setw(16) << "overlap, scan" << setw(12) << t_scan << " ms   ("
+       << by_scan << " found)   speedup " << t_scan / t_set << endl;
+
+  if (not set.verify())
+    cout << "Invalid treap!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <heap.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Merge-heavy workloads. In the first, num_workers local queues receive
+ * m random keys each per round, are merged into a global queue and the
+ * global queue serves half of its keys. In the second, 1024 heaps of m
+ * keys are merged pairwise into one. DynHeap and LHeap merge by
+ * reinserting every key; PairingHeap, LeftistHeap and BinomialHeap call
+ * merge(). Times are in milliseconds.
+ *
+ * Usage: demo-meldable-heaps [num_workers] [m] [rounds]
+ */
+
+template <class Heap>
+void meld(Heap & h, Heap & other)
+{
+  h.merge(other);
+}
+
+template <class Heap>
+void reinsert(Heap & h, Heap & other)
+{
+  while (not other.is_empty())
+    h.insert(other.get());
+}
+
+void meld(DynHeap<nat_t> & h, DynHeap<nat_t> & other)
+{
+  reinsert(h, other);
+}
+
+void meld(LHeap<nat_t> & h, LHeap<nat_t> & other)
+{
+  reinsert(h, other);
+}
+
+template <class Heap>
+double schedule(nat_t num_workers, nat_t m, nat_t rounds, nat_t & checksum)
+{
+  rng_t rng(num_workers);
+  FixedArray<Heap> local(num_workers);
+  Heap global;
+  nat_t time = 0;
+
+  Now now(true);
+
+  for (nat_t r = 0; r < rounds; ++r)
+    {
+      for (nat_t w = 0; w < num_workers; ++w)
+	for (nat_t i = 0; i < m; ++i)
+	  local[w].insert(time + random_uniform(rng, 1 << 20));
+
+      for (nat_t w = 0; w < num_workers; ++w)
+	meld(global, local[w]);
+
+      for (nat_t i = global.size() / 2; i > 0; --i)
+	time = global.get();
+    }
+
+  checksum += time + global.size();
+
+  return now.elapsed();
+}
+
+template <class Heap>
+double merge_all(nat_t m, nat_t & checksum)
+{
+  constexpr nat_t num_heaps = 1024;
+
+  rng_t rng(m);
+  FixedArray<Heap> heaps(num_heaps);
+
+  for (nat_t i = 0; i < num_heaps; ++i)
+    for (nat_t j = 0; j < m; ++j)
+      heaps[i].insert(random_uniform(rng, 1 << 30));
+
+  Now now(true);
+
+  for (nat_t step = 1; step < num_heaps; step *= 2)
+    for (nat_t i = 0; i + step < num_heaps; i += 2 * step)
+      meld(heaps[i], heaps[i + step]);
+
+  double t = now.elapsed();
+
+  checksum += heaps[0].top() + heaps[0].size();
+
+  return t;
+}
+
+template <class Heap>
+void measure(const char * name, nat_t num_workers, nat_t m, nat_t rounds,
+	     nat_t & checksum)
+{
+  double t_schedule = schedule<Heap>(num_workers, m, rounds, checksum);
+  double t_merge    = merge_all<Heap>(m, checksum);
+
+  cout << setw(16) << name << setw(14) << t_schedule << setw(14) << t_merge
+       << endl;
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t num_workers = argc > 1 ? atol(argv[1]) : 16;
+  nat_t m           = argc > 2 ? atol(argv[2]) : 1000;
+  nat_t rounds      = argc > 3 ? atol(argv[3]) : 100;
+
+  cout << num_workers << " workers, " << m << " keys per worker and round, "
+       << rounds << " rounds\n\n" << fixed << setprecision(1)
+       << setw(16) << "" << setw(14) << "scheduler" << setw(14)
+       << "merge all" << endl;
+
+  nat_t checksum = 0;
+
+  measure<DynHeap<nat_t>>("DynHeap", num_workers, m, rounds, checksum);
+  measure<LHeap<nat_t>>("LHeap", num_workers, m, rounds, checksum);
+  measure<PairingHeap<nat_t>>("PairingHeap", num_workers, m, rounds,
+			      checksum);
+  measure<LeftistHeap<nat_t>>("LeftistHeap", num_workers, m, rounds,
+			      checksum);
+  measure<BinomialHeap<nat_t>>("BinomialHeap", num_workers, m, rounds,
+			       checksum);
+
+  cout << "\n(checksum " << checksum << ")" << endl;
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <heap.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Dijkstra on a random digraph of n nodes and n * deg arcs with weights
+ * in [1, max_weight], with every heap which has decrease-key: LHeap,
+ * PairingHeap, RadixHeap and BucketQueue by reference and DAryHeap<4> by
+ * handle. Times are in milliseconds.
+ *
+ * Usage: demo-min-path-heaps [n] [deg] [max_weight]
+ */
+
+struct Graph
+{
+  nat_t            num_nodes;
+  nat_t            deg;
+  DynArray<nat_t>  tgt;
+  DynArray<nat_t>  weight;
+};
+
+using Entry = std::pair<nat_t, nat_t>; // (distance, node)
+
+// Orders the entries for the comparison heaps and gives their priority.
+struct CmpEntry
+{
+  bool operator () (const Entry & a, const Entry & b) const
+  {
+    return a.first < b.first;
+  }
+
+  nat_t operator () (const Entry & a) const
+  {
+    return a.first;
+  }
+};
+
+constexpr nat_t INF = std::numeric_limits<nat_t>::max();
+
+template <template <typename, class> class HeapType>
+DynArray<nat_t> dijkstra(const Graph & g)
+{
+  DynArray<nat_t> dist(g.num_nodes, INF);
+  DynArray<Entry *> entry(g.num_nodes, nullptr);
+  HeapType<Entry, CmpEntry> heap;
+
+  dist[0] = 0;
+  entry[0] = &const_cast<Entry &>(heap.insert(Entry(0, 0)));
+
+  while (not heap.is_empty())
+    {
+      nat_t u = heap.get().second;
+
+      for (nat_t a = u * g.deg; a < (u + 1) * g.deg; ++a)
+	{
+	  nat_t v = g.tgt[a];
+	  nat_t d = dist[u] + g.weight[a];
+
+	  if (d >= dist[v])
+	    continue;
+
+	  if (dist[v] == INF)
+	    entry[v] = &const_cast<Entry &>(heap.insert(Entry(d, v)));
+	  else
+	    heap.decrease_key(*entry[v], Entry(d, v));
+
+	  dist[v] = d;
+	}
+    }
+
+  return dist;
+}
+
+DynArray<nat_t> dijkstra_dary(const Graph & g)
+{
+  using Heap = DAryHeap<Entry, 4, CmpEntry>;
+
+  DynArray<nat_t> dist(g.num_nodes, INF);
+  DynArray<typename Heap::Handle> handle(g.num_nodes, 0);
+  Heap heap;
+
+  dist[0] = 0;
+  handle[0] = heap.insert(Entry(0, 0));
+
+  while (not heap.is_empty())
+    {
+      nat_t u = heap.get().second;
+
+      for (nat_t a = u * g.deg; a < (u + 1) * g.deg; ++a)
+	{
+	  nat_t v = g.tgt[a];
+	  nat_t d = dist[u] + g.weight[a];
+
+	  if (d >= dist[v])
+	    continue;
+
+	  if (dist[v] == INF)
+	    handle[v] = heap.insert(Entry(d, v));
+	  else
+	    heap.decrease_key(handle[v], Entry(d, v));
+
+	  dist[v] = d;
+	}
+    }
+
+  return dist;
+}
+
+template <class Fct>
+void measure(const char * name, Fct fct, const DynArray<nat_t> & expected)
+{
+  Now now(true);
+  DynArray<nat_t> dist = fct();
+  double t = now.elapsed();
+
+  cout << setw(20) << name << setw(12) << t << " ms";
+
+  for (nat_t i = 0; i < dist.size(); ++i)
+    if (dist[i] != expected[i])
+      {
+	cout << "   wrong distances!";
+	break;
+      }
+
+  cout << endl;
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t n          = argc > 1 ? atol(argv[1]) : 1 << 20;
+  nat_t deg        = argc > 2 ? atol(argv[2]) : 8;
+  nat_t max_weight = argc > 3 ? atol(argv[3]) : 100;
+
+  rng_t rng(get_random_seed());
+
+  Graph g;
+  g.num_nodes = n;
+  g.deg = deg;
+
+  for (nat_t a = 0; a < n * deg; ++a)
+    {
+      g.tgt.append(random_uniform(rng, n));
+      g.weight.append(1 + random_uniform(rng, max_weight));
+    }
+
+  cout << "Dijkstra, n = " << n << ", " << n * deg << " arcs, weights in [1, "
+       << max_weight << "]\n\n" << fixed << setprecision(1);
+
+  DynArray<nat_t> expected = dijkstra_dary(g);
+
+  measure("DAryHeap<4>", [&g] () { return dijkstra_dary(g); }, expected);
+  measure("LHeap", [&g] () { return dijkstra<LHeap>(g); }, expected);
+  measure("PairingHeap", [&g] () { return dijkstra<PairingHeap>(g); },
+	  expected);
+  measure("RadixHeap", [&g] () { return dijkstra<RadixHeap>(g); }, expected);
+  measure("BucketQueue", [&g] () { return dijkstra<BucketQueue>(g); },
+	  expected);
+
+  return 0;
+}
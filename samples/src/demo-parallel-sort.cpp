@@ -0,0 +1,69 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <sort.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Compares sequential quicksort against parallel_sort and
+ * parallel_stable_sort for n = min_n, 4 * min_n, ... up to max_n random
+ * keys, with pools of 1, 2, 4, ... up to max_threads threads.
+ *
+ * Usage: demo-parallel-sort [min_n] [max_n] [max_threads]
+ */
+
+int main(int argc, char * argv[])
+{
+  nat_t min_n       = argc > 1 ? atol(argv[1]) : 1000000;
+  nat_t max_n       = argc > 2 ? atol(argv[2]) : 16000000;
+  nat_t max_threads = argc > 3 ? atol(argv[3]) : 64;
+
+  rng_t rng(get_random_seed());
+
+  cout << setw(12) << "n" << setw(10) << "threads" << setw(14) << "quicksort"
+       << setw(14) << "parallel" << setw(14) << "stable" << "  (ms)\n";
+
+  for (nat_t n = min_n; n <= max_n; n *= 4)
+    {
+      FixedArray<nat_t> input(n);
+
+      for (nat_t i = 0; i < n; ++i)
+	input[i] = random_uniform(rng, std::numeric_limits<nat_t>::max());
+
+      FixedArray<nat_t> a = input;
+
+      Now now(true);
+      quicksort(a);
+      double tq = now.elapsed();
+
+      for (nat_t t = 1; t <= max_threads; t *= 2)
+	{
+	  ThreadPool pool(t);
+
+	  a = input;
+	  now.start();
+	  parallel_sort(a, std::less<nat_t>(), pool);
+	  double tp = now.elapsed();
+
+	  a = input;
+	  now.start();
+	  parallel_stable_sort(a, std::less<nat_t>(), pool);
+	  double ts = now.elapsed();
+
+	  cout << setw(12) << n << setw(10) << t << fixed << setprecision(1)
+	       << setw(14) << tq << setw(14) << tp << setw(14) << ts << endl;
+	}
+    }
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <parallel.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Compares a sequential fold over a range against parallel_reduce with
+ * every schedule and against the closed-form sum of Range.
+ *
+ * Usage: demo-parallel [n] [grain]
+ */
+
+int main(int argc, char * argv[])
+{
+  nat_t n     = argc > 1 ? atol(argv[1]) : 50000000;
+  nat_t grain = argc > 2 ? atol(argv[2]) : 10000;
+
+  UIntRange r(n);
+
+  // Uneven cost per item, so the schedules behave differently.
+  auto op = [] (nat_t i, real_t acc)
+    {
+      return acc + (i % 64 == 0 ? std::sqrt(real_t(i)) * std::log(i + 1.)
+		    : real_t(i & 7));
+    };
+
+  Now now(true);
+  real_t expected = r.fold(0., op);
+  double t = now.elapsed();
+
+  cout << "Workers in the shared pool: "
+       << ThreadPool::shared().num_threads() << "\n\n"
+       << setw(12) << "schedule" << setw(12) << "ms"
+       << setw(12) << "speedup" << endl
+       << setw(12) << "sequential" << setw(12) << t << setw(12) << 1.0 << endl;
+
+  const char * names[] = { "static", "dynamic", "guided" };
+  Schedule schedules[] = { Schedule::STATIC, Schedule::DYNAMIC,
+			   Schedule::GUIDED };
+
+  for (nat_t i = 0; i < 3; ++i)
+    {
+      now.start();
+      real_t result = parallel_reduce(r, 0., op, std::plus<real_t>(),
+				      schedules[i], grain);
+      double tp = now.elapsed();
+
+      cout << setw(12) << names[i] << setw(12) << tp
+	   << setw(12) << t / tp
+	   << (std::abs(result - expected) > 1e-6 * expected ?
+	       "  (wrong result)" : "") << endl;
+    }
+
+  Now ns(Now::Precision::NANOSECONDS, true);
+  nat_t sum = r.sum();
+  t = ns.elapsed();
+
+  cout << "\nClosed-form sum " << sum << " in " << t << " ns\n";
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <pipeline.hpp>
+#include <random.hpp>
+
+using namespace Designar;
+
+/* Streaming word count: a source builds random lines, a parallel stage
+ * counts the words of each line and hashes them, and an ordered sink
+ * aggregates the results. The pipeline runs with 1, 2, 4, ... workers
+ * in the middle stage and prints the counters of every stage.
+ *
+ * Usage: demo-pipeline [num_lines] [max_workers]
+ */
+
+struct LineInfo
+{
+  nat_t num_words = 0;
+  nat_t hash      = 0;
+};
+
+LineInfo parse(const string & line)
+{
+  LineInfo info;
+  bool in_word = false;
+
+  for (char c : line)
+    {
+      info.hash = info.hash * 31 + c;
+
+      if (c == ' ')
+	in_word = false;
+      else if (not in_word)
+	{
+	  in_word = true;
+	  ++info.num_words;
+	}
+    }
+
+  return info;
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t num_lines   = argc > 1 ? atol(argv[1]) : 200000;
+  nat_t max_workers = argc > 2 ? atol(argv[2]) : thread::hardware_concurrency();
+
+  for (nat_t w = 1; w <= max(max_workers, nat_t(1)); w *= 2)
+    {
+      Pipeline pipeline(64, 256);
+
+      rng_t rng(0);
+      nat_t i = 0;
+      nat_t words = 0;
+      nat_t hash = 0;
+
+      pipeline.source<string>([&] (string & line)
+			      {
+				line.clear();
+
+				nat_t len = random_uniform(rng, 40, 200);
+
+				for (nat_t j = 0; j < len; ++j)
+				  line.push_back(random_uniform(rng, 6) == 0 ?
+						 ' ' : 'a' + random_uniform(rng, 26));
+
+				return i++ < num_lines;
+			      }, "generate")
+	.then(parse, w, Pipeline::Ordering::UNORDERED, "parse")
+	.sink([&] (const LineInfo & info)
+	      {
+		words += info.num_words;
+		hash ^= info.hash;
+	      }, 1, Pipeline::Ordering::ORDERED, "aggregate");
+
+      Now now(true);
+
+      pipeline.run();
+
+      double t = now.elapsed();
+
+      cout << "Workers: " << w << "  words: " << words << "  hash: " << hash
+	   << "  time: " << t << " ms\n";
+
+      DynArray<Pipeline::StageStats> stats = pipeline.stats();
+
+      cout << setw(12) << "stage" << setw(10) << "threads"
+	   << setw(12) << "items" << setw(12) << "items/s"
+	   << setw(12) << "max depth" << endl;
+
+      for (nat_t i = 0; i < stats.size(); ++i)
+	cout << setw(12) << stats[i].name << setw(10) << stats[i].parallelism
+	     << setw(12) << stats[i].num_items << setw(12) << fixed
+	     << setprecision(0) << stats[i].throughput()
+	     << setw(12) << stats[i].max_queue_depth << endl;
+
+      cout << endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <radixsort.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Compares quicksort against radix_sort and parallel_radix_sort on random
+ * nat_t, int_t and real_t keys for n = min_n, 10 * min_n, ... up to max_n,
+ * then quicksort against msd_radix_sort and american_flag_sort on min_n
+ * random strings. Times are in milliseconds. Sorting 1B keys needs
+ * about 16 GB.
+ *
+ * Usage: demo-radixsort [min_n] [max_n]
+ */
+
+template <typename T>
+void run(const char * name, nat_t n, rng_t & rng, T min, T max)
+{
+  FixedArray<T> input(n);
+
+  for (nat_t i = 0; i < n; ++i)
+    input[i] = random_uniform(rng, min, max);
+
+  FixedArray<T> a = input;
+  Now now(true);
+  quicksort(a);
+  double tq = now.elapsed();
+
+  a = input;
+  now.start();
+  radix_sort(a);
+  double tr = now.elapsed();
+
+  a = input;
+  now.start();
+  parallel_radix_sort(a);
+  double tp = now.elapsed();
+
+  cout << setw(8) << name << setw(12) << n << fixed << setprecision(1)
+       << setw(12) << tq << setw(12) << tr << setw(12) << tp << endl;
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t min_n = argc > 1 ? atol(argv[1]) : 1000000;
+  nat_t max_n = argc > 2 ? atol(argv[2]) : 100000000;
+
+  rng_t rng(get_random_seed());
+
+  cout << "Workers in the shared pool: "
+       << ThreadPool::shared().num_threads() << "\n\n"
+       << setw(8) << "key" << setw(12) << "n" << setw(12) << "quicksort"
+       << setw(12) << "radix" << setw(12) << "parallel" << endl;
+
+  for (nat_t n = min_n; n <= max_n; n *= 10)
+    {
+      run<nat_t>("nat_t", n, rng, 0, std::numeric_limits<nat_t>::max());
+      run<int_t>("int_t", n, rng, std::numeric_limits<int_t>::min() / 2,
+		 std::numeric_limits<int_t>::max() / 2);
+      run<real_t>("real_t", n, rng, -1e9, 1e9);
+    }
+
+  DynArray<string> words;
+
+  for (nat_t i = 0; i < min_n; ++i)
+    {
+      string s;
+      nat_t len = 4 + random_uniform(rng, nat_t(16));
+
+      for (nat_t j = 0; j < len; ++j)
+	s.push_back('a' + random_uniform(rng, nat_t(26)));
+
+      words.append(std::move(s));
+    }
+
+  cout << "\n" << setw(12) << "strings" << setw(12) << "quicksort"
+       << setw(12) << "msd" << setw(12) << "flag" << endl;
+
+  DynArray<string> w = words;
+  Now now(true);
+  quicksort(w);
+  double tq = now.elapsed();
+
+  w = words;
+  now.start();
+  msd_radix_sort(w);
+  double tm = now.elapsed();
+
+  w = words;
+  now.start();
+  american_flag_sort(w);
+  double ta = now.elapsed();
+
+  cout << setw(12) << min_n << setw(12) << tq << setw(12) << tm
+       << setw(12) << ta << endl;
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <searchlayout.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Times q random lookups over n sorted keys with the recursive
+ * binary_search, the branchless lower_bound, EytzingerArray and
+ * STreeArray. Times are in nanoseconds per lookup.
+ *
+ * Usage: demo-search [n] [q]
+ */
+
+template <class Op>
+void run(const char * name, const FixedArray<nat_t> & queries, Op op,
+	 double base)
+{
+  nat_t check = 0;
+
+  Now now(Now::Precision::NANOSECONDS, true);
+
+  for (nat_t i = 0; i < queries.size(); ++i)
+    check += op(queries[i]);
+
+  double t = now.elapsed() / queries.size();
+
+  cout << setw(16) << name << setw(12) << t << setw(12)
+       << (base > 0 ? base / t : 1.0) << "   (" << check << ")" << endl;
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t n = argc > 1 ? atol(argv[1]) : 1 << 24;
+  nat_t q = argc > 2 ? atol(argv[2]) : 1000000;
+
+  rng_t rng(get_random_seed());
+
+  DynArray<nat_t> keys;
+
+  for (nat_t i = 0; i < n; ++i)
+    keys.append(2 * i);
+
+  FixedArray<nat_t> queries(q);
+
+  for (nat_t i = 0; i < q; ++i)
+    queries[i] = random_uniform(rng, 2 * n);
+
+  EytzingerArray<nat_t> eytzinger(keys);
+  STreeArray<nat_t> stree(keys);
+
+  std::less<nat_t> less;
+
+  cout << "n = " << n << ", q = " << q << "\n\n" << fixed << setprecision(1)
+       << setw(16) << "search" << setw(12) << "ns" << setw(12) << "speedup"
+       << endl;
+
+  Now now(Now::Precision::NANOSECONDS, true);
+  nat_t check = 0;
+
+  for (nat_t i = 0; i < q; ++i)
+    check += binary_search(keys, queries[i], less);
+
+  double base = now.elapsed() / q;
+
+  cout << setw(16) << "binary_search" << setw(12) << base << setw(12) << 1.0
+       << "   (" << check << ")" << endl;
+
+  run("lower_bound", queries, [&keys, &less] (nat_t k)
+      {
+	return lower_bound(keys, 0, keys.size(), k, less);
+      }, base);
+
+  run("eytzinger", queries, [&eytzinger] (nat_t k)
+      {
+	return eytzinger.lower_bound(k);
+      }, base);
+
+  run("s-tree", queries, [&stree] (nat_t k)
+      {
+	return stree.lower_bound(k);
+      }, base);
+
+  return 0;
+}
@@ -0,0 +1,85 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <sort.hpp>
+#include <heap.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Gets the k smallest of n random keys by sorting everything, by draining
+ * a DynHeap, with partial_sort, with nth_element (unsorted) and with the
+ * streaming top_k_it. Times are in milliseconds.
+ *
+ * Usage: demo-select [n] [k]
+ */
+
+int main(int argc, char * argv[])
+{
+  nat_t n = argc > 1 ? atol(argv[1]) : 10000000;
+  nat_t k = argc > 2 ? atol(argv[2]) : 100;
+
+  rng_t rng(get_random_seed());
+
+  FixedArray<nat_t> input(n);
+
+  for (nat_t i = 0; i < n; ++i)
+    input[i] = random_uniform(rng, std::numeric_limits<nat_t>::max());
+
+  FixedArray<nat_t> a = input;
+  Now now(true);
+  quicksort(a);
+  double t_sort = now.elapsed();
+  nat_t expected = a[k - 1];
+
+  now.start();
+  DynHeap<nat_t> heap;
+
+  for (nat_t i = 0; i < n; ++i)
+    heap.insert(input[i]);
+
+  nat_t h = 0;
+
+  for (nat_t i = 0; i < k; ++i)
+    h = heap.get();
+
+  double t_heap = now.elapsed();
+
+  a = input;
+  now.start();
+  partial_sort(a, k);
+  double t_partial = now.elapsed();
+  nat_t p = a[k - 1];
+
+  a = input;
+  now.start();
+  nth_element(a, k - 1);
+  double t_nth = now.elapsed();
+  nat_t q = a[k - 1];
+
+  now.start();
+  DynArray<nat_t> top = top_k_it(input.begin(), input.end(), k);
+  double t_top = now.elapsed();
+
+  cout << "n = " << n << ", k = " << k << "\n\n" << fixed << setprecision(1)
+       << setw(14) << "quicksort" << setw(12) << t_sort << endl
+       << setw(14) << "DynHeap" << setw(12) << t_heap << endl
+       << setw(14) << "partial_sort" << setw(12) << t_partial << endl
+       << setw(14) << "nth_element" << setw(12) << t_nth << endl
+       << setw(14) << "top_k_it" << setw(12) << t_top << endl;
+
+  if (h != expected or p != expected or q != expected or
+      top[k - 1] != expected)
+    cout << "\nWrong result\n";
+
+  return 0;
+}
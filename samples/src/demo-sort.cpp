@@ -0,0 +1,131 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+#include <sort.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Benchmark of quicksort against heapsort and std::sort on several input
+ * distributions, followed by the list merge sort on the same inputs.
+ * Times are in milliseconds.
+ *
+ * Usage: demo-sort [n]
+ */
+
+enum class Distribution
+  {
+    RANDOM,
+    SORTED,
+    REVERSED,
+    FEW_UNIQUE,
+    SAWTOOTH,
+    ORGAN_PIPE
+  };
+
+void fill(FixedArray<nat_t> & a, Distribution d, rng_t & rng)
+{
+  nat_t n = a.size();
+
+  for (nat_t i = 0; i < n; ++i)
+    switch (d)
+      {
+      case Distribution::RANDOM:
+	a[i] = random_uniform(rng, std::numeric_limits<nat_t>::max());
+	break;
+      case Distribution::SORTED:
+	a[i] = i;
+	break;
+      case Distribution::REVERSED:
+	a[i] = n - i;
+	break;
+      case Distribution::FEW_UNIQUE:
+	a[i] = random_uniform(rng, nat_t(16));
+	break;
+      case Distribution::SAWTOOTH:
+	a[i] = i % (n / 64 + 1);
+	break;
+      case Distribution::ORGAN_PIPE:
+	a[i] = i < n / 2 ? i : n - i;
+	break;
+      }
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t n = argc > 1 ? atol(argv[1]) : 10000000;
+
+  rng_t rng(get_random_seed());
+
+  const char * names[] = { "random", "sorted", "reversed", "few unique",
+			   "sawtooth", "organ pipe" };
+
+  cout << "n = " << n << "\n\n"
+       << setw(12) << "input" << setw(12) << "quicksort"
+       << setw(12) << "heapsort" << setw(12) << "std::sort" << endl;
+
+  FixedArray<nat_t> input(n);
+
+  for (nat_t d = 0; d < 6; ++d)
+    {
+      fill(input, Distribution(d), rng);
+
+      FixedArray<nat_t> a = input;
+      Now now(true);
+      quicksort(a);
+      double tq = now.elapsed();
+
+      a = input;
+      now.start();
+      heapsort(a);
+      double th = now.elapsed();
+
+      a = input;
+      now.start();
+      std::sort(&a[0], &a[0] + n);
+      double ts = now.elapsed();
+
+      cout << setw(12) << names[d] << fixed << setprecision(1)
+	   << setw(12) << tq << setw(12) << th << setw(12) << ts << endl;
+    }
+
+  cout << "\nLists\n\n"
+       << setw(12) << "input" << setw(12) << "SLList" << setw(12) << "DLList"
+       << endl;
+
+  for (nat_t d = 0; d < 6; ++d)
+    {
+      fill(input, Distribution(d), rng);
+
+      SLList<nat_t> sl;
+      DLList<nat_t> dl;
+
+      for (nat_t i = 0; i < n; ++i)
+	{
+	  sl.append(input[i]);
+	  dl.append(input[i]);
+	}
+
+      Now now(true);
+      mergesort(sl);
+      double ts = now.elapsed();
+
+      now.start();
+      mergesort(dl);
+      double td = now.elapsed();
+
+      cout << setw(12) << names[d] << setw(12) << ts << setw(12) << td << endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <set.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Merges two sets of n random keys each: by inserting the keys of one
+ * into the other, and by join_with on a pool of a single thread and on
+ * the shared pool. Times are in milliseconds.
+ *
+ * Usage: demo-treap-join [n]
+ */
+
+void fill(TreeSet<nat_t> & s1, TreeSet<nat_t> & s2, nat_t n, rng_t & rng)
+{
+  DynArray<nat_t> k1(n + 1), k2(n + 1);
+
+  for (nat_t i = 0; i < n; ++i)
+    {
+      k1.append(random_uniform(rng, 4 * n));
+      k2.append(random_uniform(rng, 4 * n));
+    }
+
+  s1.clear();
+  s2.clear();
+  s1.multi_insert(k1);
+  s2.multi_insert(k2);
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t n = argc > 1 ? atol(argv[1]) : 1 << 22;
+
+  rng_t rng(get_random_seed());
+
+  TreeSet<nat_t> s1, s2;
+
+  cout << "n = " << n << "   (" << ThreadPool::shared().num_threads()
+       << " threads)\n\n" << fixed << setprecision(1);
+
+  fill(s1, s2, n, rng);
+
+  double t_insert;
+
+  {
+    Now now(true);
+
+    s2.for_each([&s1] (const nat_t & k) { s1.insert(k); });
+
+    t_insert = now.elapsed();
+
+    cout << setw(16) << "insert" << setw(12) << t_insert << " ms   ("
+	 << s1.size() << " keys)" << endl;
+  }
+
+  fill(s1, s2, n, rng);
+
+  {
+    ThreadPool pool(1);
+    Now now(true);
+
+    s1.join_with(s2, &pool);
+
+    double t = now.elapsed();
+
+    cout << setw(16) << "join, 1 thread" << setw(12) << t << " ms   ("
+	 << s1.size() << " keys)   speedup " << t_insert / t << endl;
+  }
+
+  fill(s1, s2, n, rng);
+
+  {
+    Now now(true);
+
+    s1.join_with(s2);
+
+    double t = now.elapsed();
+
+    cout << setw(16) << "join" << setw(12) << t << " ms   ("
+	 << s1.size() << " keys)   speedup " << t_insert / t << endl;
+  }
+
+  if (not s1.verify())
+    cout << "Invalid treap!" << endl;
+
+  return 0;
+}
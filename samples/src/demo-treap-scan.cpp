@@ -0,0 +1,140 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include <set.hpp>
+#include <random.hpp>
+#include <now.hpp>
+
+using namespace Designar;
+
+/* Iteration over a set of n random keys against a DynArray with the
+ * same keys: full scans by for_each, by a range-based for and by fold,
+ * and q short scans of 16 keys from lower_bound. Times are in
+ * milliseconds.
+ *
+ * Usage: demo-treap-scan [n] [q]
+ */
+
+template <class ContainerType>
+nat_t sum_for_each(const ContainerType & c)
+{
+  nat_t s = 0;
+  c.for_each([&s] (nat_t k) { s += k; });
+  return s;
+}
+
+template <class ContainerType>
+nat_t sum_range_for(const ContainerType & c)
+{
+  nat_t s = 0;
+
+  for (nat_t k : c)
+    s += k;
+
+  return s;
+}
+
+template <class ContainerType>
+nat_t sum_fold(const ContainerType & c)
+{
+  return c.fold(nat_t(0), [] (nat_t k, nat_t acc) { return acc + k; });
+}
+
+nat_t short_scans(const TreeSet<nat_t> & set, const DynArray<nat_t> & starts)
+{
+  nat_t s = 0;
+
+  for (nat_t k : starts)
+    {
+      auto it = set.lower_bound(k);
+
+      for (nat_t i = 0; i < 16 and it != set.end(); ++i, ++it)
+	s += *it;
+    }
+
+  return s;
+}
+
+nat_t short_scans(const DynArray<nat_t> & array,
+		  const DynArray<nat_t> & starts)
+{
+  nat_t s = 0;
+  std::less<nat_t> cmp;
+
+  for (nat_t k : starts)
+    {
+      nat_t i = lower_bound(array, 0, array.size(), k, cmp);
+
+      for (nat_t j = 0; j < 16 and i < array.size(); ++j, ++i)
+	s += array[i];
+    }
+
+  return s;
+}
+
+int main(int argc, char * argv[])
+{
+  nat_t n = argc > 1 ? atol(argv[1]) : 1 << 20;
+  nat_t q = argc > 2 ? atol(argv[2]) : 1 << 20;
+
+  rng_t rng(get_random_seed());
+
+  TreeSet<nat_t> set;
+
+  while (set.size() < n)
+    set.insert(random_uniform(rng, 4 * n));
+
+  DynArray<nat_t> array(n + 1);
+
+  for (nat_t k : set)
+    array.append(k);
+
+  DynArray<nat_t> starts(q + 1);
+
+  for (nat_t i = 0; i < q; ++i)
+    starts.append(random_uniform(rng, 4 * n));
+
+  cout << "n = " << n << "   q = " << q << "\n\n" << fixed << setprecision(1)
+       << setw(16) << "" << setw(12) << "TreeSet" << setw(12) << "DynArray"
+       << endl;
+
+  nat_t sum = 0;
+
+  auto measure = [&sum] (const char * name, auto scan_set, auto scan_array)
+    {
+      Now now(true);
+      sum += scan_set();
+      double t_set = now.elapsed();
+
+      now.start();
+      sum += scan_array();
+      double t_array = now.elapsed();
+
+      cout << setw(16) << name << setw(12) << t_set << setw(12) << t_array
+	   << endl;
+    };
+
+  measure("for_each", [&] () { return sum_for_each(set); },
+	  [&] () { return sum_for_each(array); });
+
+  measure("range for", [&] () { return sum_range_for(set); },
+	  [&] () { return sum_range_for(array); });
+
+  measure("fold", [&] () { return sum_fold(set); },
+	  [&] () { return sum_fold(array); });
+
+  measure("short scans", [&] () { return short_scans(set, starts); },
+	  [&] () { return short_scans(array, starts); });
+
+  cout << "\n(checksum " << sum << ")" << endl;
+
+  return 0;
+}
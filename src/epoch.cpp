@@ -0,0 +1,270 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <thread>
+
+#include <epoch.hpp>
+
+namespace Designar
+{
+
+  thread_local Epoch::RecordOwner Epoch::owner;
+
+  void Epoch::Bucket::free_all()
+  {
+    if (items.is_empty())
+      return;
+
+    // Deleters may retire new objects, so the list is detached first.
+    DynArray<Retired> to_free;
+    items.swap(to_free);
+
+    for (nat_t i = 0; i < to_free.size(); ++i)
+      to_free[i].deleter(to_free[i].ptr);
+  }
+
+  Epoch::RecordOwner::~RecordOwner()
+  {
+    if (rec != nullptr)
+      domain().release_record(rec);
+  }
+
+  Epoch::Record * Epoch::RecordOwner::get()
+  {
+    if (rec == nullptr)
+      rec = domain().acquire_record();
+
+    return rec;
+  }
+
+  Epoch::~Epoch()
+  {
+    Record * r = records.load();
+
+    while (r != nullptr)
+      {
+	Record * next = r->next;
+
+	for (nat_t i = 0; i < NUM_BUCKETS; ++i)
+	  r->buckets[i].free_all();
+
+	delete r;
+	r = next;
+      }
+
+    for (nat_t i = 0; i < orphans.size(); ++i)
+      {
+	orphans[i]->free_all();
+	delete orphans[i];
+      }
+  }
+
+  Epoch::Record * Epoch::acquire_record()
+  {
+    for (Record * r = records.load(); r != nullptr; r = r->next)
+      {
+	bool expected = false;
+
+	if (r->in_use.compare_exchange_strong(expected, true))
+	  return r;
+      }
+
+    Record * r = new Record;
+    r->next = records.load();
+
+    while (not records.compare_exchange_weak(r->next, r))
+      ; // retry with the updated head
+
+    return r;
+  }
+
+  void Epoch::release_record(Record * r)
+  {
+    assert(r->nesting == 0);
+
+    std::lock_guard<std::mutex> lck(orphans_mtx);
+
+    for (nat_t i = 0; i < NUM_BUCKETS; ++i)
+      {
+	Bucket & b = r->buckets[i];
+
+	if (b.items.is_empty())
+	  continue;
+
+	Bucket * orphan = new Bucket;
+	orphan->items.swap(b.items);
+	orphan->epoch = b.epoch;
+	orphans.append(orphan);
+      }
+
+    r->num_retired = 0;
+    r->local_epoch.store(0);
+    r->in_use.store(false);
+  }
+
+  bool Epoch::try_advance()
+  {
+    nat_t e = global_epoch.load();
+
+    for (Record * r = records.load(); r != nullptr; r = r->next)
+      {
+	if (not r->in_use.load())
+	  continue;
+
+	nat_t local = r->local_epoch.load();
+
+	if ((local & ACTIVE) and (local >> 1) != e)
+	  return false;
+      }
+
+    return global_epoch.compare_exchange_strong(e, e + 1);
+  }
+
+  void Epoch::reclaim(Record * r, nat_t g)
+  {
+    for (nat_t i = 0; i < NUM_BUCKETS; ++i)
+      if (r->buckets[i].epoch + 2 <= g)
+	r->buckets[i].free_all();
+  }
+
+  void Epoch::reclaim_orphans(nat_t g)
+  {
+    std::unique_lock<std::mutex> lck(orphans_mtx, std::try_to_lock);
+
+    if (not lck.owns_lock() or orphans.is_empty())
+      return;
+
+    DynArray<Bucket *> to_free;
+
+    nat_t i = 0;
+
+    while (i < orphans.size())
+      if (orphans[i]->epoch + 2 <= g)
+	to_free.append(orphans.remove_pos(i));
+      else
+	++i;
+
+    lck.unlock();
+
+    for (i = 0; i < to_free.size(); ++i)
+      {
+	to_free[i]->free_all();
+	delete to_free[i];
+      }
+  }
+
+  void Epoch::enter()
+  {
+    Record * r = owner.get();
+
+    if (r->nesting++ > 0)
+      return;
+
+    Epoch & d = domain();
+
+    nat_t e = d.global_epoch.load();
+
+    while (true)
+      {
+	r->local_epoch.store(e << 1 | ACTIVE);
+
+	nat_t g = d.global_epoch.load();
+
+	if (g == e)
+	  break;
+
+	e = g;
+      }
+
+    d.reclaim(r, e);
+  }
+
+  void Epoch::exit()
+  {
+    Record * r = owner.get();
+
+    assert(r->nesting > 0);
+
+    if (--r->nesting > 0)
+      return;
+
+    r->local_epoch.store(r->local_epoch.load(std::memory_order_relaxed) &
+			 ~ACTIVE, std::memory_order_release);
+  }
+
+  bool Epoch::is_in_critical_region()
+  {
+    return owner.get()->nesting > 0;
+  }
+
+  nat_t Epoch::current()
+  {
+    return domain().global_epoch.load();
+  }
+
+  void Epoch::retire(void * ptr, Deleter deleter)
+  {
+    Epoch & d = domain();
+    Record * r = owner.get();
+
+    // Anyone holding a reference to ptr entered at this epoch or before.
+    nat_t g = d.global_epoch.load();
+
+    Bucket & b = r->buckets[g % NUM_BUCKETS];
+
+    if (b.epoch != g)
+      {
+	// Same residue and older, so at least three epochs old.
+	b.free_all();
+	b.epoch = g;
+      }
+
+    b.items.append(Retired{ptr, deleter});
+
+    if (++r->num_retired < RETIRE_THRESHOLD)
+      return;
+
+    r->num_retired = 0;
+    d.try_advance();
+    g = d.global_epoch.load();
+    d.reclaim(r, g);
+    d.reclaim_orphans(g);
+  }
+
+  nat_t Epoch::num_pending()
+  {
+    Record * r = owner.get();
+
+    nat_t ret_val = 0;
+
+    for (nat_t i = 0; i < NUM_BUCKETS; ++i)
+      ret_val += r->buckets[i].items.size();
+
+    return ret_val;
+  }
+
+  void Epoch::synchronize()
+  {
+    Epoch & d = domain();
+    Record * r = owner.get();
+
+    assert(r->nesting == 0);
+
+    for (nat_t attempt = 0; attempt < 4 * NUM_BUCKETS; ++attempt)
+      {
+	d.try_advance();
+	nat_t g = d.global_epoch.load();
+	d.reclaim(r, g);
+	d.reclaim_orphans(g);
+
+	if (num_pending() == 0)
+	  return;
+
+	std::this_thread::yield();
+      }
+  }
+
+} // end namespace Designar
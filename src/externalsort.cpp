@@ -0,0 +1,67 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <externalsort.hpp>
+#include <random.hpp>
+
+namespace Designar
+{
+
+  std::string default_temp_dir()
+  {
+    const char * dir = std::getenv("TMPDIR");
+
+    return dir != nullptr and *dir != '\0' ? dir : "/tmp";
+  }
+
+  TempFileSet::TempFileSet(const std::string & _dir)
+    : dir(_dir)
+  {
+    // empty
+  }
+
+  TempFileSet::~TempFileSet()
+  {
+    for (nat_t i = 0; i < paths.size(); ++i)
+      std::remove(paths[i].c_str());
+  }
+
+  std::string TempFileSet::create()
+  {
+    static std::atomic<nat_t> counter(0);
+    static const rng_seed_t seed = get_random_seed();
+
+    std::string path = dir + "/designar-" + std::to_string(seed) + "-" +
+      std::to_string(counter++) + ".run";
+
+    paths.append(path);
+
+    return path;
+  }
+
+  void TempFileSet::release(const std::string & path)
+  {
+    for (nat_t i = 0; i < paths.size(); ++i)
+      if (paths[i] == path)
+	{
+	  std::remove(path.c_str());
+	  std::swap(paths[i], paths[paths.size() - 1]);
+	  paths.remove_last();
+	  return;
+	}
+  }
+
+  real_t ExternalSortStats::throughput() const
+  {
+    double t = total_time();
+
+    return t > 0 ? num_bytes / 1e3 / t : 0;
+  }
+
+} // end namespace Designar
@@ -0,0 +1,92 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <parallel.hpp>
+
+namespace Designar
+{
+
+  nat_t num_workers_for(nat_t n, nat_t grain, ThreadPool & pool)
+  {
+    grain = std::max(grain, nat_t(1));
+
+    nat_t num_chunks = n / grain + (n % grain != 0);
+
+    return std::min(pool.num_threads(), num_chunks);
+  }
+
+  nat_t parallel_chunks(nat_t n, Schedule schedule, nat_t grain,
+			ThreadPool & pool, const ChunkBody & body)
+  {
+    grain = std::max(grain, nat_t(1));
+
+    nat_t num_workers = num_workers_for(n, grain, pool);
+
+    if (num_workers == 0)
+      return 0;
+
+    if (num_workers == 1)
+      {
+	body(0, n, 0);
+	return 1;
+      }
+
+    std::atomic<nat_t> next(0);
+
+    auto worker = [&] (nat_t w)
+      {
+	switch (schedule)
+	  {
+	  case Schedule::STATIC:
+	    body(w * n / num_workers, (w + 1) * n / num_workers, w);
+	    break;
+
+	  case Schedule::DYNAMIC:
+	    while (true)
+	      {
+		nat_t b = next.fetch_add(grain);
+
+		if (b >= n)
+		  break;
+
+		body(b, std::min(b + grain, n), w);
+	      }
+	    break;
+
+	  case Schedule::GUIDED:
+	    while (true)
+	      {
+		nat_t b = next.load();
+		nat_t e;
+
+		do
+		  {
+		    if (b >= n)
+		      return;
+
+		    nat_t chunk = std::max(grain, (n - b) / (2 * num_workers));
+		    e = std::min(b + chunk, n);
+		  }
+		while (not next.compare_exchange_weak(b, e));
+
+		body(b, e, w);
+	      }
+	  }
+      };
+
+    // Declared last so it waits for the tasks before the locals die.
+    TaskGroup group(pool);
+
+    for (nat_t w = 1; w < num_workers; ++w)
+      group.run([&worker, w] () { worker(w); });
+
+    worker(0);
+    group.wait();
+
+    return num_workers;
+  }
+
+} // end namespace Designar
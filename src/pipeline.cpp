@@ -0,0 +1,193 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <pipeline.hpp>
+
+namespace Designar
+{
+
+  Pipeline::BaseStage::BaseStage(Pipeline & p, const std::string & n,
+				 nat_t par, Ordering ord)
+    : active(0), end_time(-1), pipeline(p), name(n), parallelism(par),
+      ordering(ord), workers(par), connected(false),
+      start_time(Now::current_time_point()), num_items(0), num_batches(0),
+      max_queue_depth(0)
+  {
+    if (parallelism == 0)
+      throw std::domain_error("Parallelism must be greater than zero");
+  }
+
+  Pipeline::BaseStage::~BaseStage()
+  {
+    // empty
+  }
+
+  void Pipeline::BaseStage::update_counters(nat_t items, nat_t depth)
+  {
+    num_items += items;
+    ++num_batches;
+
+    nat_t max_depth = max_queue_depth.load();
+
+    while (depth > max_depth and
+	   not max_queue_depth.compare_exchange_weak(max_depth, depth))
+      ; // retry with the updated maximum
+  }
+
+  void Pipeline::BaseStage::run_worker()
+  {
+    try
+      {
+	work();
+      }
+    catch (...)
+      {
+	pipeline.fail(std::current_exception());
+      }
+
+    if (--active > 0)
+      return;
+
+    end_time = Now::compute_time_diff(Now::current_time_point(), start_time,
+				      Now::Precision::MILLISECONDS);
+    finish();
+  }
+
+  void Pipeline::BaseStage::start()
+  {
+    start_time = Now::current_time_point();
+    active = parallelism;
+
+    for (nat_t i = 0; i < parallelism; ++i)
+      workers[i] = std::thread(&BaseStage::run_worker, this);
+  }
+
+  void Pipeline::BaseStage::join()
+  {
+    for (nat_t i = 0; i < parallelism; ++i)
+      if (workers[i].joinable())
+	workers[i].join();
+  }
+
+  Pipeline::StageStats Pipeline::BaseStage::stats() const
+  {
+    StageStats s;
+    s.name            = name;
+    s.parallelism     = parallelism;
+    s.ordered         = ordering == Ordering::ORDERED;
+    s.num_items       = num_items;
+    s.num_batches     = num_batches;
+    s.queue_depth     = queue_depth();
+    s.max_queue_depth = max_queue_depth;
+    s.elapsed         = end_time;
+
+    if (s.elapsed < 0)
+      s.elapsed = Now::compute_time_diff(Now::current_time_point(),
+					 start_time,
+					 Now::Precision::MILLISECONDS);
+    return s;
+  }
+
+  Pipeline::Pipeline(nat_t queue_cap, nat_t batch)
+    : queue_capacity(queue_cap), batch_size(batch), stages(),
+      started(false), joined(false), stop_requested(false), failed(false)
+  {
+    if (queue_capacity == 0 or batch_size == 0)
+      throw std::domain_error("Queue capacity and batch size must be "
+			      "greater than zero");
+  }
+
+  Pipeline::~Pipeline()
+  {
+    if (started and not joined)
+      {
+	stop();
+
+	for (nat_t i = 0; i < stages.size(); ++i)
+	  stages[i]->join();
+      }
+
+    for (nat_t i = 0; i < stages.size(); ++i)
+      delete stages[i];
+  }
+
+  void Pipeline::fail(std::exception_ptr e)
+  {
+    std::lock_guard<std::mutex> lck(error_mtx);
+
+    if (not failed)
+      error = e;
+
+    failed = true;
+    stop_requested = true;
+  }
+
+  std::string Pipeline::stage_name(const std::string & name) const
+  {
+    if (not name.empty())
+      return name;
+
+    return "stage " + std::to_string(stages.size());
+  }
+
+  void Pipeline::connect(BaseStage * prev)
+  {
+    if (started)
+      throw std::domain_error("Pipeline is already running");
+
+    if (prev->connected)
+      throw std::domain_error("Stage output is already connected");
+
+    prev->connected = true;
+  }
+
+  void Pipeline::start()
+  {
+    if (started)
+      throw std::domain_error("Pipeline is already running");
+
+    if (stages.is_empty())
+      throw std::domain_error("Pipeline is empty");
+
+    for (nat_t i = 0; i < stages.size(); ++i)
+      if (stages[i]->has_output() and not stages[i]->connected)
+	throw std::domain_error("Stage " + stages[i]->name +
+				" has no consumer");
+
+    started = true;
+
+    for (nat_t i = 0; i < stages.size(); ++i)
+      stages[i]->start();
+  }
+
+  void Pipeline::wait()
+  {
+    if (not started)
+      throw std::domain_error("Pipeline is not running");
+
+    if (not joined)
+      {
+	for (nat_t i = 0; i < stages.size(); ++i)
+	  stages[i]->join();
+
+	joined = true;
+      }
+
+    if (error != nullptr)
+      std::rethrow_exception(error);
+  }
+
+  DynArray<Pipeline::StageStats> Pipeline::stats() const
+  {
+    DynArray<StageStats> ret_val;
+
+    for (nat_t i = 0; i < stages.size(); ++i)
+      ret_val.append(stages[i]->stats());
+
+    return ret_val;
+  }
+
+} // end namespace Designar
@@ -0,0 +1,7 @@
+/*
+  This file is part of Designar.
+  
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <radixsort.hpp>
@@ -0,0 +1,153 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <threadpool.hpp>
+
+namespace Designar
+{
+
+  ThreadPool::ThreadPool(nat_t num_threads)
+    : workers(std::max(num_threads, nat_t(1))), stopped(false)
+  {
+    for (nat_t i = 0; i < workers.size(); ++i)
+      workers[i] = std::thread(&ThreadPool::work, this);
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lck(mtx);
+      stopped = true;
+    }
+
+    cond_var.notify_all();
+
+    for (nat_t i = 0; i < workers.size(); ++i)
+      workers[i].join();
+  }
+
+  ThreadPool & ThreadPool::shared()
+  {
+    static ThreadPool instance;
+    return instance;
+  }
+
+  void ThreadPool::work()
+  {
+    while (true)
+      {
+	Task task;
+
+	{
+	  std::unique_lock<std::mutex> lck(mtx);
+	  cond_var.wait(lck, [this] { return stopped or not tasks.is_empty(); });
+
+	  if (tasks.is_empty())
+	    return;
+
+	  task = tasks.get();
+	}
+
+	task();
+      }
+  }
+
+  bool ThreadPool::pop_task(Task & task)
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+
+    if (tasks.is_empty())
+      return false;
+
+    task = tasks.get();
+    return true;
+  }
+
+  nat_t ThreadPool::num_pending() const
+  {
+    std::lock_guard<std::mutex> lck(const_cast<std::mutex &>(mtx));
+    return tasks.size();
+  }
+
+  void ThreadPool::submit(Task task)
+  {
+    {
+      std::lock_guard<std::mutex> lck(mtx);
+
+      if (stopped)
+	throw std::domain_error("Thread pool is stopped");
+
+      tasks.put(std::move(task));
+    }
+
+    cond_var.notify_one();
+  }
+
+  bool ThreadPool::run_pending_task()
+  {
+    Task task;
+
+    if (not pop_task(task))
+      return false;
+
+    task();
+    return true;
+  }
+
+  TaskGroup::~TaskGroup()
+  {
+    try
+      {
+	wait();
+      }
+    catch (...)
+      {
+	// Exceptions are only reported by an explicit wait().
+      }
+  }
+
+  void TaskGroup::finish_task(std::exception_ptr e)
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+
+    if (e != nullptr and error == nullptr)
+      error = e;
+
+    if (--num_running == 0)
+      cond_var.notify_all();
+  }
+
+  void TaskGroup::wait()
+  {
+    while (true)
+      {
+	{
+	  std::lock_guard<std::mutex> lck(mtx);
+
+	  if (num_running == 0)
+	    break;
+	}
+
+	if (pool.run_pending_task())
+	  continue;
+
+	std::unique_lock<std::mutex> lck(mtx);
+	cond_var.wait_for(lck, std::chrono::microseconds(100),
+			  [this] { return num_running == 0; });
+      }
+
+    std::exception_ptr e = nullptr;
+
+    {
+      std::lock_guard<std::mutex> lck(mtx);
+      std::swap(e, error);
+    }
+
+    if (e != nullptr)
+      std::rethrow_exception(e);
+  }
+
+} // end namespace Designar
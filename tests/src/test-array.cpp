@@ -225,8 +225,64 @@ int main()
 			
   assert(s1.zip(s2).equal({{1,3},{2,4},{3,5},{4,6}}));
 
+  SortedArraySet<int_t> ss1 = {4,2,3,1,2};
+  SortedArraySet<int_t> ss2 = {3,4,5,6};
+
+  assert(ss1.equal({1,2,3,4}));
+  assert(ss1.join(ss2).equal({1,2,3,4,5,6}));
+  assert(ss1.intersect(ss2).equal({3,4}));
+  assert(ss1.difference(ss2).equal({1,2}));
+  assert(ss2.difference(ss1).equal({5,6}));
+
+  assert(ss1.insert_bulk(DynArray<int_t>({9,0,3,9})) == 2);
+  assert(ss1.equal({0,1,2,3,4,9}));
+
   rng_t rng(time(nullptr));
 
+  // Merge-based algebra against a linear scan, balanced and skewed.
+  for (nat_t m : { nat_t(0), nat_t(5), nat_t(300), nat_t(3000) })
+    {
+      DynArray<int_t> xs, ys;
+
+      for (nat_t i = 0; i < 3000; ++i)
+	xs.append(random_uniform(rng, 6000));
+
+      for (nat_t i = 0; i < m; ++i)
+	ys.append(random_uniform(rng, 6000));
+
+      SortedArraySet<int_t> sx, sy;
+      sx.build_from_unsorted(xs);
+      sy.build_from_unsorted(std::move(ys));
+
+      for (nat_t i = 1; i < sx.size(); ++i)
+	assert(sx[i - 1] < sx[i]);
+
+      assert(xs.all([&sx] (int_t x) { return sx.contains(x); }));
+
+      SortedArraySet<int_t> u = sx.join(sy);
+      SortedArraySet<int_t> i1 = sx.intersect(sy), i2 = sy.intersect(sx);
+      SortedArraySet<int_t> d1 = sx.difference(sy), d2 = sy.difference(sx);
+
+      for (int_t k = 0; k < 6000; ++k)
+	{
+	  bool x = sx.contains(k), y = sy.contains(k);
+
+	  assert(u.contains(k) == (x or y));
+	  assert(i1.contains(k) == (x and y) and i2.contains(k) == (x and y));
+	  assert(d1.contains(k) == (x and not y));
+	  assert(d2.contains(k) == (y and not x));
+	}
+
+      assert(u.size() == i1.size() + d1.size() + d2.size());
+
+      SortedArraySet<int_t> b = sx;
+      sy.for_each([&b] (int_t k) { b.insert(k); });
+      nat_t n = sx.size();
+
+      assert(sx.insert_bulk(sy) == b.size() - n);
+      assert(sx.equal(b));
+    }
+
   DynArray<int_t> aa;
 
   for (int_t i = 0; i < 20; ++i)
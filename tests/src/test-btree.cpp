@@ -0,0 +1,124 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <btree.hpp>
+#include <map.hpp>
+#include <random.hpp>
+
+using namespace std;
+using namespace Designar;
+
+int main()
+{
+  TreeSet<int_t, std::less<int_t>, BPlusTree> tree = { 2,4,6,8,10 };
+
+  assert(tree.verify());
+  assert(tree.size() == 5);
+  assert(tree.select(0) == 2);
+  assert(tree.select(3) == 8);
+  assert(tree.min() == 2);
+  assert(tree.max() == 10);
+  assert(tree.position(8) == 3);
+  assert(tree.position(5) == -1);
+  assert(tree.equal({2,4,6,8,10}));
+
+  try
+    {
+      tree.select(5);
+      assert(false);
+    }
+  catch(const out_of_range &)
+    {
+      assert(true);
+    }
+
+  // Random insertions and removals against the treap.
+  rng_t rng(17);
+
+  BPlusTree<int_t> bt;
+  RankedTreap<int_t> rt;
+
+  for (nat_t i = 0; i < 40000; ++i)
+    {
+      int_t k = random_uniform(rng, 20000);
+
+      if (random_uniform(rng, 3) < 2)
+	assert((bt.insert(k) == nullptr) == (rt.insert(k) == nullptr));
+      else
+	assert(bt.remove(k) == rt.remove(k));
+
+      if (i % 4000 == 0)
+	assert(bt.verify());
+    }
+
+  assert(bt.verify());
+  assert(bt.size() == rt.size());
+  assert(bt.equal(rt));
+
+  for (nat_t i = 0; i < bt.size(); i += 37)
+    {
+      assert(bt.select(i) == rt.select(i));
+      assert(bt.position(bt.select(i)) == int_t(i));
+    }
+
+  for (int_t k = -1; k < 20001; ++k)
+    assert((bt.search(k) == nullptr) == (rt.search(k) == nullptr));
+
+  BPlusTree<int_t> cpy = bt;
+  assert(cpy.verify() and cpy.equal(rt));
+
+  nat_t num_mult3 = rt.filter([] (int_t k) { return k % 3 == 0; }).size();
+
+  while (not bt.is_empty())
+    {
+      nat_t i = random_uniform(rng, bt.size());
+      assert(bt.remove_pos(i) == rt.remove_pos(i));
+    }
+
+  assert(bt.verify() and bt.is_empty() and bt.begin() == bt.end());
+
+  cpy.remove_if([] (int_t k) { return k % 3 != 0; });
+  assert(cpy.verify());
+  assert(cpy.all([] (int_t k) { return k % 3 == 0; }));
+  assert(cpy.size() == num_mult3);
+
+  // Equal keys keep the order of insertion and may span several leaves.
+  BPlusTree<int_t> dup;
+
+  for (int_t i = 0; i < 5; ++i)
+    for (int_t j = 0; j < 300; ++j)
+      dup.insert_dup(i * 7 % 5);
+
+  assert(dup.verify_dup());
+  assert(dup.size() == 1500);
+
+  for (int_t i = 0; i < 5; ++i)
+    assert(dup.position(i) == i * 300 and dup.select(i * 300 + 299) == i);
+
+  assert(dup.search_or_insert(2) == dup.search(2));
+  assert(dup.size() == 1500);
+
+  for (nat_t i = 0; i < 1000; ++i)
+    assert(dup.remove(i % 5));
+
+  assert(dup.verify_dup() and dup.size() == 500);
+
+  // Plugged into TreeMap.
+  TreeMap<string, int_t, std::less<string>, BPlusTree> map =
+    {{"One",1},{"Two",2},{"Three",3}};
+
+  map["Four"] = 4;
+  map.insert("Two", 0);
+
+  assert(map.size() == 4);
+  assert(map["Two"] == 2);
+  assert(map.find("Four") == 4);
+  assert(map.remove("One") and not map.has("One"));
+  assert(map.equal({{"Four",4},{"Three",3},{"Two",2}}));
+
+  cout << "Everything ok!\n";
+  return 0;
+}
@@ -0,0 +1,156 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <thread>
+
+#include <map.hpp>
+
+using namespace std;
+using namespace Designar;
+
+int main()
+{
+  ConcurrentTreeMap<int_t, string> map = { {5, "five"}, {1, "one"},
+					   {3, "three"} };
+
+  assert(map.size() == 3 and not map.is_empty());
+  assert(map.verify());
+  assert(map.insert(4, "four") and not map.insert(4, "cuatro"));
+  assert(map.find(4) == "four");
+  assert(map.contains(1) and not map.contains(2));
+
+  string s;
+
+  assert(map.search(3, s) and s == "three");
+  assert(not map.search(6, s));
+
+  try
+    {
+      map.find(2);
+      assert(false);
+    }
+  catch(const domain_error &)
+    {
+      assert(true);
+    }
+
+  assert(map.lower_bound(2)->first == 3 and map.lower_bound(3)->first == 3);
+  assert(map.upper_bound(3)->first == 4);
+  assert(map.upper_bound(5) == map.end());
+
+  int_t prev = 0;
+
+  for (const auto & item : map)
+    {
+      assert(prev < item.first);
+      prev = item.first;
+    }
+
+  int_t sum = 0;
+  map.for_each_in_range(2, 4, [&sum] (const MapKey<int_t, string> & item)
+			{
+			  sum += item.first;
+			});
+  assert(sum == 3 + 4);
+
+  assert(map.remove(3) and not map.remove(3));
+  assert(map.size() == 3 and map.verify());
+  assert(map.lower_bound(2)->first == 4);
+
+  map.clear();
+
+  assert(map.is_empty() and map.size() == 0 and map.begin() == map.end());
+
+  // Threads insert and remove disjoint keys, and read every key.
+  constexpr nat_t num_threads = 8;
+  constexpr nat_t num_keys    = 10000;
+
+  ConcurrentTreeMap<nat_t, nat_t> cmap;
+  FixedArray<thread> threads(num_threads);
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    threads[i] = thread([&cmap, i] ()
+			{
+			  for (nat_t j = i; j < num_keys; j += num_threads)
+			    assert(cmap.insert(j, 2 * j));
+
+			  for (nat_t j = i; j < num_keys; j += 2 * num_threads)
+			    assert(cmap.remove(j));
+
+			  for (nat_t j = 0; j < num_keys; ++j)
+			    {
+			      nat_t v;
+
+			      if (cmap.search(j, v))
+				assert(v == 2 * j);
+			    }
+			});
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    threads[i].join();
+
+  assert(cmap.verify() and cmap.size() == num_keys / 2);
+
+  for (nat_t j = 0; j < num_keys; ++j)
+    assert(cmap.contains(j) == ((j % (2 * num_threads)) >= num_threads));
+
+  // Every thread fights over the same keys while others iterate.
+  std::atomic<bool> done(false);
+  std::atomic<int_t> balance(cmap.size());
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    threads[i] = thread([&, i] ()
+			{
+			  if (i % 4 == 0)
+			    {
+			      while (not done)
+				{
+				  nat_t prev = 0, n = 0;
+
+				  for (auto it = cmap.lower_bound(100);
+				       it != cmap.end(); ++it, ++n)
+				    {
+				      assert(n == 0 or prev < it->first);
+				      prev = it->first;
+				    }
+				}
+			      return;
+			    }
+
+			  rng_t rng(i);
+
+			  for (nat_t j = 0; j < 20000; ++j)
+			    {
+			      nat_t k = random_uniform(rng, 1000);
+
+			      if (random_uniform(rng, 2) == 0)
+				balance += cmap.insert(k, 2 * k);
+			      else
+				balance -= cmap.remove(k);
+			    }
+			});
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    if (i % 4 != 0)
+      threads[i].join();
+
+  done = true;
+
+  for (nat_t i = 0; i < num_threads; i += 4)
+    threads[i].join();
+
+  nat_t n = 0;
+  cmap.for_each([&n] (const MapKey<nat_t, nat_t> & item)
+		{
+		  assert(item.second == 2 * item.first);
+		  ++n;
+		});
+
+  assert(cmap.verify() and n == cmap.size() and int_t(n) == balance);
+
+  cout << "Everything ok!\n";
+  return 0;
+}
@@ -0,0 +1,170 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <stack.hpp>
+#include <queue.hpp>
+
+using namespace std;
+using namespace Designar;
+
+int main()
+{
+  ConcurrentStack<int_t> stack;
+
+  assert(stack.is_empty());
+  assert(stack.size() == 0);
+
+  stack.push(1);
+  stack.push(2);
+  stack.push(3);
+
+  assert(not stack.is_empty());
+  assert(stack.size() == 3);
+  assert(stack.pop() == 3);
+  assert(stack.pop() == 2);
+
+  int_t item = 0;
+
+  assert(stack.try_pop(item));
+  assert(item == 1);
+  assert(not stack.try_pop(item));
+  assert(stack.is_empty());
+
+  try
+    {
+      stack.pop();
+      assert(false);
+    }
+  catch(underflow_error)
+    {
+      assert(true);
+    }
+  catch(...)
+    {
+      assert(false);
+    }
+
+  constexpr nat_t num_threads = 8;
+  constexpr nat_t num_items   = 20000;
+
+  FixedArray<thread> threads(num_threads);
+  std::atomic<nat_t> popped_sum(0);
+  std::atomic<nat_t> popped_num(0);
+  std::atomic<bool>  working(true);
+  nat_t              max_size = 0;
+
+  // size() must never count more items than were pushed.
+  thread watcher([&stack, &working, &max_size] ()
+		 {
+		   while (working)
+		     max_size = std::max(max_size, stack.size());
+		 });
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    threads[i] = thread([&stack, &popped_sum, &popped_num, i] ()
+			{
+			  for (nat_t j = 0; j < num_items; ++j)
+			    {
+				stack.push(int_t(i * num_items + j));
+
+				int_t v;
+
+				if (j % 2 == 0 and stack.try_pop(v))
+				  {
+				    popped_sum += v;
+				    ++popped_num;
+				  }
+			    }
+			});
+
+  for (nat_t i = 0; i < num_threads; ++i)
+    threads[i].join();
+
+  working = false;
+  watcher.join();
+
+  assert(max_size <= num_threads * num_items);
+
+  while (stack.try_pop(item))
+    {
+      popped_sum += item;
+      ++popped_num;
+    }
+
+  nat_t total = num_threads * num_items;
+
+  assert(popped_num == total);
+  assert(popped_sum == total * (total - 1) / 2);
+
+  WorkStealingDeque<int_t> deque;
+
+  assert(deque.is_empty());
+
+  for (int_t i = 0; i < 100; ++i)
+    deque.push(i);
+
+  assert(deque.size() == 100);
+  assert(deque.get_capacity() >= 100);
+  assert(deque.try_pop(item) and item == 99);
+  assert(deque.try_steal(item) and item == 0);
+  assert(deque.size() == 98);
+
+  while (deque.try_pop(item));
+
+  assert(deque.is_empty());
+  assert(not deque.try_steal(item));
+
+  std::atomic<bool>  done(false);
+  std::atomic<nat_t> stolen_sum(0);
+  std::atomic<nat_t> stolen_num(0);
+  FixedArray<thread> thieves(num_threads - 1);
+
+  for (nat_t i = 0; i < thieves.size(); ++i)
+    thieves[i] = thread([&] ()
+			{
+			  int_t v;
+
+			  while (not done or not deque.is_empty())
+			    if (deque.try_steal(v))
+				{
+				  stolen_sum += v;
+				  ++stolen_num;
+				}
+			});
+
+  nat_t owner_sum = 0;
+  nat_t owner_num = 0;
+
+  for (nat_t i = 0; i < total; ++i)
+    {
+      deque.push(i);
+
+      if (i % 3 == 0 and deque.try_pop(item))
+	{
+	  owner_sum += item;
+	  ++owner_num;
+	}
+    }
+
+  while (deque.try_pop(item))
+    {
+      owner_sum += item;
+      ++owner_num;
+    }
+
+  done = true;
+
+  for (nat_t i = 0; i < thieves.size(); ++i)
+    thieves[i].join();
+
+  assert(owner_num + stolen_num == total);
+  assert(owner_sum + stolen_sum == total * (total - 1) / 2);
+
+  Epoch::synchronize();
+
+  cout << "Everything ok!\n";
+  return 0;
+}
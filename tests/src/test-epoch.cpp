@@ -0,0 +1,180 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <queue.hpp>
+
+using namespace std;
+using namespace Designar;
+
+std::atomic<nat_t> num_freed(0);
+
+struct Tracked
+{
+  nat_t value;
+
+  ~Tracked()
+  {
+    ++num_freed;
+  }
+};
+
+int main()
+{
+  assert(not Epoch::is_in_critical_region());
+
+  {
+    EpochGuard g1;
+    assert(Epoch::is_in_critical_region());
+
+    {
+      EpochGuard g2;
+      assert(Epoch::is_in_critical_region());
+    }
+
+    assert(Epoch::is_in_critical_region());
+  }
+
+  assert(not Epoch::is_in_critical_region());
+
+  Epoch::retire(new Tracked{1});
+  assert(Epoch::num_pending() == 1);
+  Epoch::synchronize();
+  assert(Epoch::num_pending() == 0);
+  assert(num_freed == 1);
+
+  // A reader inside a critical region keeps retired objects alive.
+  std::atomic<int> stage(0);
+
+  thread reader([&stage] ()
+		{
+		  EpochGuard guard;
+		  stage = 1;
+
+		  while (stage != 2)
+		    this_thread::yield();
+		});
+
+  while (stage != 1)
+    this_thread::yield();
+
+  Epoch::retire(new Tracked{2});
+  Epoch::synchronize();
+  assert(num_freed == 1);
+  assert(Epoch::num_pending() == 1);
+
+  stage = 2;
+  reader.join();
+
+  Epoch::synchronize();
+  assert(num_freed == 2);
+
+  num_freed = 0;
+
+  for (nat_t i = 0; i < 10 * Epoch::RETIRE_THRESHOLD; ++i)
+    Epoch::retire(new Tracked{i});
+
+  // Batches are freed as the thread keeps retiring.
+  assert(num_freed > 0);
+  Epoch::synchronize();
+  assert(num_freed == 10 * Epoch::RETIRE_THRESHOLD);
+
+  ConcurrentListQueue<int_t> queue;
+
+  assert(queue.is_empty());
+  assert(queue.size() == 0);
+
+  queue.put(1);
+  queue.put(2);
+  queue.put(3);
+
+  assert(not queue.is_empty());
+  assert(queue.size() == 3);
+  assert(queue.get() == 1);
+  assert(queue.get() == 2);
+
+  int_t item = 0;
+
+  assert(queue.try_get(item));
+  assert(item == 3);
+  assert(not queue.try_get(item));
+
+  try
+    {
+      queue.get();
+      assert(false);
+    }
+  catch(underflow_error)
+    {
+      assert(true);
+    }
+  catch(...)
+    {
+      assert(false);
+    }
+
+  constexpr nat_t num_producers = 4;
+  constexpr nat_t num_consumers = 4;
+  constexpr nat_t num_items     = 20000;
+  constexpr nat_t total         = num_producers * num_items;
+
+  FixedArray<thread> producers(num_producers);
+  FixedArray<thread> consumers(num_consumers);
+  std::atomic<nat_t> consumed_sum(0);
+  std::atomic<nat_t> consumed_num(0);
+  std::atomic<bool>  fifo_ok(true);
+  std::atomic<bool>  size_ok(true);
+
+  for (nat_t i = 0; i < num_producers; ++i)
+    producers[i] = thread([&queue, i] ()
+			  {
+			    for (nat_t j = 0; j < num_items; ++j)
+			      queue.put(int_t(i * num_items + j));
+			  });
+
+  for (nat_t i = 0; i < num_consumers; ++i)
+    consumers[i] = thread([&] ()
+			  {
+			    FixedArray<int_t> last(num_producers, -1);
+			    int_t v;
+
+			    while (consumed_num < total)
+			      {
+				// size() never counts more items than were put.
+				if (queue.size() > total)
+				  size_ok = false;
+
+				if (not queue.try_get(v))
+				  continue;
+
+				// Items of a producer are seen in order.
+				nat_t p = v / num_items;
+
+				if (v <= last[p])
+				  fifo_ok = false;
+
+				last[p] = v;
+				consumed_sum += v;
+				++consumed_num;
+			      }
+			  });
+
+  for (nat_t i = 0; i < num_producers; ++i)
+    producers[i].join();
+
+  for (nat_t i = 0; i < num_consumers; ++i)
+    consumers[i].join();
+
+  assert(fifo_ok);
+  assert(size_ok);
+  assert(consumed_num == total);
+  assert(consumed_sum == total * (total - 1) / 2);
+  assert(queue.is_empty());
+
+  Epoch::synchronize();
+
+  cout << "Everything ok!\n";
+  return 0;
+}
@@ -0,0 +1,185 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <sstream>
+
+#include <externalsort.hpp>
+#include <random.hpp>
+
+using namespace std;
+using namespace Designar;
+
+struct Edge
+{
+  nat_t src;
+  nat_t tgt;
+  real_t weight;
+};
+
+int main()
+{
+  rng_t rng(31);
+
+  ThreadPool pool(2);
+
+  // Loser tree over plain keys.
+  FixedArray<int_t> keys = { 5, 3, 9, 3, 1 };
+  auto less = [&keys] (nat_t i, nat_t j)
+    {
+      return keys[i] < keys[j] or (keys[i] == keys[j] and i < j);
+    };
+
+  LoserTree<decltype(less)> tree(keys.size(), less);
+  assert(tree.winner() == 4);
+
+  keys[4] = 10;
+  tree.replay();
+  assert(tree.winner() == 1);
+
+  keys[1] = 10;
+  tree.replay();
+  assert(tree.winner() == 3);
+
+  // Fixed-size records, with many runs and several merge passes.
+  for (nat_t n : { nat_t(0), nat_t(1), nat_t(1000), nat_t(100000) })
+    {
+      FixedArray<nat_t> input(n);
+
+      for (nat_t i = 0; i < n; ++i)
+	input[i] = random_uniform(rng, nat_t(50000));
+
+      stringstream in, out;
+
+      if (n > 0)
+	in.write(reinterpret_cast<const char *>(&input[0]),
+		 n * sizeof(nat_t));
+
+      ExternalSort<nat_t> sorter(std::less<nat_t>(), pool);
+      sorter.set_memory_budget(16 * 1024);
+      sorter.set_buffer_size(1024);
+
+      assert(sorter.max_fan_in() == 15);
+
+      ExternalSortStats stats = sorter.sort(in, out);
+
+      assert(stats.num_items == n);
+      assert(stats.num_bytes == n * sizeof(nat_t));
+      assert(stats.num_runs == (n + 2047) / 2048);
+      assert(n < 100000 or stats.num_merge_passes == 2);
+
+      quicksort(input);
+
+      string result = out.str();
+      assert(result.size() == n * sizeof(nat_t));
+
+      for (nat_t i = 0; i < n; ++i)
+	{
+	  nat_t x;
+	  memcpy(&x, result.data() + i * sizeof(nat_t), sizeof(nat_t));
+	  assert(x == input[i]);
+	}
+    }
+
+  // Records by a custom order.
+  DynArray<Edge> edges;
+  stringstream ein, eout;
+
+  for (nat_t i = 0; i < 20000; ++i)
+    {
+      edges.append(Edge{random_uniform(rng, nat_t(100)), i, 1.0 / (i + 1)});
+      ein.write(reinterpret_cast<const char *>(&edges.get_last()),
+		sizeof(Edge));
+    }
+
+  auto by_src = [] (const Edge & x, const Edge & y)
+    {
+      return x.src < y.src or (x.src == y.src and x.tgt < y.tgt);
+    };
+
+  ExternalSort<Edge, decltype(by_src)> edge_sorter(by_src, pool);
+  edge_sorter.set_memory_budget(64 * 1024);
+  edge_sorter.sort(ein, eout);
+
+  quicksort(edges, by_src);
+
+  for (nat_t i = 0; i < edges.size(); ++i)
+    {
+      Edge e;
+      assert(ExternalRecord<Edge>::read(eout, e));
+      assert(e.src == edges[i].src and e.tgt == edges[i].tgt);
+    }
+
+  // Text lines.
+  DynArray<string> lines;
+  stringstream lin, lout;
+
+  for (nat_t i = 0; i < 30000; ++i)
+    {
+      string s = i % 5 == 0 ? "" : to_string(random_uniform(rng, nat_t(1e9)));
+      lines.append(s);
+      lin << s << '\n';
+    }
+
+  ExternalSort<string> line_sorter;
+  line_sorter.set_memory_budget(32 * 1024);
+  line_sorter.set_buffer_size(4096);
+
+  ExternalSortStats stats = line_sorter.sort(lin, lout);
+
+  assert(stats.num_items == lines.size());
+  assert(stats.num_runs > 1);
+
+  quicksort(lines);
+
+  string line;
+
+  for (nat_t i = 0; i < lines.size(); ++i)
+    {
+      assert(getline(lout, line));
+      assert(line == lines[i]);
+    }
+
+  assert(not getline(lout, line));
+
+  // Bad input and temporary directory.
+  stringstream odd("abc"), sink;
+  bool thrown = false;
+
+  try
+    {
+      ExternalSort<nat_t>().sort(odd, sink);
+    }
+  catch (const std::domain_error &)
+    {
+      thrown = true;
+    }
+
+  assert(thrown);
+
+  stringstream many;
+
+  for (nat_t i = 0; i < 1000; ++i)
+    many.write(reinterpret_cast<const char *>(&i), sizeof(nat_t));
+
+  ExternalSort<nat_t> lost;
+  lost.set_memory_budget(800);
+  lost.set_temp_dir("/nonexistent/designar");
+  thrown = false;
+
+  try
+    {
+      lost.sort(many, sink);
+    }
+  catch (const std::runtime_error &)
+    {
+      thrown = true;
+    }
+
+  assert(thrown);
+
+  cout << "Everything ok!\n";
+  return 0;
+}
@@ -11,6 +11,272 @@ using namespace std;
 
 using namespace Designar;
 
+// Random operations by handle against a scan of the live keys.
+template <nat_t D>
+void test_dary_heap(rng_t & rng)
+{
+  DAryHeap<int_t, D> heap;
+  DynArray<int_t> keys;
+  DynArray<bool> alive;
+
+  for (nat_t i = 0; i < 3000; ++i)
+    {
+      nat_t op = random_uniform(rng, 10);
+
+      if (op < 4 or heap.is_empty())
+	{
+	  int_t k = random_uniform(rng, 1000);
+	  nat_t h = heap.insert(k);
+
+	  while (keys.size() <= h)
+	    {
+	      keys.append(0);
+	      alive.append(false);
+	    }
+
+	  assert(not alive[h]);
+	  keys[h] = k;
+	  alive[h] = true;
+	}
+      else if (op < 6)
+	{
+	  nat_t h = heap.top_handle();
+	  assert(heap.get() == keys[h] and alive[h]);
+	  alive[h] = false;
+	}
+      else
+	{
+	  nat_t h = random_uniform(rng, keys.size());
+
+	  if (not alive[h])
+	    {
+	      assert(not heap.contains(h));
+	      continue;
+	    }
+
+	  assert(heap.get_key(h) == keys[h]);
+
+	  if (op == 6)
+	    heap.decrease_key(h, keys[h] -= random_uniform(rng, 100));
+	  else if (op == 7)
+	    heap.increase_key(h, keys[h] += random_uniform(rng, 100));
+	  else if (op == 8)
+	    heap.update(h, keys[h] = random_uniform(rng, 1000));
+	  else
+	    {
+	      assert(heap.remove(h) == keys[h]);
+	      alive[h] = false;
+	    }
+	}
+
+      if (heap.is_empty())
+	continue;
+
+      int_t min = std::numeric_limits<int_t>::max();
+
+      for (nat_t h = 0; h < keys.size(); ++h)
+	if (alive[h])
+	  min = std::min(min, keys[h]);
+
+      assert(heap.top() == min and heap.verify());
+    }
+}
+
+// Items are (priority, id); the functor orders them and gives priorities.
+using Item = std::pair<nat_t, nat_t>;
+
+struct ItemCmp
+{
+  bool operator () (const Item & a, const Item & b) const
+  {
+    return a.first < b.first;
+  }
+
+  nat_t operator () (const Item & a) const
+  {
+    return a.first;
+  }
+};
+
+/* Random operations by reference against a scan of the live items. Keys
+ * never go before the last one seen at the top, so the monotone heaps
+ * take the same sequence.
+ */
+template <template <typename, class> class HeapType>
+void test_handle_heap(rng_t & rng)
+{
+  HeapType<Item, ItemCmp> heap;
+  DynArray<Item *> handles;
+  DynArray<nat_t> keys;
+  nat_t last = 0;
+
+  for (nat_t i = 0; i < 3000; ++i)
+    {
+      nat_t op = random_uniform(rng, 10);
+
+      if (op < 4 or heap.is_empty())
+	{
+	  nat_t id = handles.size();
+	  keys.append(last + random_uniform(rng, 1000));
+	  handles.append(&const_cast<Item &>(heap.insert(Item(keys[id], id))));
+	}
+      else if (op < 6)
+	{
+	  Item item = heap.get();
+	  assert(item.first == keys[item.second]);
+	  handles[item.second] = nullptr;
+	  last = item.first;
+	}
+      else
+	{
+	  nat_t id = random_uniform(rng, handles.size());
+
+	  if (handles[id] == nullptr)
+	    continue;
+
+	  Item & item = *handles[id];
+	  assert(item.first == keys[id] and item.second == id);
+
+	  if (op < 8)
+	    {
+	      nat_t delta = random_uniform(rng, nat_t(100));
+	      keys[id] -= std::min(keys[id] - last, delta);
+	      heap.decrease_key(item, Item(keys[id], id));
+	    }
+	  else if (op == 8)
+	    heap.update(item, Item(keys[id] = last + random_uniform(rng, 1000),
+				   id));
+	  else
+	    {
+	      heap.remove(item);
+	      handles[id] = nullptr;
+	    }
+	}
+
+      if (heap.is_empty())
+	continue;
+
+      nat_t min = std::numeric_limits<nat_t>::max();
+      nat_t n = 0;
+
+      for (nat_t id = 0; id < handles.size(); ++id)
+	if (handles[id] != nullptr)
+	  {
+	    min = std::min(min, keys[id]);
+	    ++n;
+	  }
+
+      assert(heap.top().first == min and heap.size() == n);
+      assert(heap.verify());
+      last = min;
+    }
+
+  Item & item = const_cast<Item &>(heap.insert(Item(last + 10, 0)));
+
+  try
+    {
+      heap.decrease_key(item, Item(last + 20, 0));
+      assert(false);
+    }
+  catch(const domain_error &)
+    {
+      assert(true);
+    }
+
+  heap.clear();
+
+  assert(heap.is_empty() and heap.verify());
+}
+
+// Monotone heaps refuse keys before the last extracted one.
+template <template <typename, class> class HeapType>
+void test_monotone_heap()
+{
+  HeapType<nat_t, RadixIdentity> heap;
+
+  for (nat_t k : { 8, 3, 5, 3, 1000, 70000 })
+    heap.insert(k);
+
+  assert(heap.get() == 3 and heap.get() == 3 and heap.get() == 5);
+
+  heap.insert(5);
+
+  try
+    {
+      heap.insert(4);
+      assert(false);
+    }
+  catch(const domain_error &)
+    {
+      assert(true);
+    }
+
+  assert(heap.get() == 5 and heap.get() == 8 and heap.get() == 1000);
+  assert(heap.get() == 70000 and heap.is_empty() and heap.verify());
+}
+
+// Heaps merged into one keep their items and their references.
+template <template <typename, class> class HeapType>
+void test_meldable_heap(rng_t & rng)
+{
+  FixedArray<HeapType<Item, ItemCmp>> heaps(8);
+  DynArray<Item *> handles;
+  DynArray<nat_t> keys;
+
+  for (nat_t i = 0; i < 2000; ++i)
+    {
+      keys.append(random_uniform(rng, 1000));
+      handles.append(&const_cast<Item &>(heaps[i % 8].insert(Item(keys[i],
+								  i))));
+    }
+
+  for (nat_t i = 1; i < 8; i *= 2)
+    for (nat_t j = 0; j + i < 8; j += 2 * i)
+      {
+	heaps[j].merge(heaps[j + i]);
+	assert(heaps[j + i].is_empty() and heaps[j].verify());
+      }
+
+  HeapType<Item, ItemCmp> & heap = heaps[0];
+
+  heap.merge(heap);
+
+  assert(heap.size() == 2000);
+
+  for (nat_t i = 0; i < 2000; i += 3)
+    {
+      assert(handles[i]->second == i);
+      heap.remove(*handles[i]);
+    }
+
+  for (nat_t i = 1; i < 2000; i += 3)
+    heap.update(*handles[i], Item(keys[i] = random_uniform(rng, 1000), i));
+
+  assert(heap.verify());
+
+  nat_t n = 0, prev = 0;
+
+  while (not heap.is_empty())
+    {
+      Item item = heap.get();
+      assert(item.second % 3 != 0 and item.first == keys[item.second]);
+      assert(prev <= item.first);
+      prev = item.first;
+      ++n;
+    }
+
+  assert(n == 2000 - 667);
+
+  for (nat_t i = 0; i < 1000; ++i)
+    heaps[i % 8].insert(Item(i, i));
+
+  heaps[1].merge(heaps[2]);
+  heaps[1].merge(heaps[0]);
+
+  assert(heaps[1].size() == 375 and heaps[1].top().first == 0);
+  assert(heaps[1].verify());
+}
+
 int main()
 {
   FixedHeap<int_t> fixed_heap;
@@ -114,6 +380,100 @@ int main()
   
   for (int_t i = 0; i < 100000 - current_item; ++i)
     lheap.get();
+
+  DAryHeap<int_t> dary_heap;
+
+  dary_heap.heapify(DynArray<int_t>({ 3, 22, 18, 10, 1, 42, 15, 9, 0 }));
+
+  assert(dary_heap.size() == 9 and dary_heap.verify());
+  assert(dary_heap.top() == 0 and dary_heap.top_handle() == 8);
+  assert(dary_heap.get_key(5) == 42);
+
+  dary_heap.decrease_key(5, -1);
+
+  assert(dary_heap.top() == -1 and dary_heap.top_handle() == 5);
+  assert(dary_heap.remove(0) == 3 and not dary_heap.contains(0));
+
+  try
+    {
+      dary_heap.increase_key(5, -2);
+      assert(false);
+    }
+  catch(const domain_error &)
+    {
+      assert(true);
+    }
+
+  try
+    {
+      dary_heap.get_key(0);
+      assert(false);
+    }
+  catch(const domain_error &)
+    {
+      assert(true);
+    }
+
+  assert(dary_heap.insert(7) == 0);
+
+  DAryHeap<int_t> dary_copy = dary_heap;
+
+  min_int = std::numeric_limits<int_t>::min();
+
+  while (not dary_heap.is_empty())
+    {
+      int_t item = dary_heap.get();
+      assert(min_int <= item);
+      min_int = item;
+    }
+
+  assert(dary_copy.size() == 9 and dary_copy.get() == -1);
+
+  try
+    {
+      dary_heap.top();
+      assert(false);
+    }
+  catch(const underflow_error &)
+    {
+      assert(true);
+    }
+
+  DAryHeap<string, 8, std::greater<string>> string_heap;
+
+  for (nat_t i = 0; i < 1000; ++i)
+    string_heap.insert(to_string(i));
+
+  string_heap.update(0, "zzz");
+
+  assert(string_heap.get() == "zzz" and string_heap.get() == "999");
+  assert(string_heap.verify());
+
+  test_dary_heap<2>(rng);
+  test_dary_heap<4>(rng);
+  test_dary_heap<8>(rng);
+
+  test_handle_heap<LHeap>(rng);
+  test_handle_heap<PairingHeap>(rng);
+  test_handle_heap<RadixHeap>(rng);
+  test_handle_heap<BucketQueue>(rng);
+  test_handle_heap<LeftistHeap>(rng);
+  test_handle_heap<BinomialHeap>(rng);
+
+  test_meldable_heap<PairingHeap>(rng);
+  test_meldable_heap<LeftistHeap>(rng);
+  test_meldable_heap<BinomialHeap>(rng);
+
+  test_monotone_heap<RadixHeap>();
+  test_monotone_heap<BucketQueue>();
+
+  PairingHeap<string, std::greater<string>> pairing_heap;
+
+  for (nat_t i = 0; i < 1000; ++i)
+    pairing_heap.insert(to_string(i));
+
+  assert(pairing_heap.size() == 1000 and pairing_heap.get() == "999");
+  assert(pairing_heap.verify());
   
   cout << "Everything ok!\n";
   
@@ -0,0 +1,137 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <interval.hpp>
+#include <random.hpp>
+
+using namespace std;
+using namespace Designar;
+
+int main()
+{
+  IntervalSet<int_t> set = { {1, 5}, {3, 8}, {10, 12}, {4, 4}, {14, 20} };
+
+  assert(set.verify() and set.size() == 5);
+  assert(set.min() == Interval<int_t>(1, 5));
+  assert(set.aggregate() == 20);
+
+  DynArray<Interval<int_t>> at4 = set.containing(4);
+
+  assert(at4.size() == 3);
+  assert(at4[0] == Interval<int_t>(1, 5) and at4[1] == Interval<int_t>(3, 8));
+  assert(at4[2] == Interval<int_t>(4, 4));
+  assert(set.containing(9).is_empty() and set.containing(20).size() == 1);
+  assert(set.overlapping(Interval<int_t>(8, 10)).size() == 2);
+  assert(set.overlaps(Interval<int_t>(12, 13)));
+  assert(not set.overlaps(Interval<int_t>(13, 13)));
+  assert(set.search_overlap(Interval<int_t>(21, 30)) == nullptr);
+
+  try
+    {
+      Interval<int_t>(2, 1);
+      assert(false);
+    }
+  catch(const range_error &)
+    {
+      assert(true);
+    }
+
+  assert(set.merge_overlaps() == 2);
+  assert(set.verify());
+  assert(set.equal({{1, 8}, {10, 12}, {14, 20}}));
+
+  // Random intervals against a scan.
+  rng_t rng(41);
+
+  DynArray<Interval<int_t>> all;
+
+  for (nat_t i = 0; i < 5000; ++i)
+    {
+      int_t lo = random_uniform(rng, 100000);
+      all.append(Interval<int_t>(lo, lo + random_uniform(rng, 2000)));
+    }
+
+  IntervalSet<int_t> inserted, loaded;
+
+  for (const auto & i : all)
+    inserted.insert(i);
+
+  loaded.bulk_load(all);
+
+  assert(inserted.verify() and loaded.verify());
+  assert(loaded.equal(inserted));
+
+  for (nat_t q = 0; q < 300; ++q)
+    {
+      int_t lo = random_uniform(rng, -100, 102100);
+      Interval<int_t> i(lo, lo + random_uniform(rng, 500));
+
+      auto by_tree = loaded.overlapping(i);
+      auto by_scan = inserted.filter([&i] (const Interval<int_t> & j)
+				     {
+				       return j.overlaps(i);
+				     });
+
+      assert(by_tree.size() == by_scan.size());
+      assert(loaded.overlaps(i) == not by_scan.is_empty());
+
+      nat_t n = 0;
+
+      for (const auto & j : by_scan)
+	assert(by_tree[n++] == j);
+
+      nat_t num_containing = 0;
+
+      loaded.for_each_containing(lo, [&] (const Interval<int_t> & j)
+				 {
+				   assert(j.contains(lo));
+				   ++num_containing;
+				 });
+
+      assert(num_containing == loaded.filter([lo] (const Interval<int_t> & j)
+					      {
+						return j.contains(lo);
+					      }).size());
+    }
+
+  // Removals keep the endpoints up to date.
+  for (nat_t i = 0; i < all.size(); i += 2)
+    loaded.remove(all[i]);
+
+  int_t max_hi = loaded.fold(std::numeric_limits<int_t>::lowest(),
+			     [] (const Interval<int_t> & i, int_t acc)
+			     {
+			       return std::max(i.get_hi(), acc);
+			     });
+
+  assert(loaded.verify() and loaded.aggregate() == max_hi);
+
+  nat_t num_merged = loaded.merge_overlaps();
+  assert(loaded.verify() and num_merged > 0);
+
+  Interval<int_t> prev = loaded.min();
+
+  for (const auto & i : loaded)
+    assert(i == prev or prev.get_hi() < i.get_lo()), prev = i;
+
+  // Values by interval.
+  IntervalMap<real_t, string> shifts;
+
+  shifts.insert(Interval<real_t>(8, 12), "morning");
+  shifts.insert(Interval<real_t>(12, 18), "afternoon");
+  shifts.insert(Interval<real_t>(18, 24), "night");
+
+  auto at12 = shifts.containing(12);
+
+  assert(at12.size() == 2 and at12[0].second == "morning");
+  assert(at12[1].second == "afternoon");
+  assert(shifts.containing(7.5).is_empty());
+  assert(shifts.search_overlap(Interval<real_t>(20, 30))->second == "night");
+  assert(shifts.find(Interval<real_t>(12, 18)) == "afternoon");
+
+  cout << "Everything ok!\n";
+  return 0;
+}
@@ -36,6 +36,14 @@ int main()
 
   assert(count_combinations(10, 7) == 120);
 
+  assert(count_trailing_zeros(1) == 0);
+  assert(count_trailing_zeros(40) == 3);
+  assert(count_trailing_zeros(0) == 64);
+
+  assert(floor_log2(1) == 0);
+  assert(floor_log2(40) == 5);
+  assert(floor_log2(nat_t(1) << 63) == 63);
+
   cout << "Everything ok!\n";
   return 0;
 }
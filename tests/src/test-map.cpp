@@ -10,6 +10,29 @@
 using namespace std;
 using namespace Designar;
 
+struct SumOfValues
+{
+  using ValueType = int_t;
+
+  static int_t identity()
+  {
+    return 0;
+  }
+
+  static int_t lift(const MapKey<int_t, int_t> & p)
+  {
+    return p.second;
+  }
+
+  static int_t combine(int_t a, int_t b)
+  {
+    return a + b;
+  }
+};
+
+template <typename Key, class Cmp>
+using SumTreap = GenRankedTreap<Key, Cmp, SumOfValues>;
+
 int main()
 {
   ArrayMap<string, int_t> array_map = {{"One",1},{"Two",2},
@@ -56,6 +79,26 @@ int main()
   key(prod).pop_back();
   assert(key(prod) == "One*Two*Three*Four*Five*Six" and value(prod) == 720);
 
+  // Bulk construction keeps the first item of each key.
+  ArrayMap<string, int_t, std::less<string>, SortedArraySet> sorted_map;
+
+  sorted_map.build_from_unsorted(DynArray<MapKey<string, int_t>>
+				 ({{"Two",2},{"One",1},{"Two",0},{"Four",4}}));
+
+  assert(sorted_map.size() == 3);
+  assert(sorted_map["Two"] == 2);
+
+  assert(sorted_map.insert_bulk(DynArray<MapKey<string, int_t>>
+				({{"Three",3},{"One",0}})) == 1);
+
+  assert(sorted_map.equal({{"Four",4},{"One",1},{"Three",3},{"Two",2}}));
+
+  TreeMap<string, int_t> sorted_tree_map =
+    DynArray<MapKey<string, int_t>>({{"a",1},{"b",2},{"c",3}});
+
+  assert(sorted_tree_map.verify());
+  assert(sorted_tree_map["b"] == 2 and sorted_tree_map.size() == 3);
+
   TreeMap<string, int_t> tree_map = {{"One",1},{"Two",2},
 				      {"Three",3},{"Four",4}};
 
@@ -158,7 +201,41 @@ int main()
   
   key(prod).pop_back();
   assert(value(prod) == 720);
-  
+
+  // Range queries by key.
+  TreeMap<int_t, string> window = {{10,"a"},{20,"b"},{30,"c"},{40,"d"}};
+
+  assert(window.lower_bound(15)->first == 20);
+  assert(window.upper_bound(20)->first == 30);
+  assert(window.lower_bound(41) == window.end());
+  assert(window.count_range(20, 40) == 3);
+
+  string concat;
+  window.for_each_in_range(11, 35, [&concat] (const auto & p)
+			   {
+			     concat += p.second;
+			   });
+  assert(concat == "bc");
+
+  assert(window.remove_range(15, 30) == 2 and window.size() == 2);
+
+  // Sums of values over key ranges.
+  TreeMap<int_t, int_t, std::less<int_t>, SumTreap> sums;
+
+  for (int_t k = 1; k <= 100; ++k)
+    sums.insert(k, k * k);
+
+  assert(sums.aggregate() == 338350);
+  assert(sums.aggregate(1, 3) == 14 and sums.aggregate(101, 200) == 0);
+  assert(sums.aggregate_pos(0, 2) == 14);
+
+  sums[2] = 0;
+  assert(sums.refresh(2) and sums.aggregate(1, 3) == 10);
+  assert(not sums.refresh(0));
+
+  sums.remove(3);
+  assert(sums.aggregate(1, 3) == 1 and sums.aggregate() == 338350 - 13);
+
   cout << "Everything ok!\n";
   
   return 0;
@@ -0,0 +1,159 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <graphalgorithms.hpp>
+#include <random.hpp>
+
+using namespace std;
+
+using namespace Designar;
+
+using UGT = Graph<nat_t, nat_t>;
+using DGT = Digraph<nat_t, nat_t>;
+
+constexpr nat_t num_nodes = 300;
+constexpr nat_t num_arcs  = 1500;
+constexpr nat_t UNREACHED = std::numeric_limits<nat_t>::max();
+
+// A chain through every node keeps the graph connected from node 0.
+template <class GT>
+GT build_graph(rng_t & rng, DynArray<Node<GT> *> & nodes)
+{
+  GT g;
+
+  for (nat_t i = 0; i < num_nodes; ++i)
+    nodes.append(g.insert_node(i));
+
+  for (nat_t i = 1; i < num_nodes; ++i)
+    g.insert_arc(nodes[i - 1], nodes[i], 1 + random_uniform(rng, 50));
+
+  for (nat_t i = num_nodes - 1; i < num_arcs; ++i)
+    g.insert_arc(nodes[random_uniform(rng, num_nodes)],
+		 nodes[random_uniform(rng, num_nodes)],
+		 1 + random_uniform(rng, 50));
+
+  return g;
+}
+
+// Bellman-Ford from node 0.
+template <class GT>
+DynArray<nat_t> min_distances(const GT & g)
+{
+  DynArray<nat_t> dist(num_nodes, UNREACHED);
+  dist[0] = 0;
+
+  auto relax = [&dist] (Node<GT> * s, Node<GT> * t, nat_t w)
+    {
+      nat_t ds = dist[s->get_info()];
+
+      if (ds != UNREACHED and ds + w < dist[t->get_info()])
+	dist[t->get_info()] = ds + w;
+    };
+
+  for (nat_t i = 0; i < num_nodes; ++i)
+    g.for_each_arc([&] (Arc<GT> * a)
+		   {
+		     relax(a->get_src_node(), a->get_tgt_node(), a->get_info());
+
+		     if (not g.is_digraph())
+		       relax(a->get_tgt_node(), a->get_src_node(),
+			     a->get_info());
+		   });
+
+  return dist;
+}
+
+template <class GT>
+nat_t path_cost(const Path<GT> & path)
+{
+  nat_t cost = 0;
+
+  path.for_each([&cost] (Node<GT> *, Arc<GT> * a)
+		{
+		  if (a != nullptr)
+		    cost += a->get_info();
+		});
+
+  return cost;
+}
+
+template <class GT>
+nat_t tree_cost(const GT & tree)
+{
+  nat_t cost = 0;
+  tree.for_each_arc([&cost] (Arc<GT> * a) { cost += a->get_info(); });
+  return cost;
+}
+
+template <class GT, template <typename, class> class HeapType>
+void test_min_paths(const GT & g, const DynArray<Node<GT> *> & nodes,
+		    const DynArray<nat_t> & dist)
+{
+  using Distance = DefaultDistance<GT>;
+  using Heuristic = DefaultHeuristic<GT, Distance>;
+
+  Dijkstra<GT, Distance, std::less<nat_t>, std::plus<nat_t>, HeapType>
+    dijkstra;
+
+  Astar<GT, Distance, Heuristic, std::less<nat_t>, std::plus<nat_t>,
+	HeapType> astar;
+
+  for (nat_t i = 0; i < num_nodes; i += 7)
+    {
+      Path<GT> path = dijkstra.search_min_path(g, nodes[0], nodes[i]);
+      assert(path_cost(path) == dist[i]);
+
+      path = astar.search_min_path(g, nodes[0], nodes[i]);
+      assert(path_cost(path) == dist[i]);
+    }
+
+  GT tree = dijkstra.build_min_path_tree(g, nodes[0]);
+  assert(tree.get_num_nodes() == num_nodes);
+  assert(tree.get_num_arcs() == num_nodes - 1);
+}
+
+template <template <typename, class> class HeapType>
+void test_min_spanning_tree(const UGT & g, nat_t cost)
+{
+  using Distance = DefaultDistance<UGT>;
+
+  UGT tree = Prim<UGT, Distance, std::less<nat_t>, HeapType>().
+    build_min_spanning_tree(g);
+
+  assert(tree.get_num_arcs() == num_nodes - 1 and tree_cost(tree) == cost);
+}
+
+int main()
+{
+  rng_t rng(get_random_seed());
+
+  DynArray<Node<UGT> *> unodes;
+  UGT ug = build_graph<UGT>(rng, unodes);
+  DynArray<nat_t> udist = min_distances(ug);
+
+  test_min_paths<UGT, LHeap>(ug, unodes, udist);
+  test_min_paths<UGT, PairingHeap>(ug, unodes, udist);
+  test_min_paths<UGT, RadixHeap>(ug, unodes, udist);
+  test_min_paths<UGT, BucketQueue>(ug, unodes, udist);
+
+  DynArray<Node<DGT> *> dnodes;
+  DGT dg = build_graph<DGT>(rng, dnodes);
+  DynArray<nat_t> ddist = min_distances(dg);
+
+  test_min_paths<DGT, LHeap>(dg, dnodes, ddist);
+  test_min_paths<DGT, PairingHeap>(dg, dnodes, ddist);
+  test_min_paths<DGT, RadixHeap>(dg, dnodes, ddist);
+  test_min_paths<DGT, BucketQueue>(dg, dnodes, ddist);
+
+  nat_t cost = tree_cost(Kruskal<UGT>().build_min_spanning_tree(ug));
+
+  test_min_spanning_tree<LHeap>(ug, cost);
+  test_min_spanning_tree<PairingHeap>(ug, cost);
+
+  cout << "Everything ok!\n";
+
+  return 0;
+}
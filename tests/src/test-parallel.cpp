@@ -0,0 +1,127 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <parallel.hpp>
+
+using namespace std;
+using namespace Designar;
+
+int main()
+{
+  ThreadPool pool(4);
+
+  assert(pool.num_threads() == 4);
+
+  auto f = pool.async([] () { return 42; });
+  assert(f.get() == 42);
+
+  {
+    TaskGroup group(pool);
+    std::atomic<nat_t> count(0);
+
+    for (nat_t i = 0; i < 1000; ++i)
+      group.run([&count] () { ++count; });
+
+    group.wait();
+    assert(count == 1000);
+
+    // Nested groups do not deadlock because waiting threads help.
+    for (nat_t i = 0; i < 8; ++i)
+      group.run([&pool, &count] ()
+		{
+		  TaskGroup inner(pool);
+
+		  for (nat_t j = 0; j < 8; ++j)
+		    inner.run([&count] () { ++count; });
+
+		  inner.wait();
+		});
+
+    group.wait();
+    assert(count == 1064);
+
+    group.run([] () { throw std::overflow_error("Task failure"); });
+
+    try
+      {
+	group.wait();
+	assert(false);
+      }
+    catch(overflow_error)
+      {
+	assert(true);
+      }
+    catch(...)
+      {
+	assert(false);
+      }
+  }
+
+  constexpr nat_t N = 100000;
+
+  Schedule schedules[] = { Schedule::STATIC, Schedule::DYNAMIC,
+			   Schedule::GUIDED };
+
+  for (Schedule s : schedules)
+    for (nat_t grain : { nat_t(1), nat_t(7), nat_t(1000), 2 * N })
+      {
+	FixedArray<nat_t> visits(N, 0);
+
+	parallel_for(UIntRange(N), [&visits] (nat_t i) { ++visits[i]; },
+		     s, grain, pool);
+
+	for (nat_t i = 0; i < N; ++i)
+	  assert(visits[i] == 1);
+
+	nat_t sum = parallel_reduce(UIntRange(N), nat_t(0),
+				    [] (nat_t i, nat_t acc)
+				    {
+				      return acc + i * i;
+				    }, std::plus<nat_t>(), s, grain, pool);
+
+	assert(sum == (N - 1) * N * (2 * N - 1) / 6);
+      }
+
+  IntRange r(-1000, 1000, 3);
+
+  int_t min = parallel_reduce(r, std::numeric_limits<int_t>::max(),
+			      [] (int_t i, int_t acc)
+			      {
+				return std::min(i * i, acc);
+			      },
+			      [] (int_t a, int_t b) { return std::min(a, b); },
+			      Schedule::DYNAMIC, 16, pool);
+  assert(min == 1);
+
+  std::atomic<nat_t> count(0);
+  parallel_for(UIntRange(0), [&count] (nat_t) { ++count; },
+	       Schedule::STATIC, 1, pool);
+  assert(count == 0);
+
+  assert(parallel_reduce(UIntRange(0), nat_t(5), std::plus<nat_t>(),
+			 std::plus<nat_t>()) == 5);
+
+  try
+    {
+      parallel_for(UIntRange(N), [] (nat_t i)
+		   {
+		     if (i == N / 2)
+		       throw std::range_error("Item failure");
+		   }, Schedule::DYNAMIC, 100, pool);
+      assert(false);
+    }
+  catch(range_error)
+    {
+      assert(true);
+    }
+  catch(...)
+    {
+      assert(false);
+    }
+
+  cout << "Everything ok!\n";
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <thread>
+
+#include <persistenttree.hpp>
+#include <tree.hpp>
+
+using namespace std;
+using namespace Designar;
+
+int main()
+{
+  PersistentTreap<int_t> tree = { 2,4,6,8,10 };
+
+  auto s0 = tree.snapshot();
+
+  assert(s0.verify());
+  assert(s0.size() == 5);
+  assert(s0.select(0) == 2 and s0.select(3) == 8);
+  assert(s0.min() == 2 and s0.max() == 10);
+  assert(s0.position(8) == 3 and s0.position(5) == -1);
+  assert(s0.count_range(3, 8) == 3 and s0.count_range(8, 3) == 0);
+  assert(s0.count_range(0, 100) == 5 and s0.count_range(11, 20) == 0);
+  assert(not tree.insert(4));
+
+  try
+    {
+      s0.select(5);
+      assert(false);
+    }
+  catch(const out_of_range &)
+    {
+      assert(true);
+    }
+
+  try
+    {
+      s0.find(5);
+      assert(false);
+    }
+  catch(const domain_error &)
+    {
+      assert(true);
+    }
+
+  // Older versions do not see later updates.
+  assert(tree.insert(5) and tree.remove(2) and not tree.remove(3));
+
+  auto s1 = tree.snapshot();
+
+  assert(s0.size() == 5 and s0.contains(2) and not s0.contains(5));
+  assert(s1.size() == 5 and not s1.contains(2) and s1.contains(5));
+  assert(s0.verify() and s1.verify());
+
+  PersistentTreap<int_t> cpy = tree;
+  cpy.clear();
+
+  assert(cpy.is_empty() and tree.size() == 5);
+
+  int_t sum = 0;
+  s1.for_each_in_range(5, 8, [&sum] (int_t k) { sum += k; });
+  assert(sum == 5 + 6 + 8);
+
+  // Random updates against the treap, keeping every tenth version.
+  rng_t rng(29);
+
+  RankedTreap<int_t> rt;
+  DynArray<PersistentTreap<int_t>::Snapshot> versions;
+  DynArray<RankedTreap<int_t>> expected;
+
+  tree.clear();
+
+  for (nat_t i = 0; i < 20000; ++i)
+    {
+      int_t k = random_uniform(rng, 5000);
+
+      if (random_uniform(rng, 3) < 2)
+	assert(tree.insert(k) == (rt.insert(k) != nullptr));
+      else
+	assert(tree.remove(k) == rt.remove(k));
+
+      if (i % 2000 == 0)
+	{
+	  versions.append(tree.snapshot());
+	  expected.append(rt);
+	}
+    }
+
+  for (nat_t v = 0; v < versions.size(); ++v)
+    {
+      const auto & s = versions[v];
+      const auto & e = expected[v];
+
+      assert(s.verify() and s.size() == e.size());
+
+      nat_t i = 0;
+
+      for (int_t k : s)
+	assert(k == e.select(i++));
+
+      for (nat_t j = 0; j < e.size(); j += 17)
+	assert(s.select(j) == e.select(j) and
+	       s.position(e.select(j)) == int_t(j));
+    }
+
+  // Readers take snapshots while a writer keeps updating.
+  tree.clear();
+
+  std::atomic<bool> done(false);
+  std::atomic<nat_t> num_checked(0);
+
+  FixedArray<thread> readers(3);
+
+  for (nat_t i = 0; i < readers.size(); ++i)
+    readers[i] = thread([&] ()
+			{
+			  while (not done)
+			    {
+			      auto s = tree.snapshot();
+			      nat_t n = 0;
+			      int_t prev = -1;
+
+			      for (int_t k : s)
+				{
+				  assert(prev < k);
+				  prev = k;
+				  ++n;
+				}
+
+			      assert(n == s.size() and
+				     s.count_range(0, 1000) == n);
+			      ++num_checked;
+			    }
+			});
+
+  for (nat_t i = 0; i < 20000; ++i)
+    {
+      int_t k = random_uniform(rng, 1000);
+
+      if (random_uniform(rng, 2) == 0)
+	tree.insert(k);
+      else
+	tree.remove(k);
+    }
+
+  done = true;
+
+  for (nat_t i = 0; i < readers.size(); ++i)
+    readers[i].join();
+
+  assert(num_checked > 0 and tree.snapshot().verify());
+
+  cout << "Everything ok!\n";
+  return 0;
+}
@@ -0,0 +1,229 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <pipeline.hpp>
+
+using namespace std;
+using namespace Designar;
+
+int main()
+{
+  BoundedConcurrentQueue<nat_t> queue(2);
+
+  assert(queue.get_capacity() == 2);
+  assert(queue.is_empty());
+
+  queue.put(1);
+  queue.put(2);
+  assert(queue.size() == 2);
+
+  thread producer([&queue] () { queue.put(3); });
+
+  nat_t item = 0;
+
+  assert(queue.get(item));
+  assert(item == 1);
+
+  producer.join();
+  assert(queue.size() == 2);
+
+  queue.close();
+  assert(queue.is_closed());
+
+  try
+    {
+      queue.put(4);
+      assert(false);
+    }
+  catch(domain_error)
+    {
+      assert(true);
+    }
+  catch(...)
+    {
+      assert(false);
+    }
+
+  // Closed queues are drained before get() reports the end.
+  assert(queue.get(item));
+  assert(item == 2);
+  assert(queue.try_get(item));
+  assert(item == 3);
+  assert(not queue.get(item));
+
+  constexpr nat_t N = 100000;
+
+  {
+    Pipeline pipeline(8, 16);
+
+    nat_t i = 0;
+    std::atomic<nat_t> sum(0);
+
+    pipeline.source<nat_t>([&i] (nat_t & item)
+			   {
+			     item = i++;
+			     return item < N;
+			   })
+      .then([] (nat_t item) { return 2 * item; }, 4)
+      .sink([&sum] (nat_t item) { sum += item; }, 2);
+
+    assert(pipeline.num_stages() == 3);
+
+    pipeline.run();
+
+    assert(sum == N * (N - 1));
+
+    DynArray<Pipeline::StageStats> stats = pipeline.stats();
+
+    assert(stats.size() == 3);
+    assert(stats[0].name == "stage 0");
+    assert(stats[1].parallelism == 4);
+
+    for (nat_t i = 0; i < stats.size(); ++i)
+      {
+	assert(stats[i].num_items == N);
+	assert(stats[i].num_batches == (N + 15) / 16);
+	assert(stats[i].queue_depth == 0);
+	assert(stats[i].max_queue_depth <= 8);
+      }
+  }
+
+  {
+    Pipeline pipeline(4, 7);
+
+    nat_t i = 0;
+    DynArray<string> result;
+
+    pipeline.source<nat_t>([&i] (nat_t & item)
+			   {
+			     item = i++;
+			     return item < N;
+			   }, "numbers")
+      .then([] (nat_t item)
+	    {
+	      if (item % 3 == 0)
+		this_thread::yield();
+	      return item + 1;
+	    }, 4)
+      .then([] (nat_t item) { return to_string(item); }, 3,
+	    Pipeline::Ordering::ORDERED, "to_string")
+      .sink([&result] (string & s) { result.append(std::move(s)); }, 2,
+	    Pipeline::Ordering::ORDERED);
+
+    pipeline.run();
+
+    assert(pipeline.stats()[0].name == "numbers");
+    assert(pipeline.stats()[2].name == "to_string");
+    assert(pipeline.stats()[2].ordered);
+    assert(result.size() == N);
+
+    for (nat_t i = 0; i < N; ++i)
+      assert(result[i] == to_string(i + 1));
+  }
+
+  {
+    Pipeline pipeline(4, 8);
+
+    std::atomic<nat_t> num(0);
+
+    pipeline.source<nat_t>([] (nat_t & item)
+			   {
+			     item = 1;
+			     return true;
+			   })
+      .sink([&num] (nat_t item) { num += item; }, 2);
+
+    pipeline.start();
+
+    while (num < 1000)
+      this_thread::yield();
+
+    pipeline.stop();
+    pipeline.wait();
+
+    // Every produced item is consumed after the stop.
+    assert(pipeline.is_stopped());
+    assert(num == pipeline.stats()[0].num_items);
+    assert(num == pipeline.stats()[1].num_items);
+  }
+
+  {
+    Pipeline pipeline(2, 4);
+
+    nat_t i = 0;
+
+    pipeline.source<nat_t>([&i] (nat_t & item)
+			   {
+			     item = i++;
+			     return true;
+			   })
+      .then([] (nat_t item)
+	    {
+	      if (item == 5000)
+		throw std::overflow_error("Stage failure");
+	      return item;
+	    }, 2)
+      .sink([] (nat_t) { });
+
+    try
+      {
+	pipeline.run();
+	assert(false);
+      }
+    catch(overflow_error)
+      {
+	assert(true);
+      }
+    catch(...)
+      {
+	assert(false);
+      }
+
+    assert(pipeline.is_stopped());
+  }
+
+  {
+    Pipeline pipeline;
+
+    auto numbers = pipeline.source<nat_t>([] (nat_t &) { return false; });
+
+    try
+      {
+	pipeline.start();
+	assert(false);
+      }
+    catch(domain_error)
+      {
+	assert(true);
+      }
+    catch(...)
+      {
+	assert(false);
+      }
+
+    numbers.sink([] (nat_t) { });
+
+    try
+      {
+	numbers.sink([] (nat_t) { });
+	assert(false);
+      }
+    catch(domain_error)
+      {
+	assert(true);
+      }
+    catch(...)
+      {
+	assert(false);
+      }
+
+    pipeline.run();
+    assert(pipeline.stats()[1].num_items == 0);
+  }
+
+  cout << "Everything ok!\n";
+  return 0;
+}
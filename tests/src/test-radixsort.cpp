@@ -0,0 +1,150 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <radixsort.hpp>
+#include <random.hpp>
+
+using namespace std;
+using namespace Designar;
+
+struct Record
+{
+  int_t key;
+  nat_t pos;
+};
+
+int main()
+{
+  rng_t rng(23);
+
+  ThreadPool pool(4);
+
+  assert(radix_key(int_t(-1)) < radix_key(int_t(0)));
+  assert(radix_key(std::numeric_limits<int_t>::min()) == 0);
+  assert(radix_key(-2.5) < radix_key(-1.0));
+  assert(radix_key(-0.0) < radix_key(0.0));
+  assert(radix_key(1.0) < radix_key(std::numeric_limits<real_t>::infinity()));
+  assert(radix_key(-std::numeric_limits<real_t>::infinity()) <
+	 radix_key(-1e300));
+
+  for (nat_t n : { nat_t(0), nat_t(1), nat_t(10), nat_t(1000),
+	nat_t(ParallelSortThreshold + 7), nat_t(200000) })
+    {
+      FixedArray<nat_t> u(n);
+      DynArray<int_t> s;
+      FixedArray<real_t> f(n);
+
+      for (nat_t i = 0; i < n; ++i)
+	{
+	  u[i] = random_uniform(rng, std::numeric_limits<nat_t>::max());
+	  s.append(random_uniform(rng, int_t(-1000000), int_t(1000000)));
+	  f[i] = random_uniform(rng, -1e6, 1e6);
+	}
+
+      FixedArray<nat_t> pu = u;
+      DynArray<int_t> ps = s;
+      FixedArray<real_t> pf = f;
+
+      FixedArray<nat_t> eu = u;
+      DynArray<int_t> es = s;
+      FixedArray<real_t> ef = f;
+
+      quicksort(eu);
+      quicksort(es);
+      quicksort(ef);
+
+      radix_sort(u);
+      radix_sort(s);
+      radix_sort(f);
+
+      parallel_radix_sort(pu, RadixIdentity(), pool);
+      parallel_radix_sort(ps, RadixIdentity(), pool);
+      parallel_radix_sort(pf, RadixIdentity(), pool);
+
+      for (nat_t i = 0; i < n; ++i)
+	{
+	  assert(u[i] == eu[i] and pu[i] == eu[i]);
+	  assert(s[i] == es[i] and ps[i] == es[i]);
+	  assert(radix_key(f[i]) == radix_key(ef[i]) and
+		 radix_key(pf[i]) == radix_key(ef[i]));
+	}
+    }
+
+  // Records by a key extractor; equal keys keep their order.
+  auto key = [] (const Record & r) { return r.key; };
+
+  for (nat_t n : { nat_t(20), nat_t(100000) })
+    {
+      DynArray<Record> a;
+
+      for (nat_t i = 0; i < n; ++i)
+	a.append(Record{random_uniform(rng, int_t(-50), int_t(50)), i});
+
+      DynArray<Record> p = a;
+
+      radix_sort(a, key);
+      parallel_radix_sort(p, key, pool);
+
+      for (nat_t i = 1; i < n; ++i)
+	{
+	  assert(a[i - 1].key < a[i].key or
+		 (a[i - 1].key == a[i].key and a[i - 1].pos < a[i].pos));
+	  assert(p[i].key == a[i].key and p[i].pos == a[i].pos);
+	}
+    }
+
+  // Subranges, and keys which differ in a single byte.
+  FixedArray<nat_t> r(1000);
+
+  for (nat_t i = 0; i < r.size(); ++i)
+    r[i] = (nat_t(7) << 40) | (r.size() - i) % 256;
+
+  radix_sort(r, 100, 899, RadixIdentity());
+
+  assert(r[0] == (nat_t(7) << 40 | 1000 % 256));
+  assert(r[99] == (nat_t(7) << 40 | 901 % 256));
+  assert(r[900] == (nat_t(7) << 40 | 100 % 256));
+
+  for (nat_t i = 101; i < 900; ++i)
+    assert(r[i - 1] <= r[i]);
+
+  // Strings with shared prefixes, empty strings and high bytes.
+  for (nat_t n : { nat_t(0), nat_t(1), nat_t(30), nat_t(50000) })
+    {
+      DynArray<string> w;
+
+      for (nat_t i = 0; i < n; ++i)
+	{
+	  nat_t len = random_uniform(rng, nat_t(12));
+	  string s = i % 3 == 0 ? "prefix/shared/" : "";
+
+	  for (nat_t j = 0; j < len; ++j)
+	    s.push_back(char(random_uniform(rng, nat_t(4)) * 70 + 'a'));
+
+	  w.append(s);
+	}
+
+      DynArray<string> m = w;
+      DynArray<string> af = w;
+
+      quicksort(w);
+      msd_radix_sort(m);
+      american_flag_sort(af);
+
+      for (nat_t i = 0; i < n; ++i)
+	assert(m[i] == w[i] and af[i] == w[i]);
+    }
+
+  DynArray<string> same(1000, string(5000, 'x'));
+  american_flag_sort(same);
+  msd_radix_sort(same);
+
+  for (nat_t i = 0; i < same.size(); ++i)
+    assert(same[i] == string(5000, 'x'));
+
+  cout << "Everything ok!\n";
+  return 0;
+}
@@ -98,6 +98,25 @@ int main()
   assert(num_equal(r11.max(), 5.));
   assert(num_equal(r11.step_size(), 0.02));
   assert(r11.size() == 500);
+
+  Range<int> r12(-5, 20, 3);
+  assert(r12.at(0) == -5);
+  assert(r12.at(4) == 7);
+  assert(r12.sum() == r12.fold(0, [](auto item, auto acc){ return item + acc; }));
+  assert(r12.fold(100, std::plus<int>()) == 100 + 63);
+  assert(r12.slice(2, 5).to_list().equal({1,4,7}));
+  assert(r12.slice(7, 20).to_list().equal({16,19}));
+  assert(r12.slice(3, 3).size() == 0);
+
+  auto it = r12.begin();
+  it.next_n(3);
+  assert(it.get_curr() == 4);
+  it.next_n(10);
+  assert(not it.has_curr());
+
+  UIntRange r13(3, 1000000001, 2);
+  assert(r13.sum() == 250000000000000000ull - 1);
+  assert(r8.sum() == 0);
   
   cout << "Everything ok!\n";
   return 0;
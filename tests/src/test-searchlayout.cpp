@@ -0,0 +1,126 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <searchlayout.hpp>
+#include <set.hpp>
+#include <random.hpp>
+
+using namespace std;
+using namespace Designar;
+
+template <class Layout>
+void check(const Layout & layout, const DynArray<int_t> & sorted,
+	   int_t max_key)
+{
+  assert(layout.size() == sorted.size());
+
+  for (nat_t i = 0; i < sorted.size(); ++i)
+    assert(layout.select(i) == sorted[i]);
+
+  for (int_t k = -2; k <= max_key + 2; ++k)
+    {
+      auto range = equal_range(sorted, 0, sorted.size(), k);
+
+      assert(layout.lower_bound(k) == nat_t(range.first));
+      assert(layout.upper_bound(k) == nat_t(range.second));
+      assert(layout.equal_range(k).first == nat_t(range.first));
+      assert(layout.contains(k) == (range.first < range.second));
+
+      const int_t * p = layout.search(k);
+      assert(p == nullptr or *p == k);
+    }
+}
+
+int main()
+{
+  rng_t rng(41);
+
+  // Sizes around complete trees and around S-tree node and layer limits.
+  for (nat_t n : { 0, 1, 2, 3, 7, 8, 15, 16, 17, 31, 33, 272, 273, 1000,
+	4912, 5000 })
+    {
+      DynArray<int_t> sorted;
+
+      for (nat_t i = 0; i < n; ++i)
+	sorted.append(random_uniform(rng, int_t(2 * n + 1)));
+
+      quicksort(sorted);
+
+      EytzingerArray<int_t> eytzinger(sorted);
+      STreeArray<int_t> stree(sorted);
+
+      check(eytzinger, sorted, 2 * n + 1);
+      check(stree, sorted, 2 * n + 1);
+    }
+
+  // Branchless bounds against a linear scan.
+  DynArray<int_t> a;
+
+  for (int_t i = 0; i < 500; ++i)
+    a.append(i / 3);
+
+  for (int_t k = -1; k <= 170; ++k)
+    {
+      int_t lo = 0;
+
+      while (lo < 500 and a[lo] < k)
+	++lo;
+
+      int_t hi = lo;
+
+      while (hi < 500 and a[hi] == k)
+	++hi;
+
+      assert(lower_bound(a, 0, 500, k) == lo);
+      assert(upper_bound(a, 0, 500, k) == hi);
+    }
+
+  assert(lower_bound(a, 7, 7, 100) == 7);
+  assert(upper_bound(a, 10, 20, 0) == 10);
+
+  // Descending order and the SortedArraySet interface.
+  SortedArraySet<int_t, std::greater<int_t>> set;
+
+  for (int_t i = 0; i < 100; ++i)
+    set.append(random_uniform(rng, int_t(300)));
+
+  for (int_t k = -1; k <= 300; ++k)
+    {
+      nat_t lo = set.lower_bound(k);
+      nat_t hi = set.upper_bound(k);
+
+      assert(hi - lo <= 1);
+      assert((hi - lo == 1) == (set.search(k) != nullptr));
+      assert(lo == set.size() or set[lo] <= k);
+      assert(lo == 0 or set[lo - 1] > k);
+      assert(set.equal_range(k).second == hi);
+    }
+
+  STreeArray<int_t, std::greater<int_t>> frozen(set);
+  EytzingerArray<int_t, std::greater<int_t>> frozen_bfs(set);
+
+  for (int_t k = -1; k <= 300; ++k)
+    {
+      assert(frozen.lower_bound(k) == set.lower_bound(k));
+      assert(frozen_bfs.upper_bound(k) == set.upper_bound(k));
+    }
+
+  bool thrown = false;
+
+  try
+    {
+      frozen.select(set.size());
+    }
+  catch (const std::out_of_range &)
+    {
+      thrown = true;
+    }
+
+  assert(thrown);
+
+  cout << "Everything ok!\n";
+  return 0;
+}
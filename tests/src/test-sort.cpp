@@ -0,0 +1,426 @@
+/*
+  This file is part of Designar.
+
+  Author: Alejandro Mujica (aledrums@gmail.com)
+*/
+
+#include <sort.hpp>
+#include <list.hpp>
+#include <random.hpp>
+
+using namespace std;
+using namespace Designar;
+
+struct Item
+{
+  nat_t key;
+  nat_t pos;
+};
+
+template <class ArrayType>
+bool is_sorted(const ArrayType & a)
+{
+  for (nat_t i = 1; i < a.size(); ++i)
+    if (a[i] < a[i - 1])
+      return false;
+
+  return true;
+}
+
+int main()
+{
+  rng_t rng(17);
+
+  ThreadPool pool(4);
+
+  DynArray<int_t> b = { 1, 3, 3, 3, 5, 8 };
+  std::less<int_t> less;
+
+  assert(lower_bound(b, 0, b.size(), 3, less) == 1);
+  assert(upper_bound(b, 0, b.size(), 3, less) == 4);
+  assert(lower_bound(b, 0, b.size(), 0, less) == 0);
+  assert(upper_bound(b, 0, b.size(), 9, less) == 6);
+  assert(lower_bound(b, 2, 5, 1, less) == 2);
+
+  for (nat_t n : { nat_t(0), nat_t(1), nat_t(1000),
+	nat_t(ParallelSortThreshold + 1), nat_t(200000) })
+    {
+      FixedArray<nat_t> a(n);
+      DynArray<nat_t> d;
+
+      for (nat_t i = 0; i < n; ++i)
+	{
+	  a[i] = random_uniform(rng, nat_t(1000000));
+	  d.append(a[i]);
+	}
+
+      FixedArray<nat_t> c = a;
+
+      parallel_sort(a, std::less<nat_t>(), pool);
+      assert(is_sorted(a));
+
+      parallel_stable_sort(d, std::less<nat_t>(), pool);
+      assert(is_sorted(d));
+
+      quicksort(c);
+
+      for (nat_t i = 0; i < n; ++i)
+	assert(a[i] == c[i] and d[i] == c[i]);
+    }
+
+  // Reverse and constant inputs.
+  FixedArray<nat_t> r(100000);
+
+  for (nat_t i = 0; i < r.size(); ++i)
+    r[i] = r.size() - i;
+
+  parallel_stable_sort(r, std::less<nat_t>(), pool);
+  assert(is_sorted(r));
+
+  for (nat_t i = 0; i < r.size(); ++i)
+    r[i] = 7;
+
+  parallel_stable_sort(r, std::less<nat_t>(), pool);
+  assert(is_sorted(r));
+
+  // Equal keys keep their original order.
+  DynArray<Item> items;
+
+  for (nat_t i = 0; i < 100000; ++i)
+    items.append(Item{random_uniform(rng, nat_t(100)), i});
+
+  parallel_stable_sort(items, [] (const Item & x, const Item & y)
+		       {
+			 return x.key < y.key;
+		       }, pool);
+
+  for (nat_t i = 1; i < items.size(); ++i)
+    assert(items[i - 1].key < items[i].key or
+	   (items[i - 1].key == items[i].key and
+	    items[i - 1].pos < items[i].pos));
+
+  for (nat_t n : { nat_t(0), nat_t(1), nat_t(20), nat_t(1000), nat_t(100000) })
+    {
+      DynArray<Item> seq;
+
+      for (nat_t i = 0; i < n; ++i)
+	seq.append(Item{random_uniform(rng, nat_t(100)), i});
+
+      stable_sort(seq, [] (const Item & x, const Item & y)
+		  {
+		    return x.key < y.key;
+		  });
+
+      for (nat_t i = 1; i < seq.size(); ++i)
+	assert(seq[i - 1].key < seq[i].key or
+	       (seq[i - 1].key == seq[i].key and
+		seq[i - 1].pos < seq[i].pos));
+    }
+
+  // Subranges and the shared pool.
+  DynArray<int_t> s;
+
+  for (int_t i = 0; i < 50000; ++i)
+    s.append(50000 - i);
+
+  parallel_stable_sort(s, 100, 40000, less, ThreadPool::shared());
+
+  assert(s[99] == 50000 - 99);
+  assert(s[100] == 50000 - 40000);
+  assert(s[40000] == 50000 - 100);
+  assert(s[40001] == 50000 - 40001);
+
+  parallel_sort(s);
+  assert(is_sorted(s));
+
+  // Distributions which break naive quicksorts.
+  constexpr nat_t M = 100000;
+
+  auto fill = [&rng] (FixedArray<int_t> & a, nat_t kind)
+    {
+      for (nat_t i = 0; i < a.size(); ++i)
+	switch (kind)
+	  {
+	  case 0: a[i] = random_uniform(rng, int_t(M)); break;
+	  case 1: a[i] = i; break;
+	  case 2: a[i] = M - i; break;
+	  case 3: a[i] = random_uniform(rng, int_t(4)); break;
+	  case 4: a[i] = i % 1000; break;
+	  case 5: a[i] = i < M / 2 ? i : M - i; break;
+	  default: a[i] = i == M - 1 ? 0 : i + 1;
+	  }
+    };
+
+  for (nat_t kind = 0; kind < 7; ++kind)
+    {
+      FixedArray<int_t> a(M);
+      fill(a, kind);
+
+      FixedArray<int_t> expected = a;
+      parallel_stable_sort(expected, less, pool);
+
+      FixedArray<int_t> q = a;
+      quicksort(q);
+
+      FixedArray<int_t> g = a;
+      quicksort(g, std::greater<int_t>());
+
+      nat_t num_heap_cmp = 0;
+      FixedArray<int_t> h = a;
+      heapsort(h, 0, M - 1, [&num_heap_cmp] (int_t x, int_t y)
+	       {
+		 ++num_heap_cmp;
+		 return x < y;
+	       });
+
+      // Bottom-up heapsort: about n log n comparisons, not 2 n log n.
+      assert(num_heap_cmp < M * 19);
+
+      FixedArray<int_t> p = a;
+      parallel_sort(p, less, pool);
+
+      nat_t num_cmp = 0;
+      FixedArray<int_t> c = a;
+      quicksort(c, [&num_cmp] (int_t x, int_t y)
+		{
+		  ++num_cmp;
+		  return x < y;
+		});
+
+      // O(n log n) comparisons even on adversarial patterns.
+      assert(num_cmp < 4 * M * 17);
+
+      for (nat_t i = 0; i < M; ++i)
+	{
+	  assert(q[i] == expected[i]);
+	  assert(g[i] == expected[M - 1 - i]);
+	  assert(h[i] == expected[i]);
+	  assert(p[i] == expected[i]);
+	  assert(c[i] == expected[i]);
+	}
+    }
+
+  // Heap algorithms.
+  for (nat_t kind = 0; kind < 7; ++kind)
+    {
+      FixedArray<int_t> a(M);
+      fill(a, kind);
+
+      FixedArray<int_t> sorted = a;
+      quicksort(sorted);
+
+      FixedArray<int_t> h = a;
+      make_heap(h);
+      assert(is_heap(h));
+      assert(h[0] == sorted[M - 1]);
+
+      sort_heap(h);
+
+      for (nat_t i = 0; i < M; ++i)
+	assert(h[i] == sorted[i]);
+
+      make_heap(h, std::greater<int_t>());
+      assert(is_heap(h, std::greater<int_t>()));
+      assert(h[0] == sorted[0]);
+    }
+
+  DynArray<int_t> pq;
+  DynArray<int_t> pq_keys;
+
+  for (nat_t i = 0; i < 20000; ++i)
+    if (pq.is_empty() or random_uniform(rng, 3) > 0)
+      {
+	pq.append(random_uniform(rng, 1000));
+	pq_keys.append(pq.get_last());
+	push_heap(pq);
+	assert(is_heap(pq));
+      }
+    else
+      {
+	pop_heap(pq);
+	int_t top = pq.remove_last();
+
+	nat_t pos = 0;
+
+	for (nat_t j = 1; j < pq_keys.size(); ++j)
+	  if (pq_keys[j] > pq_keys[pos])
+	    pos = j;
+
+	assert(top == pq_keys[pos]);
+	std::swap(pq_keys[pos], pq_keys[pq_keys.size() - 1]);
+	pq_keys.remove_last();
+	assert(is_heap(pq, 0, pq.size() - 1, less));
+      }
+
+  DynArray<int_t> not_heap = { 1, 5, 3 };
+  assert(not is_heap(not_heap));
+  assert(is_heap(not_heap, 1, 2, less));
+  assert(is_heap(DynArray<int_t>()));
+
+  // Selection.
+  for (nat_t kind = 0; kind < 7; ++kind)
+    {
+      FixedArray<int_t> a(M);
+      fill(a, kind);
+
+      FixedArray<int_t> sorted = a;
+      quicksort(sorted);
+
+      for (int_t n : { int_t(0), int_t(1), int_t(M / 3), int_t(M / 2),
+	    int_t(M - 1) })
+	{
+	  FixedArray<int_t> s = a;
+	  nth_element(s, n);
+
+	  assert(s[n] == sorted[n]);
+
+	  for (int_t i = 0; i < int_t(M); ++i)
+	    assert(i < n ? s[i] <= s[n] : s[i] >= s[n]);
+	}
+
+      FixedArray<int_t> p = a;
+      partial_sort(p, 1000, std::greater<int_t>());
+
+      for (nat_t i = 0; i < 1000; ++i)
+	assert(p[i] == sorted[M - 1 - i]);
+    }
+
+  DynArray<int_t> few = { 5, 1, 4 };
+
+  partial_sort(few, 10);
+  assert(few[0] == 1 and few[1] == 4 and few[2] == 5);
+
+  nth_element(few, 0, 2, 1, std::greater<int_t>());
+  assert(few[1] == 4);
+
+  bool thrown = false;
+
+  try
+    {
+      nth_element(few, 3);
+    }
+  catch (const std::out_of_range &)
+    {
+      thrown = true;
+    }
+
+  assert(thrown);
+
+  SLList<nat_t> stream;
+  DynArray<nat_t> stream_sorted;
+
+  for (nat_t i = 0; i < 10000; ++i)
+    {
+      stream.append(random_uniform(rng, nat_t(5000)));
+      stream_sorted.append(stream.get_last());
+    }
+
+  quicksort(stream_sorted);
+
+  for (nat_t k : { nat_t(0), nat_t(1), nat_t(100), nat_t(20000) })
+    {
+      auto top = top_k(stream, k);
+      auto unsorted = top_k_unsorted_it(stream.begin(), stream.end(), k);
+      auto largest = top_k_it(stream_sorted.begin(), stream_sorted.end(), k,
+			      std::greater<nat_t>());
+
+      nat_t m = std::min(k, stream.size());
+
+      assert(top.size() == m and unsorted.size() == m and
+	     largest.size() == m);
+
+      quicksort(unsorted);
+
+      for (nat_t i = 0; i < m; ++i)
+	{
+	  assert(top[i] == stream_sorted[i]);
+	  assert(unsorted[i] == stream_sorted[i]);
+	  assert(largest[i] == stream_sorted[stream.size() - 1 - i]);
+	}
+    }
+
+  DynArray<string> words;
+
+  for (nat_t i = 0; i < 5000; ++i)
+    words.append(to_string(random_uniform(rng, nat_t(300))));
+
+  quicksort(words);
+
+  for (nat_t i = 1; i < words.size(); ++i)
+    assert(not (words[i] < words[i - 1]));
+
+  // Natural merge sort of lists.
+  auto item_cmp = [] (const Item & x, const Item & y) { return x.key < y.key; };
+
+  for (nat_t kind = 0; kind < 4; ++kind)
+    {
+      SLList<Item> sl;
+      DLList<Item> dl;
+
+      for (nat_t i = 0; i < M; ++i)
+	{
+	  nat_t key = kind == 0 ? random_uniform(rng, nat_t(50)) :
+	    kind == 1 ? i : kind == 2 ? M - i : i % 100;
+	  sl.append(Item{key, i});
+	  dl.append(Item{key, i});
+	}
+
+      mergesort(sl, item_cmp);
+      mergesort(dl, item_cmp);
+
+      // The tail is updated, so appending keeps working.
+      sl.append(Item{M, M});
+      dl.append(Item{M, M});
+
+      assert(sl.size() == M + 1);
+      assert(dl.size() == M + 1);
+      assert(sl.get_last().pos == M);
+      assert(dl.get_last().pos == M);
+
+      auto is_stable_sorted = [] (const Item & x, const Item & y)
+	{
+	  return x.key < y.key or (x.key == y.key and x.pos < y.pos);
+	};
+
+      assert(sl.is_sorted(is_stable_sorted));
+      assert(dl.is_sorted(is_stable_sorted));
+
+      nat_t n = 0;
+
+      for (auto it = dl.begin(); it != dl.end(); ++it)
+	++n;
+
+      assert(n == M + 1);
+
+      dl.remove_last();
+
+      while (not dl.is_empty())
+	dl.remove_last();
+    }
+
+  NodeSLList<int_t> nl;
+  assert((mergesort(nl), nl.is_empty()));
+
+  for (int_t i = 0; i < 10; ++i)
+    nl.append(new SLNode<int_t>(9 - i));
+
+  mergesort(nl, std::greater<int_t>());
+  mergesort(nl);
+
+  for (int_t i = 0; i < 10; ++i)
+    {
+      auto p = nl.remove_first();
+      assert(p->get_item() == i);
+      delete p;
+    }
+
+  assert(nl.is_empty());
+
+  DLList<int_t> dli = { 3, 1, 2 };
+  assert(sort(dli).equal({1, 2, 3}));
+  inline_sort(dli, std::greater<int_t>());
+  assert(dli.equal({3, 2, 1}));
+
+  cout << "Everything ok!\n";
+  return 0;
+}
@@ -284,6 +284,47 @@ int main()
     {
       assert(false);
     }
+
+
+  InlineStack<int_t, 4> inline_stack;
+
+  assert(inline_stack.is_empty() and inline_stack.size() == 0);
+
+  for (int_t i = 0; i < 10; ++i)
+    assert(inline_stack.push(i) == i);
+
+  assert(inline_stack.size() == 10 and inline_stack.top() == 9);
+
+  InlineStack<int_t, 4> inline_copy = inline_stack;
+
+  assert(inline_stack.pop() == 9 and inline_stack.pop() == 8);
+  inline_stack.popn(5);
+  assert(inline_stack.size() == 3 and inline_stack.top() == 2);
+
+  InlineStack<int_t, 4> inline_moved = std::move(inline_copy);
+
+  for (int_t i = 9; i >= 0; --i)
+    assert(inline_moved.pop() == i);
+
+  assert(inline_moved.is_empty());
+
+  inline_moved.push(7);
+  inline_moved.swap(inline_stack);
+
+  assert(inline_moved.size() == 3 and inline_stack.size() == 1);
+  assert(inline_moved.top() == 2 and inline_stack.top() == 7);
+
+  inline_moved.clear();
+
+  try
+    {
+      inline_moved.pop();
+      assert(false);
+    }
+  catch(const underflow_error &)
+    {
+      assert(true);
+    }
     
   cout << "Everything ok!\n";
   return 0;
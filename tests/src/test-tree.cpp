@@ -5,10 +5,61 @@
 */
 
 #include <set.hpp>
+#include <random.hpp>
 
 using namespace std;
 using namespace Designar;
 
+// Polynomial hash of the sequence of keys, so the order counts.
+struct SeqHash
+{
+  using ValueType = pair<nat_t, nat_t>;
+
+  static ValueType identity()
+  {
+    return make_pair(1, 0);
+  }
+
+  static ValueType lift(int_t k)
+  {
+    return make_pair(31, nat_t(k));
+  }
+
+  static ValueType combine(const ValueType & a, const ValueType & b)
+  {
+    return make_pair(a.first * b.first, a.second * b.first + b.second);
+  }
+};
+
+struct MaxKey
+{
+  using ValueType = int_t;
+
+  static int_t identity()
+  {
+    return std::numeric_limits<int_t>::min();
+  }
+
+  static int_t lift(int_t k)
+  {
+    return k;
+  }
+
+  static int_t combine(int_t a, int_t b)
+  {
+    return std::max(a, b);
+  }
+};
+
+struct CmpFirst
+{
+  bool operator () (const pair<int_t, int_t> & a,
+		    const pair<int_t, int_t> & b) const
+  {
+    return a.first < b.first;
+  }
+};
+
 int main()
 {
   TreeSet<int_t> tree = { 2,4,6,8,10 };
@@ -172,6 +223,251 @@ int main()
 
   assert(ts1.zip(ts2).equal({{1,3},{2,4},{3,5},{4,6}}));
 
+  // Linear construction from sorted keys.
+  DynArray<int_t> sorted_keys;
+
+  for (int_t i = 0; i < 10000; ++i)
+    sorted_keys.append(3 * i);
+
+  TreeSet<int_t> built = sorted_keys;
+
+  assert(built.verify());
+  assert(built.size() == 10000);
+
+  for (int_t i = 0; i < 10000; i += 7)
+    assert(built.select(i) == 3 * i and built.position(3 * i) == i);
+
+  assert(built.insert(5) != nullptr and built.remove(0) and built.verify());
+
+  sorted_keys.append(0);
+
+  TreeSet<int_t> unsorted = sorted_keys;
+  assert(unsorted.verify() and unsorted.size() == 10000);
+
+  RankedTreap<int_t> built_dup;
+  built_dup.build_from_sorted(DynArray<int_t>({1,1,2,2,2,3}));
+
+  assert(built_dup.verify_dup());
+  assert(built_dup.equal<SLList<int_t>>({1,1,2,2,2,3}));
+
+  built_dup.build_from_sorted(DynArray<int_t>());
+  assert(built_dup.is_empty());
+
+  // Join-based set operations, large enough to run in parallel.
+  rng_t rng(31);
+  ThreadPool pool(4);
+
+  const int_t universe = 60000;
+  FixedArray<bool> in1(universe), in2(universe);
+  RankedTreap<int_t> s1(7), s2(11);
+
+  for (int_t k = 0; k < universe; ++k)
+    {
+      in1[k] = random_uniform(rng, 3) == 0;
+      in2[k] = random_uniform(rng, 2) == 0;
+
+      if (in1[k])
+	s1.insert(k);
+
+      if (in2[k])
+	s2.insert(k);
+    }
+
+  RankedTreap<int_t> u = s1, i = s1, d = s1, e = s2;
+  RankedTreap<int_t> t2 = s2;
+  u.join_with(t2, &pool);
+  assert(t2.is_empty());
+  t2 = s2;
+  i.intersect_with(t2, &pool);
+  t2 = s2;
+  d.difference_with(t2, &pool);
+  t2 = s1;
+  e.difference_with(t2, &pool);
+
+  assert(u.verify() and i.verify() and d.verify() and e.verify());
+
+  for (int_t k = 0; k < universe; ++k)
+    {
+      assert(u.contains(k) == (in1[k] or in2[k]));
+      assert(i.contains(k) == (in1[k] and in2[k]));
+      assert(d.contains(k) == (in1[k] and not in2[k]));
+      assert(e.contains(k) == (in2[k] and not in1[k]));
+    }
+
+  assert(u.size() == s1.size() + e.size());
+  assert(s1.join(s2).equal(u) and s1.intersect(s2).equal(i));
+  assert(s1.difference(s2).equal(d));
+
+  RankedTreap<int_t> empty;
+  assert(RankedTreap<int_t>::intersect(s1, empty).is_empty());
+  assert(RankedTreap<int_t>::difference(s1, empty).equal(s1));
+  assert(RankedTreap<int_t>::join(empty, s2).equal(s2));
+
+  // Keys of the receiver are kept over equal ones.
+  RankedTreap<pair<int_t, int_t>, CmpFirst> p1, p2;
+
+  for (int_t k = 0; k < 10000; ++k)
+    {
+      if (k % 2 == 0)
+	p1.insert(make_pair(k, 1));
+
+      if (k % 3 == 0)
+	p2.insert(make_pair(k, 2));
+    }
+
+  RankedTreap<pair<int_t, int_t>, CmpFirst> q1 = p1, q2 = p2;
+  p1.join_with(p2, &pool);
+  q1.intersect_with(q2, &pool);
+
+  assert(p1.verify() and q1.verify());
+  assert(p1.size() == 5000 + 3334 - 1667 and q1.size() == 1667);
+  assert(p1.all([] (auto & p) { return p.second == (p.first % 2 ? 2 : 1); }));
+  assert(q1.all([] (auto & p) { return p.second == 1; }));
+
+  // Batches, sorted or not, with keys already in the tree.
+  DynArray<int_t> batch;
+
+  for (int_t k = 0; k < 20000; k += 2)
+    batch.append(k);
+
+  nat_t old_size = s1.size();
+  nat_t num_new = s1.multi_insert(batch, &pool);
+
+  assert(s1.verify() and s1.size() == old_size + num_new);
+
+  for (int_t k = 0; k < 20000; ++k)
+    assert(s1.contains(k) == (in1[k] or k % 2 == 0));
+
+  assert(s1.multi_insert(batch, &pool) == 0);
+  assert(s1.multi_insert(DynArray<int_t>({universe + 5, universe + 1,
+	    universe + 5})) == 2);
+  assert(s1.verify() and s1.max() == universe + 5);
+
+  // Seek iterators and range queries against a scan.
+  RankedTreap<int_t> w;
+
+  for (int_t k = 0; k < 3000; ++k)
+    if (random_uniform(rng, 2) == 0)
+      w.insert(k);
+
+  for (nat_t q = 0; q < 500; ++q)
+    {
+      int_t lo = random_uniform(rng, -10, 3010);
+      int_t hi = random_uniform(rng, -10, 3010);
+
+      nat_t num = w.filter([lo, hi] (int_t k)
+			   {
+			     return lo <= k and k <= hi;
+			   }).size();
+      assert(w.count_range(lo, hi) == num);
+
+      nat_t n = 0;
+      int_t prev = lo - 1;
+      w.for_each_in_range(lo, hi, [&] (int_t k)
+			  {
+			    assert(prev < k and lo <= k and k <= hi);
+			    prev = k;
+			    ++n;
+			  });
+      assert(n == num);
+
+      auto lb = w.lower_bound(lo);
+      auto ub = w.upper_bound(lo);
+      const int_t * first = w.search_ptr([lo] (int_t k) { return k >= lo; });
+      const int_t * next = w.search_ptr([lo] (int_t k) { return k > lo; });
+
+      assert(first == nullptr ? lb == w.end() : *lb == *first);
+      assert(next == nullptr ? ub == w.end() : *ub == *next);
+
+      nat_t i = random_uniform(rng, w.size() + 2);
+      auto it = w.seek(i);
+
+      for (nat_t j = i; j < w.size() and j < i + 20; ++j, ++it)
+	assert(*it == w.select(j));
+
+      if (i >= w.size())
+	assert(it == w.end());
+    }
+
+  RankedTreap<int_t> ww = w;
+  nat_t total = ww.size();
+
+  assert(ww.remove_range(500, 400) == 0);
+  assert(ww.remove_range(1000, 1999) == w.count_range(1000, 1999));
+  assert(ww.verify() and ww.size() == total - w.count_range(1000, 1999));
+  assert(ww.count_range(1000, 1999) == 0);
+  assert(ww.count_range(0, 999) == w.count_range(0, 999));
+  assert(ww.remove_range(-5, 500) + ww.remove_range(2500, 5000) ==
+	 w.count_range(0, 500) + w.count_range(2500, 2999));
+  assert(ww.verify() and ww.min() > 500 and ww.max() < 2500);
+  ww.remove_range(-1, 3000);
+  assert(ww.is_empty());
+
+  // Aggregates kept through insertions, removals, splits and joins.
+  GenRankedTreap<int_t, std::less<int_t>, SeqHash> h;
+  GenRankedTreap<int_t, std::less<int_t>, MaxKey> mx = {5, 1, 9};
+
+  assert(mx.aggregate() == 9 and mx.aggregate(2, 8) == 5);
+  assert(mx.aggregate(6, 8) == MaxKey::identity());
+
+  for (nat_t i = 0; i < 6000; ++i)
+    {
+      int_t k = random_uniform(rng, 4000);
+
+      if (random_uniform(rng, 3) < 2)
+	h.insert(k);
+      else
+	h.remove(k);
+    }
+
+  auto scan = [&h] (int_t lo, int_t hi)
+    {
+      SeqHash::ValueType ret_val = SeqHash::identity();
+
+      h.for_each([&] (int_t k)
+		 {
+		   if (lo <= k and k <= hi)
+		     ret_val = SeqHash::combine(ret_val, SeqHash::lift(k));
+		 });
+
+      return ret_val;
+    };
+
+  assert(h.verify() and h.aggregate() == scan(-1, 4000));
+
+  for (nat_t q = 0; q < 300; ++q)
+    {
+      int_t lo = random_uniform(rng, -5, 4005);
+      int_t hi = random_uniform(rng, -5, 4005);
+
+      assert(h.aggregate(lo, hi) == scan(lo, hi));
+
+      nat_t i = random_uniform(rng, h.size());
+      nat_t j = random_uniform(rng, h.size());
+
+      if (i <= j)
+	assert(h.aggregate_pos(i, j) == scan(h.select(i), h.select(j)));
+    }
+
+  h.remove_range(1000, 1999);
+  h.multi_insert(DynArray<int_t>({1500, 1200, 7000}));
+  auto h2 = h.split_pos(h.size() / 2);
+
+  assert(get<0>(h2).aggregate(-1, 10000) != SeqHash::identity());
+  h.exclusive_join(get<0>(h2), get<1>(h2));
+  assert(h.verify() and h.aggregate() == scan(-1, 10000));
+  assert(h.aggregate(1000, 1999) == scan(1000, 1999));
+
+  try
+    {
+      h.aggregate_pos(1, h.size());
+      assert(false);
+    }
+  catch(const out_of_range &)
+    {
+      assert(true);
+    }
+
   TreeSet<int> ttt{1,2,3,4,5,6,7,8,9,10};
 
   ttt.remove_first_if([] (auto item) { return item > 5; });
@@ -179,6 +475,24 @@ int main()
 
   ttt.remove_if( [] (int x) { return (x & 1); });
   assert(ttt.equal({2,4,8,10}));
+
+  // Assigned iterators work on the tree of the source.
+  RankedTreap<int_t> other = { 1, 2, 3 };
+
+  auto it_other = other.begin();
+  it_other = w.lower_bound(1000);
+
+  int_t first_from = *it_other;
+
+  assert(it_other.del() == first_from and not w.search(first_from));
+  assert(other.size() == 3 and w.verify());
+
+  auto it_copy = it_other;
+
+  for (nat_t i = 0; i < 10; ++i, ++it_other)
+    ;
+
+  assert(*it_copy > first_from and *it_copy < *it_other);
   
   cout << "Everything ok!\n";
 